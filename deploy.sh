@@ -4,7 +4,10 @@ set -euo pipefail
 TARGET_IP="${TARGET_IP:-192.168.33.254}"
 TARGET_USER="${TARGET_USER:-root}"
 BIN_SRC="${BIN_SRC:-src/build/target/nanohat-oled}"
+STATUS_SRC="${STATUS_SRC:-$(dirname "$BIN_SRC")/nanohat-status}"
+MIRROR_SRC="${MIRROR_SRC:-$(dirname "$BIN_SRC")/nanohat-mirror}"
 INIT_SRC="${INIT_SRC:-src/nanohat-oled.init}"
+CONFIG_SRC="${CONFIG_SRC:-src/nanohat-oled.config}"
 SSH_OPTS="${SSH_OPTS:-"-o BatchMode=yes -o StrictHostKeyChecking=accept-new"}"
 
 usage() {
@@ -46,11 +49,28 @@ remote "service nanohat-oled stop" || true
 echo "Uploading binary to /usr/bin/nanohat-oled..."
 scp $SSH_OPTS "$BIN_SRC" "$TARGET_USER@$TARGET_IP:/usr/bin/nanohat-oled"
 
+if [ -f "$STATUS_SRC" ]; then
+    echo "Uploading status reader to /usr/bin/nanohat-status..."
+    scp $SSH_OPTS "$STATUS_SRC" "$TARGET_USER@$TARGET_IP:/usr/bin/nanohat-status"
+    remote "chmod +x /usr/bin/nanohat-status"
+fi
+
+if [ -f "$MIRROR_SRC" ]; then
+    echo "Uploading mirror viewer to /usr/bin/nanohat-mirror..."
+    scp $SSH_OPTS "$MIRROR_SRC" "$TARGET_USER@$TARGET_IP:/usr/bin/nanohat-mirror"
+    remote "chmod +x /usr/bin/nanohat-mirror"
+fi
+
 if [ -f "$INIT_SRC" ]; then
     echo "Uploading init script..."
     scp $SSH_OPTS "$INIT_SRC" "$TARGET_USER@$TARGET_IP:/etc/init.d/nanohat-oled"
 fi
 
+if [ -f "$CONFIG_SRC" ] && ! remote "test -f /etc/config/nanohat-oled"; then
+    echo "Uploading default config to /etc/config/nanohat-oled..."
+    scp $SSH_OPTS "$CONFIG_SRC" "$TARGET_USER@$TARGET_IP:/etc/config/nanohat-oled"
+fi
+
 echo "Setting permissions..."
 remote "chmod +x /usr/bin/nanohat-oled"
 if [ -f "$INIT_SRC" ]; then
@@ -0,0 +1,244 @@
+#include "app_loop.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <libubox/uloop.h>
+
+#include "hal/gpio_hal.h"
+#include "hal/time_hal.h"
+#include "input_latency.h"
+#include "loop_watch.h"
+#include "metrics.h"
+#include "session_log.h"
+
+static void schedule_ui_timer(void);
+
+static ui_controller_t g_ui;
+static struct uloop_timeout g_ui_timer;
+static uint64_t g_ui_timer_due_ms;
+static struct uloop_timeout g_render_kick;  /* Coalesced render after async results */
+static int g_press_dispatch = -1;           /* Line masks pushed to gpio_hal, -1 = none yet */
+static int g_auto_repeat = -1;
+static int g_gesture_keys = -1;             /* Gesture keys pushed to gpio_hal */
+static app_loop_frame_observer_t g_frame_observer;
+
+LOOP_WATCH_SOURCE(g_watch_ui_timer, "ui-timer");
+LOOP_WATCH_SOURCE(g_watch_render_kick, "render");
+
+METRIC_COUNTER(g_m_gpio_events, "gpio_events");
+
+/* Gesture key -> GPIO gesture recognized for it */
+static const struct {
+    uint8_t key;
+    gpio_gesture_t gesture;
+} g_gesture_map[] = {
+    { KEY_K1_K2, { GPIO_GESTURE_CHORD, GPIO_LINE_BIT(0) | GPIO_LINE_BIT(1), GPIO_EVT_CHORD_K1_K2 } },
+    { KEY_K1_K3, { GPIO_GESTURE_CHORD, GPIO_LINE_BIT(0) | GPIO_LINE_BIT(2), GPIO_EVT_CHORD_K1_K3 } },
+    { KEY_K2_DOUBLE, { GPIO_GESTURE_DOUBLE, GPIO_LINE_BIT(1), GPIO_EVT_BTN_K2_DOUBLE } },
+};
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static bool render(uint64_t now_ms) {
+    if (!g_frame_observer) {
+        return ui_controller_render(&g_ui, now_ms);
+    }
+
+    uint64_t start_ns = monotonic_ns();
+    bool rendered = ui_controller_render(&g_ui, now_ms);
+    if (rendered) {
+        g_frame_observer(monotonic_ns() - start_ns);
+    }
+    return rendered;
+}
+
+static uint8_t keys_to_lines(uint8_t keys) {
+    uint8_t lines = 0;
+    for (int line = 0; line < GPIO_NUM_BUTTONS; line++) {
+        if (keys & KEY_BIT(KEY_K1 + line)) {
+            lines |= GPIO_LINE_BIT(line);
+        }
+    }
+    return lines;
+}
+
+/*
+ * Push the key policy of the current UI state to the GPIO HAL: keys
+ * without a long-press action fire on the press edge (no wait for
+ * release), list keys opted in by the page auto-repeat while held, and
+ * only the gestures the state handles are recognized.
+ * Re-evaluated after every input and tick, since mode and screen state
+ * change in both.
+ */
+static void update_key_policy(void) {
+    if (gpio_hal->set_press_dispatch) {
+        uint8_t lines = keys_to_lines(page_controller_press_dispatch_keys(&g_ui.page_ctrl));
+        if (lines != g_press_dispatch) {
+            g_press_dispatch = lines;
+            gpio_hal->set_press_dispatch(lines);
+        }
+    }
+
+    if (gpio_hal->set_auto_repeat) {
+        uint8_t lines = keys_to_lines(page_controller_repeat_keys(&g_ui.page_ctrl));
+        if (lines != g_auto_repeat) {
+            g_auto_repeat = lines;
+            gpio_hal->set_auto_repeat(lines);
+        }
+    }
+
+    if (gpio_hal->set_gestures) {
+        uint8_t keys = page_controller_gesture_keys(&g_ui.page_ctrl);
+        if (keys != g_gesture_keys) {
+            gpio_gesture_t table[GPIO_GESTURE_MAX];
+            int count = 0;
+            for (size_t i = 0; i < sizeof(g_gesture_map) / sizeof(g_gesture_map[0]); i++) {
+                if (keys & KEY_BIT(g_gesture_map[i].key)) {
+                    table[count++] = g_gesture_map[i].gesture;
+                }
+            }
+            gpio_gesture_config_t config = { .gestures = table, .count = count };
+            g_gesture_keys = keys;
+            gpio_hal->set_gestures(&config);
+        }
+    }
+}
+
+/*
+ * Button event handler - called when a button press/release is detected
+ */
+static void handle_button_event(const gpio_event_t *event) {
+    if (!event) {
+        return;
+    }
+
+    uint64_t now_ms = event->timestamp_ns / 1000000ULL;
+
+    uint8_t key = 0;
+    bool long_press = false;
+    int presses = 1;
+    switch (event->type) {
+        case GPIO_EVT_BTN_K1_SHORT: key = KEY_K1; break;
+        case GPIO_EVT_BTN_K2_SHORT: key = KEY_K2; break;
+        case GPIO_EVT_BTN_K3_SHORT: key = KEY_K3; break;
+        case GPIO_EVT_BTN_K1_LONG:  key = KEY_K1; long_press = true; break;
+        case GPIO_EVT_BTN_K2_LONG:  key = KEY_K2; long_press = true; break;
+        case GPIO_EVT_BTN_K3_LONG:  key = KEY_K3; long_press = true; break;
+        /* Auto-repeat: one short press per (possibly coalesced) step */
+        case GPIO_EVT_BTN_K1_REPEAT: key = KEY_K1; presses = event->repeat; break;
+        case GPIO_EVT_BTN_K2_REPEAT: key = KEY_K2; presses = event->repeat; break;
+        case GPIO_EVT_BTN_K3_REPEAT: key = KEY_K3; presses = event->repeat; break;
+        /* Gestures */
+        case GPIO_EVT_CHORD_K1_K2:   key = KEY_K1_K2; break;
+        case GPIO_EVT_CHORD_K1_K3:   key = KEY_K1_K3; break;
+        case GPIO_EVT_BTN_K2_DOUBLE: key = KEY_K2_DOUBLE; break;
+        default: break;
+    }
+
+    if (key != 0) {
+        /* Measure from the edge through handling, render and flush */
+        input_latency_begin(event->timestamp_ns);
+        for (int i = 0; i < presses; i++) {
+            ui_controller_handle_button(&g_ui, key, long_press, now_ms);
+        }
+        input_latency_mark(INPUT_LATENCY_HANDLED);
+        if (!render(now_ms)) {
+            input_latency_end();
+        }
+        update_key_policy();
+        schedule_ui_timer();
+    }
+}
+
+void app_loop_gpio_readable(void) {
+    gpio_event_t event;
+    int ret;
+
+    /* Read all available events */
+    while ((ret = gpio_hal->read_event(&event)) > 0) {
+        metric_inc(&g_m_gpio_events);
+        handle_button_event(&event);
+    }
+
+    if (ret < 0) {
+        fprintf(stderr, "WARN: gpio read_event error\n");
+    }
+}
+
+/*
+ * Render requested from ubus completion callbacks (e.g. batch progress).
+ * A zero timeout coalesces completions arriving in the same loop iteration.
+ */
+static void render_kick_cb(struct uloop_timeout *t) {
+    loop_watch_timeout_begin(&g_watch_render_kick, t);
+    render(time_hal_now_ms());
+    schedule_ui_timer();
+    loop_watch_end(&g_watch_render_kick);
+}
+
+static void request_render(void) {
+    g_render_kick.cb = render_kick_cb;
+    uloop_timeout_set(&g_render_kick, 0);
+}
+
+static void ui_timer_cb(struct uloop_timeout *t) {
+    loop_watch_timeout_begin(&g_watch_ui_timer, t);
+
+    uint64_t now_ms = time_hal_now_ms();
+    session_log_timer(g_ui_timer_due_ms, now_ms);
+    ui_controller_tick(&g_ui, now_ms);
+    render(now_ms);
+    update_key_policy();
+    schedule_ui_timer();
+
+    loop_watch_end(&g_watch_ui_timer);
+}
+
+static void schedule_ui_timer(void) {
+    int next_ms = ui_controller_next_timeout_ms(&g_ui);
+    if (next_ms > 0) {
+        g_ui_timer.cb = ui_timer_cb;
+        g_ui_timer_due_ms = time_hal_now_ms() + (uint64_t)next_ms;
+        uloop_timeout_set(&g_ui_timer, next_ms);
+    }
+}
+
+void app_loop_init(void) {
+    ui_controller_init(&g_ui);
+    g_ui.render_hook = request_render;
+    g_press_dispatch = -1;
+    g_auto_repeat = -1;
+    g_gesture_keys = -1;
+}
+
+void app_loop_start(void) {
+    uint64_t now_ms = time_hal_now_ms();
+    ui_controller_tick(&g_ui, now_ms);
+    render(now_ms);
+    update_key_policy();
+    schedule_ui_timer();
+}
+
+void app_loop_cleanup(void) {
+    uloop_timeout_cancel(&g_ui_timer);
+    uloop_timeout_cancel(&g_render_kick);
+    ui_controller_cleanup(&g_ui);
+}
+
+ui_controller_t *app_loop_ui(void) {
+    return &g_ui;
+}
+
+void app_loop_reload_config(void) {
+    ui_controller_reload_config(&g_ui);
+    render(time_hal_now_ms());
+    schedule_ui_timer();
+}
+
+void app_loop_set_frame_observer(app_loop_frame_observer_t observer) {
+    g_frame_observer = observer;
+}
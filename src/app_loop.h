@@ -0,0 +1,56 @@
+/*
+ * UI event wiring for the uloop main loop
+ *
+ * Owns the UI controller and connects it to the HALs:
+ * - GPIO events -> key handling -> render (with latency instrumentation)
+ * - UI tick timer scheduled from ui_controller_next_timeout_ms()
+ * - coalesced render kick for async completions (ubus results)
+ * - key policy (press dispatch, auto-repeat, gestures) pushed to gpio_hal
+ *
+ * main.c adds the process around it (HAL init, signals, fd registration);
+ * the host replay tool drives the same wiring in virtual time.
+ * Call from the uloop thread only.
+ */
+#ifndef APP_LOOP_H
+#define APP_LOOP_H
+
+#include <stdint.h>
+
+#include "ui_controller.h"
+
+/*
+ * Initialize the UI controller. HALs must be initialized first.
+ */
+void app_loop_init(void);
+
+/*
+ * First tick and render, key policy and timer. Call once uloop is ready.
+ */
+void app_loop_start(void);
+
+/*
+ * Cancel timers and free the UI controller.
+ */
+void app_loop_cleanup(void);
+
+ui_controller_t *app_loop_ui(void);
+
+/*
+ * Drain and handle all pending gpio_hal events (fd or timer fd readable).
+ */
+void app_loop_gpio_readable(void);
+
+/*
+ * Reload service configuration in place and redraw (SIGHUP).
+ */
+void app_loop_reload_config(void);
+
+/*
+ * Optional observer called after each rendered frame with the time
+ * ui_controller_render() took (CLOCK_MONOTONIC ns, independent of
+ * time_hal). NULL disables the measurement.
+ */
+typedef void (*app_loop_frame_observer_t)(uint64_t render_ns);
+void app_loop_set_frame_observer(app_loop_frame_observer_t observer);
+
+#endif
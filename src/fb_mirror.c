@@ -0,0 +1,259 @@
+#include "fb_mirror.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <libubox/uloop.h>
+
+#include "loop_watch.h"
+#include "metrics.h"
+
+typedef struct {
+    struct uloop_fd ufd;
+    bool used;
+    bool need_key;          /* Send a keyframe once out[] has drained */
+    bool want_write;        /* ULOOP_WRITE registered */
+    size_t out_len;         /* Pending message, 0 when drained */
+    size_t out_sent;
+    uint8_t out[FB_MIRROR_MSG_MAX];
+} mirror_client_t;
+
+static struct uloop_fd g_listen = { .fd = -1 };
+static char g_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static mirror_client_t g_clients[FB_MIRROR_MAX_CLIENTS];
+static int g_client_count;
+
+/* Last flushed frame (display buffer) and last streamed frame */
+static const uint8_t *g_fb;
+static uint8_t g_shadow[FB_MIRROR_FB_SIZE];
+static bool g_shadow_valid;     /* Clients in sync hold g_shadow as frame g_seq */
+static uint32_t g_seq;
+static uint8_t g_delta[FB_MIRROR_MSG_MAX];
+
+LOOP_WATCH_SOURCE(g_watch_mirror, "mirror");
+
+METRIC_COUNTER(g_m_frames, "mirror_frames");
+METRIC_COUNTER(g_m_keyframes, "mirror_keyframes");
+METRIC_COUNTER(g_m_bytes, "mirror_bytes");
+METRIC_COUNTER(g_m_rejected, "mirror_rejected");
+
+static void client_close(mirror_client_t *c) {
+    if (!c->used) return;
+
+    uloop_fd_delete(&c->ufd);
+    close(c->ufd.fd);
+    c->used = false;
+    g_client_count--;
+}
+
+static void client_watch_write(mirror_client_t *c, bool on) {
+    if (c->want_write == on) return;
+    c->want_write = on;
+    uloop_fd_add(&c->ufd, ULOOP_READ | (on ? ULOOP_WRITE : 0));
+}
+
+static void client_service(mirror_client_t *c);
+
+static void client_flush(mirror_client_t *c) {
+    while (c->out_sent < c->out_len) {
+        /* No SIGPIPE when the viewer went away */
+        ssize_t n = send(c->ufd.fd, c->out + c->out_sent, c->out_len - c->out_sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                client_watch_write(c, true);
+                return;
+            }
+            if (errno == EINTR) continue;
+            client_close(c);
+            return;
+        }
+        c->out_sent += (size_t)n;
+        metric_add(&g_m_bytes, (uint64_t)n);
+    }
+    c->out_len = 0;
+    client_watch_write(c, false);
+    client_service(c);
+}
+
+/* Shadow restarts from the current frame: only when no client is in sync */
+static bool shadow_sync(void) {
+    if (!g_fb) return false;
+    memcpy(g_shadow, g_fb, sizeof(g_shadow));
+    g_seq++;
+    g_shadow_valid = true;
+    return true;
+}
+
+/* Keyframe of the shadow when one is owed and nothing is pending */
+static void client_service(mirror_client_t *c) {
+    if (!c->used || !c->need_key || c->out_len > 0) return;
+    if (!g_shadow_valid && !shadow_sync()) return;
+
+    c->need_key = false;
+    c->out_len = fb_mirror_encode(g_shadow, NULL, g_seq, c->out);
+    c->out_sent = 0;
+    metric_inc(&g_m_keyframes);
+    client_flush(c);
+}
+
+static void client_read(mirror_client_t *c) {
+    uint8_t buf[64];
+
+    for (;;) {
+        ssize_t n = read(c->ufd.fd, buf, sizeof(buf));
+        if (n == 0) {
+            client_close(c);
+            return;
+        }
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            if (errno == EINTR) continue;
+            client_close(c);
+            return;
+        }
+        if (memchr(buf, FB_MIRROR_REQ_KEYFRAME, (size_t)n)) {
+            c->need_key = true;
+        }
+    }
+    client_service(c);
+}
+
+static void client_cb(struct uloop_fd *u, unsigned int events) {
+    mirror_client_t *c = container_of(u, mirror_client_t, ufd);
+    loop_watch_begin(&g_watch_mirror);
+    if (events & ULOOP_WRITE) {
+        client_flush(c);
+    }
+    if (c->used && (events & ULOOP_READ)) {
+        client_read(c);
+    }
+    loop_watch_end(&g_watch_mirror);
+}
+
+static void listen_cb(struct uloop_fd *u, unsigned int events) {
+    (void)events;
+    loop_watch_begin(&g_watch_mirror);
+
+    for (;;) {
+        int fd = accept4(u->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) break;
+
+        mirror_client_t *c = NULL;
+        for (int i = 0; i < FB_MIRROR_MAX_CLIENTS; i++) {
+            if (!g_clients[i].used) {
+                c = &g_clients[i];
+                break;
+            }
+        }
+        if (!c) {
+            metric_inc(&g_m_rejected);
+            close(fd);
+            continue;
+        }
+
+        /* Frames went unstreamed while nobody watched */
+        if (g_client_count == 0) {
+            g_shadow_valid = false;
+        }
+        g_client_count++;
+
+        c->used = true;
+        c->need_key = true;
+        c->want_write = false;
+        c->out_len = 0;
+        c->out_sent = 0;
+        c->ufd.fd = fd;
+        c->ufd.cb = client_cb;
+        uloop_fd_add(&c->ufd, ULOOP_READ);
+        client_service(c);
+    }
+
+    loop_watch_end(&g_watch_mirror);
+}
+
+void fb_mirror_frame(const uint8_t *fb) {
+    g_fb = fb;
+    if (!fb || g_client_count == 0) return;
+
+    if (!g_shadow_valid) {
+        /* Nobody in sync yet: everyone waits for a keyframe */
+        shadow_sync();
+    } else {
+        size_t len = fb_mirror_encode(fb, g_shadow, g_seq + 1, g_delta);
+        if (len == 0) return;   /* Static screen */
+
+        g_seq++;
+        memcpy(g_shadow, fb, sizeof(g_shadow));
+        metric_inc(&g_m_frames);
+
+        for (int i = 0; i < FB_MIRROR_MAX_CLIENTS; i++) {
+            mirror_client_t *c = &g_clients[i];
+            if (!c->used) continue;
+            if (c->out_len > 0 || c->need_key) {
+                c->need_key = true;     /* Missed this delta: resync */
+                continue;
+            }
+            memcpy(c->out, g_delta, len);
+            c->out_len = len;
+            c->out_sent = 0;
+            client_flush(c);
+        }
+    }
+
+    for (int i = 0; i < FB_MIRROR_MAX_CLIENTS; i++) {
+        client_service(&g_clients[i]);
+    }
+}
+
+int fb_mirror_start(const char *path) {
+    if (!path || path[0] != '/' || g_listen.fd >= 0) return -1;
+
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    unlink(path);   /* Stale socket from a previous run */
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    snprintf(g_path, sizeof(g_path), "%s", path);
+
+    if (listen(fd, FB_MIRROR_MAX_CLIENTS) != 0) {
+        close(fd);
+        fb_mirror_stop();
+        return -1;
+    }
+
+    g_listen.fd = fd;
+    g_listen.cb = listen_cb;
+    if (uloop_fd_add(&g_listen, ULOOP_READ) < 0) {
+        fb_mirror_stop();
+        return -1;
+    }
+    return 0;
+}
+
+void fb_mirror_stop(void) {
+    for (int i = 0; i < FB_MIRROR_MAX_CLIENTS; i++) {
+        client_close(&g_clients[i]);
+    }
+    if (g_listen.fd >= 0) {
+        uloop_fd_delete(&g_listen);
+        close(g_listen.fd);
+        g_listen.fd = -1;
+    }
+    if (g_path[0]) {
+        unlink(g_path);
+        g_path[0] = '\0';
+    }
+    g_fb = NULL;
+    g_shadow_valid = false;
+}
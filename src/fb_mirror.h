@@ -0,0 +1,130 @@
+/*
+ * Framebuffer mirror
+ *
+ * An optional Unix socket server, driven by uloop, that streams what the
+ * OLED shows (headless debugging, rack dashboards):
+ *
+ *   NANOHAT_MIRROR_LISTEN=/var/run/nanohat-oled.mirror
+ *       nanohat-mirror -p /var/run/nanohat-oled.mirror
+ *
+ * After each frame, fb_mirror_frame() compares the 1 KB framebuffer with
+ * a shadow of the last streamed frame, tile by tile, and sends only the
+ * tiles that changed, RLE-compressed. A static screen costs one 1 KB
+ * memcmp per frame and sends nothing; without clients nothing is
+ * compared at all.
+ *
+ * Framebuffer: u8g2 full-buffer layout, 8 pages of 128 bytes; byte x of
+ * page p holds pixels (x, 8p..8p+7), LSB on top. Tile t (0..127) is
+ * bytes 8t..8t+7: an 8x8 block at page t / 16, column (t % 16) * 8.
+ *
+ * Protocol v1, server to client (integers little-endian):
+ *
+ *   off  size  field
+ *     0     1  magic 'M'
+ *     1     1  type: 'K' keyframe, 'D' delta
+ *     2     2  payload length
+ *     4     4  seq: frame number the payload produces
+ *     8    16  tile map: bit t % 8 of byte t / 8 set = tile t follows
+ *    24     -  changed tiles, in tile order, RLE-compressed
+ *
+ *   RLE: control byte c < 0x80: c + 1 literal bytes follow;
+ *        c >= 0x80: the next byte repeated c - 0x80 + 2 times.
+ *   The encoder only emits runs of 3 or more, so output never exceeds
+ *   the input plus one control byte per 128 bytes.
+ *
+ * A keyframe carries every tile. A delta with seq n turns frame n - 1
+ * into frame n; a client that sees any other seq must resync. A client
+ * gets a keyframe on connect (once a frame exists) and whenever it
+ * writes FB_MIRROR_REQ_KEYFRAME. A client whose socket is still full
+ * when a frame comes skips deltas and gets a keyframe once it drains.
+ *
+ * Server and codec use static state only: no allocation per frame.
+ * uloop thread only; fb_mirror_proto.c (the codec) needs only libc and
+ * is shared with the viewer.
+ */
+#ifndef FB_MIRROR_H
+#define FB_MIRROR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FB_MIRROR_WIDTH       128
+#define FB_MIRROR_HEIGHT      64
+#define FB_MIRROR_FB_SIZE     (FB_MIRROR_WIDTH * FB_MIRROR_HEIGHT / 8)
+#define FB_MIRROR_TILE_SIZE   8
+#define FB_MIRROR_TILES_X     (FB_MIRROR_WIDTH / 8)
+#define FB_MIRROR_TILES       (FB_MIRROR_FB_SIZE / FB_MIRROR_TILE_SIZE)
+#define FB_MIRROR_MAP_SIZE    (FB_MIRROR_TILES / 8)
+
+#define FB_MIRROR_MAGIC       'M'
+#define FB_MIRROR_KEYFRAME    'K'
+#define FB_MIRROR_DELTA       'D'
+#define FB_MIRROR_REQ_KEYFRAME 'K'
+
+#define FB_MIRROR_HEADER_SIZE 8
+/* Worst case RLE: one control byte per 128 literals */
+#define FB_MIRROR_RLE_MAX     (FB_MIRROR_FB_SIZE + (FB_MIRROR_FB_SIZE + 127) / 128)
+#define FB_MIRROR_MSG_MAX     (FB_MIRROR_HEADER_SIZE + FB_MIRROR_MAP_SIZE + FB_MIRROR_RLE_MAX)
+
+#define FB_MIRROR_MAX_CLIENTS 4
+#define FB_MIRROR_DEFAULT_PATH "/var/run/nanohat-oled.mirror"
+
+/*
+ * Server (uloop)
+ */
+
+/*
+ * Listen on the Unix socket path. Returns 0, or -1 on a bad path or
+ * socket error.
+ */
+int fb_mirror_start(const char *path);
+
+/*
+ * Close the listener and all clients (removes the socket).
+ */
+void fb_mirror_stop(void);
+
+/*
+ * A frame was flushed: stream the tiles of fb (FB_MIRROR_FB_SIZE bytes)
+ * that differ from the last streamed frame. fb must stay valid until the
+ * next call (it is read again for a client that connects in between).
+ */
+void fb_mirror_frame(const uint8_t *fb);
+
+/*
+ * Codec (fb_mirror_proto.c)
+ */
+
+/*
+ * RLE-compress len bytes into dst, which holds at least
+ * len + (len + 127) / 128 bytes. Returns the compressed length.
+ */
+size_t fb_mirror_rle_encode(const uint8_t *src, size_t len, uint8_t *dst);
+
+/*
+ * Expand src into dst. Returns the expanded length, or -1 when src is
+ * malformed or would overflow dst_size.
+ */
+int fb_mirror_rle_decode(const uint8_t *src, size_t len, uint8_t *dst, size_t dst_size);
+
+/*
+ * Build a message into msg (FB_MIRROR_MSG_MAX bytes): a delta of fb
+ * against shadow, or a keyframe when shadow is NULL. Returns the message
+ * length, 0 for a delta with no changed tile.
+ */
+size_t fb_mirror_encode(const uint8_t *fb, const uint8_t *shadow, uint32_t seq, uint8_t *msg);
+
+/*
+ * Total message length announced by a header (FB_MIRROR_HEADER_SIZE
+ * bytes), or -1 when it is not a valid header.
+ */
+int fb_mirror_msg_len(const uint8_t *header);
+
+/*
+ * Apply a complete message to fb. Returns the message type
+ * (FB_MIRROR_KEYFRAME or FB_MIRROR_DELTA) and its seq, or -1 when the
+ * message is malformed (fb may then be partly updated).
+ */
+int fb_mirror_decode(const uint8_t *msg, size_t len, uint8_t *fb, uint32_t *seq);
+
+#endif
@@ -0,0 +1,156 @@
+/*
+ * Framebuffer mirror codec (see fb_mirror.h). libc only: also built into
+ * nanohat-mirror.
+ */
+#include "fb_mirror.h"
+
+#include <string.h>
+
+#define RLE_LITERAL_MAX 128
+#define RLE_RUN_MIN     3     /* Shorter runs stay literal */
+#define RLE_RUN_MAX     129
+
+#define PAYLOAD_MIN     FB_MIRROR_MAP_SIZE
+#define PAYLOAD_MAX     (FB_MIRROR_MSG_MAX - FB_MIRROR_HEADER_SIZE)
+
+static uint8_t *put_literals(uint8_t *out, const uint8_t *src, size_t n) {
+    while (n > 0) {
+        size_t chunk = n < RLE_LITERAL_MAX ? n : RLE_LITERAL_MAX;
+        *out++ = (uint8_t)(chunk - 1);
+        memcpy(out, src, chunk);
+        out += chunk;
+        src += chunk;
+        n -= chunk;
+    }
+    return out;
+}
+
+size_t fb_mirror_rle_encode(const uint8_t *src, size_t len, uint8_t *dst) {
+    uint8_t *out = dst;
+    size_t lit_start = 0;
+    size_t i = 0;
+
+    while (i < len) {
+        size_t run = 1;
+        while (i + run < len && run < RLE_RUN_MAX && src[i + run] == src[i]) {
+            run++;
+        }
+        if (run < RLE_RUN_MIN) {
+            i += run;
+            continue;
+        }
+        out = put_literals(out, src + lit_start, i - lit_start);
+        *out++ = (uint8_t)(0x80 + run - 2);
+        *out++ = src[i];
+        i += run;
+        lit_start = i;
+    }
+    out = put_literals(out, src + lit_start, len - lit_start);
+    return (size_t)(out - dst);
+}
+
+int fb_mirror_rle_decode(const uint8_t *src, size_t len, uint8_t *dst, size_t dst_size) {
+    size_t in = 0;
+    size_t out = 0;
+
+    while (in < len) {
+        uint8_t c = src[in++];
+        if (c < 0x80) {
+            size_t n = (size_t)c + 1;
+            if (in + n > len || out + n > dst_size) return -1;
+            memcpy(dst + out, src + in, n);
+            in += n;
+            out += n;
+        } else {
+            size_t n = (size_t)c - 0x80 + 2;
+            if (in >= len || out + n > dst_size) return -1;
+            memset(dst + out, src[in++], n);
+            out += n;
+        }
+    }
+    return (int)out;
+}
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+size_t fb_mirror_encode(const uint8_t *fb, const uint8_t *shadow, uint32_t seq, uint8_t *msg) {
+    if (shadow && memcmp(fb, shadow, FB_MIRROR_FB_SIZE) == 0) return 0;
+
+    uint8_t *map = msg + FB_MIRROR_HEADER_SIZE;
+    uint8_t tiles[FB_MIRROR_FB_SIZE];
+    size_t tiles_len = 0;
+
+    memset(map, 0, FB_MIRROR_MAP_SIZE);
+    for (int t = 0; t < FB_MIRROR_TILES; t++) {
+        const uint8_t *tile = fb + t * FB_MIRROR_TILE_SIZE;
+        if (shadow && memcmp(tile, shadow + t * FB_MIRROR_TILE_SIZE, FB_MIRROR_TILE_SIZE) == 0) {
+            continue;
+        }
+        map[t / 8] |= (uint8_t)(1u << (t % 8));
+        memcpy(tiles + tiles_len, tile, FB_MIRROR_TILE_SIZE);
+        tiles_len += FB_MIRROR_TILE_SIZE;
+    }
+
+    size_t rle_len = fb_mirror_rle_encode(tiles, tiles_len, map + FB_MIRROR_MAP_SIZE);
+    size_t payload = FB_MIRROR_MAP_SIZE + rle_len;
+
+    msg[0] = FB_MIRROR_MAGIC;
+    msg[1] = shadow ? FB_MIRROR_DELTA : FB_MIRROR_KEYFRAME;
+    put_u16(msg + 2, (uint16_t)payload);
+    put_u32(msg + 4, seq);
+    return FB_MIRROR_HEADER_SIZE + payload;
+}
+
+int fb_mirror_msg_len(const uint8_t *header) {
+    if (header[0] != FB_MIRROR_MAGIC) return -1;
+    if (header[1] != FB_MIRROR_KEYFRAME && header[1] != FB_MIRROR_DELTA) return -1;
+
+    uint16_t payload = get_u16(header + 2);
+    if (payload < PAYLOAD_MIN || payload > PAYLOAD_MAX) return -1;
+    return FB_MIRROR_HEADER_SIZE + payload;
+}
+
+int fb_mirror_decode(const uint8_t *msg, size_t len, uint8_t *fb, uint32_t *seq) {
+    if (len < FB_MIRROR_HEADER_SIZE) return -1;
+    int msg_len = fb_mirror_msg_len(msg);
+    if (msg_len < 0 || (size_t)msg_len != len) return -1;
+
+    const uint8_t *map = msg + FB_MIRROR_HEADER_SIZE;
+    int count = 0;
+    for (int t = 0; t < FB_MIRROR_TILES; t++) {
+        if (map[t / 8] & (1u << (t % 8))) count++;
+    }
+    if (msg[1] == FB_MIRROR_KEYFRAME && count != FB_MIRROR_TILES) return -1;
+
+    uint8_t tiles[FB_MIRROR_FB_SIZE];
+    const uint8_t *rle = map + FB_MIRROR_MAP_SIZE;
+    int n = fb_mirror_rle_decode(rle, len - (size_t)(rle - msg), tiles, sizeof(tiles));
+    if (n != count * FB_MIRROR_TILE_SIZE) return -1;
+
+    const uint8_t *tile = tiles;
+    for (int t = 0; t < FB_MIRROR_TILES; t++) {
+        if (!(map[t / 8] & (1u << (t % 8)))) continue;
+        memcpy(fb + t * FB_MIRROR_TILE_SIZE, tile, FB_MIRROR_TILE_SIZE);
+        tile += FB_MIRROR_TILE_SIZE;
+    }
+    if (seq) *seq = get_u32(msg + 4);
+    return msg[1];
+}
@@ -14,3 +14,10 @@ const uint8_t *font_title = u8g2_font_8x13B_tf;       /* Bold title font */
 const uint8_t *font_small = u8g2_font_5x7_tf;         /* Small font for indicators */
 const uint8_t *font_content = u8g2_font_7x13_tf;      /* Content font */
 const uint8_t *font_symbols = u8g2_font_6x12_m_symbols; /* UI symbols */
+
+/* Byte 13 of the u8g2 font header is ascent_A (signed) */
+#define FONT_HEADER_ASCENT_A 13
+
+int font_ascent(const uint8_t *font) {
+    return font ? (int8_t)font[FONT_HEADER_ASCENT_A] : 0;
+}
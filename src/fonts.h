@@ -16,4 +16,10 @@ extern const uint8_t *font_small;
 extern const uint8_t *font_content;
 extern const uint8_t *font_symbols;
 
+/*
+ * Height of 'A' above the baseline in pixels (u8g2 ascent_A), for
+ * placing text inside a box of a given height.
+ */
+int font_ascent(const uint8_t *font);
+
 #endif
@@ -0,0 +1,125 @@
+#include "frame_prof.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RING_MASK (FRAME_PROF_EVENTS - 1)
+
+static frame_prof_event_t g_ring[FRAME_PROF_EVENTS];
+static uint64_t g_head;     /* Events recorded since reset */
+
+static const char *const g_phase_names[FRAME_PHASES] = {
+    [FRAME_PHASE_TICK] = "tick",
+    [FRAME_PHASE_SAMPLE] = "sample",
+    [FRAME_PHASE_FRAME] = "frame",
+    [FRAME_PHASE_TITLE] = "title",
+    [FRAME_PHASE_PAGE] = "page",
+    [FRAME_PHASE_FLUSH] = "flush",
+};
+
+uint64_t frame_prof_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void frame_prof_record(frame_phase_t phase, const char *label, uint64_t start_ns) {
+    uint64_t now_ns = frame_prof_now_ns();
+    uint64_t dur_ns = now_ns > start_ns ? now_ns - start_ns : 0;
+
+    frame_prof_event_t *ev = &g_ring[g_head & RING_MASK];
+    ev->start_ns = start_ns;
+    ev->dur_ns = dur_ns > UINT32_MAX ? UINT32_MAX : (uint32_t)dur_ns;
+    ev->phase = (uint8_t)phase;
+    ev->label = label;
+    g_head++;
+}
+
+int frame_prof_snapshot(frame_prof_event_t *out, int max) {
+    if (!out || max <= 0) return 0;
+
+    uint64_t n = g_head < FRAME_PROF_EVENTS ? g_head : FRAME_PROF_EVENTS;
+    if (n > (uint64_t)max) n = (uint64_t)max;
+    uint64_t first = g_head - n;
+    for (uint64_t i = 0; i < n; i++) {
+        out[i] = g_ring[(first + i) & RING_MASK];
+    }
+    return (int)n;
+}
+
+const char *frame_prof_phase_name(frame_phase_t phase) {
+    if ((int)phase < 0 || phase >= FRAME_PHASES) return NULL;
+    return g_phase_names[phase];
+}
+
+void frame_prof_reset(void) {
+    g_head = 0;
+}
+
+/* Labels are page names: escape anyway so the JSON stays valid */
+static void write_json_string(FILE *fp, const char *s) {
+    fputc('"', fp);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fputc('\\', fp);
+            fputc(c, fp);
+        } else if (c < 0x20) {
+            fprintf(fp, "\\u%04x", c);
+        } else {
+            fputc(c, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+int frame_prof_write_trace(FILE *fp) {
+    if (!fp) return -1;
+
+    static frame_prof_event_t events[FRAME_PROF_EVENTS];
+    int n = frame_prof_snapshot(events, FRAME_PROF_EVENTS);
+    int pid = (int)getpid();
+
+    /* Timestamps in us with ns precision, as the format expects */
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+            "\"args\":{\"name\":\"nanohat-oled\"}}", pid);
+    for (int i = 0; i < n; i++) {
+        const frame_prof_event_t *ev = &events[i];
+        const char *name = frame_prof_phase_name((frame_phase_t)ev->phase);
+        fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,"
+                "\"ts\":%" PRIu64 ".%03u,\"dur\":%" PRIu32 ".%03u",
+                name ? name : "unknown", pid, pid,
+                ev->start_ns / 1000, (unsigned)(ev->start_ns % 1000),
+                ev->dur_ns / 1000, (unsigned)(ev->dur_ns % 1000));
+        if (ev->label) {
+            fprintf(fp, ",\"args\":{\"page\":");
+            write_json_string(fp, ev->label);
+            fputc('}', fp);
+        }
+        fputc('}', fp);
+    }
+    fprintf(fp, "\n]}\n");
+
+    return ferror(fp) ? -1 : n;
+}
+
+int frame_prof_dump(const char *path) {
+    if (!path) path = FRAME_PROF_TRACE_PATH;
+
+    char tmp[256];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) return -1;
+
+    FILE *fp = fopen(tmp, "w");
+    if (!fp) return -1;
+
+    int n = frame_prof_write_trace(fp);
+    if (fclose(fp) != 0) n = -1;
+    if (n < 0 || rename(tmp, path) < 0) {
+        unlink(tmp);
+        return -1;
+    }
+    return n;
+}
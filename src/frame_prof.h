@@ -0,0 +1,93 @@
+/*
+ * Per-phase frame profiler with Chrome trace-event export
+ *
+ * Scoped probes around the phases of a frame:
+ *
+ *   tick    ui_controller_tick()
+ *   sample  sys_status_update_local() (/proc reads)
+ *   frame   ui_controller_render() from clear to flush
+ *   title   title bar of one page
+ *   page    content of one page (label = page name)
+ *   flush   display_hal->send_buffer() (I2C transfer)
+ *
+ * Each probe costs two clock_gettime() calls and one 24-byte store into
+ * a fixed ring of the last FRAME_PROF_EVENTS events: no locks, no
+ * allocation, oldest events overwritten. frame_prof_dump() writes the ring as
+ * Chrome trace-event JSON ("ph":"X" complete events), which opens in
+ * Perfetto or chrome://tracing; nesting shows where frame time goes.
+ *
+ * Probes compile to nothing unless built with -DFRAME_PROFILE
+ * (cmake -DFRAME_PROFILE=ON); the ring and export are always available.
+ * Single-threaded: call from the uloop thread only.
+ */
+#ifndef FRAME_PROF_H
+#define FRAME_PROF_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define FRAME_PROF_EVENTS     4096  /* Power of two */
+#define FRAME_PROF_TRACE_PATH "/tmp/nanohat-trace.json"
+
+typedef enum {
+    FRAME_PHASE_TICK = 0,
+    FRAME_PHASE_SAMPLE,
+    FRAME_PHASE_FRAME,
+    FRAME_PHASE_TITLE,
+    FRAME_PHASE_PAGE,
+    FRAME_PHASE_FLUSH,
+    FRAME_PHASES
+} frame_phase_t;
+
+typedef struct {
+    uint64_t start_ns;      /* CLOCK_MONOTONIC */
+    uint32_t dur_ns;        /* Saturates at ~4.3 s */
+    uint8_t phase;          /* frame_phase_t */
+    const char *label;      /* Static string or NULL */
+} frame_prof_event_t;
+
+#ifdef FRAME_PROFILE
+#define FRAME_PROF_BEGIN(var) uint64_t var = frame_prof_now_ns()
+#define FRAME_PROF_END(var, phase, label) frame_prof_record((phase), (label), (var))
+#else
+#define FRAME_PROF_BEGIN(var) do { } while (0)
+#define FRAME_PROF_END(var, phase, label) do { } while (0)
+#endif
+
+uint64_t frame_prof_now_ns(void);
+
+/*
+ * Record one completed phase that started at start_ns and ends now.
+ * Overwrites the oldest event when the ring is full.
+ */
+void frame_prof_record(frame_phase_t phase, const char *label, uint64_t start_ns);
+
+/*
+ * Copy the most recent events, oldest first. Returns the number copied
+ * (at most max and FRAME_PROF_EVENTS).
+ */
+int frame_prof_snapshot(frame_prof_event_t *out, int max);
+
+/*
+ * Phase name as used in the trace, NULL for an invalid phase.
+ */
+const char *frame_prof_phase_name(frame_phase_t phase);
+
+/*
+ * Drop all recorded events.
+ */
+void frame_prof_reset(void);
+
+/*
+ * Write the ring as trace-event JSON. Returns the event count, -1 on error.
+ */
+int frame_prof_write_trace(FILE *fp);
+
+/*
+ * Write the trace to path (FRAME_PROF_TRACE_PATH if NULL) through a
+ * temporary file, so a reader never sees a partial trace.
+ * Returns the event count, -1 on error.
+ */
+int frame_prof_dump(const char *path);
+
+#endif
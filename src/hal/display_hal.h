@@ -65,6 +65,13 @@ typedef struct {
      * level: 1-10 (1=dimmest, 10=brightest)
      */
     void (*set_contrast)(uint8_t level);
+
+    /*
+     * Framebuffer of the last rendered frame: DISPLAY_BUFFER_SIZE bytes in
+     * u8g2 full-buffer layout (8 pages of 128 columns, LSB on top).
+     * Returns NULL if not initialized. Read-only for callers.
+     */
+    const uint8_t *(*get_buffer)(void);
 } display_hal_ops_t;
 
 /*
@@ -78,6 +85,7 @@ extern const display_hal_ops_t *display_hal;
  */
 #define DISPLAY_WIDTH   128
 #define DISPLAY_HEIGHT  64
+#define DISPLAY_BUFFER_SIZE  (DISPLAY_WIDTH * DISPLAY_HEIGHT / 8)
 
 /* Dual-color OLED regions */
 #define DISPLAY_YELLOW_START  0
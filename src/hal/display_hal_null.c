@@ -12,6 +12,8 @@
 static u8g2_t g_u8g2_stub;
 static bool g_initialized = false;
 static bool g_power_on = false;
+static unsigned long g_flush_count = 0;
+static uint8_t g_buffer[DISPLAY_BUFFER_SIZE];  /* Stub draws nothing: stays blank */
 
 static int null_init(void) {
     if (g_initialized) return 0;
@@ -40,7 +42,8 @@ static void null_set_power(bool on) {
 }
 
 static void null_send_buffer(void) {
-    /* No-op for null driver */
+    /* No I/O; counted so tests can measure flushes */
+    g_flush_count++;
 }
 
 static void null_clear_buffer(void) {
@@ -52,6 +55,10 @@ static void null_set_contrast(uint8_t level) {
     /* No-op for null driver */
 }
 
+static const uint8_t *null_get_buffer(void) {
+    return g_initialized ? g_buffer : NULL;
+}
+
 static const display_hal_ops_t null_ops = {
     .init = null_init,
     .cleanup = null_cleanup,
@@ -60,6 +67,12 @@ static const display_hal_ops_t null_ops = {
     .send_buffer = null_send_buffer,
     .clear_buffer = null_clear_buffer,
     .set_contrast = null_set_contrast,
+    .get_buffer = null_get_buffer,
 };
 
 const display_hal_ops_t *display_hal = &null_ops;
+
+/* Test API */
+unsigned long display_null_get_flush_count(void) {
+    return g_flush_count;
+}
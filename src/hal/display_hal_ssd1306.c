@@ -16,6 +16,8 @@
 #include <linux/i2c-dev.h>
 #include <u8g2.h>
 
+#include "metrics.h"
+
 /* I2C configuration */
 #ifndef I2C_DEV_PATH
 #define I2C_DEV_PATH "/dev/i2c-0"
@@ -30,6 +32,9 @@ static u8g2_t g_u8g2;
 static int g_i2c_fd = -1;
 static bool g_initialized = false;
 
+METRIC_COUNTER(g_m_i2c_bytes, "i2c_bytes");
+METRIC_COUNTER(g_m_i2c_errors, "i2c_errors");
+
 /*
  * u8g2 GPIO and delay callback for Linux.
  */
@@ -105,9 +110,11 @@ static uint8_t u8x8_byte_linux_i2c(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, v
         case U8X8_MSG_BYTE_END_TRANSFER:
             if (g_i2c_fd >= 0 && buf_idx > 0) {
                 if (write(g_i2c_fd, buffer, buf_idx) != (ssize_t)buf_idx) {
+                    metric_inc(&g_m_i2c_errors);
                     perror("I2C write failed");
                     return 0;
                 }
+                metric_add(&g_m_i2c_bytes, buf_idx);
             }
             break;
 
@@ -212,6 +219,10 @@ static void ssd1306_set_contrast(uint8_t level) {
     u8g2_SetContrast(&g_u8g2, contrast_table[level - 1]);
 }
 
+static const uint8_t *ssd1306_get_buffer(void) {
+    return g_initialized ? u8g2_GetBufferPtr(&g_u8g2) : NULL;
+}
+
 static const display_hal_ops_t ssd1306_ops = {
     .init = ssd1306_init,
     .cleanup = ssd1306_cleanup,
@@ -220,6 +231,7 @@ static const display_hal_ops_t ssd1306_ops = {
     .send_buffer = ssd1306_send_buffer,
     .clear_buffer = ssd1306_clear_buffer,
     .set_contrast = ssd1306_set_contrast,
+    .get_buffer = ssd1306_get_buffer,
 };
 
 const display_hal_ops_t *display_hal = &ssd1306_ops;
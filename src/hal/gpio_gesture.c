@@ -0,0 +1,222 @@
+#include "gpio_gesture.h"
+
+#include <string.h>
+
+#define NS_PER_MS 1000000ULL
+
+static bool is_short(gpio_event_type_t type) {
+    return type == GPIO_EVT_BTN_K1_SHORT || type == GPIO_EVT_BTN_K2_SHORT ||
+           type == GPIO_EVT_BTN_K3_SHORT;
+}
+
+static int lowest_line(uint8_t lines) {
+    for (int i = 0; i < GPIO_NUM_BUTTONS; i++) {
+        if (lines & GPIO_LINE_BIT(i)) return i;
+    }
+    return 0;
+}
+
+static gpio_event_type_t double_event(const gpio_gesture_state_t *state, int line) {
+    for (int i = 0; i < state->count; i++) {
+        const gpio_gesture_t *g = &state->table[i];
+        if (g->kind == GPIO_GESTURE_DOUBLE && g->lines == GPIO_LINE_BIT(line)) {
+            return g->event;
+        }
+    }
+    return GPIO_EVT_NONE;
+}
+
+void gpio_gesture_reset(gpio_gesture_state_t *state) {
+    memset(state, 0, sizeof(*state));
+    state->chord_window_ms = GPIO_CHORD_WINDOW_MS;
+    state->double_window_ms = GPIO_DOUBLE_WINDOW_MS;
+}
+
+void gpio_gesture_drop_held(gpio_gesture_state_t *state) {
+    state->held_press = 0;
+    state->chorded = 0;
+    state->held_click = 0;
+}
+
+int gpio_gesture_configure(gpio_gesture_state_t *state, const gpio_gesture_config_t *config) {
+    int count = config ? config->count : 0;
+    if (count < 0 || count > GPIO_GESTURE_MAX || (count > 0 && !config->gestures)) {
+        return -1;
+    }
+
+    uint8_t all_lines = (uint8_t)((1u << GPIO_NUM_BUTTONS) - 1);
+    for (int i = 0; i < count; i++) {
+        const gpio_gesture_t *g = &config->gestures[i];
+        if (g->lines == 0 || (g->lines & ~all_lines)) return -1;
+        bool single = (g->lines & (g->lines - 1)) == 0;
+        if (g->kind == GPIO_GESTURE_CHORD && single) return -1;
+        if (g->kind == GPIO_GESTURE_DOUBLE && !single) return -1;
+    }
+
+    state->count = count;
+    state->chord_lines = 0;
+    state->double_lines = 0;
+    for (int i = 0; i < count; i++) {
+        state->table[i] = config->gestures[i];
+        if (state->table[i].kind == GPIO_GESTURE_CHORD) {
+            state->chord_lines |= state->table[i].lines;
+        } else {
+            state->double_lines |= state->table[i].lines;
+        }
+    }
+    state->chord_window_ms = (config && config->chord_window_ms) ?
+                             config->chord_window_ms : GPIO_CHORD_WINDOW_MS;
+    state->double_window_ms = (config && config->double_window_ms) ?
+                              config->double_window_ms : GPIO_DOUBLE_WINDOW_MS;
+    return 0;
+}
+
+int gpio_gesture_filter_edge(gpio_gesture_state_t *state, int line, bool pressed,
+                             uint64_t timestamp_ns, gpio_gesture_edge_t out[2],
+                             gpio_event_t *gesture) {
+    memset(gesture, 0, sizeof(*gesture));
+    gesture->type = GPIO_EVT_NONE;
+
+    if (line < 0 || line >= GPIO_NUM_BUTTONS) return 0;
+    uint8_t bit = GPIO_LINE_BIT(line);
+
+    if (pressed) {
+        if (!(state->chord_lines & bit)) {
+            out[0] = (gpio_gesture_edge_t){ .line = line, .pressed = true,
+                                            .timestamp_ns = timestamp_ns };
+            return 1;
+        }
+
+        uint64_t window_ns = (uint64_t)state->chord_window_ms * NS_PER_MS;
+        for (int i = 0; i < state->count; i++) {
+            const gpio_gesture_t *g = &state->table[i];
+            if (g->kind != GPIO_GESTURE_CHORD || !(g->lines & bit)) continue;
+
+            uint8_t others = g->lines & (uint8_t)~bit;
+            if ((state->held_press & others) != others) continue;
+
+            /* Chord starts at its first press */
+            uint64_t first_ns = timestamp_ns;
+            bool in_window = true;
+            for (int l = 0; l < GPIO_NUM_BUTTONS; l++) {
+                if (!(others & GPIO_LINE_BIT(l))) continue;
+                uint64_t held_ns = state->held_press_ns[l];
+                if (held_ns < timestamp_ns && timestamp_ns - held_ns > window_ns) {
+                    in_window = false;
+                }
+                if (held_ns < first_ns) first_ns = held_ns;
+            }
+            if (!in_window) continue;
+
+            state->held_press &= (uint8_t)~others;
+            state->chorded |= g->lines;
+            gesture->type = g->event;
+            gesture->line = (uint8_t)lowest_line(g->lines);
+            gesture->timestamp_ns = first_ns;
+            return 0;
+        }
+
+        state->held_press |= bit;
+        state->held_press_ns[line] = timestamp_ns;
+        return 0;
+    }
+
+    if (state->chorded & bit) {
+        state->chorded &= (uint8_t)~bit;
+        return 0;
+    }
+
+    int n = 0;
+    if (state->held_press & bit) {
+        /* Released inside the window: it was a plain press after all */
+        state->held_press &= (uint8_t)~bit;
+        out[n++] = (gpio_gesture_edge_t){ .line = line, .pressed = true,
+                                          .timestamp_ns = state->held_press_ns[line] };
+    }
+    out[n++] = (gpio_gesture_edge_t){ .line = line, .pressed = false,
+                                      .timestamp_ns = timestamp_ns };
+    return n;
+}
+
+int gpio_gesture_filter_event(gpio_gesture_state_t *state, const gpio_event_t *event,
+                              gpio_event_t out[2]) {
+    int line = event->line;
+    if (line >= GPIO_NUM_BUTTONS) {
+        out[0] = *event;
+        return 1;
+    }
+    uint8_t bit = GPIO_LINE_BIT(line);
+
+    int n = 0;
+    if (state->held_click & bit) {
+        const gpio_event_t *held = &state->held_click_evt[line];
+        uint64_t window_ns = (uint64_t)state->double_window_ms * NS_PER_MS;
+        state->held_click &= (uint8_t)~bit;
+
+        if (is_short(event->type) && event->timestamp_ns >= held->timestamp_ns &&
+            event->timestamp_ns - held->timestamp_ns <= window_ns) {
+            out[0] = *event;
+            out[0].type = double_event(state, line);
+            return 1;
+        }
+        /* Anything else on this line ends the wait */
+        out[n++] = *held;
+    }
+
+    if (is_short(event->type) && (state->double_lines & bit)) {
+        state->held_click |= bit;
+        state->held_click_evt[line] = *event;
+        return n;
+    }
+
+    out[n++] = *event;
+    return n;
+}
+
+uint64_t gpio_gesture_next_deadline_ms(const gpio_gesture_state_t *state) {
+    uint64_t next = 0;
+    for (int i = 0; i < GPIO_NUM_BUTTONS; i++) {
+        uint8_t bit = GPIO_LINE_BIT(i);
+        uint64_t deadline;
+        if (state->held_press & bit) {
+            deadline = state->held_press_ns[i] / NS_PER_MS + state->chord_window_ms;
+            if (next == 0 || deadline < next) next = deadline;
+        }
+        if (state->held_click & bit) {
+            deadline = state->held_click_evt[i].timestamp_ns / NS_PER_MS +
+                       state->double_window_ms;
+            if (next == 0 || deadline < next) next = deadline;
+        }
+    }
+    return next;
+}
+
+int gpio_gesture_expire_edges(gpio_gesture_state_t *state, uint64_t now_ms,
+                              gpio_gesture_edge_t out[GPIO_NUM_BUTTONS]) {
+    int n = 0;
+    for (int i = 0; i < GPIO_NUM_BUTTONS; i++) {
+        uint8_t bit = GPIO_LINE_BIT(i);
+        if (!(state->held_press & bit)) continue;
+        if (state->held_press_ns[i] / NS_PER_MS + state->chord_window_ms > now_ms) continue;
+
+        state->held_press &= (uint8_t)~bit;
+        out[n++] = (gpio_gesture_edge_t){ .line = i, .pressed = true,
+                                          .timestamp_ns = state->held_press_ns[i] };
+    }
+    return n;
+}
+
+int gpio_gesture_expire_events(gpio_gesture_state_t *state, uint64_t now_ms,
+                               gpio_event_t out[GPIO_NUM_BUTTONS]) {
+    int n = 0;
+    for (int i = 0; i < GPIO_NUM_BUTTONS; i++) {
+        uint8_t bit = GPIO_LINE_BIT(i);
+        if (!(state->held_click & bit)) continue;
+        const gpio_event_t *held = &state->held_click_evt[i];
+        if (held->timestamp_ns / NS_PER_MS + state->double_window_ms > now_ms) continue;
+
+        state->held_click &= (uint8_t)~bit;
+        out[n++] = *held;
+    }
+    return n;
+}
@@ -0,0 +1,104 @@
+/*
+ * Gesture recognizer shared by the GPIO HAL backends
+ *
+ * Sits on both sides of a backend's press/long-press logic:
+ *
+ *   edges -> gpio_gesture_filter_edge() -> backend -> gpio_gesture_filter_event() -> queue
+ *
+ * The edge filter recognizes chords: a press of a chord line is held back
+ * until either the rest of the chord arrives (chord event, presses and
+ * releases swallowed) or the chord window expires / the line is released
+ * (the held press is replayed with its original timestamp).
+ *
+ * The event filter recognizes double-clicks: a short press of a
+ * double-click line is held back until a second one arrives (double event)
+ * or the window expires (delivered unchanged).
+ *
+ * Lines that appear in no gesture pass straight through. Not thread-safe;
+ * the backend calls everything under its own lock and arms its timer fd
+ * for gpio_gesture_next_deadline_ms().
+ */
+#ifndef GPIO_GESTURE_H
+#define GPIO_GESTURE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gpio_hal.h"
+
+typedef struct {
+    int line;
+    bool pressed;
+    uint64_t timestamp_ns;
+} gpio_gesture_edge_t;
+
+typedef struct {
+    gpio_gesture_t table[GPIO_GESTURE_MAX];
+    int count;
+    uint32_t chord_window_ms;
+    uint32_t double_window_ms;
+    uint8_t chord_lines;                /* Lines in any chord */
+    uint8_t double_lines;               /* Lines with a double-click */
+
+    uint8_t held_press;                 /* Press edges waiting for a chord */
+    uint64_t held_press_ns[GPIO_NUM_BUTTONS];
+    uint8_t chorded;                    /* Pressed as part of a chord, until release */
+
+    uint8_t held_click;                 /* Short presses waiting for a second click */
+    gpio_event_t held_click_evt[GPIO_NUM_BUTTONS];
+} gpio_gesture_state_t;
+
+/*
+ * Clear the table and all held input.
+ */
+void gpio_gesture_reset(gpio_gesture_state_t *state);
+
+/*
+ * Drop all held input, keeping the table.
+ */
+void gpio_gesture_drop_held(gpio_gesture_state_t *state);
+
+/*
+ * Replace the table. Input already held back is delivered on its own
+ * deadline. Returns 0 on success, -1 if the config is invalid.
+ */
+int gpio_gesture_configure(gpio_gesture_state_t *state, const gpio_gesture_config_t *config);
+
+/*
+ * Filter a debounced edge. Stores the edges to process now in out[]
+ * (at most 2: a replayed press plus this release) and returns their
+ * count. A recognized chord is stored in *gesture (type GPIO_EVT_NONE
+ * otherwise).
+ */
+int gpio_gesture_filter_edge(gpio_gesture_state_t *state, int line, bool pressed,
+                             uint64_t timestamp_ns, gpio_gesture_edge_t out[2],
+                             gpio_event_t *gesture);
+
+/*
+ * Filter a button event about to be queued. Stores the events to queue
+ * now in out[] (at most 2: a flushed held click plus this event) and
+ * returns their count.
+ */
+int gpio_gesture_filter_event(gpio_gesture_state_t *state, const gpio_event_t *event,
+                              gpio_event_t out[2]);
+
+/*
+ * Earliest deadline (time_hal ms) of held input, 0 if nothing is held.
+ */
+uint64_t gpio_gesture_next_deadline_ms(const gpio_gesture_state_t *state);
+
+/*
+ * Release held presses whose chord window expired by now_ms.
+ * Returns the number of press edges stored in out[] (in line order).
+ */
+int gpio_gesture_expire_edges(gpio_gesture_state_t *state, uint64_t now_ms,
+                              gpio_gesture_edge_t out[GPIO_NUM_BUTTONS]);
+
+/*
+ * Release held clicks whose double window expired by now_ms.
+ * Returns the number of events stored in out[] (in line order).
+ */
+int gpio_gesture_expire_events(gpio_gesture_state_t *state, uint64_t now_ms,
+                               gpio_event_t out[GPIO_NUM_BUTTONS]);
+
+#endif
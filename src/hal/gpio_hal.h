@@ -24,7 +24,16 @@ typedef enum {
     GPIO_EVT_BTN_K3_SHORT,
     GPIO_EVT_BTN_K1_LONG,
     GPIO_EVT_BTN_K2_LONG,
-    GPIO_EVT_BTN_K3_LONG
+    GPIO_EVT_BTN_K3_LONG,
+    GPIO_EVT_BTN_K1_REPEAT,     /* Auto-repeat while held (see set_auto_repeat) */
+    GPIO_EVT_BTN_K2_REPEAT,
+    GPIO_EVT_BTN_K3_REPEAT,
+    GPIO_EVT_CHORD_K1_K2,       /* Gestures (see set_gestures) */
+    GPIO_EVT_CHORD_K1_K3,
+    GPIO_EVT_CHORD_K2_K3,
+    GPIO_EVT_BTN_K1_DOUBLE,
+    GPIO_EVT_BTN_K2_DOUBLE,
+    GPIO_EVT_BTN_K3_DOUBLE
 } gpio_event_type_t;
 
 /*
@@ -34,8 +43,35 @@ typedef struct {
     gpio_event_type_t type;
     uint8_t line;           /* Button index: 0=K1, 1=K2, 2=K3 */
     uint64_t timestamp_ns;  /* Event timestamp (CLOCK_MONOTONIC) */
+    uint16_t repeat;        /* REPEAT: steps represented (>1 if coalesced), else 0 */
 } gpio_event_t;
 
+/*
+ * Gesture table entry.
+ * CHORD:  all lines in the mask pressed within the chord window. The
+ *         event (line = lowest line of the chord) replaces the individual
+ *         presses; the releases are swallowed.
+ * DOUBLE: two short presses of a single line within the double window.
+ *         The event replaces the second short press.
+ */
+typedef enum {
+    GPIO_GESTURE_CHORD = 0,
+    GPIO_GESTURE_DOUBLE
+} gpio_gesture_kind_t;
+
+typedef struct {
+    gpio_gesture_kind_t kind;
+    uint8_t lines;              /* GPIO_LINE_BIT mask */
+    gpio_event_type_t event;    /* Event emitted on recognition */
+} gpio_gesture_t;
+
+typedef struct {
+    const gpio_gesture_t *gestures;
+    int count;                  /* At most GPIO_GESTURE_MAX */
+    uint16_t chord_window_ms;   /* 0 = GPIO_CHORD_WINDOW_MS */
+    uint16_t double_window_ms;  /* 0 = GPIO_DOUBLE_WINDOW_MS */
+} gpio_gesture_config_t;
+
 /*
  * GPIO HAL operations.
  */
@@ -75,6 +111,38 @@ typedef struct {
      *   -1 - Error
      */
     int (*read_event)(gpio_event_t *event);
+
+    /*
+     * Optional: buttons that dispatch on press (bit n = line n, see
+     * GPIO_LINE_BIT). Their short press event is emitted on the press edge
+     * with its timestamp; no long press is detected and the release is
+     * ignored. Use for keys without a long-press action in the current UI
+     * state. The mask is sampled per press edge, so changing it while a
+     * button is held does not affect that press.
+     */
+    void (*set_press_dispatch)(uint8_t line_mask);
+
+    /*
+     * Optional: buttons that auto-repeat while held (bit n = line n).
+     * Implies press dispatch: the short press is emitted on the press edge,
+     * then after GPIO_REPEAT_DELAY_MS REPEAT events follow at an
+     * accelerating rate (GPIO_REPEAT_START_MS down to GPIO_REPEAT_MIN_MS)
+     * until release. Driven by the timer fd. If the previous REPEAT event
+     * for the line has not been read yet, new steps are added to it
+     * instead of queueing more events.
+     */
+    void (*set_auto_repeat)(uint8_t line_mask);
+
+    /*
+     * Optional: replace the gesture table (NULL or count 0 clears it).
+     * Only lines named in the table pay for recognition: a press of a
+     * chord line is held back for up to the chord window, and a short
+     * press of a double-click line for up to the double window (then
+     * delivered with its original timestamp). Other lines are untouched.
+     * Driven by the timer fd.
+     * Returns: 0 on success, -1 if invalid or no timer fd
+     */
+    int (*set_gestures)(const gpio_gesture_config_t *config);
 } gpio_hal_ops_t;
 
 /*
@@ -90,4 +158,14 @@ extern const gpio_hal_ops_t *gpio_hal;
 #define GPIO_LONG_PRESS_MS  600
 #define GPIO_DEBOUNCE_MS    30
 
+#define GPIO_REPEAT_DELAY_MS  400
+#define GPIO_REPEAT_START_MS  150
+#define GPIO_REPEAT_MIN_MS    30
+
+#define GPIO_GESTURE_MAX       8
+#define GPIO_CHORD_WINDOW_MS   60
+#define GPIO_DOUBLE_WINDOW_MS  250
+
+#define GPIO_LINE_BIT(line) ((uint8_t)(1u << (line)))
+
 #endif
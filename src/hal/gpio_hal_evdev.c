@@ -0,0 +1,310 @@
+/*
+ * GPIO HAL implementation using the evdev interface (gpio-keys driver)
+ *
+ * For boards whose device tree binds the NanoHat buttons to gpio-keys:
+ * the kernel debounces the lines and reports EV_KEY events on
+ * /dev/input/eventX. One read() returns all queued input_events, so a
+ * burst of edges costs one wakeup, and no software debounce is needed.
+ * Long press, press dispatch, auto-repeat and gestures come from the
+ * shared key state machine (gpio_keys.c), driven by a timerfd as in the
+ * libgpiod backend.
+ *
+ * Without EVDEV_PATH the first event device reporting all three
+ * EVDEV_KEYCODES is used.
+ */
+#include "gpio_hal.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gpio_keys.h"
+#include "session_log.h"
+#include "time_hal.h"
+
+#ifdef GPIO_DEBUG
+#define GPIO_LOG(...) fprintf(stderr, "[gpio] " __VA_ARGS__)
+#else
+#define GPIO_LOG(...) do {} while (0)
+#endif
+
+#ifndef EVDEV_KEYCODES
+#define EVDEV_KEYCODES BTN_0, BTN_1, BTN_2
+#endif
+
+#define EVDEV_INPUT_DIR "/dev/input"
+#define READ_BATCH 64
+
+#define BITS_PER_LONG_ (8 * sizeof(unsigned long))
+#define TEST_BIT(bit, array) \
+    ((array[(bit) / BITS_PER_LONG_] >> ((bit) % BITS_PER_LONG_)) & 1UL)
+
+/* Static state */
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static int g_input_fd = -1;
+static int g_timer_fd = -1;
+static bool g_dropped;                          /* SYN_DROPPED: skip to SYN_REPORT, then resync */
+
+static const unsigned int g_keycodes[GPIO_NUM_BUTTONS] = {EVDEV_KEYCODES};
+
+static gpio_keys_t g_keys;
+
+/* Arm the timer fd for the next long-press, repeat or gesture deadline */
+static void arm_timer_locked(void) {
+    if (g_timer_fd < 0) return;
+
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    uint64_t deadline_ms;
+    if (gpio_keys_next_deadline_ms(&g_keys, &deadline_ms)) {
+        uint64_t now_ms = time_hal_now_ms();
+        uint64_t delay_ms = (deadline_ms > now_ms) ? (deadline_ms - now_ms) : 1; /* fire asap */
+        its.it_value.tv_sec = (time_t)(delay_ms / 1000);
+        its.it_value.tv_nsec = (long)((delay_ms % 1000) * 1000000L);
+    }
+    timerfd_settime(g_timer_fd, 0, &its, NULL);
+}
+
+static int keycode_to_line(unsigned int code) {
+    for (int i = 0; i < GPIO_NUM_BUTTONS; i++) {
+        if (g_keycodes[i] == code) return i;
+    }
+    return -1;
+}
+
+static void process_key_edge(int line, bool is_pressed, uint64_t timestamp_ns) {
+    GPIO_LOG("key line=%d is_pressed=%d\n", line, (int)is_pressed);
+    session_log_gpio_edge(line, is_pressed, timestamp_ns);
+
+    gpio_keys_edge(&g_keys, line, is_pressed, timestamp_ns);
+}
+
+/* After SYN_DROPPED: compare the kernel's key state with ours */
+static void resync_keys(void) {
+    unsigned long keys[KEY_CNT / BITS_PER_LONG_ + 1];
+    memset(keys, 0, sizeof(keys));
+    if (ioctl(g_input_fd, EVIOCGKEY(sizeof(keys)), keys) < 0) {
+        return;
+    }
+
+    uint64_t now_ns = time_hal_now_ns();
+    for (int i = 0; i < GPIO_NUM_BUTTONS; i++) {
+        bool down = TEST_BIT(g_keycodes[i], keys);
+        if (down != g_keys.pressed[i]) {
+            process_key_edge(i, down, now_ns);
+        }
+    }
+}
+
+static void process_input_event(const struct input_event *ev) {
+    if (ev->type == EV_SYN) {
+        if (ev->code == SYN_DROPPED) {
+            g_dropped = true;
+        } else if (ev->code == SYN_REPORT && g_dropped) {
+            g_dropped = false;
+            resync_keys();
+        }
+        return;
+    }
+
+    /* value 2 is the kernel's own autorepeat: we repeat ourselves */
+    if (g_dropped || ev->type != EV_KEY || ev->value > 1) {
+        return;
+    }
+
+    int line = keycode_to_line(ev->code);
+    if (line < 0) return;
+
+    /* Clock set to CLOCK_MONOTONIC at init */
+    uint64_t timestamp_ns = (uint64_t)ev->input_event_sec * 1000000000ULL +
+                            (uint64_t)ev->input_event_usec * 1000ULL;
+    process_key_edge(line, ev->value == 1, timestamp_ns);
+}
+
+static bool has_all_keys(int fd) {
+    unsigned long keys[KEY_CNT / BITS_PER_LONG_ + 1];
+    memset(keys, 0, sizeof(keys));
+    if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys) < 0) {
+        return false;
+    }
+    for (int i = 0; i < GPIO_NUM_BUTTONS; i++) {
+        if (!TEST_BIT(g_keycodes[i], keys)) return false;
+    }
+    return true;
+}
+
+static int open_input_device(void) {
+#ifdef EVDEV_PATH
+    return open(EVDEV_PATH, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+#else
+    DIR *dir = opendir(EVDEV_INPUT_DIR);
+    if (!dir) return -1;
+
+    int fd = -1;
+    struct dirent *de;
+    while (fd < 0 && (de = readdir(dir)) != NULL) {
+        if (strncmp(de->d_name, "event", 5) != 0) continue;
+
+        int cand = openat(dirfd(dir), de->d_name, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (cand < 0) continue;
+        if (has_all_keys(cand)) {
+            GPIO_LOG("using " EVDEV_INPUT_DIR "/%s\n", de->d_name);
+            fd = cand;
+        } else {
+            close(cand);
+        }
+    }
+    closedir(dir);
+    return fd;
+#endif
+}
+
+/* HAL Interface Implementation */
+
+static int evdev_init(void) {
+    pthread_mutex_lock(&g_lock);
+    gpio_keys_drop(&g_keys);
+    g_dropped = false;
+
+    g_input_fd = open_input_device();
+    if (g_input_fd < 0) {
+        GPIO_LOG("no input device with the button keycodes: %s\n", strerror(errno));
+        pthread_mutex_unlock(&g_lock);
+        return -1;
+    }
+
+    /* Event timestamps must share time_hal's clock (latency, long press) */
+    int clock = CLOCK_MONOTONIC;
+    if (ioctl(g_input_fd, EVIOCSCLOCKID, &clock) < 0) {
+        GPIO_LOG("EVIOCSCLOCKID failed: %s\n", strerror(errno));
+        close(g_input_fd);
+        g_input_fd = -1;
+        pthread_mutex_unlock(&g_lock);
+        return -1;
+    }
+
+    g_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (g_timer_fd < 0) {
+        close(g_input_fd);
+        g_input_fd = -1;
+        pthread_mutex_unlock(&g_lock);
+        return -1;
+    }
+
+    g_keys.timed = true;
+    pthread_mutex_unlock(&g_lock);
+    return 0;
+}
+
+static void evdev_cleanup(void) {
+    pthread_mutex_lock(&g_lock);
+    if (g_timer_fd >= 0) {
+        close(g_timer_fd);
+        g_timer_fd = -1;
+    }
+    if (g_input_fd >= 0) {
+        close(g_input_fd);
+        g_input_fd = -1;
+    }
+    gpio_keys_reset(&g_keys);
+    pthread_mutex_unlock(&g_lock);
+}
+
+static int evdev_get_fd(void) {
+    return g_input_fd;
+}
+
+static int evdev_get_timer_fd(void) {
+    return g_timer_fd;
+}
+
+static int evdev_read_event(gpio_event_t *event) {
+    if (!event || g_input_fd < 0) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&g_lock);
+
+    /* Check for pending events first */
+    if (gpio_keys_pop(&g_keys, event)) {
+        pthread_mutex_unlock(&g_lock);
+        return 1;
+    }
+
+    /* Drain timerfd if needed and emit long-press events */
+    if (g_timer_fd >= 0) {
+        uint64_t expirations;
+        while (read(g_timer_fd, &expirations, sizeof(expirations)) > 0) {
+            /* drain */
+        }
+        gpio_keys_expire(&g_keys, time_hal_now_ns());
+        arm_timer_locked();
+    }
+
+    if (gpio_keys_pop(&g_keys, event)) {
+        pthread_mutex_unlock(&g_lock);
+        return 1;
+    }
+
+    /* Everything queued since the last wakeup, in one read */
+    struct input_event evs[READ_BATCH];
+    ssize_t len = read(g_input_fd, evs, sizeof(evs));
+    if (len < 0) {
+        int err = errno;
+        pthread_mutex_unlock(&g_lock);
+        return (err == EAGAIN || err == EWOULDBLOCK) ? 0 : -1;
+    }
+
+    size_t num = (size_t)len / sizeof(evs[0]);
+    for (size_t i = 0; i < num; i++) {
+        process_input_event(&evs[i]);
+    }
+    arm_timer_locked();
+
+    bool has_event = gpio_keys_pop(&g_keys, event);
+    pthread_mutex_unlock(&g_lock);
+    return has_event ? 1 : 0;
+}
+
+static void evdev_set_press_dispatch(uint8_t line_mask) {
+    pthread_mutex_lock(&g_lock);
+    g_keys.press_dispatch = line_mask;
+    pthread_mutex_unlock(&g_lock);
+}
+
+static void evdev_set_auto_repeat(uint8_t line_mask) {
+    pthread_mutex_lock(&g_lock);
+    g_keys.auto_repeat = line_mask;
+    pthread_mutex_unlock(&g_lock);
+}
+
+static int evdev_set_gestures(const gpio_gesture_config_t *config) {
+    pthread_mutex_lock(&g_lock);
+    int ret = (g_timer_fd >= 0) ? gpio_gesture_configure(&g_keys.gesture, config) : -1;
+    pthread_mutex_unlock(&g_lock);
+    return ret;
+}
+
+/* HAL operations table */
+static const gpio_hal_ops_t evdev_ops = {
+    .init = evdev_init,
+    .cleanup = evdev_cleanup,
+    .get_fd = evdev_get_fd,
+    .get_timer_fd = evdev_get_timer_fd,
+    .read_event = evdev_read_event,
+    .set_press_dispatch = evdev_set_press_dispatch,
+    .set_auto_repeat = evdev_set_auto_repeat,
+    .set_gestures = evdev_set_gestures,
+};
+
+const gpio_hal_ops_t *gpio_hal = &evdev_ops;
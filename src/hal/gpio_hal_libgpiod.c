@@ -17,6 +17,9 @@
 #include <time.h>
 #include <unistd.h>
 
+#include "gpio_keys.h"
+#include "metrics.h"
+#include "session_log.h"
 #include "time_hal.h"
 
 #ifdef GPIO_DEBUG
@@ -33,16 +36,6 @@
 #define BTN_OFFSETS 0, 2, 3
 #endif
 
-#define MAX_PENDING_EVENTS 32
-
-/* Internal event queue */
-typedef struct {
-    gpio_event_t events[MAX_PENDING_EVENTS];
-    size_t head;
-    size_t tail;
-    size_t count;
-} event_queue_t;
-
 /* Static state */
 static struct gpiod_chip *g_chip = NULL;
 static struct gpiod_line_request *g_request = NULL;
@@ -55,40 +48,10 @@ static const unsigned int g_btn_offsets[GPIO_NUM_BUTTONS] = {BTN_OFFSETS};
 static int g_pressed_level = 0;
 static bool g_use_soft_debounce = false;
 
-static uint64_t g_press_time_ms[GPIO_NUM_BUTTONS];
-static uint64_t g_last_edge_ms[GPIO_NUM_BUTTONS];
-static bool g_pressed[GPIO_NUM_BUTTONS];
-static bool g_long_sent[GPIO_NUM_BUTTONS];
-static event_queue_t g_pending;
-
-/* Queue operations */
-static void pending_push(const gpio_event_t *event) {
-    if (g_pending.count >= MAX_PENDING_EVENTS) {
-        g_pending.head = (g_pending.head + 1) % MAX_PENDING_EVENTS;
-        g_pending.count--;
-    }
-    g_pending.events[g_pending.tail] = *event;
-    g_pending.tail = (g_pending.tail + 1) % MAX_PENDING_EVENTS;
-    g_pending.count++;
-}
+METRIC_COUNTER(g_m_debounce_drops, "gpio_debounce_drops");
 
-static bool pending_pop(gpio_event_t *event) {
-    if (g_pending.count == 0) {
-        return false;
-    }
-    *event = g_pending.events[g_pending.head];
-    g_pending.head = (g_pending.head + 1) % MAX_PENDING_EVENTS;
-    g_pending.count--;
-    return true;
-}
-
-static gpio_event_type_t to_button_event(int line, bool long_press) {
-    switch (line) {
-    case 0: return long_press ? GPIO_EVT_BTN_K1_LONG : GPIO_EVT_BTN_K1_SHORT;
-    case 1: return long_press ? GPIO_EVT_BTN_K2_LONG : GPIO_EVT_BTN_K2_SHORT;
-    default: return long_press ? GPIO_EVT_BTN_K3_LONG : GPIO_EVT_BTN_K3_SHORT;
-    }
-}
+static uint64_t g_last_edge_ms[GPIO_NUM_BUTTONS];
+static gpio_keys_t g_keys;
 
 static int detect_pressed_level(void) {
     int zeros = 0, ones = 0;
@@ -105,65 +68,24 @@ static int detect_pressed_level(void) {
 }
 
 static void reset_state(void) {
-    memset(g_press_time_ms, 0, sizeof(g_press_time_ms));
     memset(g_last_edge_ms, 0, sizeof(g_last_edge_ms));
-    memset(g_pressed, 0, sizeof(g_pressed));
-    memset(g_long_sent, 0, sizeof(g_long_sent));
-    memset(&g_pending, 0, sizeof(g_pending));
+    gpio_keys_drop(&g_keys);
 }
 
-static void update_long_press_timer_locked(void) {
+/* Arm the timer fd for the next long-press, repeat or gesture deadline */
+static void arm_timer_locked(void) {
     if (g_timer_fd < 0) return;
 
-    uint64_t now_ms = time_hal_now_ms();
-    uint64_t next_delay_ms = 0;
-    bool has_pending = false;
-    for (int i = 0; i < GPIO_NUM_BUTTONS; i++) {
-        if (g_pressed[i] && !g_long_sent[i]) {
-            has_pending = true;
-            uint64_t deadline = g_press_time_ms[i] + GPIO_LONG_PRESS_MS;
-            uint64_t remaining = (deadline > now_ms) ? (deadline - now_ms) : 0;
-            if (next_delay_ms == 0 || remaining < next_delay_ms) {
-                next_delay_ms = remaining;
-            }
-        }
-    }
-
     struct itimerspec its;
     memset(&its, 0, sizeof(its));
-    if (has_pending) {
-        if (next_delay_ms == 0) {
-            next_delay_ms = 1; /* fire asap */
-        }
-        its.it_value.tv_sec = (time_t)(next_delay_ms / 1000);
-        its.it_value.tv_nsec = (long)((next_delay_ms % 1000) * 1000000L);
-        timerfd_settime(g_timer_fd, 0, &its, NULL);
-    } else {
-        timerfd_settime(g_timer_fd, 0, &its, NULL);
+    uint64_t deadline_ms;
+    if (gpio_keys_next_deadline_ms(&g_keys, &deadline_ms)) {
+        uint64_t now_ms = time_hal_now_ms();
+        uint64_t delay_ms = (deadline_ms > now_ms) ? (deadline_ms - now_ms) : 1; /* fire asap */
+        its.it_value.tv_sec = (time_t)(delay_ms / 1000);
+        its.it_value.tv_nsec = (long)((delay_ms % 1000) * 1000000L);
     }
-}
-
-static void handle_long_press_timer_locked(void) {
-    if (g_timer_fd < 0) return;
-
-    uint64_t now_ms = time_hal_now_ms();
-    uint64_t now_ns = time_hal_now_ns();
-
-    for (int i = 0; i < GPIO_NUM_BUTTONS; i++) {
-        if (g_pressed[i] && !g_long_sent[i] &&
-            now_ms - g_press_time_ms[i] >= GPIO_LONG_PRESS_MS) {
-            g_long_sent[i] = true;
-            gpio_event_t evt = {
-                .type = to_button_event(i, true),
-                .line = (uint8_t)i,
-                .timestamp_ns = now_ns
-            };
-            pending_push(&evt);
-            GPIO_LOG("event: line=%d type=%d long_press\n", i, evt.type);
-        }
-    }
-
-    update_long_press_timer_locked();
+    timerfd_settime(g_timer_fd, 0, &its, NULL);
 }
 
 static void process_edge_event(struct gpiod_edge_event *event) {
@@ -182,60 +104,22 @@ static void process_edge_event(struct gpiod_edge_event *event) {
     }
     if (line < 0) return;
 
+    int new_value = (type == GPIOD_EDGE_EVENT_FALLING_EDGE) ? 0 : 1;
+    bool is_pressed = (new_value == g_pressed_level);
+    session_log_gpio_edge(line, is_pressed, timestamp_ns);
+
     /* Software debounce if hardware debounce not available */
     if (g_use_soft_debounce && g_last_edge_ms[line] != 0 &&
         now_ms - g_last_edge_ms[line] < GPIO_DEBOUNCE_MS) {
+        metric_inc(&g_m_debounce_drops);
         return;
     }
     g_last_edge_ms[line] = now_ms;
 
-    int new_value = (type == GPIOD_EDGE_EVENT_FALLING_EDGE) ? 0 : 1;
-    bool is_pressed = (new_value == g_pressed_level);
-
     GPIO_LOG("edge offset=%u line=%d value=%d is_pressed=%d\n",
              offset, line, new_value, (int)is_pressed);
 
-    bool use_longpress_timer = (g_timer_fd >= 0);
-
-    if (is_pressed) {
-        /* Button pressed - record time */
-        g_pressed[line] = true;
-        g_press_time_ms[line] = now_ms;
-        g_long_sent[line] = false;
-        if (use_longpress_timer) {
-            update_long_press_timer_locked();
-        }
-        return;
-    }
-
-    /* Button released - emit event */
-    if (g_pressed[line]) {
-        g_pressed[line] = false;
-        if (!use_longpress_timer) {
-            uint64_t elapsed = now_ms - g_press_time_ms[line];
-            gpio_event_t evt = {
-                .type = to_button_event(line, elapsed >= GPIO_LONG_PRESS_MS),
-                .line = (uint8_t)line,
-                .timestamp_ns = timestamp_ns
-            };
-            pending_push(&evt);
-            GPIO_LOG("event: line=%d type=%d elapsed=%llu ms\n",
-                     line, evt.type, (unsigned long long)elapsed);
-        } else {
-            bool long_sent = g_long_sent[line];
-            g_long_sent[line] = false;
-            if (!long_sent) {
-                gpio_event_t evt = {
-                    .type = to_button_event(line, false),
-                    .line = (uint8_t)line,
-                    .timestamp_ns = timestamp_ns
-                };
-                pending_push(&evt);
-                GPIO_LOG("event: line=%d type=%d short_press\n", line, evt.type);
-            }
-            update_long_press_timer_locked();
-        }
-    }
+    gpio_keys_edge(&g_keys, line, is_pressed, timestamp_ns);
 }
 
 static struct gpiod_line_request *request_lines(bool with_debounce) {
@@ -249,6 +133,8 @@ static struct gpiod_line_request *request_lines(bool with_debounce) {
 
     gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
     gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+    /* Edge timestamps must share time_hal's clock (latency, long press) */
+    gpiod_line_settings_set_event_clock(settings, GPIOD_LINE_CLOCK_MONOTONIC);
     if (with_debounce) {
         gpiod_line_settings_set_debounce_period_us(settings, GPIO_DEBOUNCE_MS * 1000);
     }
@@ -337,6 +223,7 @@ static int libgpiod_init(void) {
         return -1;
     }
 
+    g_keys.timed = true;
     GPIO_LOG("init ok: fd=%d soft_debounce=%d\n",
              g_gpiod_fd, g_use_soft_debounce);
     pthread_mutex_unlock(&g_lock);
@@ -363,6 +250,7 @@ static void libgpiod_cleanup(void) {
     }
     g_gpiod_fd = -1;
     reset_state();
+    gpio_keys_reset(&g_keys);
     pthread_mutex_unlock(&g_lock);
 }
 
@@ -385,7 +273,7 @@ static int libgpiod_read_event(gpio_event_t *event) {
     pthread_mutex_lock(&g_lock);
 
     /* Check for pending events first */
-    if (pending_pop(event)) {
+    if (gpio_keys_pop(&g_keys, event)) {
         pthread_mutex_unlock(&g_lock);
         return 1;
     }
@@ -396,10 +284,11 @@ static int libgpiod_read_event(gpio_event_t *event) {
         while (read(g_timer_fd, &expirations, sizeof(expirations)) > 0) {
             /* drain */
         }
-        handle_long_press_timer_locked();
+        gpio_keys_expire(&g_keys, time_hal_now_ns());
+        arm_timer_locked();
     }
 
-    if (pending_pop(event)) {
+    if (gpio_keys_pop(&g_keys, event)) {
         pthread_mutex_unlock(&g_lock);
         return 1;
     }
@@ -421,13 +310,33 @@ static int libgpiod_read_event(gpio_event_t *event) {
         struct gpiod_edge_event *edge = gpiod_edge_event_buffer_get_event(g_event_buf, i);
         process_edge_event(edge);
     }
+    arm_timer_locked();
 
     /* Return next pending event if available */
-    bool has_event = pending_pop(event);
+    bool has_event = gpio_keys_pop(&g_keys, event);
     pthread_mutex_unlock(&g_lock);
     return has_event ? 1 : 0;
 }
 
+static void libgpiod_set_press_dispatch(uint8_t line_mask) {
+    pthread_mutex_lock(&g_lock);
+    g_keys.press_dispatch = line_mask;
+    pthread_mutex_unlock(&g_lock);
+}
+
+static void libgpiod_set_auto_repeat(uint8_t line_mask) {
+    pthread_mutex_lock(&g_lock);
+    g_keys.auto_repeat = line_mask;
+    pthread_mutex_unlock(&g_lock);
+}
+
+static int libgpiod_set_gestures(const gpio_gesture_config_t *config) {
+    pthread_mutex_lock(&g_lock);
+    int ret = (g_timer_fd >= 0) ? gpio_gesture_configure(&g_keys.gesture, config) : -1;
+    pthread_mutex_unlock(&g_lock);
+    return ret;
+}
+
 /* HAL operations table */
 static const gpio_hal_ops_t libgpiod_ops = {
     .init = libgpiod_init,
@@ -435,6 +344,9 @@ static const gpio_hal_ops_t libgpiod_ops = {
     .get_fd = libgpiod_get_fd,
     .get_timer_fd = libgpiod_get_timer_fd,
     .read_event = libgpiod_read_event,
+    .set_press_dispatch = libgpiod_set_press_dispatch,
+    .set_auto_repeat = libgpiod_set_auto_repeat,
+    .set_gestures = libgpiod_set_gestures,
 };
 
 const gpio_hal_ops_t *gpio_hal = &libgpiod_ops;
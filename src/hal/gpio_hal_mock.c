@@ -25,10 +25,10 @@
 #define USE_TIMERFD 0
 #endif
 
+#include "gpio_keys.h"
+#include "metrics.h"
 #include "time_hal.h"
 
-#define MAX_PENDING_EVENTS 32
-
 /* Edge type for internal use */
 typedef enum {
     EDGE_RISING = 0,
@@ -54,28 +54,20 @@ static size_t g_edge_head = 0;
 static size_t g_edge_tail = 0;
 static size_t g_edge_count = 0;
 
-static gpio_event_t g_pending[MAX_PENDING_EVENTS];
-static size_t g_pending_head = 0;
-static size_t g_pending_tail = 0;
-static size_t g_pending_count = 0;
-
-static uint64_t g_press_time_ms[GPIO_NUM_BUTTONS];
 static uint64_t g_last_edge_ms[GPIO_NUM_BUTTONS];
-static bool g_pressed[GPIO_NUM_BUTTONS];
-static bool g_long_sent[GPIO_NUM_BUTTONS];
+static gpio_keys_t g_keys;
 
 static int g_line_values[GPIO_NUM_BUTTONS] = {1, 1, 1};
 static int g_pressed_level = 0;
 static bool g_use_soft_debounce = true;
 
+METRIC_COUNTER(g_m_debounce_drops, "gpio_debounce_drops");
+
 /* Queue operations */
 static void reset_state(void) {
-    memset(g_press_time_ms, 0, sizeof(g_press_time_ms));
     memset(g_last_edge_ms, 0, sizeof(g_last_edge_ms));
-    memset(g_pressed, 0, sizeof(g_pressed));
-    memset(g_long_sent, 0, sizeof(g_long_sent));
+    gpio_keys_drop(&g_keys);
     g_edge_head = g_edge_tail = g_edge_count = 0;
-    g_pending_head = g_pending_tail = g_pending_count = 0;
 }
 
 static void signal_fd(void) {
@@ -119,32 +111,6 @@ static bool pop_edge(mock_edge_t *edge) {
     return true;
 }
 
-static void push_pending(const gpio_event_t *event) {
-    if (g_pending_count >= MAX_PENDING_EVENTS) {
-        g_pending_head = (g_pending_head + 1) % MAX_PENDING_EVENTS;
-        g_pending_count--;
-    }
-    g_pending[g_pending_tail] = *event;
-    g_pending_tail = (g_pending_tail + 1) % MAX_PENDING_EVENTS;
-    g_pending_count++;
-}
-
-static bool pop_pending(gpio_event_t *event) {
-    if (g_pending_count == 0) return false;
-    *event = g_pending[g_pending_head];
-    g_pending_head = (g_pending_head + 1) % MAX_PENDING_EVENTS;
-    g_pending_count--;
-    return true;
-}
-
-static gpio_event_type_t to_button_event(int line, bool long_press) {
-    switch (line) {
-    case 0: return long_press ? GPIO_EVT_BTN_K1_LONG : GPIO_EVT_BTN_K1_SHORT;
-    case 1: return long_press ? GPIO_EVT_BTN_K2_LONG : GPIO_EVT_BTN_K2_SHORT;
-    default: return long_press ? GPIO_EVT_BTN_K3_LONG : GPIO_EVT_BTN_K3_SHORT;
-    }
-}
-
 static int detect_pressed_level(void) {
     int zeros = 0, ones = 0;
     for (int i = 0; i < GPIO_NUM_BUTTONS; i++) {
@@ -154,57 +120,20 @@ static int detect_pressed_level(void) {
 }
 
 #if USE_TIMERFD
-static void update_long_press_timer_locked(void) {
+/* Arm the timer fd for the next long-press, repeat or gesture deadline */
+static void arm_timer_locked(void) {
     if (g_timer_fd < 0) return;
 
-    uint64_t now_ms = time_hal_now_ms();
-    uint64_t next_delay_ms = 0;
-    bool has_pending = false;
-    for (int i = 0; i < GPIO_NUM_BUTTONS; i++) {
-        if (g_pressed[i] && !g_long_sent[i]) {
-            has_pending = true;
-            uint64_t deadline = g_press_time_ms[i] + GPIO_LONG_PRESS_MS;
-            uint64_t remaining = (deadline > now_ms) ? (deadline - now_ms) : 0;
-            if (next_delay_ms == 0 || remaining < next_delay_ms) {
-                next_delay_ms = remaining;
-            }
-        }
-    }
-
     struct itimerspec its;
     memset(&its, 0, sizeof(its));
-    if (has_pending) {
-        if (next_delay_ms == 0) {
-            next_delay_ms = 1;
-        }
-        its.it_value.tv_sec = (time_t)(next_delay_ms / 1000);
-        its.it_value.tv_nsec = (long)((next_delay_ms % 1000) * 1000000L);
-        timerfd_settime(g_timer_fd, 0, &its, NULL);
-    } else {
-        timerfd_settime(g_timer_fd, 0, &its, NULL);
+    uint64_t deadline_ms;
+    if (gpio_keys_next_deadline_ms(&g_keys, &deadline_ms)) {
+        uint64_t now_ms = time_hal_now_ms();
+        uint64_t delay_ms = (deadline_ms > now_ms) ? (deadline_ms - now_ms) : 1; /* fire asap */
+        its.it_value.tv_sec = (time_t)(delay_ms / 1000);
+        its.it_value.tv_nsec = (long)((delay_ms % 1000) * 1000000L);
     }
-}
-
-static void handle_long_press_timer_locked(void) {
-    if (g_timer_fd < 0) return;
-
-    uint64_t now_ms = time_hal_now_ms();
-    uint64_t now_ns = time_hal_now_ns();
-
-    for (int i = 0; i < GPIO_NUM_BUTTONS; i++) {
-        if (g_pressed[i] && !g_long_sent[i] &&
-            now_ms - g_press_time_ms[i] >= GPIO_LONG_PRESS_MS) {
-            g_long_sent[i] = true;
-            gpio_event_t evt = {
-                .type = to_button_event(i, true),
-                .line = (uint8_t)i,
-                .timestamp_ns = now_ns
-            };
-            push_pending(&evt);
-        }
-    }
-
-    update_long_press_timer_locked();
+    timerfd_settime(g_timer_fd, 0, &its, NULL);
 }
 #endif
 
@@ -216,6 +145,7 @@ static void process_edge(const mock_edge_t *edge) {
     /* Debounce */
     if (g_use_soft_debounce && g_last_edge_ms[line] != 0 &&
         now_ms - g_last_edge_ms[line] < GPIO_DEBOUNCE_MS) {
+        metric_inc(&g_m_debounce_drops);
         return;
     }
     g_last_edge_ms[line] = now_ms;
@@ -224,46 +154,7 @@ static void process_edge(const mock_edge_t *edge) {
     g_line_values[line] = new_value;
     bool is_pressed = (new_value == g_pressed_level);
 
-    bool use_longpress_timer = (g_timer_fd >= 0);
-
-    if (is_pressed) {
-        g_pressed[line] = true;
-        g_press_time_ms[line] = now_ms;
-        g_long_sent[line] = false;
-#if USE_TIMERFD
-        if (use_longpress_timer) {
-            update_long_press_timer_locked();
-        }
-#endif
-        return;
-    }
-
-    if (g_pressed[line]) {
-        g_pressed[line] = false;
-        if (!use_longpress_timer) {
-            uint64_t elapsed = now_ms - g_press_time_ms[line];
-            gpio_event_t evt = {
-                .type = to_button_event(line, elapsed >= GPIO_LONG_PRESS_MS),
-                .line = (uint8_t)line,
-                .timestamp_ns = edge->timestamp_ns
-            };
-            push_pending(&evt);
-        } else {
-            bool long_sent = g_long_sent[line];
-            g_long_sent[line] = false;
-            if (!long_sent) {
-                gpio_event_t evt = {
-                    .type = to_button_event(line, false),
-                    .line = (uint8_t)line,
-                    .timestamp_ns = edge->timestamp_ns
-                };
-                push_pending(&evt);
-            }
-#if USE_TIMERFD
-            update_long_press_timer_locked();
-#endif
-        }
-    }
+    gpio_keys_edge(&g_keys, line, is_pressed, edge->timestamp_ns);
 }
 
 /* HAL Interface */
@@ -312,6 +203,7 @@ static int mock_init(void) {
         pthread_mutex_unlock(&g_lock);
         return -1;
     }
+    g_keys.timed = true;
 #endif
 
     pthread_mutex_unlock(&g_lock);
@@ -341,6 +233,7 @@ static void mock_cleanup(void) {
 #endif
 
     reset_state();
+    gpio_keys_reset(&g_keys);
     pthread_mutex_unlock(&g_lock);
 }
 
@@ -368,11 +261,12 @@ static int mock_read_event(gpio_event_t *event) {
         while (read(g_timer_fd, &expirations, sizeof(expirations)) > 0) {
             /* drain */
         }
-        handle_long_press_timer_locked();
+        gpio_keys_expire(&g_keys, time_hal_now_ns());
+        arm_timer_locked();
     }
 #endif
 
-    if (pop_pending(event)) {
+    if (gpio_keys_pop(&g_keys, event)) {
         pthread_mutex_unlock(&g_lock);
         return 1;
     }
@@ -382,13 +276,35 @@ static int mock_read_event(gpio_event_t *event) {
     while (pop_edge(&edge)) {
         process_edge(&edge);
     }
+#if USE_TIMERFD
+    arm_timer_locked();
+#endif
 
     /* Return next event */
-    bool has_event = pop_pending(event);
+    bool has_event = gpio_keys_pop(&g_keys, event);
     pthread_mutex_unlock(&g_lock);
     return has_event ? 1 : 0;
 }
 
+static void mock_set_press_dispatch(uint8_t line_mask) {
+    pthread_mutex_lock(&g_lock);
+    g_keys.press_dispatch = line_mask;
+    pthread_mutex_unlock(&g_lock);
+}
+
+static void mock_set_auto_repeat(uint8_t line_mask) {
+    pthread_mutex_lock(&g_lock);
+    g_keys.auto_repeat = line_mask;
+    pthread_mutex_unlock(&g_lock);
+}
+
+static int mock_set_gestures(const gpio_gesture_config_t *config) {
+    pthread_mutex_lock(&g_lock);
+    int ret = (g_timer_fd >= 0) ? gpio_gesture_configure(&g_keys.gesture, config) : -1;
+    pthread_mutex_unlock(&g_lock);
+    return ret;
+}
+
 /* HAL operations table */
 static const gpio_hal_ops_t mock_ops = {
     .init = mock_init,
@@ -396,6 +312,9 @@ static const gpio_hal_ops_t mock_ops = {
     .get_fd = mock_get_fd,
     .get_timer_fd = mock_get_timer_fd,
     .read_event = mock_read_event,
+    .set_press_dispatch = mock_set_press_dispatch,
+    .set_auto_repeat = mock_set_auto_repeat,
+    .set_gestures = mock_set_gestures,
 };
 
 const gpio_hal_ops_t *gpio_hal = &mock_ops;
@@ -426,11 +345,24 @@ void gpio_mock_inject_press(int line, bool long_press) {
     }
 }
 
+/* Deadline of the timer fd as time_hal ms (0 = disarmed), for virtual time drivers */
+uint64_t gpio_mock_next_deadline_ms(void) {
+    uint64_t deadline = 0;
+#if USE_TIMERFD
+    pthread_mutex_lock(&g_lock);
+    if (g_timer_fd >= 0 && !gpio_keys_next_deadline_ms(&g_keys, &deadline)) {
+        deadline = 0;
+    }
+    pthread_mutex_unlock(&g_lock);
+#endif
+    return deadline;
+}
+
 void gpio_mock_clear(void) {
     pthread_mutex_lock(&g_lock);
     reset_state();
 #if USE_TIMERFD
-    update_long_press_timer_locked();
+    arm_timer_locked();
 #endif
     drain_fd();
     pthread_mutex_unlock(&g_lock);
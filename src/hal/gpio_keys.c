@@ -0,0 +1,246 @@
+#include "gpio_keys.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef GPIO_DEBUG
+#define GPIO_LOG(...) fprintf(stderr, "[gpio] " __VA_ARGS__)
+#else
+#define GPIO_LOG(...) do {} while (0)
+#endif
+
+#define NS_PER_MS 1000000ULL
+
+static gpio_event_type_t to_button_event(int line, bool long_press) {
+    switch (line) {
+    case 0: return long_press ? GPIO_EVT_BTN_K1_LONG : GPIO_EVT_BTN_K1_SHORT;
+    case 1: return long_press ? GPIO_EVT_BTN_K2_LONG : GPIO_EVT_BTN_K2_SHORT;
+    default: return long_press ? GPIO_EVT_BTN_K3_LONG : GPIO_EVT_BTN_K3_SHORT;
+    }
+}
+
+static gpio_event_type_t to_repeat_event(int line) {
+    switch (line) {
+    case 0: return GPIO_EVT_BTN_K1_REPEAT;
+    case 1: return GPIO_EVT_BTN_K2_REPEAT;
+    default: return GPIO_EVT_BTN_K3_REPEAT;
+    }
+}
+
+/* Queue operations (a full queue drops its oldest event) */
+static void pending_push(gpio_keys_t *keys, const gpio_event_t *event) {
+    if (keys->pending_count >= GPIO_KEYS_MAX_PENDING) {
+        keys->pending_head = (keys->pending_head + 1) % GPIO_KEYS_MAX_PENDING;
+        keys->pending_count--;
+    }
+    int tail = (keys->pending_head + keys->pending_count) % GPIO_KEYS_MAX_PENDING;
+    keys->pending[tail] = *event;
+    keys->pending_count++;
+}
+
+/* Queue a button event through the double-click filter */
+static void emit_event(gpio_keys_t *keys, const gpio_event_t *event) {
+    gpio_event_t out[2];
+    int n = gpio_gesture_filter_event(&keys->gesture, event, out);
+    for (int i = 0; i < n; i++) {
+        pending_push(keys, &out[i]);
+    }
+}
+
+static void emit_button(gpio_keys_t *keys, int line, bool long_press, uint64_t timestamp_ns) {
+    gpio_event_t evt = {
+        .type = to_button_event(line, long_press),
+        .line = (uint8_t)line,
+        .timestamp_ns = timestamp_ns
+    };
+    emit_event(keys, &evt);
+    GPIO_LOG("event: line=%d type=%d\n", line, evt.type);
+}
+
+/* Queue repeat steps, merging into an unread REPEAT event of the same line */
+static void push_repeat(gpio_keys_t *keys, int line, uint16_t steps, uint64_t now_ns) {
+    if (keys->pending_count > 0) {
+        int last = (keys->pending_head + keys->pending_count - 1) % GPIO_KEYS_MAX_PENDING;
+        gpio_event_t *evt = &keys->pending[last];
+        if (evt->type == to_repeat_event(line) && evt->repeat <= UINT16_MAX - steps) {
+            evt->repeat += steps;
+            evt->timestamp_ns = now_ns;
+            return;
+        }
+    }
+
+    gpio_event_t evt = {
+        .type = to_repeat_event(line),
+        .line = (uint8_t)line,
+        .timestamp_ns = now_ns,
+        .repeat = steps
+    };
+    pending_push(keys, &evt);
+}
+
+/* Press / release after chord filtering */
+static void process_line_edge(gpio_keys_t *keys, int line, bool is_pressed,
+                              uint64_t timestamp_ns) {
+    uint64_t now_ms = timestamp_ns / NS_PER_MS;
+
+    uint8_t on_press = keys->press_dispatch | (keys->timed ? keys->auto_repeat : 0);
+    if (is_pressed && (on_press & GPIO_LINE_BIT(line))) {
+        /* No long action: emit now, ignore the release */
+        keys->pressed[line] = true;
+        keys->long_sent[line] = true;
+        keys->press_sent[line] = true;
+        keys->repeating[line] = keys->timed && (keys->auto_repeat & GPIO_LINE_BIT(line));
+        if (keys->repeating[line]) {
+            keys->repeat_next_ms[line] = now_ms + GPIO_REPEAT_DELAY_MS;
+            keys->repeat_interval_ms[line] = GPIO_REPEAT_START_MS;
+        }
+        emit_button(keys, line, false, timestamp_ns);
+        return;
+    }
+
+    if (is_pressed) {
+        keys->pressed[line] = true;
+        keys->press_time_ms[line] = now_ms;
+        keys->long_sent[line] = false;
+        return;
+    }
+
+    if (keys->press_sent[line]) {
+        keys->press_sent[line] = false;
+        keys->pressed[line] = false;
+        keys->long_sent[line] = false;
+        keys->repeating[line] = false;
+        return;
+    }
+
+    if (!keys->pressed[line]) {
+        return;
+    }
+    keys->pressed[line] = false;
+
+    if (!keys->timed) {
+        /* No timer: a long press is only known on release */
+        uint64_t elapsed = now_ms - keys->press_time_ms[line];
+        emit_button(keys, line, elapsed >= GPIO_LONG_PRESS_MS, timestamp_ns);
+        return;
+    }
+
+    bool long_sent = keys->long_sent[line];
+    keys->long_sent[line] = false;
+    if (!long_sent) {
+        emit_button(keys, line, false, timestamp_ns);
+    }
+}
+
+void gpio_keys_drop(gpio_keys_t *keys) {
+    memset(keys->pressed, 0, sizeof(keys->pressed));
+    memset(keys->press_time_ms, 0, sizeof(keys->press_time_ms));
+    memset(keys->long_sent, 0, sizeof(keys->long_sent));
+    memset(keys->press_sent, 0, sizeof(keys->press_sent));
+    memset(keys->repeating, 0, sizeof(keys->repeating));
+    keys->pending_head = 0;
+    keys->pending_count = 0;
+    gpio_gesture_drop_held(&keys->gesture);
+}
+
+void gpio_keys_reset(gpio_keys_t *keys) {
+    memset(keys, 0, sizeof(*keys));
+    gpio_gesture_reset(&keys->gesture);
+}
+
+void gpio_keys_edge(gpio_keys_t *keys, int line, bool pressed, uint64_t timestamp_ns) {
+    if (line < 0 || line >= GPIO_NUM_BUTTONS) return;
+
+    gpio_gesture_edge_t edges[2];
+    gpio_event_t chord;
+    int n = gpio_gesture_filter_edge(&keys->gesture, line, pressed, timestamp_ns,
+                                     edges, &chord);
+    if (chord.type != GPIO_EVT_NONE) {
+        emit_event(keys, &chord);
+        GPIO_LOG("event: line=%d type=%d chord\n", line, chord.type);
+    }
+    for (int i = 0; i < n; i++) {
+        process_line_edge(keys, edges[i].line, edges[i].pressed, edges[i].timestamp_ns);
+    }
+}
+
+void gpio_keys_expire(gpio_keys_t *keys, uint64_t now_ns) {
+    if (!keys->timed) return;
+    uint64_t now_ms = now_ns / NS_PER_MS;
+
+    /* Chord window over: replay held presses, then flush lone clicks */
+    gpio_gesture_edge_t edges[GPIO_NUM_BUTTONS];
+    int n = gpio_gesture_expire_edges(&keys->gesture, now_ms, edges);
+    for (int i = 0; i < n; i++) {
+        process_line_edge(keys, edges[i].line, edges[i].pressed, edges[i].timestamp_ns);
+    }
+    gpio_event_t clicks[GPIO_NUM_BUTTONS];
+    n = gpio_gesture_expire_events(&keys->gesture, now_ms, clicks);
+    for (int i = 0; i < n; i++) {
+        pending_push(keys, &clicks[i]);
+    }
+
+    for (int i = 0; i < GPIO_NUM_BUTTONS; i++) {
+        if (!keys->pressed[i]) continue;
+
+        if (keys->repeating[i]) {
+            if (now_ms < keys->repeat_next_ms[i]) continue;
+
+            /* Catch up on missed deadlines as one coalesced step count */
+            uint16_t steps = 0;
+            while (now_ms >= keys->repeat_next_ms[i] && steps < UINT16_MAX) {
+                steps++;
+                keys->repeat_next_ms[i] += keys->repeat_interval_ms[i];
+                /* Accelerate: each interval 20% shorter, down to the minimum */
+                keys->repeat_interval_ms[i] = keys->repeat_interval_ms[i] * 4 / 5;
+                if (keys->repeat_interval_ms[i] < GPIO_REPEAT_MIN_MS) {
+                    keys->repeat_interval_ms[i] = GPIO_REPEAT_MIN_MS;
+                }
+            }
+            push_repeat(keys, i, steps, now_ns);
+        } else if (!keys->long_sent[i] &&
+                   now_ms - keys->press_time_ms[i] >= GPIO_LONG_PRESS_MS) {
+            keys->long_sent[i] = true;
+            emit_button(keys, i, true, now_ns);
+        }
+    }
+}
+
+bool gpio_keys_next_deadline_ms(const gpio_keys_t *keys, uint64_t *deadline_ms) {
+    if (!keys->timed) return false;
+
+    /* A deadline already due is still the earliest: no "0 = unset" */
+    bool has_deadline = false;
+    uint64_t next = 0;
+    for (int i = 0; i < GPIO_NUM_BUTTONS; i++) {
+        if (!keys->pressed[i] || (keys->long_sent[i] && !keys->repeating[i])) continue;
+
+        uint64_t deadline = keys->repeating[i] ? keys->repeat_next_ms[i]
+                                               : keys->press_time_ms[i] + GPIO_LONG_PRESS_MS;
+        if (!has_deadline || deadline < next) {
+            next = deadline;
+            has_deadline = true;
+        }
+    }
+
+    uint64_t gesture_deadline = gpio_gesture_next_deadline_ms(&keys->gesture);
+    if (gesture_deadline != 0 && (!has_deadline || gesture_deadline < next)) {
+        next = gesture_deadline;
+        has_deadline = true;
+    }
+
+    if (has_deadline) {
+        *deadline_ms = next;
+    }
+    return has_deadline;
+}
+
+bool gpio_keys_pop(gpio_keys_t *keys, gpio_event_t *event) {
+    if (keys->pending_count == 0) {
+        return false;
+    }
+    *event = keys->pending[keys->pending_head];
+    keys->pending_head = (keys->pending_head + 1) % GPIO_KEYS_MAX_PENDING;
+    keys->pending_count--;
+    return true;
+}
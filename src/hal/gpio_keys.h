@@ -0,0 +1,80 @@
+/*
+ * Key state machine shared by the GPIO HAL backends
+ *
+ * A backend only turns its input into debounced edges and owns the fds:
+ *
+ *   edges -> gpio_keys_edge() -> chord filter -> press / long / repeat
+ *         -> double-click filter -> queue -> gpio_keys_pop()
+ *
+ * With a timer (timed = true) long presses are emitted while the key is
+ * held, and press dispatch, auto-repeat and gestures are available; the
+ * backend arms its timer for gpio_keys_next_deadline_ms() after feeding
+ * edges or calling gpio_keys_expire(). Without one, a long press is
+ * detected on release.
+ *
+ * Not thread-safe; the backend calls everything under its own lock.
+ */
+#ifndef GPIO_KEYS_H
+#define GPIO_KEYS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gpio_gesture.h"
+#include "gpio_hal.h"
+
+#define GPIO_KEYS_MAX_PENDING 32
+
+typedef struct {
+    bool timed;                         /* A timer drives deadlines (set by the backend) */
+    uint8_t press_dispatch;             /* GPIO_LINE_BIT mask */
+    uint8_t auto_repeat;                /* GPIO_LINE_BIT mask */
+
+    bool pressed[GPIO_NUM_BUTTONS];
+    uint64_t press_time_ms[GPIO_NUM_BUTTONS];
+    bool long_sent[GPIO_NUM_BUTTONS];
+    bool press_sent[GPIO_NUM_BUTTONS];  /* Dispatched on press edge */
+    bool repeating[GPIO_NUM_BUTTONS];   /* Held with auto-repeat */
+    uint64_t repeat_next_ms[GPIO_NUM_BUTTONS];
+    uint32_t repeat_interval_ms[GPIO_NUM_BUTTONS];
+
+    gpio_event_t pending[GPIO_KEYS_MAX_PENDING];
+    int pending_head;
+    int pending_count;
+
+    gpio_gesture_state_t gesture;
+} gpio_keys_t;
+
+/*
+ * Drop held keys and queued events, keeping the masks and gesture table.
+ */
+void gpio_keys_drop(gpio_keys_t *keys);
+
+/*
+ * Back to the initial state: nothing held, no masks, no gestures.
+ */
+void gpio_keys_reset(gpio_keys_t *keys);
+
+/*
+ * Feed a debounced edge (timestamp on time_hal's clock).
+ */
+void gpio_keys_edge(gpio_keys_t *keys, int line, bool pressed, uint64_t timestamp_ns);
+
+/*
+ * Emit whatever is due by now_ns: replayed chord presses, lone clicks,
+ * long presses and repeat steps.
+ */
+void gpio_keys_expire(gpio_keys_t *keys, uint64_t now_ns);
+
+/*
+ * Earliest long-press, repeat or gesture deadline (time_hal ms).
+ * Returns false if nothing is pending.
+ */
+bool gpio_keys_next_deadline_ms(const gpio_keys_t *keys, uint64_t *deadline_ms);
+
+/*
+ * Take the oldest queued event. Returns false if the queue is empty.
+ */
+bool gpio_keys_pop(gpio_keys_t *keys, gpio_event_t *event);
+
+#endif
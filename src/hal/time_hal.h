@@ -6,4 +6,11 @@
 uint64_t time_hal_now_ms(void);
 uint64_t time_hal_now_ns(void);
 
+/*
+ * Virtual clock control (time_hal_virtual.c only). The clock only moves
+ * when told to and never goes backwards.
+ */
+void time_hal_virtual_set_ns(uint64_t now_ns);
+void time_hal_virtual_advance_ms(uint64_t delta_ms);
+
 #endif
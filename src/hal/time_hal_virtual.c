@@ -0,0 +1,32 @@
+/*
+ * Virtual clock for deterministic simulation
+ *
+ * Replaces time_hal_real.c in simulation builds. Time stands still until
+ * the simulation driver moves it with time_hal_virtual_set_ns(), so runs
+ * are reproducible and hours of UI time pass in milliseconds.
+ */
+#include "time_hal.h"
+
+/* Start well away from 0: some callers treat 0 as "never" */
+#define VIRTUAL_EPOCH_NS (1000ULL * 1000000000ULL)
+
+static uint64_t g_now_ns = VIRTUAL_EPOCH_NS;
+
+uint64_t time_hal_now_ms(void) {
+    return g_now_ns / 1000000ULL;
+}
+
+uint64_t time_hal_now_ns(void) {
+    return g_now_ns;
+}
+
+void time_hal_virtual_set_ns(uint64_t now_ns) {
+    /* Monotonic: never step back */
+    if (now_ns > g_now_ns) {
+        g_now_ns = now_ns;
+    }
+}
+
+void time_hal_virtual_advance_ms(uint64_t delta_ms) {
+    g_now_ns += delta_ms * 1000000ULL;
+}
@@ -70,3 +70,9 @@ const uint8_t *font_title = NULL;
 const uint8_t *font_small = NULL;
 const uint8_t *font_content = NULL;
 const uint8_t *font_symbols = NULL;
+
+/* Placeholders measure like the target content font (7x13) */
+int font_ascent(const uint8_t *font) {
+    (void)font;
+    return 9;
+}
@@ -10,6 +10,8 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+struct sys_status;
+
 /*
  * Status codes (compatible with libubus UBUS_STATUS_*)
  */
@@ -19,6 +21,32 @@
 #define UBUS_HAL_STATUS_CONN_FAILED  4   /* UBUS_STATUS_CONNECTION_FAILED */
 #define UBUS_HAL_STATUS_ERROR        (-1)
 
+/*
+ * Returned by the *_async calls when every request slot of that class is
+ * taken (see UBUS_HAL_MAX_QUERIES / UBUS_HAL_MAX_CONTROLS). Nothing was
+ * sent and the callback is NOT invoked: retry later, this is not a
+ * failure of the service.
+ */
+#define UBUS_HAL_BUSY                (-2)
+
+/*
+ * Requests in flight at once, per class: a status refresh never starves
+ * controls of slots and a service batch never starves the queries.
+ */
+#define UBUS_HAL_MAX_QUERIES         16
+#define UBUS_HAL_MAX_CONTROLS        20
+#define UBUS_HAL_MAX_PENDING         (UBUS_HAL_MAX_QUERIES + UBUS_HAL_MAX_CONTROLS)
+
+/*
+ * Service control actions (rc init "action").
+ * STOP/START keep the values of the former bool start argument.
+ */
+typedef enum {
+    UBUS_HAL_ACTION_STOP = 0,
+    UBUS_HAL_ACTION_START = 1,
+    UBUS_HAL_ACTION_RESTART = 2,
+} ubus_hal_action_t;
+
 /*
  * Query callback - invoked when async query completes.
  *
@@ -72,12 +100,14 @@ typedef struct {
      * @param name  Service name (e.g., "dropbear")
      * @param cb    Callback invoked on completion/timeout
      * @param priv  User context passed to callback
-     * @return 0 on success (callback will be invoked), -1 on invalid args
+     * @return 0 on success (callback will be invoked), -1 on invalid args,
+     *         UBUS_HAL_BUSY if no request slot is free
      *
      * Return value semantics:
      *   - Returns 0: Callback WILL be invoked exactly once (async or sync)
      *     This includes connection failures - callback receives CONN_FAILED.
      *   - Returns -1: Invalid arguments (null name/cb), callback NOT invoked.
+     *   - Returns UBUS_HAL_BUSY: nothing sent, callback NOT invoked.
      *
      * The callback is guaranteed to be called at most once per request.
      */
@@ -91,7 +121,8 @@ typedef struct {
      * @param count     Number of services
      * @param cb        Callback invoked per service
      * @param priv      User context
-     * @return 0 on success, -1 on invalid args
+     * @return 0 on success, -1 on invalid args, UBUS_HAL_BUSY if the
+     *         slots ran out (names from the first busy one on not sent)
      *
      * Same return/callback semantics as query_service_async().
      */
@@ -99,16 +130,25 @@ typedef struct {
                                  ubus_query_cb cb, void *priv);
 
     /*
-     * Start or stop a service asynchronously.
+     * Start, stop or restart a service asynchronously.
      *
      * @param name      Service name (e.g., "dropbear")
-     * @param start     true to start, false to stop
+     * @param action    UBUS_HAL_ACTION_*
      * @param cb        Callback invoked on completion
      * @param priv      User context
-     * @return 0 on success (callback will be invoked), -1 on invalid args
+     * @return 0 on success (callback will be invoked), -1 on invalid args,
+     *         UBUS_HAL_BUSY if no request slot is free (callback NOT invoked)
      */
-    int (*control_service_async)(const char *name, bool start,
+    int (*control_service_async)(const char *name, ubus_hal_action_t action,
                                   ubus_control_cb cb, void *priv);
+
+    /*
+     * Serve status from the "nanohat" object (`ubus call nanohat status`,
+     * `services`, `history`). status is the daemon's working copy and is
+     * only read from the uloop thread, between collector updates; NULL
+     * stops serving it. Optional: NULL where no object is registered.
+     */
+    void (*set_status_source)(const struct sys_status *status);
 } ubus_hal_ops_t;
 
 /*
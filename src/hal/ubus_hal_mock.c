@@ -13,7 +13,7 @@
 #include <stdlib.h>
 #include <libubox/uloop.h>
 
-#define MAX_PENDING_REQUESTS 16
+#define MAX_PENDING_REQUESTS UBUS_HAL_MAX_PENDING
 #define MAX_MOCK_RESPONSES   16
 #define DEFAULT_DELAY_MS     50
 #define DEFAULT_TIMEOUT_MS   3000
@@ -63,7 +63,7 @@ typedef struct {
     int status;
 
     /* For control: operation type */
-    bool start_op;
+    ubus_hal_action_t action;
 } pending_request_t;
 
 static mock_response_t g_mock_responses[MAX_MOCK_RESPONSES];
@@ -71,6 +71,7 @@ static pending_request_t g_pending[MAX_PENDING_REQUESTS];
 static bool g_initialized = false;
 static int g_timeout_ms = DEFAULT_TIMEOUT_MS;
 static int g_consecutive_timeouts = 0;  /* Track consecutive timeouts for testing */
+static unsigned long g_request_count = 0;  /* Queries + controls issued */
 
 /* Default response for unconfigured services */
 static mock_response_t g_default_response = {
@@ -81,6 +82,15 @@ static mock_response_t g_default_response = {
     .configured = false
 };
 
+/*
+ * Optional responder consulted before the response table for queries
+ * (session replay). Returns true with the response filled in.
+ */
+typedef bool (*ubus_mock_responder_t)(const char *service, bool *installed, bool *running,
+                                      int *status, int *delay_ms, void *priv);
+static ubus_mock_responder_t g_responder;
+static void *g_responder_priv;
+
 /* Forward declarations */
 static void response_timer_cb(struct uloop_timeout *t);
 static void timeout_timer_cb(struct uloop_timeout *t);
@@ -142,10 +152,19 @@ void ubus_mock_clear_responses(void) {
     g_consecutive_timeouts = 0;
 }
 
+void ubus_mock_set_responder(ubus_mock_responder_t responder, void *priv) {
+    g_responder = responder;
+    g_responder_priv = priv;
+}
+
 int ubus_mock_get_consecutive_timeouts(void) {
     return g_consecutive_timeouts;
 }
 
+unsigned long ubus_mock_get_request_count(void) {
+    return g_request_count;
+}
+
 int ubus_mock_get_pending_count(void) {
     int count = 0;
     for (int i = 0; i < MAX_PENDING_REQUESTS; i++) {
@@ -249,20 +268,29 @@ static void timeout_timer_cb(struct uloop_timeout *t) {
 }
 
 /*
- * Allocate pending request slot
+ * Allocate pending request slot, within the limit of its class
  */
-static pending_request_t *alloc_request(void) {
+static pending_request_t *alloc_request(request_type_t type) {
+    int limit = (type == REQ_TYPE_QUERY) ? UBUS_HAL_MAX_QUERIES : UBUS_HAL_MAX_CONTROLS;
+    pending_request_t *free_slot = NULL;
+    int used = 0;
+
     for (int i = 0; i < MAX_PENDING_REQUESTS; i++) {
-        if (!g_pending[i].in_use) {
-            memset(&g_pending[i], 0, sizeof(pending_request_t));
-            g_pending[i].in_use = true;
-            g_pending[i].completed = false;
-            g_pending[i].response_timer.cb = response_timer_cb;
-            g_pending[i].timeout_timer.cb = timeout_timer_cb;
-            return &g_pending[i];
+        if (g_pending[i].in_use) {
+            if (g_pending[i].type == type) used++;
+        } else if (!free_slot) {
+            free_slot = &g_pending[i];
         }
     }
-    return NULL;
+    if (!free_slot || used >= limit) return NULL;
+
+    memset(free_slot, 0, sizeof(pending_request_t));
+    free_slot->in_use = true;
+    free_slot->completed = false;
+    free_slot->type = type;
+    free_slot->response_timer.cb = response_timer_cb;
+    free_slot->timeout_timer.cb = timeout_timer_cb;
+    return free_slot;
 }
 
 /*
@@ -279,27 +307,36 @@ static int mock_init(void) {
 static void mock_cleanup(void) {
     if (!g_initialized) return;
 
-    /* Cancel all pending timers */
+    /* Fail whatever is still in flight (match real impl) */
+    g_initialized = false;
     for (int i = 0; i < MAX_PENDING_REQUESTS; i++) {
-        if (g_pending[i].in_use) {
-            uloop_timeout_cancel(&g_pending[i].response_timer);
-            uloop_timeout_cancel(&g_pending[i].timeout_timer);
-            g_pending[i].in_use = false;
+        pending_request_t *req = &g_pending[i];
+        if (!req->in_use) continue;
+
+        uloop_timeout_cancel(&req->response_timer);
+        uloop_timeout_cancel(&req->timeout_timer);
+        if (!req->completed) {
+            req->completed = true;
+            if (req->type == REQ_TYPE_QUERY && req->query_cb) {
+                req->query_cb(req->service, false, false,
+                              UBUS_HAL_STATUS_CONN_FAILED, req->priv);
+            } else if (req->type == REQ_TYPE_CONTROL && req->control_cb) {
+                req->control_cb(req->service, false,
+                                UBUS_HAL_STATUS_CONN_FAILED, req->priv);
+            }
         }
+        req->in_use = false;
     }
-
-    g_initialized = false;
 }
 
 static int mock_query_service_async(const char *name, ubus_query_cb cb, void *priv) {
     if (!g_initialized || !name || !cb) return -1;
 
-    pending_request_t *req = alloc_request();
+    pending_request_t *req = alloc_request(REQ_TYPE_QUERY);
     if (!req) {
-        /* Match real impl: callback with error, return 0 */
-        cb(name, false, false, UBUS_HAL_STATUS_ERROR, priv);
-        return 0;
+        return UBUS_HAL_BUSY;  /* Match real impl */
     }
+    g_request_count++;
 
     /* Copy service name */
     strncpy(req->service, name, sizeof(req->service) - 1);
@@ -309,17 +346,22 @@ static int mock_query_service_async(const char *name, ubus_query_cb cb, void *pr
     req->priv = priv;
 
     /* Look up mock response */
-    const mock_response_t *resp = find_response(name);
-    req->installed = resp->installed;
-    req->running = resp->running;
-    req->status = resp->status;
+    int delay_ms;
+    if (!g_responder || !g_responder(name, &req->installed, &req->running, &req->status,
+                                     &delay_ms, g_responder_priv)) {
+        const mock_response_t *resp = find_response(name);
+        req->installed = resp->installed;
+        req->running = resp->running;
+        req->status = resp->status;
+        delay_ms = resp->delay_ms;
+    }
 
     /* Start timeout timer */
     uloop_timeout_set(&req->timeout_timer, g_timeout_ms);
 
     /* Schedule response callback (unless HANG mode) */
-    if (resp->delay_ms != MOCK_DELAY_HANG) {
-        uloop_timeout_set(&req->response_timer, resp->delay_ms);
+    if (delay_ms != MOCK_DELAY_HANG) {
+        uloop_timeout_set(&req->response_timer, delay_ms);
     }
     /* HANG mode: response timer never fires, timeout will trigger */
 
@@ -334,22 +376,22 @@ static int mock_query_services_async(const char **names, size_t count,
     for (size_t i = 0; i < count; i++) {
         if (names[i]) {
             int ret = mock_query_service_async(names[i], cb, priv);
-            if (ret < 0) return -1;
+            if (ret < 0) return ret;
         }
     }
 
     return 0;
 }
 
-static int mock_control_service_async(const char *name, bool start,
+static int mock_control_service_async(const char *name, ubus_hal_action_t action,
                                        ubus_control_cb cb, void *priv) {
     if (!g_initialized || !name || !cb) return -1;
 
-    pending_request_t *req = alloc_request();
+    pending_request_t *req = alloc_request(REQ_TYPE_CONTROL);
     if (!req) {
-        cb(name, false, UBUS_HAL_STATUS_ERROR, priv);
-        return 0;
+        return UBUS_HAL_BUSY;
     }
+    g_request_count++;
 
     /* Copy service name */
     strncpy(req->service, name, sizeof(req->service) - 1);
@@ -357,7 +399,7 @@ static int mock_control_service_async(const char *name, bool start,
     req->type = REQ_TYPE_CONTROL;
     req->control_cb = cb;
     req->priv = priv;
-    req->start_op = start;
+    req->action = action;
 
     /* Use default response settings for control */
     const mock_response_t *resp = find_response(name);
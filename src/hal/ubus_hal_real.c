@@ -5,11 +5,17 @@
  * Features:
  *   - Request timeout protection via uloop_timeout
  *   - Lazy reconnect on rpcd restart (reset rc_id on error)
+ *   - Background reconnect (with backoff) when ubusd is lost or a reset
+ *     drops the connection, so the nanohat object comes back while idle
+ *   - "nanohat" object on the same connection: `ubus call nanohat stats`
+ *     returns the metrics registry (metrics.h); `status`, `services` and
+ *     `history` return what the daemon last sampled, without new reads
  */
 #define _POSIX_C_SOURCE 200809L
 
 #include "ubus_hal.h"
 
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
@@ -17,7 +23,13 @@
 #include <libubox/uloop.h>
 #include <libubox/blobmsg.h>
 
-#define MAX_PENDING_REQUESTS 16
+#include "loop_watch.h"
+#include "metrics.h"
+#include "status_history.h"
+#include "sys_status.h"
+#include "time_hal.h"
+
+#define MAX_PENDING_REQUESTS UBUS_HAL_MAX_PENDING
 #define DEFAULT_TIMEOUT_MS   3000
 
 /*
@@ -49,10 +61,11 @@ typedef struct pending_request {
     bool running;
 
     /* For control: operation type */
-    bool start_op;
+    ubus_hal_action_t action;
 } pending_request_t;
 
 static struct ubus_context *g_ctx = NULL;
+static uloop_fd_handler g_sock_cb = NULL;   /* libubus socket handler, wrapped */
 static uint32_t g_rc_id = 0;
 static pending_request_t g_pending[MAX_PENDING_REQUESTS];
 static bool g_initialized = false;
@@ -63,6 +76,34 @@ static time_t g_last_attempt_time = 0;
 #define BACKOFF_BASE_SEC  1
 #define BACKOFF_MAX_SEC   60
 #define TIMEOUT_RESET_THRESHOLD 3  /* Reset connection after N consecutive timeouts */
+static bool g_connected_once = false;
+
+/*
+ * Reconnects without waiting for an outgoing request: the nanohat object
+ * lives on the connection and must be callable even while idle.
+ */
+static struct uloop_timeout g_reconnect_timer;
+static bool g_connection_lost = false;
+
+static uint64_t read_consecutive_failures(void) {
+    return (uint64_t)g_consecutive_failures;
+}
+
+static uint64_t read_pending(void) {
+    uint64_t n = 0;
+    for (int i = 0; i < MAX_PENDING_REQUESTS; i++) {
+        if (g_pending[i].in_use) n++;
+    }
+    return n;
+}
+
+METRIC_COUNTER(g_m_requests, "ubus_requests");
+METRIC_COUNTER(g_m_timeouts, "ubus_timeouts");
+METRIC_COUNTER(g_m_errors, "ubus_errors");
+METRIC_COUNTER(g_m_reconnects, "ubus_reconnects");
+METRIC_COUNTER(g_m_connect_failures, "ubus_connect_failures");
+METRIC_GAUGE_FN(g_m_failures, "ubus_consecutive_failures", read_consecutive_failures);
+METRIC_GAUGE_FN(g_m_pending, "ubus_pending", read_pending);
 
 /*
  * Response parsing for "rc list"
@@ -83,19 +124,28 @@ static void request_timeout_cb(struct uloop_timeout *t);
 static void reset_connection(void);
 
 /*
- * Allocate pending request slot
+ * Allocate pending request slot, within the limit of its class
  */
-static pending_request_t *alloc_request(void) {
+static pending_request_t *alloc_request(request_type_t type) {
+    int limit = (type == REQ_TYPE_QUERY) ? UBUS_HAL_MAX_QUERIES : UBUS_HAL_MAX_CONTROLS;
+    pending_request_t *free_slot = NULL;
+    int used = 0;
+
     for (int i = 0; i < MAX_PENDING_REQUESTS; i++) {
-        if (!g_pending[i].in_use) {
-            memset(&g_pending[i], 0, sizeof(pending_request_t));
-            g_pending[i].in_use = true;
-            g_pending[i].completed = false;
-            g_pending[i].timeout.cb = request_timeout_cb;
-            return &g_pending[i];
+        if (g_pending[i].in_use) {
+            if (g_pending[i].type == type) used++;
+        } else if (!free_slot) {
+            free_slot = &g_pending[i];
         }
     }
-    return NULL;
+    if (!free_slot || used >= limit) return NULL;
+
+    memset(free_slot, 0, sizeof(pending_request_t));
+    free_slot->in_use = true;
+    free_slot->completed = false;
+    free_slot->type = type;
+    free_slot->timeout.cb = request_timeout_cb;
+    return free_slot;
 }
 
 /*
@@ -108,13 +158,34 @@ static void release_request(pending_request_t *preq) {
     }
 }
 
+/*
+ * Loop watchdog wrappers (loop_watch.h)
+ */
+LOOP_WATCH_SOURCE(g_watch_sock, "ubus");
+LOOP_WATCH_SOURCE(g_watch_timeout, "ubus-tmo");
+
+static void handle_request_timeout(struct uloop_timeout *t);
+
+static void request_timeout_cb(struct uloop_timeout *t) {
+    loop_watch_timeout_begin(&g_watch_timeout, t);
+    handle_request_timeout(t);
+    loop_watch_end(&g_watch_timeout);
+}
+
+/* Replies and their completion callbacks run here */
+static void sock_cb(struct uloop_fd *u, unsigned int events) {
+    loop_watch_begin(&g_watch_sock);
+    g_sock_cb(u, events);
+    loop_watch_end(&g_watch_sock);
+}
+
 /*
  * Timeout callback - fires when request takes too long
  *
  * NOTE: We set completed=true BEFORE ubus_abort_request() to prevent
  * potential double-callback if abort synchronously triggers complete_cb.
  */
-static void request_timeout_cb(struct uloop_timeout *t) {
+static void handle_request_timeout(struct uloop_timeout *t) {
     pending_request_t *preq = container_of(t, pending_request_t, timeout);
 
     if (!preq->in_use || preq->completed) return;
@@ -129,6 +200,7 @@ static void request_timeout_cb(struct uloop_timeout *t) {
 
     /* Timeout counts as failure for backoff */
     g_consecutive_failures++;
+    metric_inc(&g_m_timeouts);
 
     /*
      * After threshold consecutive timeouts, reset connection to trigger backoff.
@@ -234,6 +306,9 @@ static void query_complete_cb(struct ubus_request *req, int ret) {
         status = UBUS_HAL_STATUS_ERROR;
         break;
     }
+    if (status != UBUS_HAL_STATUS_OK) {
+        metric_inc(&g_m_errors);
+    }
 
     /* Invoke user callback */
     if (preq->type == REQ_TYPE_QUERY && preq->query_cb) {
@@ -247,6 +322,142 @@ static void query_complete_cb(struct ubus_request *req, int ret) {
     preq->in_use = false;
 }
 
+/*
+ * "nanohat" ubus object
+ *
+ * stats:    { "<metric>": <value>, ... } from a snapshot of the registry.
+ * status:   system and network fields of the working sys_status_t.
+ * services: { "services": [ { "name", "installed", "running", ... } ] }
+ * history:  { "interval_ms", "samples": [ { "age_ms", "cpu_usage", ... } ] }
+ *           oldest first (status_history.h).
+ * Runs on the uloop thread between callbacks, like any other reply, so
+ * the status read here is never half updated.
+ */
+static struct blob_buf g_reply;
+static const sys_status_t *g_status;
+
+static int stats_handler(struct ubus_context *ctx, struct ubus_object *obj,
+                         struct ubus_request_data *req, const char *method,
+                         struct blob_attr *msg) {
+    (void)obj;
+    (void)method;
+    (void)msg;
+
+    static metric_sample_t samples[METRICS_MAX];
+    int n = metrics_snapshot(samples, METRICS_MAX);
+
+    blob_buf_init(&g_reply, 0);
+    for (int i = 0; i < n; i++) {
+        blobmsg_add_u64(&g_reply, samples[i].name, samples[i].value);
+    }
+    ubus_send_reply(ctx, req, g_reply.head);
+    return UBUS_STATUS_OK;
+}
+
+static int status_handler(struct ubus_context *ctx, struct ubus_object *obj,
+                          struct ubus_request_data *req, const char *method,
+                          struct blob_attr *msg) {
+    (void)obj;
+    (void)method;
+    (void)msg;
+
+    const sys_status_t *st = g_status;
+    if (!st) return UBUS_STATUS_NO_DATA;
+
+    blob_buf_init(&g_reply, 0);
+    blobmsg_add_string(&g_reply, "hostname", st->hostname);
+    blobmsg_add_string(&g_reply, "ip", st->ip_addr);
+    blobmsg_add_string(&g_reply, "gateway", st->gateway);
+    blobmsg_add_double(&g_reply, "cpu_usage", st->cpu_usage);
+    blobmsg_add_double(&g_reply, "cpu_temp", st->cpu_temp);
+    blobmsg_add_u64(&g_reply, "mem_total_kb", st->mem_total_kb);
+    blobmsg_add_u64(&g_reply, "mem_available_kb", st->mem_available_kb);
+    blobmsg_add_u32(&g_reply, "uptime_sec", st->uptime_sec);
+    blobmsg_add_u64(&g_reply, "rx_bytes", st->rx_bytes);
+    blobmsg_add_u64(&g_reply, "tx_bytes", st->tx_bytes);
+    blobmsg_add_u64(&g_reply, "rx_speed", st->rx_speed);
+    blobmsg_add_u64(&g_reply, "tx_speed", st->tx_speed);
+    blobmsg_add_u32(&g_reply, "service_count", (uint32_t)st->service_count);
+    ubus_send_reply(ctx, req, g_reply.head);
+    return UBUS_STATUS_OK;
+}
+
+static int services_handler(struct ubus_context *ctx, struct ubus_object *obj,
+                            struct ubus_request_data *req, const char *method,
+                            struct blob_attr *msg) {
+    (void)obj;
+    (void)method;
+    (void)msg;
+
+    const sys_status_t *st = g_status;
+    if (!st) return UBUS_STATUS_NO_DATA;
+
+    blob_buf_init(&g_reply, 0);
+    void *list = blobmsg_open_array(&g_reply, "services");
+    for (size_t i = 0; i < st->service_count; i++) {
+        const service_status_t *svc = &st->services[i];
+        void *entry = blobmsg_open_table(&g_reply, NULL);
+        blobmsg_add_string(&g_reply, "name", svc->name);
+        blobmsg_add_u8(&g_reply, "installed", svc->installed);
+        blobmsg_add_u8(&g_reply, "running", svc->running);
+        blobmsg_add_u8(&g_reply, "valid", svc->status_valid);
+        if (svc->usage_valid) {
+            blobmsg_add_double(&g_reply, "cpu_percent", svc->cpu_percent);
+            blobmsg_add_u64(&g_reply, "mem_bytes", svc->mem_bytes);
+        }
+        blobmsg_close_table(&g_reply, entry);
+    }
+    blobmsg_close_array(&g_reply, list);
+    ubus_send_reply(ctx, req, g_reply.head);
+    return UBUS_STATUS_OK;
+}
+
+static int history_handler(struct ubus_context *ctx, struct ubus_object *obj,
+                           struct ubus_request_data *req, const char *method,
+                           struct blob_attr *msg) {
+    (void)obj;
+    (void)method;
+    (void)msg;
+
+    static status_history_sample_t samples[STATUS_HISTORY_LEN];
+    size_t n = status_history_get(samples, STATUS_HISTORY_LEN);
+    uint64_t now_ms = time_hal_now_ms();
+
+    blob_buf_init(&g_reply, 0);
+    blobmsg_add_u32(&g_reply, "interval_ms", STATUS_HISTORY_INTERVAL_MS);
+    void *list = blobmsg_open_array(&g_reply, "samples");
+    for (size_t i = 0; i < n; i++) {
+        void *entry = blobmsg_open_table(&g_reply, NULL);
+        blobmsg_add_u64(&g_reply, "age_ms", now_ms - samples[i].time_ms);
+        blobmsg_add_double(&g_reply, "cpu_usage", samples[i].cpu_usage);
+        blobmsg_add_double(&g_reply, "cpu_temp", samples[i].cpu_temp);
+        blobmsg_add_u64(&g_reply, "mem_available_kb", samples[i].mem_available_kb);
+        blobmsg_add_u64(&g_reply, "rx_speed", samples[i].rx_speed);
+        blobmsg_add_u64(&g_reply, "tx_speed", samples[i].tx_speed);
+        blobmsg_close_table(&g_reply, entry);
+    }
+    blobmsg_close_array(&g_reply, list);
+    ubus_send_reply(ctx, req, g_reply.head);
+    return UBUS_STATUS_OK;
+}
+
+static const struct ubus_method g_nanohat_methods[] = {
+    UBUS_METHOD_NOARG("stats", stats_handler),
+    UBUS_METHOD_NOARG("status", status_handler),
+    UBUS_METHOD_NOARG("services", services_handler),
+    UBUS_METHOD_NOARG("history", history_handler),
+};
+
+static struct ubus_object_type g_nanohat_object_type =
+    UBUS_OBJECT_TYPE("nanohat", g_nanohat_methods);
+
+static struct ubus_object g_nanohat_object = {
+    .name = "nanohat",
+    .type = &g_nanohat_object_type,
+    .methods = g_nanohat_methods,
+    .n_methods = ARRAY_SIZE(g_nanohat_methods),
+};
+
 /*
  * Connection management with backoff
  */
@@ -279,6 +490,11 @@ static void abort_all_pending(int status) {
     }
 }
 
+static void schedule_reconnect(void) {
+    if (!g_initialized) return;
+    uloop_timeout_set(&g_reconnect_timer, get_backoff_delay() * 1000);
+}
+
 static void reset_connection(void) {
     /* Abort pending requests before freeing context */
     abort_all_pending(UBUS_HAL_STATUS_CONN_FAILED);
@@ -288,6 +504,27 @@ static void reset_connection(void) {
         g_ctx = NULL;
     }
     g_rc_id = 0;
+    g_connection_lost = false;
+    schedule_reconnect();
+}
+
+/* ubusd went away (libubus default would end the uloop) */
+static void connection_lost_cb(struct ubus_context *ctx) {
+    uloop_fd_delete(&ctx->sock);
+    g_connection_lost = true;
+    uloop_timeout_set(&g_reconnect_timer, 0);  /* Not from inside libubus */
+}
+
+static int ensure_context(void);
+
+static void reconnect_cb(struct uloop_timeout *t) {
+    loop_watch_timeout_begin(&g_watch_timeout, t);
+    if (g_connection_lost) {
+        reset_connection();  /* Reschedules */
+    } else if (ensure_context() < 0) {
+        schedule_reconnect();
+    }
+    loop_watch_end(&g_watch_timeout);
 }
 
 static int ensure_context(void) {
@@ -307,12 +544,25 @@ static int ensure_context(void) {
     if (!g_ctx) {
         g_rc_id = 0;
         g_consecutive_failures++;
+        metric_inc(&g_m_connect_failures);
         return -1;
     }
 
-    /* Register with uloop */
+    /* Register with uloop, timing the socket callback */
+    g_sock_cb = g_ctx->sock.cb;
+    g_ctx->sock.cb = sock_cb;
+    g_ctx->connection_lost = connection_lost_cb;
     ubus_add_uloop(g_ctx);
 
+    /* Objects live on the connection: register again after a reconnect */
+    if (ubus_add_object(g_ctx, &g_nanohat_object) != 0) {
+        fprintf(stderr, "WARN: failed to register ubus object nanohat\n");
+    }
+
+    if (g_connected_once) {
+        metric_inc(&g_m_reconnects);
+    }
+    g_connected_once = true;
     g_consecutive_failures = 0;
     return 0;
 }
@@ -336,35 +586,35 @@ static int real_init(void) {
     if (g_initialized) return 0;
 
     memset(g_pending, 0, sizeof(g_pending));
-
-    /* Initial connection attempt (non-blocking if fails) */
-    ensure_context();
-
+    g_reconnect_timer.cb = reconnect_cb;
     g_initialized = true;
+
+    /* Initial connection attempt; retried in the background if it fails */
+    if (ensure_context() < 0) {
+        schedule_reconnect();
+    }
     return 0;
 }
 
 static void real_cleanup(void) {
     if (!g_initialized) return;
 
-    /* Abort pending and reset connection (callbacks not invoked during shutdown) */
-    for (int i = 0; i < MAX_PENDING_REQUESTS; i++) {
-        if (g_pending[i].in_use) {
-            g_pending[i].completed = true;  /* Prevent late callbacks */
-            uloop_timeout_cancel(&g_pending[i].timeout);
-            if (g_ctx) {
-                ubus_abort_request(g_ctx, &g_pending[i].req);
-            }
-            g_pending[i].in_use = false;
-        }
-    }
+    /*
+     * Fail whatever is still in flight so its owner can let go of it (a
+     * service batch waits for every job). New requests from the callbacks
+     * are refused: not initialized any more.
+     */
+    g_initialized = false;
+    uloop_timeout_cancel(&g_reconnect_timer);
+    g_connection_lost = false;
+    abort_all_pending(UBUS_HAL_STATUS_CONN_FAILED);
 
     if (g_ctx) {
         ubus_free(g_ctx);
         g_ctx = NULL;
     }
+    blob_buf_free(&g_reply);
     g_rc_id = 0;
-    g_initialized = false;
 }
 
 static int real_query_service_async(const char *name, ubus_query_cb cb, void *priv) {
@@ -376,10 +626,9 @@ static int real_query_service_async(const char *name, ubus_query_cb cb, void *pr
         return 0;  /* Request "initiated" - callback will be called */
     }
 
-    pending_request_t *preq = alloc_request();
+    pending_request_t *preq = alloc_request(REQ_TYPE_QUERY);
     if (!preq) {
-        cb(name, false, false, UBUS_HAL_STATUS_ERROR, priv);
-        return 0;
+        return UBUS_HAL_BUSY;
     }
 
     /* Store request info */
@@ -411,6 +660,7 @@ static int real_query_service_async(const char *name, ubus_query_cb cb, void *pr
 
     /* Complete request setup - this registers with uloop */
     ubus_complete_request_async(g_ctx, &preq->req);
+    metric_inc(&g_m_requests);
 
     /* Start timeout timer */
     uloop_timeout_set(&preq->timeout, DEFAULT_TIMEOUT_MS);
@@ -431,14 +681,22 @@ static int real_query_services_async(const char **names, size_t count,
     for (size_t i = 0; i < count; i++) {
         if (names[i]) {
             int ret = real_query_service_async(names[i], cb, priv);
-            if (ret < 0) return -1;
+            if (ret < 0) return ret;
         }
     }
 
     return 0;
 }
 
-static int real_control_service_async(const char *name, bool start,
+static const char *action_name(ubus_hal_action_t action) {
+    switch (action) {
+        case UBUS_HAL_ACTION_START:   return "start";
+        case UBUS_HAL_ACTION_RESTART: return "restart";
+        default:                      return "stop";
+    }
+}
+
+static int real_control_service_async(const char *name, ubus_hal_action_t action,
                                        ubus_control_cb cb, void *priv) {
     if (!g_initialized || !name || !cb) return -1;
 
@@ -447,10 +705,9 @@ static int real_control_service_async(const char *name, bool start,
         return 0;
     }
 
-    pending_request_t *preq = alloc_request();
+    pending_request_t *preq = alloc_request(REQ_TYPE_CONTROL);
     if (!preq) {
-        cb(name, false, UBUS_HAL_STATUS_ERROR, priv);
-        return 0;
+        return UBUS_HAL_BUSY;
     }
 
     /* Store request info */
@@ -459,13 +716,13 @@ static int real_control_service_async(const char *name, bool start,
     preq->type = REQ_TYPE_CONTROL;
     preq->control_cb = cb;
     preq->priv = priv;
-    preq->start_op = start;
+    preq->action = action;
 
-    /* Build request: rc init {"name":"xxx","action":"start|stop"} */
+    /* Build request: rc init {"name":"xxx","action":"start|stop|restart"} */
     struct blob_buf b = {0};
     blob_buf_init(&b, 0);
     blobmsg_add_string(&b, "name", name);
-    blobmsg_add_string(&b, "action", start ? "start" : "stop");
+    blobmsg_add_string(&b, "action", action_name(action));
 
     /* Initiate async request */
     int ret = ubus_invoke_async(g_ctx, g_rc_id, "init", b.head, &preq->req);
@@ -482,6 +739,7 @@ static int real_control_service_async(const char *name, bool start,
 
     /* Complete request setup */
     ubus_complete_request_async(g_ctx, &preq->req);
+    metric_inc(&g_m_requests);
 
     /* Start timeout timer */
     uloop_timeout_set(&preq->timeout, DEFAULT_TIMEOUT_MS);
@@ -490,12 +748,17 @@ static int real_control_service_async(const char *name, bool start,
     return 0;
 }
 
+static void real_set_status_source(const struct sys_status *status) {
+    g_status = status;
+}
+
 static const ubus_hal_ops_t real_ops = {
     .init = real_init,
     .cleanup = real_cleanup,
     .query_service_async = real_query_service_async,
     .query_services_async = real_query_services_async,
     .control_service_async = real_control_service_async,
+    .set_status_source = real_set_status_source,
 };
 
 const ubus_hal_ops_t *ubus_hal = &real_ops;
@@ -0,0 +1,125 @@
+#include "input_latency.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "hal/time_hal.h"
+
+/* Values below this map 1:1 to buckets; above, 4 sub-buckets per octave */
+#define LINEAR_LIMIT 8
+
+static latency_hist_t g_hist[INPUT_LATENCY_STAGES];
+
+/* Input in flight */
+static bool g_active;
+static uint64_t g_edge_ns;
+static bool g_marked[INPUT_LATENCY_STAGES];
+
+static const char *const g_stage_names[INPUT_LATENCY_STAGES] = {
+    [INPUT_LATENCY_HANDLED] = "handled",
+    [INPUT_LATENCY_RENDERED] = "rendered",
+    [INPUT_LATENCY_FLUSHED] = "flushed",
+};
+
+static int bucket_index(uint64_t v) {
+    if (v < LINEAR_LIMIT) return (int)v;
+
+    int exp = 63 - __builtin_clzll(v);
+    int sub = (int)((v >> (exp - 2)) & 3);
+    int index = LINEAR_LIMIT + (exp - 3) * 4 + sub;
+    return index < LATENCY_HIST_BUCKETS ? index : LATENCY_HIST_BUCKETS - 1;
+}
+
+static uint64_t bucket_upper(int index) {
+    if (index < LINEAR_LIMIT) return (uint64_t)index;
+
+    int exp = 3 + (index - LINEAR_LIMIT) / 4;
+    int sub = (index - LINEAR_LIMIT) % 4;
+    uint64_t lower = (uint64_t)(4 + sub) << (exp - 2);
+    return lower + (1ULL << (exp - 2)) - 1;
+}
+
+void latency_hist_reset(latency_hist_t *hist) {
+    if (hist) memset(hist, 0, sizeof(*hist));
+}
+
+void latency_hist_record(latency_hist_t *hist, uint64_t value_us) {
+    if (!hist) return;
+
+    hist->buckets[bucket_index(value_us)]++;
+    hist->count++;
+    hist->sum_us += value_us;
+    if (value_us > hist->max_us) hist->max_us = value_us;
+}
+
+uint64_t latency_hist_percentile(const latency_hist_t *hist, double p) {
+    if (!hist || hist->count == 0) return 0;
+
+    if (p < 0.0) p = 0.0;
+    if (p > 100.0) p = 100.0;
+
+    /* Rank of the sample at percentile p (1-based, nearest-rank) */
+    uint64_t rank = (uint64_t)(p / 100.0 * (double)hist->count + 0.999999);
+    if (rank < 1) rank = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            if (i == LATENCY_HIST_BUCKETS - 1) return hist->max_us;  /* Saturated */
+            uint64_t upper = bucket_upper(i);
+            return upper < hist->max_us ? upper : hist->max_us;
+        }
+    }
+    return hist->max_us;
+}
+
+void input_latency_begin(uint64_t edge_ns) {
+    g_active = true;
+    g_edge_ns = edge_ns;
+    memset(g_marked, 0, sizeof(g_marked));
+}
+
+void input_latency_mark(input_latency_stage_t stage) {
+    if (!g_active || (unsigned)stage >= INPUT_LATENCY_STAGES) return;
+    if (g_marked[stage]) return;
+
+    uint64_t now_ns = time_hal_now_ns();
+    uint64_t elapsed_us = (now_ns > g_edge_ns) ? (now_ns - g_edge_ns) / 1000ULL : 0;
+    latency_hist_record(&g_hist[stage], elapsed_us);
+    g_marked[stage] = true;
+
+    if (stage == INPUT_LATENCY_FLUSHED) {
+        g_active = false;
+    }
+}
+
+void input_latency_end(void) {
+    g_active = false;
+}
+
+const latency_hist_t *input_latency_get(input_latency_stage_t stage) {
+    if ((unsigned)stage >= INPUT_LATENCY_STAGES) return NULL;
+    return &g_hist[stage];
+}
+
+void input_latency_reset(void) {
+    memset(g_hist, 0, sizeof(g_hist));
+}
+
+void input_latency_dump(FILE *fp) {
+    if (!fp) return;
+
+    for (int i = 0; i < INPUT_LATENCY_STAGES; i++) {
+        const latency_hist_t *h = &g_hist[i];
+        fprintf(fp, "latency %-8s n=%" PRIu64 " p50=%" PRIu64 "us p90=%" PRIu64
+                "us p99=%" PRIu64 "us max=%" PRIu64 "us\n",
+                g_stage_names[i], h->count,
+                latency_hist_percentile(h, 50.0),
+                latency_hist_percentile(h, 90.0),
+                latency_hist_percentile(h, 99.0),
+                h->max_us);
+    }
+    fflush(fp);
+}
@@ -0,0 +1,84 @@
+/*
+ * Button-to-photon latency instrumentation
+ *
+ * Every button event carries the kernel edge timestamp (CLOCK_MONOTONIC,
+ * see gpio_hal.h). The event loop tags the input being processed with
+ * input_latency_begin(); the stages below record (now - edge) into one
+ * histogram each when they complete for that input:
+ *
+ *   HANDLED   page/controller key handling done
+ *   RENDERED  frame composed in the u8g2 buffer
+ *   FLUSHED   send_buffer() returned (I2C transfer complete = photon)
+ *
+ * Histograms are log-linear (4 sub-buckets per power of two, in us), so
+ * percentiles are accurate to ~25% over 1 us .. 2^31 us with fixed memory.
+ * Single-threaded: call from the uloop thread only.
+ */
+#ifndef INPUT_LATENCY_H
+#define INPUT_LATENCY_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define LATENCY_HIST_BUCKETS 128
+
+typedef struct {
+    uint32_t buckets[LATENCY_HIST_BUCKETS];
+    uint64_t count;
+    uint64_t sum_us;
+    uint64_t max_us;
+} latency_hist_t;
+
+typedef enum {
+    INPUT_LATENCY_HANDLED = 0,
+    INPUT_LATENCY_RENDERED,
+    INPUT_LATENCY_FLUSHED,
+    INPUT_LATENCY_STAGES
+} input_latency_stage_t;
+
+/*
+ * Histogram primitives.
+ */
+void latency_hist_reset(latency_hist_t *hist);
+void latency_hist_record(latency_hist_t *hist, uint64_t value_us);
+
+/*
+ * Value at percentile p (0..100), as the upper bound of its bucket
+ * (never above the recorded maximum). Returns 0 for an empty histogram.
+ */
+uint64_t latency_hist_percentile(const latency_hist_t *hist, double p);
+
+/*
+ * Tag the input currently being processed with its edge timestamp (ns).
+ * Replaces any input still in flight.
+ */
+void input_latency_begin(uint64_t edge_ns);
+
+/*
+ * Record a stage for the input in flight (no-op without one, e.g. for
+ * timer or ubus driven renders). Each stage is recorded at most once.
+ * FLUSHED completes the input.
+ */
+void input_latency_mark(input_latency_stage_t stage);
+
+/*
+ * Drop the input in flight (e.g. key that did not trigger a render).
+ */
+void input_latency_end(void);
+
+/*
+ * Histogram of a stage, NULL for an invalid stage.
+ */
+const latency_hist_t *input_latency_get(input_latency_stage_t stage);
+
+/*
+ * Clear all histograms.
+ */
+void input_latency_reset(void);
+
+/*
+ * Print count/p50/p90/p99/max per stage (one line each).
+ */
+void input_latency_dump(FILE *fp);
+
+#endif
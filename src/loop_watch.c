@@ -0,0 +1,123 @@
+#include "loop_watch.h"
+
+#include <inttypes.h>
+#include <string.h>
+#include <libubox/uloop.h>
+
+#include "hal/time_hal.h"
+#include "metrics.h"
+
+METRIC_COUNTER(g_m_stalls, "loop_stalls");
+
+static loop_watch_source_t *g_sources;
+
+static loop_stall_t g_stalls[LOOP_STALL_LOG];
+static uint64_t g_stall_total;
+static uint64_t g_last_report_ms;
+static uint64_t g_unreported;       /* Stalls since the last stderr report */
+
+static void register_source(loop_watch_source_t *source) {
+    if (source->registered) return;
+    source->registered = true;
+    source->next = g_sources;
+    g_sources = source;
+}
+
+void loop_watch_timeout_begin(loop_watch_source_t *source, const struct uloop_timeout *t) {
+    loop_watch_begin(source);
+
+    uint64_t due_us = (uint64_t)t->time.tv_sec * 1000000ULL + (uint64_t)t->time.tv_usec;
+    uint64_t now_us = source->start_ns / 1000ULL;
+    latency_hist_record(&source->lag_us, now_us > due_us ? now_us - due_us : 0);
+}
+
+void loop_watch_begin(loop_watch_source_t *source) {
+    register_source(source);
+    source->start_ns = time_hal_now_ns();
+}
+
+static void record_stall(loop_watch_source_t *source, uint64_t run_us) {
+    source->stalls++;
+    metric_inc(&g_m_stalls);
+
+    memmove(&g_stalls[1], &g_stalls[0], sizeof(g_stalls) - sizeof(g_stalls[0]));
+    g_stalls[0].name = source->name;
+    g_stalls[0].run_us = run_us;
+    g_stalls[0].at_ms = source->start_ns / 1000000ULL;
+    g_stall_total++;
+    g_unreported++;
+
+    uint64_t now_ms = time_hal_now_ms();
+    if (g_last_report_ms == 0 || now_ms - g_last_report_ms >= LOOP_STALL_REPORT_MS) {
+        fprintf(stderr, "WARN: loop stall: %s ran %" PRIu64 " ms (%" PRIu64
+                " stalls since last report)\n", source->name, run_us / 1000, g_unreported);
+        g_last_report_ms = now_ms;
+        g_unreported = 0;
+    }
+}
+
+void loop_watch_end(loop_watch_source_t *source) {
+    uint64_t now_ns = time_hal_now_ns();
+    uint64_t run_us = now_ns > source->start_ns ? (now_ns - source->start_ns) / 1000ULL : 0;
+    latency_hist_record(&source->run_us, run_us);
+
+    if (run_us >= (uint64_t)LOOP_STALL_MS * 1000ULL) {
+        record_stall(source, run_us);
+    }
+}
+
+const loop_watch_source_t *loop_watch_find(const char *name) {
+    for (const loop_watch_source_t *s = g_sources; s; s = s->next) {
+        if (strcmp(s->name, name) == 0) return s;
+    }
+    return NULL;
+}
+
+int loop_watch_stalls(loop_stall_t *out, int max, uint64_t *total) {
+    int n = (g_stall_total < LOOP_STALL_LOG) ? (int)g_stall_total : LOOP_STALL_LOG;
+    if (n > max) n = max;
+    for (int i = 0; i < n; i++) {
+        out[i] = g_stalls[i];
+    }
+    if (total) *total = g_stall_total;
+    return n;
+}
+
+void loop_watch_reset(void) {
+    for (loop_watch_source_t *s = g_sources; s; s = s->next) {
+        latency_hist_reset(&s->lag_us);
+        latency_hist_reset(&s->run_us);
+        s->stalls = 0;
+    }
+    memset(g_stalls, 0, sizeof(g_stalls));
+    g_stall_total = 0;
+    g_last_report_ms = 0;
+    g_unreported = 0;
+}
+
+void loop_watch_dump(FILE *fp) {
+    if (!fp) return;
+
+    for (const loop_watch_source_t *s = g_sources; s; s = s->next) {
+        if (s->lag_us.count > 0) {
+            fprintf(fp, "loop %-10s lag n=%" PRIu64 " p50=%" PRIu64 "us p99=%" PRIu64
+                    "us max=%" PRIu64 "us\n", s->name, s->lag_us.count,
+                    latency_hist_percentile(&s->lag_us, 50.0),
+                    latency_hist_percentile(&s->lag_us, 99.0), s->lag_us.max_us);
+        }
+        fprintf(fp, "loop %-10s run n=%" PRIu64 " p50=%" PRIu64 "us p99=%" PRIu64
+                "us max=%" PRIu64 "us stalls=%" PRIu32 "\n", s->name, s->run_us.count,
+                latency_hist_percentile(&s->run_us, 50.0),
+                latency_hist_percentile(&s->run_us, 99.0), s->run_us.max_us, s->stalls);
+    }
+
+    loop_stall_t stalls[LOOP_STALL_LOG];
+    uint64_t total;
+    int n = loop_watch_stalls(stalls, LOOP_STALL_LOG, &total);
+    fprintf(fp, "loop stalls total=%" PRIu64 "\n", total);
+    for (int i = 0; i < n; i++) {
+        fprintf(fp, "loop stall %s %" PRIu64 "us at %" PRIu64 "ms\n",
+                stalls[i].name, stalls[i].run_us, stalls[i].at_ms);
+    }
+    fflush(fp);
+}
@@ -0,0 +1,92 @@
+/*
+ * Event-loop lag and stall watchdog
+ *
+ * A blocking /proc read, getifaddrs() or I2C write delays every uloop
+ * callback queued behind it. Each instrumented callback brackets its body
+ * with loop_watch_begin()/loop_watch_end() on a static source, which
+ * records into log-linear histograms (see input_latency.h):
+ *
+ *   lag  timeouts only: actual firing time - scheduled deadline
+ *   run  time spent in the callback
+ *
+ * A callback running for LOOP_STALL_MS or more is a stall: counted on its
+ * source, kept in a log of the last LOOP_STALL_LOG stalls and reported on
+ * stderr (rate-limited). Two time_hal reads per callback and nothing at
+ * all while idle. Sources register themselves on first use.
+ *
+ * Single-threaded: call from the uloop thread only.
+ */
+#ifndef LOOP_WATCH_H
+#define LOOP_WATCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "input_latency.h"
+
+#define LOOP_STALL_MS        50
+#define LOOP_STALL_LOG       8
+#define LOOP_STALL_REPORT_MS 10000  /* Min interval between stderr reports */
+
+struct uloop_timeout;
+
+typedef struct loop_watch_source {
+    const char *name;
+    latency_hist_t lag_us;
+    latency_hist_t run_us;
+    uint32_t stalls;
+
+    /* Internal */
+    uint64_t start_ns;
+    bool registered;
+    struct loop_watch_source *next;
+} loop_watch_source_t;
+
+typedef struct {
+    const char *name;
+    uint64_t run_us;
+    uint64_t at_ms;     /* time_hal ms when the callback started */
+} loop_stall_t;
+
+/* Define a static source: LOOP_WATCH_SOURCE(g_watch_ui_timer, "ui-timer"); */
+#define LOOP_WATCH_SOURCE(var, source_name) \
+    static loop_watch_source_t var = { .name = (source_name) }
+
+/*
+ * Start of a timeout callback: records lag against the timeout's deadline.
+ */
+void loop_watch_timeout_begin(loop_watch_source_t *source, const struct uloop_timeout *t);
+
+/*
+ * Start of any other callback (fd, signal).
+ */
+void loop_watch_begin(loop_watch_source_t *source);
+
+/*
+ * End of the callback: records run time and detects a stall.
+ */
+void loop_watch_end(loop_watch_source_t *source);
+
+/*
+ * Registered source by name, NULL if none.
+ */
+const loop_watch_source_t *loop_watch_find(const char *name);
+
+/*
+ * Most recent stalls, newest first. Returns the number stored (at most
+ * max and LOOP_STALL_LOG). *total receives the stall count since reset.
+ */
+int loop_watch_stalls(loop_stall_t *out, int max, uint64_t *total);
+
+/*
+ * Clear histograms, counters and the stall log.
+ */
+void loop_watch_reset(void);
+
+/*
+ * Print lag/run percentiles per source and the stall log.
+ */
+void loop_watch_dump(FILE *fp);
+
+#endif
@@ -4,28 +4,45 @@
  * Main entry point with libubox/uloop event loop.
  */
 #include <stdio.h>
+#include <stdlib.h>
 #include <signal.h>
 #include <libubox/uloop.h>
 
+#include "app_loop.h"
+#include "fb_mirror.h"
 #include "hal/display_hal.h"
 #include "hal/gpio_hal.h"
-#include "hal/time_hal.h"
 #include "hal/ubus_hal.h"
-#include "ui_controller.h"
+#include "input_latency.h"
+#include "frame_prof.h"
+#include "loop_watch.h"
+#include "metrics.h"
+#include "offload.h"
+#include "prom_server.h"
+#include "session_log.h"
+#include "status_shm.h"
 
 #define APP_NAME "nanohat-oled"
 
-/* Forward declarations */
-static void gpio_fd_cb(struct uloop_fd *u, unsigned int events);
-static void handle_button_event(const gpio_event_t *event);
-static void ui_timer_cb(struct uloop_timeout *t);
-static void schedule_ui_timer(void);
+/* Record a session log for offline replay (see session_log.h) */
+#define SESSION_LOG_ENV "NANOHAT_SESSION_LOG"
+
+/* Prometheus endpoint: Unix socket path or loopback port (see prom_server.h) */
+#define METRICS_LISTEN_ENV "NANOHAT_METRICS_LISTEN"
+
+/* Framebuffer mirror: Unix socket path (see fb_mirror.h) */
+#define MIRROR_LISTEN_ENV "NANOHAT_MIRROR_LISTEN"
 
 /*
  * Signal handlers - static to ensure lifetime
  */
 static struct uloop_signal sig_term;
 static struct uloop_signal sig_int;
+static struct uloop_signal sig_hup;
+static struct uloop_signal sig_usr2;
+#ifdef FRAME_PROFILE
+static struct uloop_signal sig_usr1;
+#endif
 
 /*
  * GPIO fd for uloop integration
@@ -34,10 +51,21 @@ static struct uloop_fd gpio_uloop_fd;
 static struct uloop_fd gpio_timer_uloop_fd;
 
 /*
- * UI controller and refresh timer
+ * Offload pool completions
  */
-static ui_controller_t g_ui;
-static struct uloop_timeout g_ui_timer;
+static struct uloop_fd offload_uloop_fd;
+
+/*
+ * Mirror each rendered frame (a frame with nothing new sends nothing)
+ */
+static void mirror_frame(uint64_t render_ns) {
+    (void)render_ns;
+    fb_mirror_frame(display_hal->get_buffer());
+}
+
+LOOP_WATCH_SOURCE(g_watch_gpio, "gpio");
+LOOP_WATCH_SOURCE(g_watch_signal, "signal");
+LOOP_WATCH_SOURCE(g_watch_offload, "offload");
 
 /*
  * Signal callback - called by uloop when signal received.
@@ -50,33 +78,41 @@ static void handle_signal(struct uloop_signal *s) {
 }
 
 /*
- * Button event handler - called when a button press/release is detected
+ * SIGHUP - reload service configuration in place (procd reload).
  */
-static void handle_button_event(const gpio_event_t *event) {
-    if (!event) {
-        return;
-    }
-
-    uint64_t now_ms = event->timestamp_ns / 1000000ULL;
+static void handle_reload(struct uloop_signal *s) {
+    (void)s;
+    loop_watch_begin(&g_watch_signal);
+    app_loop_reload_config();
+    printf("%s reloaded config: %zu services\n", APP_NAME, app_loop_ui()->status.service_count);
+    loop_watch_end(&g_watch_signal);
+}
 
-    uint8_t key = 0;
-    bool long_press = false;
-    switch (event->type) {
-        case GPIO_EVT_BTN_K1_SHORT: key = KEY_K1; break;
-        case GPIO_EVT_BTN_K2_SHORT: key = KEY_K2; break;
-        case GPIO_EVT_BTN_K3_SHORT: key = KEY_K3; break;
-        case GPIO_EVT_BTN_K1_LONG:  key = KEY_K1; long_press = true; break;
-        case GPIO_EVT_BTN_K2_LONG:  key = KEY_K2; long_press = true; break;
-        case GPIO_EVT_BTN_K3_LONG:  key = KEY_K3; long_press = true; break;
-        default: break;
-    }
+/*
+ * SIGUSR2 - print button-to-photon latency, loop lag/stall statistics and
+ * the metrics registry.
+ */
+static void handle_latency_dump(struct uloop_signal *s) {
+    (void)s;
+    input_latency_dump(stdout);
+    loop_watch_dump(stdout);
+    metrics_dump(stdout);
+}
 
-    if (key != 0) {
-        ui_controller_handle_button(&g_ui, key, long_press, now_ms);
-        ui_controller_render(&g_ui, now_ms);
-        schedule_ui_timer();
+#ifdef FRAME_PROFILE
+/*
+ * SIGUSR1 - write the recent frame phases as a trace for Perfetto.
+ */
+static void handle_trace_dump(struct uloop_signal *s) {
+    (void)s;
+    int n = frame_prof_dump(FRAME_PROF_TRACE_PATH);
+    if (n < 0) {
+        fprintf(stderr, "WARN: failed to write %s\n", FRAME_PROF_TRACE_PATH);
+    } else {
+        printf("%s wrote %d frame events to %s\n", APP_NAME, n, FRAME_PROF_TRACE_PATH);
     }
 }
+#endif
 
 /*
  * GPIO fd callback - called by uloop when GPIO fd is readable
@@ -84,35 +120,20 @@ static void handle_button_event(const gpio_event_t *event) {
 static void gpio_fd_cb(struct uloop_fd *u, unsigned int events) {
     (void)u;
     (void)events;
-
-    gpio_event_t event;
-    int ret;
-
-    /* Read all available events */
-    while ((ret = gpio_hal->read_event(&event)) > 0) {
-        handle_button_event(&event);
-    }
-
-    if (ret < 0) {
-        fprintf(stderr, "WARN: gpio read_event error\n");
-    }
-}
-
-static void ui_timer_cb(struct uloop_timeout *t) {
-    (void)t;
-
-    uint64_t now_ms = time_hal_now_ms();
-    ui_controller_tick(&g_ui, now_ms);
-    ui_controller_render(&g_ui, now_ms);
-    schedule_ui_timer();
+    loop_watch_begin(&g_watch_gpio);
+    app_loop_gpio_readable();
+    loop_watch_end(&g_watch_gpio);
 }
 
-static void schedule_ui_timer(void) {
-    int next_ms = ui_controller_next_timeout_ms(&g_ui);
-    if (next_ms > 0) {
-        g_ui_timer.cb = ui_timer_cb;
-        uloop_timeout_set(&g_ui_timer, next_ms);
-    }
+/*
+ * Offload fd callback - deliver finished jobs to their owners
+ */
+static void offload_fd_cb(struct uloop_fd *u, unsigned int events) {
+    (void)u;
+    (void)events;
+    loop_watch_begin(&g_watch_offload);
+    offload_dispatch();
+    loop_watch_end(&g_watch_offload);
 }
 
 /*
@@ -144,7 +165,7 @@ int main(void) {
         return 1;
     }
 
-    ui_controller_init(&g_ui);
+    app_loop_init();
 
     /* 2. Initialize uloop */
     if (uloop_init() != 0) {
@@ -171,6 +192,26 @@ int main(void) {
         fprintf(stderr, "WARN: failed to register SIGINT handler\n");
     }
 
+    sig_hup.cb = handle_reload;
+    sig_hup.signo = SIGHUP;
+    if (uloop_signal_add(&sig_hup) < 0) {
+        fprintf(stderr, "WARN: failed to register SIGHUP handler\n");
+    }
+
+    sig_usr2.cb = handle_latency_dump;
+    sig_usr2.signo = SIGUSR2;
+    if (uloop_signal_add(&sig_usr2) < 0) {
+        fprintf(stderr, "WARN: failed to register SIGUSR2 handler\n");
+    }
+
+#ifdef FRAME_PROFILE
+    sig_usr1.cb = handle_trace_dump;
+    sig_usr1.signo = SIGUSR1;
+    if (uloop_signal_add(&sig_usr1) < 0) {
+        fprintf(stderr, "WARN: failed to register SIGUSR1 handler\n");
+    }
+#endif
+
     /* 5. Register GPIO fd with uloop */
     int gpio_fd = gpio_hal->get_fd();
     if (gpio_fd >= 0) {
@@ -195,11 +236,58 @@ int main(void) {
         }
     }
 
+    /* Worker threads for blocking collectors (getifaddrs), non-fatal */
+    if (offload_init(OFFLOAD_WORKERS) == 0) {
+        offload_uloop_fd.fd = offload_get_fd();
+        offload_uloop_fd.cb = offload_fd_cb;
+        if (uloop_fd_add(&offload_uloop_fd, ULOOP_READ) < 0) {
+            fprintf(stderr, "WARN: failed to add offload fd to uloop\n");
+            offload_cleanup();
+        }
+    } else {
+        fprintf(stderr, "WARN: offload pool not available, collecting inline\n");
+    }
+
+    const char *log_path = getenv(SESSION_LOG_ENV);
+    if (log_path && log_path[0]) {
+        if (session_log_open(log_path) == 0) {
+            printf("%s recording session to %s\n", APP_NAME, log_path);
+        } else {
+            fprintf(stderr, "WARN: cannot open session log %s\n", log_path);
+        }
+    }
+
+    /* Status segment for external readers (nanohat-status), non-fatal */
+    if (status_shm_open(NULL) != 0) {
+        fprintf(stderr, "WARN: cannot create shared memory %s\n", STATUS_SHM_NAME);
+    }
+
+    const char *metrics_listen = getenv(METRICS_LISTEN_ENV);
+    if (metrics_listen && metrics_listen[0]) {
+        if (prom_server_start(metrics_listen, &app_loop_ui()->snapshot) == 0) {
+            printf("%s serving metrics on %s\n", APP_NAME, metrics_listen);
+        } else {
+            fprintf(stderr, "WARN: cannot listen for metrics on %s\n", metrics_listen);
+        }
+    }
+
+    const char *mirror_listen = getenv(MIRROR_LISTEN_ENV);
+    if (mirror_listen && mirror_listen[0] && display_hal && display_hal->get_buffer) {
+        if (fb_mirror_start(mirror_listen) == 0) {
+            app_loop_set_frame_observer(mirror_frame);
+            printf("%s mirroring display on %s\n", APP_NAME, mirror_listen);
+        } else {
+            fprintf(stderr, "WARN: cannot listen for mirror clients on %s\n", mirror_listen);
+        }
+    }
+
+    /* `ubus call nanohat status|services|history` answer from this copy */
+    if (ubus_hal && ubus_hal->set_status_source) {
+        ubus_hal->set_status_source(&app_loop_ui()->status);
+    }
+
     /* Initial render and timer schedule */
-    uint64_t now_ms = time_hal_now_ms();
-    ui_controller_tick(&g_ui, now_ms);
-    ui_controller_render(&g_ui, now_ms);
-    schedule_ui_timer();
+    app_loop_start();
 
     /* 6. Run main event loop */
     printf("%s started\n", APP_NAME);
@@ -207,11 +295,20 @@ int main(void) {
 
     /* 7. Cleanup (ubus before uloop_done to avoid resource leak) */
     printf("%s shutting down...\n", APP_NAME);
+    prom_server_stop();
+    app_loop_set_frame_observer(NULL);
+    fb_mirror_stop();
+    if (ubus_hal && ubus_hal->set_status_source) {
+        ubus_hal->set_status_source(NULL);
+    }
     if (ubus_hal && ubus_hal->cleanup) {
         ubus_hal->cleanup();
     }
     uloop_done();
-    ui_controller_cleanup(&g_ui);
+    app_loop_cleanup();
+    offload_cleanup();  /* After app_loop_cleanup: delivers jobs it cancelled */
+    session_log_close();
+    status_shm_close();
     cleanup_hal();
 
     printf("%s exit\n", APP_NAME);
@@ -0,0 +1,86 @@
+#include "metrics.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+
+static metric_t *g_metrics;
+static int g_count;
+
+/*
+ * Runs from constructors, before main(): a metric that cannot be listed is
+ * a build mistake, so say so (and stop, unless NDEBUG).
+ */
+void metrics_register(metric_t *m) {
+    if (!m || !m->name) return;
+
+    for (const metric_t *it = g_metrics; it; it = it->next) {
+        if (it == m) return;
+        if (strcmp(it->name, m->name) == 0) {
+            fprintf(stderr, "ERROR: metric %s defined twice, second one ignored\n", m->name);
+            assert(!"duplicate metric name");
+            return;
+        }
+    }
+    if (g_count >= METRICS_MAX) {
+        fprintf(stderr, "ERROR: metric %s ignored, more than METRICS_MAX (%d)\n",
+                m->name, METRICS_MAX);
+        assert(!"too many metrics");
+        return;
+    }
+    m->next = g_metrics;
+    g_metrics = m;
+    g_count++;
+}
+
+uint64_t metric_get(const metric_t *m) {
+    if (!m) return 0;
+    if (m->read) return m->read();
+    return __atomic_load_n(&m->value, __ATOMIC_RELAXED);
+}
+
+int metrics_snapshot(metric_sample_t *out, int max) {
+    if (!out || max <= 0) return 0;
+
+    /* Insertion sort by name: a few dozen metrics, reader side only */
+    int n = 0;
+    for (const metric_t *m = g_metrics; m && n < max; m = m->next) {
+        metric_sample_t sample = { .name = m->name, .type = m->type, .value = metric_get(m) };
+        int i = n++;
+        while (i > 0 && strcmp(out[i - 1].name, sample.name) > 0) {
+            out[i] = out[i - 1];
+            i--;
+        }
+        out[i] = sample;
+    }
+    return n;
+}
+
+bool metrics_get(const char *name, uint64_t *value) {
+    if (!name) return false;
+
+    for (const metric_t *m = g_metrics; m; m = m->next) {
+        if (strcmp(m->name, name) == 0) {
+            if (value) *value = metric_get(m);
+            return true;
+        }
+    }
+    return false;
+}
+
+void metrics_reset(void) {
+    for (metric_t *m = g_metrics; m; m = m->next) {
+        metric_set(m, 0);
+    }
+}
+
+void metrics_dump(FILE *fp) {
+    if (!fp) return;
+
+    metric_sample_t samples[METRICS_MAX];
+    int n = metrics_snapshot(samples, METRICS_MAX);
+    for (int i = 0; i < n; i++) {
+        fprintf(fp, "metric %s %" PRIu64 "\n", samples[i].name, samples[i].value);
+    }
+    fflush(fp);
+}
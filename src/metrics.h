@@ -0,0 +1,105 @@
+/*
+ * Runtime metrics registry
+ *
+ * Modules define their counters and gauges at file scope:
+ *
+ *   METRIC_COUNTER(g_m_frames, "ui_frames_rendered");
+ *   ...
+ *   metric_inc(&g_m_frames);
+ *
+ * Each metric registers itself before main() (constructor), so every
+ * metric is listed, at zero, from startup. A metric's value sits alone on
+ * its own cache line and is updated with one relaxed atomic add or store:
+ * no locks, and writers in different modules never share a line.
+ *
+ * Readers (ubus "nanohat stats", SIGUSR2) take metrics_snapshot(), a copy
+ * of all values sorted by name; a writer never waits for a reader.
+ * METRIC_GAUGE_FN() gauges have no stored value: the reader samples the
+ * owning module's state through a callback, called on the reader's thread
+ * (the uloop thread in the daemon).
+ */
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define METRICS_CACHELINE 64
+#define METRICS_MAX       64    /* Snapshot capacity */
+
+typedef enum {
+    METRIC_TYPE_COUNTER = 0,    /* Monotonic */
+    METRIC_TYPE_GAUGE,          /* Current level */
+} metric_type_t;
+
+typedef struct metric {
+    _Alignas(METRICS_CACHELINE) uint64_t value;
+
+    /* Set once at definition */
+    const char *name;
+    metric_type_t type;
+    uint64_t (*read)(void);     /* Sampled gauge, NULL for stored values */
+    struct metric *next;
+} metric_t;
+
+typedef struct {
+    const char *name;
+    metric_type_t type;
+    uint64_t value;
+} metric_sample_t;
+
+#define METRIC_DEFINE(var, metric_name, metric_type, read_fn) \
+    static metric_t var = { .name = (metric_name), .type = (metric_type), .read = (read_fn) }; \
+    static void __attribute__((constructor)) var##_register(void) { metrics_register(&var); }
+
+#define METRIC_COUNTER(var, name)       METRIC_DEFINE(var, name, METRIC_TYPE_COUNTER, NULL)
+#define METRIC_GAUGE(var, name)         METRIC_DEFINE(var, name, METRIC_TYPE_GAUGE, NULL)
+#define METRIC_GAUGE_FN(var, name, fn)  METRIC_DEFINE(var, name, METRIC_TYPE_GAUGE, fn)
+
+static inline void metric_add(metric_t *m, uint64_t n) {
+    __atomic_fetch_add(&m->value, n, __ATOMIC_RELAXED);
+}
+
+static inline void metric_inc(metric_t *m) {
+    metric_add(m, 1);
+}
+
+static inline void metric_set(metric_t *m, uint64_t v) {
+    __atomic_store_n(&m->value, v, __ATOMIC_RELAXED);
+}
+
+/*
+ * Add a metric to the registry (done by METRIC_DEFINE). Names are unique
+ * and at most METRICS_MAX metrics fit a snapshot: a duplicate name or one
+ * metric too many is reported on stderr and ignored, and asserts unless
+ * NDEBUG.
+ */
+void metrics_register(metric_t *m);
+
+/*
+ * Current value of a metric (samples METRIC_GAUGE_FN gauges).
+ */
+uint64_t metric_get(const metric_t *m);
+
+/*
+ * Copy all metrics, sorted by name. Returns the number copied (at most max).
+ */
+int metrics_snapshot(metric_sample_t *out, int max);
+
+/*
+ * Value of a registered metric by name. Returns false if there is none.
+ */
+bool metrics_get(const char *name, uint64_t *value);
+
+/*
+ * Zero all stored values.
+ */
+void metrics_reset(void);
+
+/*
+ * Print "name value" per metric, sorted by name.
+ */
+void metrics_dump(FILE *fp);
+
+#endif
@@ -0,0 +1,152 @@
+/*
+ * nanohat-mirror - show the daemon's display in a terminal (see fb_mirror.h)
+ *
+ *   nanohat-mirror              follow the mirror socket, redraw in place
+ *   nanohat-mirror -1           print the current frame once and exit
+ *   nanohat-mirror -a           ASCII instead of Unicode half blocks
+ *   nanohat-mirror -p path      socket path
+ *
+ * Each text row shows two pixel rows (128 x 32 characters).
+ * Exit status: 0 ok (-1), 1 connection failed or closed, 2 usage error.
+ */
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "fb_mirror.h"
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-p socket_path] [-1] [-a]\n", prog);
+}
+
+static int connect_mirror(const char *path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    return fd;
+}
+
+/* Returns 0, or -1 on EOF or error */
+static int read_full(int fd, uint8_t *buf, size_t len) {
+    size_t got = 0;
+    while (got < len) {
+        ssize_t n = read(fd, buf + got, len - got);
+        if (n == 0) return -1;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        got += (size_t)n;
+    }
+    return 0;
+}
+
+static bool pixel(const uint8_t *fb, int x, int y) {
+    return fb[(y / 8) * FB_MIRROR_WIDTH + x] & (1u << (y % 8));
+}
+
+static void draw(const uint8_t *fb, bool ascii) {
+    static const char *const blocks[4] = { " ", "\xe2\x96\x80", "\xe2\x96\x84", "\xe2\x96\x88" };
+    static const char *const chars[4] = { " ", "'", ".", ":" };
+    const char *const *glyph = ascii ? chars : blocks;
+
+    for (int y = 0; y < FB_MIRROR_HEIGHT; y += 2) {
+        for (int x = 0; x < FB_MIRROR_WIDTH; x++) {
+            fputs(glyph[pixel(fb, x, y) | (pixel(fb, x, y + 1) << 1)], stdout);
+        }
+        fputc('\n', stdout);
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *path = FB_MIRROR_DEFAULT_PATH;
+    bool once = false;
+    bool ascii = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:1ah")) != -1) {
+        switch (opt) {
+            case 'p': path = optarg; break;
+            case '1': once = true; break;
+            case 'a': ascii = true; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+
+    int fd = connect_mirror(path);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s: %s\n", argv[0], path,
+                errno == ENOENT ? "not found (mirror not enabled?)" : strerror(errno));
+        return 1;
+    }
+
+    static uint8_t fb[FB_MIRROR_FB_SIZE];
+    static uint8_t msg[FB_MIRROR_MSG_MAX];
+    uint32_t seq = 0;
+    bool synced = false;
+    uint64_t frames = 0, bytes = 0;
+
+    if (!once) {
+        fputs("\033[2J", stdout);
+    }
+
+    for (;;) {
+        if (read_full(fd, msg, FB_MIRROR_HEADER_SIZE) != 0) break;
+        int len = fb_mirror_msg_len(msg);
+        if (len < 0 || read_full(fd, msg + FB_MIRROR_HEADER_SIZE,
+                                 (size_t)len - FB_MIRROR_HEADER_SIZE) != 0) {
+            fprintf(stderr, "%s: bad message\n", argv[0]);
+            break;
+        }
+        bytes += (uint64_t)len;
+
+        /* A delta applies only on top of the frame right before it */
+        uint32_t msg_seq = (uint32_t)msg[4] | ((uint32_t)msg[5] << 8) |
+                           ((uint32_t)msg[6] << 16) | ((uint32_t)msg[7] << 24);
+        if (msg[1] == FB_MIRROR_DELTA && (!synced || msg_seq != seq + 1)) {
+            if (synced) {
+                const char req = FB_MIRROR_REQ_KEYFRAME;
+                if (write(fd, &req, 1) != 1) break;
+            }
+            synced = false;
+            continue;
+        }
+        if (fb_mirror_decode(msg, (size_t)len, fb, &seq) < 0) {
+            fprintf(stderr, "%s: bad message\n", argv[0]);
+            break;
+        }
+        synced = true;
+        frames++;
+
+        if (once) {
+            draw(fb, ascii);
+            close(fd);
+            return 0;
+        }
+        fputs("\033[H", stdout);
+        draw(fb, ascii);
+        printf("seq %" PRIu32 "  frames %" PRIu64 "  bytes %" PRIu64 "\033[K\n", seq, frames, bytes);
+        fflush(stdout);
+    }
+
+    close(fd);
+    fprintf(stderr, "%s: connection closed\n", argv[0]);
+    return 1;
+}
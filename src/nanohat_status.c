@@ -0,0 +1,155 @@
+/*
+ * nanohat-status - print the daemon's status segment (see status_shm.h)
+ *
+ *   nanohat-status              all fields, "name value" per line
+ *   nanohat-status -f cpu_usage one value, for scripts
+ *   nanohat-status -s           services only
+ *
+ * Exit status: 0 ok, 1 segment missing or unreadable, 2 usage error.
+ */
+#include <errno.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "status_shm.h"
+
+typedef enum {
+    FIELD_U32,
+    FIELD_U64,
+    FIELD_FLOAT,
+    FIELD_STR,
+} field_type_t;
+
+static const struct {
+    const char *name;
+    field_type_t type;
+    size_t offset;
+} g_fields[] = {
+    { "hostname",         FIELD_STR,   offsetof(status_shm_t, hostname) },
+    { "ip",               FIELD_STR,   offsetof(status_shm_t, ip_addr) },
+    { "gateway",          FIELD_STR,   offsetof(status_shm_t, gateway) },
+    { "cpu_usage",        FIELD_FLOAT, offsetof(status_shm_t, cpu_usage) },
+    { "cpu_temp",         FIELD_FLOAT, offsetof(status_shm_t, cpu_temp) },
+    { "mem_total_kb",     FIELD_U64,   offsetof(status_shm_t, mem_total_kb) },
+    { "mem_available_kb", FIELD_U64,   offsetof(status_shm_t, mem_available_kb) },
+    { "uptime_sec",       FIELD_U32,   offsetof(status_shm_t, uptime_sec) },
+    { "rx_bytes",         FIELD_U64,   offsetof(status_shm_t, rx_bytes) },
+    { "tx_bytes",         FIELD_U64,   offsetof(status_shm_t, tx_bytes) },
+    { "rx_speed",         FIELD_U64,   offsetof(status_shm_t, rx_speed) },
+    { "tx_speed",         FIELD_U64,   offsetof(status_shm_t, tx_speed) },
+    { "service_total",    FIELD_U32,   offsetof(status_shm_t, service_total) },
+    { "writer_pid",       FIELD_U32,   offsetof(status_shm_t, writer_pid) },
+};
+
+#define FIELD_COUNT (sizeof(g_fields) / sizeof(g_fields[0]))
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-n shm_name] [-f field] [-s]\n", prog);
+    fprintf(stderr, "Fields: age_ms");
+    for (size_t i = 0; i < FIELD_COUNT; i++) {
+        fprintf(stderr, " %s", g_fields[i].name);
+    }
+    fprintf(stderr, "\n");
+}
+
+static uint64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+static void print_value(const status_shm_t *st, size_t i) {
+    const char *p = (const char *)st + g_fields[i].offset;
+    uint32_t u32;
+    uint64_t u64;
+    float f;
+
+    switch (g_fields[i].type) {
+        case FIELD_U32:   memcpy(&u32, p, sizeof(u32)); printf("%" PRIu32, u32); break;
+        case FIELD_U64:   memcpy(&u64, p, sizeof(u64)); printf("%" PRIu64, u64); break;
+        case FIELD_FLOAT: memcpy(&f, p, sizeof(f)); printf("%.1f", f); break;
+        case FIELD_STR:   printf("%s", p); break;
+    }
+}
+
+static void print_services(const status_shm_t *st) {
+    for (uint32_t i = 0; i < st->service_count; i++) {
+        const status_shm_service_t *svc = &st->services[i];
+        printf("service %s installed=%d running=%d valid=%d", svc->name,
+               !!(svc->flags & STATUS_SHM_SVC_INSTALLED),
+               !!(svc->flags & STATUS_SHM_SVC_RUNNING),
+               !!(svc->flags & STATUS_SHM_SVC_VALID));
+        if (svc->flags & STATUS_SHM_SVC_USAGE) {
+            printf(" cpu=%.1f mem=%" PRIu64, svc->cpu_percent, svc->mem_bytes);
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *name = NULL;
+    const char *field = NULL;
+    int services_only = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:f:sh")) != -1) {
+        switch (opt) {
+            case 'n': name = optarg; break;
+            case 'f': field = optarg; break;
+            case 's': services_only = 1; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+
+    status_shm_reader_t reader;
+    int ret = status_shm_reader_open(&reader, name);
+    if (ret < 0) {
+        fprintf(stderr, "%s: %s: %s\n", argv[0], name ? name : STATUS_SHM_NAME,
+                ret == -ENOENT ? "not found (daemon not running?)" : strerror(-ret));
+        return 1;
+    }
+
+    static status_shm_t st;
+    ret = status_shm_read(&reader, &st);
+    status_shm_reader_close(&reader);
+    if (ret < 0) {
+        fprintf(stderr, "%s: read failed: %s\n", argv[0],
+                ret == -ENODATA ? "nothing published yet" : strerror(-ret));
+        return 1;
+    }
+
+    uint64_t now_ms = monotonic_ms();
+    uint64_t age_ms = now_ms > st.update_ms ? now_ms - st.update_ms : 0;
+
+    if (field) {
+        if (strcmp(field, "age_ms") == 0) {
+            printf("%" PRIu64 "\n", age_ms);
+            return 0;
+        }
+        for (size_t i = 0; i < FIELD_COUNT; i++) {
+            if (strcmp(field, g_fields[i].name) == 0) {
+                print_value(&st, i);
+                printf("\n");
+                return 0;
+            }
+        }
+        fprintf(stderr, "%s: unknown field '%s'\n", argv[0], field);
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (!services_only) {
+        printf("age_ms %" PRIu64 "\n", age_ms);
+        for (size_t i = 0; i < FIELD_COUNT; i++) {
+            printf("%s ", g_fields[i].name);
+            print_value(&st, i);
+            printf("\n");
+        }
+    }
+    print_services(&st);
+    return 0;
+}
@@ -0,0 +1,234 @@
+#include "offload.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "hal/time_hal.h"
+#include "metrics.h"
+
+struct offload_job {
+    offload_work_fn work;
+    offload_done_fn done;
+    void *arg;
+    uint64_t deadline_ms;       /* time_hal ms, 0 = none */
+    atomic_bool cancelled;
+    int status;                 /* Set by the worker when finished */
+    struct offload_job *next;
+};
+
+typedef struct {
+    offload_job_t *head;
+    offload_job_t *tail;
+} job_list_t;
+
+static struct {
+    bool running;
+    int efd;
+    pthread_t threads[OFFLOAD_MAX_WORKERS];
+    int thread_count;
+
+    /* Shared with the workers, under lock */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    job_list_t queued;
+    job_list_t finished;
+    bool stopping;
+
+    /* uloop thread only */
+    uint32_t pending;           /* Accepted, done() not yet called */
+} g_pool = { .efd = -1 };
+
+static uint64_t read_pending(void) {
+    return g_pool.pending;
+}
+
+METRIC_COUNTER(g_m_jobs, "offload_jobs");
+METRIC_COUNTER(g_m_cancelled, "offload_jobs_cancelled");
+METRIC_COUNTER(g_m_late, "offload_jobs_late");
+METRIC_GAUGE_FN(g_m_pending, "offload_pending", read_pending);
+
+static void list_append(job_list_t *list, offload_job_t *job) {
+    job->next = NULL;
+    if (list->tail) {
+        list->tail->next = job;
+    } else {
+        list->head = job;
+    }
+    list->tail = job;
+}
+
+static bool job_late(const offload_job_t *job) {
+    return job->deadline_ms != 0 && time_hal_now_ms() >= job->deadline_ms;
+}
+
+bool offload_job_stopped(const offload_job_t *job) {
+    if (!job) return true;
+    return atomic_load_explicit(&job->cancelled, memory_order_relaxed) || job_late(job);
+}
+
+static void *worker_main(void *unused) {
+    (void)unused;
+
+    for (;;) {
+        pthread_mutex_lock(&g_pool.lock);
+        while (!g_pool.queued.head && !g_pool.stopping) {
+            pthread_cond_wait(&g_pool.cond, &g_pool.lock);
+        }
+        offload_job_t *job = g_pool.queued.head;
+        if (!job) {
+            /* Stopping and drained */
+            pthread_mutex_unlock(&g_pool.lock);
+            break;
+        }
+        g_pool.queued.head = job->next;
+        if (!g_pool.queued.head) g_pool.queued.tail = NULL;
+        pthread_mutex_unlock(&g_pool.lock);
+
+        if (!offload_job_stopped(job)) {
+            job->work(job, job->arg);
+        }
+        if (atomic_load_explicit(&job->cancelled, memory_order_relaxed)) {
+            job->status = -ECANCELED;
+        } else if (job_late(job)) {
+            job->status = -ETIMEDOUT;
+        } else {
+            job->status = 0;
+        }
+
+        pthread_mutex_lock(&g_pool.lock);
+        list_append(&g_pool.finished, job);
+        pthread_mutex_unlock(&g_pool.lock);
+
+        uint64_t one = 1;
+        (void)write(g_pool.efd, &one, sizeof(one));
+    }
+    return NULL;
+}
+
+int offload_init(int workers) {
+    if (g_pool.running) return 0;
+    if (workers <= 0) workers = OFFLOAD_WORKERS;
+    if (workers > OFFLOAD_MAX_WORKERS) workers = OFFLOAD_MAX_WORKERS;
+
+    g_pool.efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (g_pool.efd < 0) {
+        return -1;
+    }
+
+    pthread_mutex_init(&g_pool.lock, NULL);
+    pthread_cond_init(&g_pool.cond, NULL);
+    g_pool.queued = (job_list_t){ 0 };
+    g_pool.finished = (job_list_t){ 0 };
+    g_pool.stopping = false;
+    g_pool.pending = 0;
+    g_pool.thread_count = 0;
+    g_pool.running = true;
+
+    for (int i = 0; i < workers; i++) {
+        if (pthread_create(&g_pool.threads[i], NULL, worker_main, NULL) != 0) {
+            fprintf(stderr, "WARN: offload: started %d of %d workers\n", i, workers);
+            break;
+        }
+        g_pool.thread_count++;
+    }
+
+    if (g_pool.thread_count == 0) {
+        offload_cleanup();
+        return -1;
+    }
+    return 0;
+}
+
+void offload_cleanup(void) {
+    if (!g_pool.running) return;
+
+    pthread_mutex_lock(&g_pool.lock);
+    g_pool.stopping = true;
+    for (offload_job_t *job = g_pool.queued.head; job; job = job->next) {
+        atomic_store_explicit(&job->cancelled, true, memory_order_relaxed);
+    }
+    pthread_cond_broadcast(&g_pool.cond);
+    pthread_mutex_unlock(&g_pool.lock);
+
+    for (int i = 0; i < g_pool.thread_count; i++) {
+        pthread_join(g_pool.threads[i], NULL);
+    }
+    g_pool.thread_count = 0;
+
+    /* Workers are gone: hand every outstanding job back */
+    offload_dispatch();
+    g_pool.running = false;
+
+    close(g_pool.efd);
+    g_pool.efd = -1;
+    pthread_cond_destroy(&g_pool.cond);
+    pthread_mutex_destroy(&g_pool.lock);
+}
+
+bool offload_running(void) {
+    return g_pool.running && !g_pool.stopping;
+}
+
+int offload_get_fd(void) {
+    return g_pool.running ? g_pool.efd : -1;
+}
+
+void offload_dispatch(void) {
+    if (!g_pool.running) return;
+
+    /* Drain first: a job finishing after the swap re-arms the fd */
+    uint64_t count;
+    (void)read(g_pool.efd, &count, sizeof(count));
+
+    pthread_mutex_lock(&g_pool.lock);
+    offload_job_t *job = g_pool.finished.head;
+    g_pool.finished = (job_list_t){ 0 };
+    pthread_mutex_unlock(&g_pool.lock);
+
+    while (job) {
+        offload_job_t *next = job->next;
+        g_pool.pending--;
+        if (job->status == -ECANCELED) {
+            metric_inc(&g_m_cancelled);
+        } else if (job->status == -ETIMEDOUT) {
+            metric_inc(&g_m_late);
+        }
+        job->done(job->status, job->arg);
+        free(job);
+        job = next;
+    }
+}
+
+offload_job_t *offload_submit(offload_work_fn work, offload_done_fn done, void *arg,
+                              uint32_t timeout_ms) {
+    if (!work || !done || !offload_running()) return NULL;
+    if (g_pool.pending >= OFFLOAD_QUEUE_MAX) return NULL;
+
+    offload_job_t *job = calloc(1, sizeof(*job));
+    if (!job) return NULL;
+
+    job->work = work;
+    job->done = done;
+    job->arg = arg;
+    job->deadline_ms = timeout_ms ? time_hal_now_ms() + timeout_ms : 0;
+    atomic_init(&job->cancelled, false);
+
+    pthread_mutex_lock(&g_pool.lock);
+    list_append(&g_pool.queued, job);
+    pthread_cond_signal(&g_pool.cond);
+    pthread_mutex_unlock(&g_pool.lock);
+
+    g_pool.pending++;
+    metric_inc(&g_m_jobs);
+    return job;
+}
+
+void offload_cancel(offload_job_t *job) {
+    if (!job) return;
+    atomic_store_explicit(&job->cancelled, true, memory_order_relaxed);
+}
@@ -0,0 +1,98 @@
+/*
+ * Blocking-work offload pool
+ *
+ * getifaddrs(), /proc and cgroup scans can block the uloop thread for
+ * tens of milliseconds on a busy router. The pool runs such jobs on a
+ * few worker threads and hands the result back to the loop:
+ *
+ *   uloop thread                      worker thread
+ *   offload_submit(work, done, arg)
+ *                                     work(job, arg)
+ *   offload_dispatch()   <- eventfd
+ *     done(status, arg)
+ *
+ * done() always runs on the uloop thread, exactly once per accepted job,
+ * so the caller's state is only touched by one thread at a time: arg
+ * belongs to work() from submit until done() is called and to the caller
+ * again afterwards. No locks outside this module.
+ *
+ * Cancellation and deadlines are cooperative: a queued job that is
+ * cancelled or past its deadline is not run; a running job can poll
+ * offload_job_stopped(). done() reports the outcome in status:
+ *
+ *   0           work() ran and finished within the deadline
+ *   -ECANCELED  offload_cancel() before work() finished
+ *   -ETIMEDOUT  the deadline passed before work() finished
+ *
+ * work() may run even when done() gets an error (it finished late); the
+ * caller must then discard what it produced.
+ *
+ * The loop side (submit, cancel, dispatch, cleanup) is uloop thread only.
+ */
+#ifndef OFFLOAD_H
+#define OFFLOAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define OFFLOAD_WORKERS   2     /* Default pool size */
+#define OFFLOAD_MAX_WORKERS 8
+#define OFFLOAD_QUEUE_MAX 32    /* Jobs queued or running */
+
+typedef struct offload_job offload_job_t;
+
+/* Runs on a worker thread */
+typedef void (*offload_work_fn)(offload_job_t *job, void *arg);
+
+/* Runs on the uloop thread */
+typedef void (*offload_done_fn)(int status, void *arg);
+
+/*
+ * Start the pool (workers <= 0 selects OFFLOAD_WORKERS). The completion
+ * fd from offload_get_fd() must then be watched for reading.
+ * Returns 0 on success, -1 on error.
+ */
+int offload_init(int workers);
+
+/*
+ * Stop the workers after their current job. Queued jobs complete with
+ * -ECANCELED; done() of every outstanding job is called before return.
+ */
+void offload_cleanup(void);
+
+/*
+ * True between offload_init() and offload_cleanup().
+ */
+bool offload_running(void);
+
+/*
+ * Completion eventfd, -1 when the pool is not running.
+ */
+int offload_get_fd(void);
+
+/*
+ * Call done() for every finished job (completion fd readable).
+ */
+void offload_dispatch(void);
+
+/*
+ * Queue work(job, arg) with a deadline timeout_ms from now (0 = none).
+ * Returns the job, valid until its done() is called, or NULL if the pool
+ * is not running or full; the caller then does the work inline.
+ */
+offload_job_t *offload_submit(offload_work_fn work, offload_done_fn done, void *arg,
+                              uint32_t timeout_ms);
+
+/*
+ * Request cancellation. done() still follows, with -ECANCELED unless the
+ * job had already finished.
+ */
+void offload_cancel(offload_job_t *job);
+
+/*
+ * For long work(): true once the job is cancelled or past its deadline.
+ * Worker thread only.
+ */
+bool offload_job_stopped(const offload_job_t *job);
+
+#endif
@@ -27,6 +27,7 @@ typedef enum {
 typedef struct page {
     const char *name;           /* Page identifier */
     bool can_enter;             /* Supports enter mode via K2 long press */
+    bool double_click_home;     /* View mode K2 double-click: first page (delays K2) */
 
     /* Lifecycle */
     void (*init)(void);
@@ -47,6 +48,30 @@ typedef struct page {
     /* Optional: Selection info for enter mode indicator (e.g., "2/5") */
     int (*get_selected_index)(void);  /* Returns 0-based index, or -1 if N/A */
     int (*get_item_count)(void);      /* Returns total items, or 0 if N/A */
+
+    /* Optional: true while a page-internal animation runs (e.g. list scroll) */
+    bool (*is_animating)(void);
+
+    /*
+     * Optional: KEY_BIT mask of keys without a long-press action in enter
+     * mode, which may then fire on the press edge. Absent = none.
+     */
+    uint8_t (*press_dispatch_keys)(void);
+
+    /*
+     * Optional: KEY_BIT mask of keys that auto-repeat while held in enter
+     * mode (each repeat is delivered as a short press). Implies press
+     * dispatch, so only for keys without a long-press action.
+     */
+    uint8_t (*repeat_keys)(void);
+
+    /*
+     * Optional: KEY_BIT mask of gesture keys (KEY_K1_K2, ...) recognized
+     * in enter mode; they arrive in on_key() as short presses. Each one
+     * delays plain presses of the keys it involves by its window, so
+     * register only what the page handles.
+     */
+    uint8_t (*gesture_keys)(void);
 } page_t;
 
 /* Button key codes */
@@ -54,6 +79,13 @@ typedef struct page {
 #define KEY_K2 2
 #define KEY_K3 3
 
+/* Gesture key codes (see gesture_keys) */
+#define KEY_K1_K2     4     /* K1 + K2 pressed together */
+#define KEY_K1_K3     5     /* K1 + K3 pressed together */
+#define KEY_K2_DOUBLE 6     /* K2 double-click */
+
+#define KEY_BIT(key) ((uint8_t)(1u << (key)))
+
 /* Screen dimensions */
 #define SCREEN_WIDTH  128
 #define SCREEN_HEIGHT 64
@@ -6,6 +6,7 @@
 
 #include "u8g2_api.h"
 #include "fonts.h"
+#include "frame_prof.h"
 /* Default idle timeout: 30 seconds (0 = disabled) */
 #define DEFAULT_IDLE_TIMEOUT_MS 30000
 
@@ -62,13 +63,16 @@ static void start_animation(page_controller_t *pc, anim_type_t type, uint64_t no
     pc->anim.start_ms = now_ms;
 }
 
-static void switch_page(page_controller_t *pc, int direction, uint64_t now_ms) {
-    if (pc->page_count <= 1) return;
-    if (pc->anim.type != ANIM_NONE) return;
+static int wrap_page(const page_controller_t *pc, int page) {
+    if (page < 0) return pc->page_count - 1;
+    if (page >= pc->page_count) return 0;
+    return page;
+}
 
-    int new_page = pc->current_page + direction;
-    if (new_page < 0) new_page = pc->page_count - 1;
-    if (new_page >= pc->page_count) new_page = 0;
+/* Slide to any page; direction > 0 slides left (like K3) */
+static void slide_to_page(page_controller_t *pc, int new_page, int direction, uint64_t now_ms) {
+    if (pc->page_count <= 1 || new_page == pc->current_page) return;
+    if (pc->anim.type != ANIM_NONE) return;
 
     pc->anim.from_page = pc->current_page;
     pc->anim.to_page = new_page;
@@ -81,6 +85,10 @@ static void switch_page(page_controller_t *pc, int direction, uint64_t now_ms) {
     }
 }
 
+static void switch_page(page_controller_t *pc, int direction, uint64_t now_ms) {
+    slide_to_page(pc, wrap_page(pc, pc->current_page + direction), direction, now_ms);
+}
+
 static const page_t *get_current_page(const page_controller_t *pc) {
     if (!pc || pc->current_page < 0 || pc->current_page >= pc->page_count) {
         return NULL;
@@ -121,24 +129,54 @@ static bool try_enter_mode(page_controller_t *pc, uint64_t now_ms) {
     return true;
 }
 
-bool page_controller_handle_key(page_controller_t *pc, uint8_t key, bool long_press, uint64_t now_ms) {
-    if (!pc) return false;
-
-    /* Update activity time */
-    pc->last_activity_ms = now_ms;
+static bool is_slide(const page_controller_t *pc) {
+    return pc->anim.type == ANIM_SLIDE_LEFT || pc->anim.type == ANIM_SLIDE_RIGHT;
+}
 
-    /* Screen off - any key wakes screen */
-    if (pc->screen_state == SCREEN_OFF) {
-        pc->screen_state = SCREEN_ON;
-        return true;
+static void finish_animation(page_controller_t *pc) {
+    /* Update current_page when slide animation completes */
+    if (is_slide(pc)) {
+        pc->current_page = pc->anim.to_page;
     }
+    pc->anim.type = ANIM_NONE;
+}
 
-    /* Don't process keys during animation */
-    if (pc->anim.type != ANIM_NONE && !anim_is_complete(&pc->anim, now_ms)) {
-        return false;
+/*
+ * Extend the running slide for another key in the same direction.
+ * Early in the slide the target moves one page further (the queued presses
+ * collapse into one multi-page jump); later the slide is fast-forwarded and
+ * the next one starts from its target.
+ */
+static bool chain_slide(page_controller_t *pc, int direction, uint64_t now_ms) {
+    if (!is_slide(pc) || pc->page_count <= 1) return false;
+
+    anim_type_t type = direction > 0 ? ANIM_SLIDE_LEFT : ANIM_SLIDE_RIGHT;
+    if (pc->anim.type != type) return false;
+
+    int next = wrap_page(pc, pc->anim.to_page + direction);
+    float progress = anim_progress(pc->anim.start_ms, now_ms, ANIM_SLIDE_DURATION_MS);
+
+    if (progress * 100.0f < PAGE_SLIDE_COLLAPSE_PCT && next != pc->anim.from_page) {
+        pc->anim.to_page = next;
+    } else {
+        pc->current_page = pc->anim.to_page;
+        pc->anim.from_page = pc->anim.to_page;
+        pc->anim.to_page = next;
+        start_animation(pc, type, now_ms);
     }
-    pc->anim.type = ANIM_NONE;
+    return true;
+}
+
+static void queue_key(page_controller_t *pc, uint8_t key, bool long_press) {
+    if (pc->key_queue_len >= PAGE_KEY_QUEUE_LEN) return;  /* Drop newest */
 
+    pc->key_queue[pc->key_queue_len].key = key;
+    pc->key_queue[pc->key_queue_len].long_press = long_press;
+    pc->key_queue_len++;
+}
+
+/* Key handling once no animation is running */
+static bool process_key(page_controller_t *pc, uint8_t key, bool long_press, uint64_t now_ms) {
     const page_t *page = get_current_page(pc);
 
     /* Handle enter mode */
@@ -181,6 +219,14 @@ bool page_controller_handle_key(page_controller_t *pc, uint8_t key, bool long_pr
                 /* K2 short press: screen off on any page */
                 pc->screen_state = SCREEN_OFF;
                 return true;
+
+            case KEY_K2_DOUBLE:
+                /* Back to the first page */
+                if (page && page->double_click_home && pc->current_page != 0) {
+                    slide_to_page(pc, 0, -1, now_ms);
+                    return true;
+                }
+                break;
         }
 
         /* Let page handle remaining keys */
@@ -192,6 +238,64 @@ bool page_controller_handle_key(page_controller_t *pc, uint8_t key, bool long_pr
     return false;
 }
 
+/* Replay queued keys until one of them starts a new animation */
+static bool replay_keys(page_controller_t *pc, uint64_t now_ms) {
+    bool changed = false;
+    int i = 0;
+
+    while (i < pc->key_queue_len && pc->anim.type == ANIM_NONE &&
+           pc->screen_state == SCREEN_ON) {
+        page_key_t k = pc->key_queue[i++];
+        if (process_key(pc, k.key, k.long_press, now_ms)) {
+            changed = true;
+        }
+    }
+
+    if (pc->screen_state != SCREEN_ON) {
+        i = pc->key_queue_len;  /* Screen went off: drop the rest */
+    }
+    pc->key_queue_len -= i;
+    memmove(pc->key_queue, pc->key_queue + i, (size_t)pc->key_queue_len * sizeof(pc->key_queue[0]));
+    return changed;
+}
+
+bool page_controller_handle_key(page_controller_t *pc, uint8_t key, bool long_press, uint64_t now_ms) {
+    if (!pc) return false;
+
+    /* Update activity time */
+    pc->last_activity_ms = now_ms;
+
+    /* Screen off - any key wakes screen */
+    if (pc->screen_state == SCREEN_OFF) {
+        pc->screen_state = SCREEN_ON;
+        pc->key_queue_len = 0;
+        return true;
+    }
+
+    /* Complete an animation whose tick has not run yet */
+    bool changed = false;
+    if (pc->anim.type != ANIM_NONE && anim_is_complete(&pc->anim, now_ms)) {
+        finish_animation(pc);
+        changed = replay_keys(pc, now_ms);
+    }
+
+    /* Animation running: extend a slide, or buffer the key */
+    if (pc->anim.type != ANIM_NONE) {
+        if (!long_press && pc->page_mode == PAGE_MODE_VIEW && pc->key_queue_len == 0 &&
+            (key == KEY_K1 || key == KEY_K3) &&
+            chain_slide(pc, key == KEY_K3 ? 1 : -1, now_ms)) {
+            return true;
+        }
+        queue_key(pc, key, long_press);
+        return changed;
+    }
+
+    if (process_key(pc, key, long_press, now_ms)) {
+        changed = true;
+    }
+    return changed;
+}
+
 bool page_controller_tick(page_controller_t *pc, uint64_t now_ms) {
     if (!pc) return false;
 
@@ -222,18 +326,20 @@ bool page_controller_tick(page_controller_t *pc, uint64_t now_ms) {
         }
     }
 
-    /* Check animation completion */
+    /* Check animation completion, then run keys buffered during it */
     if (pc->anim.type != ANIM_NONE) {
         if (anim_is_complete(&pc->anim, now_ms)) {
-            /* Update current_page when slide animation completes */
-            if (pc->anim.type == ANIM_SLIDE_LEFT || pc->anim.type == ANIM_SLIDE_RIGHT) {
-                pc->current_page = pc->anim.to_page;
-            }
-            pc->anim.type = ANIM_NONE;
+            finish_animation(pc);
+            replay_keys(pc, now_ms);
         }
         needs_render = true;
     }
 
+    /* Keep rendering while the page animates internally */
+    if (page_controller_is_page_animating(pc)) {
+        needs_render = true;
+    }
+
     return needs_render;
 }
 
@@ -242,6 +348,7 @@ static void render_title_bar(page_controller_t *pc, u8g2_t *u8g2,
     if (page_idx < 0 || page_idx >= pc->page_count) return;
     const page_t *page = pc->pages[page_idx];
     if (!page) return;
+    FRAME_PROF_BEGIN(title_ns);
 
     /* Get title */
     const char *title = page->name;
@@ -339,6 +446,7 @@ static void render_title_bar(page_controller_t *pc, u8g2_t *u8g2,
         /* No timeout active, draw full line */
         ui_draw_hline(u8g2, x_offset, TITLE_LINE_Y, SCREEN_WIDTH);
     }
+    FRAME_PROF_END(title_ns, FRAME_PHASE_TITLE, page->name);
 }
 
 static void render_page_content(page_controller_t *pc, u8g2_t *u8g2,
@@ -353,7 +461,9 @@ static void render_page_content(page_controller_t *pc, u8g2_t *u8g2,
     u8g2_SetClipWindow(u8g2, 0, CONTENT_Y_START,
                        SCREEN_WIDTH, SCREEN_HEIGHT);
 
+    FRAME_PROF_BEGIN(page_ns);
     page->render(u8g2, status, pc->page_mode, now_ms, x_offset);
+    FRAME_PROF_END(page_ns, FRAME_PHASE_PAGE, page->name);
 
     u8g2_SetMaxClipWindow(u8g2);
 }
@@ -391,6 +501,88 @@ bool page_controller_is_animating(const page_controller_t *pc) {
     return pc && pc->anim.type != ANIM_NONE;
 }
 
+uint8_t page_controller_press_dispatch_keys(const page_controller_t *pc) {
+    if (!pc) return 0;
+
+    if (pc->screen_state == SCREEN_OFF) {
+        return KEY_BIT(KEY_K1) | KEY_BIT(KEY_K2) | KEY_BIT(KEY_K3);
+    }
+
+    if (pc->page_mode == PAGE_MODE_VIEW) {
+        return KEY_BIT(KEY_K1) | KEY_BIT(KEY_K3);
+    }
+
+    const page_t *page = get_current_page(pc);
+    if (page && page->press_dispatch_keys) {
+        return page->press_dispatch_keys() & (uint8_t)~KEY_BIT(KEY_K2);
+    }
+    return 0;
+}
+
+uint8_t page_controller_repeat_keys(const page_controller_t *pc) {
+    if (!pc || pc->screen_state != SCREEN_ON || pc->page_mode != PAGE_MODE_ENTER) {
+        return 0;
+    }
+
+    const page_t *page = get_current_page(pc);
+    if (page && page->repeat_keys) {
+        return page->repeat_keys() & (uint8_t)~KEY_BIT(KEY_K2);
+    }
+    return 0;
+}
+
+uint8_t page_controller_gesture_keys(const page_controller_t *pc) {
+    if (!pc || pc->screen_state != SCREEN_ON) return 0;
+
+    const page_t *page = get_current_page(pc);
+    if (pc->page_mode == PAGE_MODE_VIEW) {
+        /* Waiting for a second click delays every K2: only where it is bound */
+        if (page && page->double_click_home && pc->current_page != 0) {
+            return KEY_BIT(KEY_K2_DOUBLE);
+        }
+        return 0;
+    }
+
+    if (page && page->gesture_keys) {
+        return page->gesture_keys();
+    }
+    return 0;
+}
+
+int page_controller_page_distance(const page_controller_t *pc, const page_t *page) {
+    if (!pc || !page || pc->page_count <= 0) return -1;
+
+    int index = -1;
+    for (int i = 0; i < pc->page_count; i++) {
+        if (pc->pages[i] == page) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) return -1;
+
+    int target = pc->current_page;
+    if (pc->anim.type == ANIM_SLIDE_LEFT || pc->anim.type == ANIM_SLIDE_RIGHT) {
+        target = pc->anim.to_page;
+    }
+
+    int distance = index - target;
+    if (distance < 0) distance = -distance;
+    if (pc->page_count - distance < distance) {
+        distance = pc->page_count - distance;
+    }
+    return distance;
+}
+
+bool page_controller_is_page_animating(const page_controller_t *pc) {
+    if (!pc || pc->screen_state != SCREEN_ON || pc->anim.type != ANIM_NONE) {
+        return false;
+    }
+
+    const page_t *page = pc->pages[pc->current_page];
+    return page && page->is_animating && page->is_animating();
+}
+
 void page_controller_set_idle_timeout(page_controller_t *pc, uint32_t timeout_ms) {
     if (pc) {
         pc->idle_timeout_ms = timeout_ms;
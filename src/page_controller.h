@@ -19,6 +19,21 @@ typedef enum {
     SCREEN_ON,
 } screen_state_t;
 
+/* Keys buffered while an animation runs */
+#define PAGE_KEY_QUEUE_LEN 8
+
+/*
+ * Same-direction key during a slide: below this progress (%) the slide is
+ * retargeted one page further (multi-page jump), above it the slide is
+ * fast-forwarded and the next one chained.
+ */
+#define PAGE_SLIDE_COLLAPSE_PCT 50
+
+typedef struct {
+    uint8_t key;
+    bool long_press;
+} page_key_t;
+
 /* Forward declaration */
 struct u8g2_struct;
 typedef struct u8g2_struct u8g2_t;
@@ -37,6 +52,10 @@ typedef struct {
     /* Animation state */
     anim_state_t anim;
 
+    /* Keys received during an animation, replayed in order when it ends */
+    page_key_t key_queue[PAGE_KEY_QUEUE_LEN];
+    int key_queue_len;
+
     /* Enter mode tracking */
     uint64_t enter_mode_start_ms;
 
@@ -64,6 +83,10 @@ void page_controller_destroy(page_controller_t *pc);
  * long_press: true for long press
  * now_ms: current time in milliseconds
  * Returns: true if screen state or page changed
+ *
+ * Keys arriving during an animation are not dropped: K1/K3 in the running
+ * slide's direction extend it (see PAGE_SLIDE_COLLAPSE_PCT), anything else
+ * is queued and replayed when the animation completes.
  */
 bool page_controller_handle_key(page_controller_t *pc, uint8_t key, bool long_press, uint64_t now_ms);
 
@@ -93,6 +116,42 @@ bool page_controller_is_screen_on(const page_controller_t *pc);
  */
 bool page_controller_is_animating(const page_controller_t *pc);
 
+/*
+ * Check if the current page runs its own animation (e.g. list scroll).
+ */
+bool page_controller_is_page_animating(const page_controller_t *pc);
+
+/*
+ * Number of page switches (wrapping) between the page being shown - or
+ * the slide target while a slide runs - and the given page.
+ * Returns 0 when the page is (about to be) visible, -1 if not registered.
+ */
+int page_controller_page_distance(const page_controller_t *pc, const page_t *page);
+
+/*
+ * Keys (KEY_BIT mask) that have no long-press action in the current state
+ * and may therefore be dispatched on the press edge instead of release:
+ * - screen off: all keys (any key only wakes the screen)
+ * - view mode: K1/K3 (page switch)
+ * - enter mode: page press_dispatch_keys(), never K2 (long press exits)
+ */
+uint8_t page_controller_press_dispatch_keys(const page_controller_t *pc);
+
+/*
+ * Keys (KEY_BIT mask) that auto-repeat while held in the current state:
+ * enter mode only, from the page's repeat_keys(), never K2.
+ */
+uint8_t page_controller_repeat_keys(const page_controller_t *pc);
+
+/*
+ * Gesture keys (KEY_BIT mask) recognized in the current state:
+ * - screen off: none
+ * - view mode: K2 double-click (jump to the first page), on pages with
+ *   double_click_home only
+ * - enter mode: page gesture_keys()
+ */
+uint8_t page_controller_gesture_keys(const page_controller_t *pc);
+
 /*
  * Set idle timeout for auto screen-off (0 to disable).
  */
@@ -8,14 +8,14 @@
 #include "../fonts.h"
 #include "../u8g2_api.h"
 #include "../ui_draw.h"
+#include "../ui_list.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 
 /* Content Y positions */
-#define LINE1_Y (CONTENT_Y_START + 12)
 #define LINE2_Y (CONTENT_Y_START + 28)
-#define LINE3_Y (CONTENT_Y_START + 44)
 
 /* Service status icons */
 #define ICON_RUNNING "\xE2\x96\xB6"  /* ▶ */
@@ -24,8 +24,8 @@
 #define ICON_PENDING_STOP "\xE2\x96\xA1" /* □ Query in progress (was stopped) */
 #define ICON_UNKNOWN "--"            /* Timeout/error */
 
-/* Maximum visible services */
-#define VISIBLE_LINES 3
+/* Width reserved for the status icon column */
+#define ICON_COL_WIDTH 14
 
 /* Dialog box dimensions */
 #define DIALOG_WIDTH  100
@@ -33,6 +33,11 @@
 #define DIALOG_X      ((SCREEN_WIDTH - DIALOG_WIDTH) / 2)
 #define DIALOG_Y      ((SCREEN_HEIGHT - DIALOG_HEIGHT) / 2)
 
+/* Batch progress bar (bottom of content area) and result box */
+#define BATCH_BAR_Y        (SCREEN_HEIGHT - 9)
+#define BATCH_BAR_HEIGHT   9
+#define BATCH_RESULT_MS    2000
+
 /* Service UI states */
 typedef enum {
     SVC_UI_STOPPED,
@@ -42,37 +47,204 @@ typedef enum {
     SVC_UI_ERROR,
 } svc_ui_state_t;
 
+/* Row order / value column (cycled with the K1+K2 chord) */
+typedef enum {
+    SORT_CONFIG,    /* Config order, CPU column */
+    SORT_CPU,       /* CPU descending */
+    SORT_MEM,       /* Memory descending, memory column */
+    SORT_COUNT,
+} sort_mode_t;
+
 /* Dialog state */
 typedef enum {
     DIALOG_NONE,
     DIALOG_CONFIRM,
+    DIALOG_CONFIRM_BATCH,   /* Restart all monitored services */
 } dialog_state_t;
 
+/* Per-service UI state, same order as status->services */
+typedef struct {
+    svc_ui_state_t ui_state;
+    uint64_t state_change_ms;
+    /* Cached running state from last render (for on_key) */
+    bool cached_running;
+} svc_item_t;
+
+/* Row draw context for ui_list callback */
+typedef struct {
+    const sys_status_t *status;
+    page_mode_t mode;
+    uint64_t now_ms;
+    int x_offset;
+} row_ctx_t;
+
 /* Page state */
 static struct {
-    int selected_index;
-    int scroll_offset;
-    svc_ui_state_t ui_states[MAX_SERVICES];
-    uint64_t state_change_ms[MAX_SERVICES];
-    /* Cached running state from last render (for on_key) */
-    bool cached_running[MAX_SERVICES];
+    ui_list_t list;        /* Selection and scroll (rows) */
+    svc_item_t *items;
+    int *order;            /* Row -> service index */
+    int item_count;
+    int item_capacity;
+    uint32_t generation;   /* sys_status service_generation of items */
+    uint32_t change_cursor; /* sys_status change log position */
+    /* Sorting */
+    sort_mode_t sort;
+    uint32_t usage_seq;    /* sys_status usage_seq of current order */
+    bool order_dirty;
     /* Dialog state */
     dialog_state_t dialog;
     int dialog_selection;  /* 0=No, 1=Yes */
     /* Pending control operation */
     int pending_control_index;  /* -1 = none */
     bool pending_control_start;
+    bool pending_batch;
+    /* Batch progress (pushed from completion callbacks) */
+    bool batch_visible;
+    int batch_done;
+    int batch_total;
+    int batch_failed;
+    uint64_t batch_end_ms;      /* First render after completion, 0 = not yet */
 } state;
 
 static void services_init(void) {
     memset(&state, 0, sizeof(state));
+    ui_list_init(&state.list, CONTENT_LINE_HEIGHT, CONTENT_MAX_LINES);
     state.pending_control_index = -1;
 }
 
+static void services_destroy(void) {
+    free(state.items);
+    free(state.order);
+    state.items = NULL;
+    state.order = NULL;
+    state.item_count = 0;
+    state.item_capacity = 0;
+}
+
+/* Status used by qsort comparators (single-threaded UI) */
+static const sys_status_t *g_sort_status;
+
+static int compare_rows(const void *a, const void *b) {
+    int ia = *(const int *)a;
+    int ib = *(const int *)b;
+    const service_status_t *sa = &g_sort_status->services[ia];
+    const service_status_t *sb = &g_sort_status->services[ib];
+
+    if (state.sort == SORT_CPU && sa->cpu_percent != sb->cpu_percent) {
+        return (sa->cpu_percent < sb->cpu_percent) ? 1 : -1;
+    }
+    if (state.sort == SORT_MEM && sa->mem_bytes != sb->mem_bytes) {
+        return (sa->mem_bytes < sb->mem_bytes) ? 1 : -1;
+    }
+    /* Stable: fall back to config order */
+    return ia - ib;
+}
+
+/* Rebuild row order; selection follows the selected service */
+static void sort_rows(const sys_status_t *status) {
+    int count = state.item_count;
+    int selected_svc = (state.list.selected < count) ? state.order[state.list.selected] : -1;
+
+    for (int i = 0; i < count; i++) {
+        state.order[i] = i;
+    }
+    if (state.sort != SORT_CONFIG && count > 1) {
+        g_sort_status = status;
+        qsort(state.order, (size_t)count, sizeof(*state.order), compare_rows);
+        g_sort_status = NULL;
+    }
+
+    for (int row = 0; row < count; row++) {
+        if (state.order[row] == selected_svc) {
+            if (row != state.list.selected) {
+                ui_list_select(&state.list, row);
+            }
+            break;
+        }
+    }
+
+    state.usage_seq = status->usage_seq;
+    state.order_dirty = false;
+}
+
+/* Cache running state and clear transition/error state once actual state matches */
+static void sync_item(const sys_status_t *status, int index) {
+    const service_status_t *svc = &status->services[index];
+    svc_item_t *item = &state.items[index];
+    bool running = svc->running;
+
+    item->cached_running = running;
+
+    svc_ui_state_t ui_state = item->ui_state;
+    bool should_sync = (ui_state == SVC_UI_STARTING && running) ||
+                       (ui_state == SVC_UI_STOPPING && !running) ||
+                       (ui_state == SVC_UI_ERROR && svc->status_valid);
+    if (should_sync) {
+        item->ui_state = running ? SVC_UI_RUNNING : SVC_UI_STOPPED;
+    }
+}
+
+/*
+ * Bring per-service UI state up to date with status.
+ * Only services from the sys_status change log are visited; the whole
+ * table is rebuilt when it was resized/reloaded (indices may have moved,
+ * transitional states are reset) or when the change log overflowed.
+ */
+static bool sync_items(const sys_status_t *status) {
+    int count = (int)status->service_count;
+    bool full = false;
+
+    if (count != state.item_count || status->service_generation != state.generation) {
+        if (count > state.item_capacity) {
+            svc_item_t *items = realloc(state.items, (size_t)count * sizeof(*items));
+            if (!items) return false;
+            state.items = items;
+            int *order = realloc(state.order, (size_t)count * sizeof(*order));
+            if (!order) return false;
+            state.order = order;
+            state.item_capacity = count;
+        }
+
+        memset(state.items, 0, (size_t)count * sizeof(*state.items));
+        for (int i = 0; i < count; i++) {
+            state.order[i] = i;
+        }
+        state.order_dirty = true;
+        state.item_count = count;
+        state.generation = status->service_generation;
+        state.dialog = DIALOG_NONE;
+        ui_list_set_count(&state.list, count);
+        full = true;
+    }
+
+    int index;
+    int ret;
+    while (!full && (ret = sys_status_next_changed_service(status, &state.change_cursor, &index)) != 0) {
+        if (ret < 0) {
+            full = true;
+        } else if (index < count) {
+            sync_item(status, index);
+        }
+    }
+
+    if (full) {
+        state.change_cursor = status->service_change_seq;
+        for (int i = 0; i < count; i++) {
+            sync_item(status, i);
+        }
+    }
+
+    /* Re-sort once per usage pass, not per frame */
+    if (state.order_dirty || (state.sort != SORT_CONFIG && status->usage_seq != state.usage_seq)) {
+        sort_rows(status);
+    }
+    return true;
+}
+
 /*
  * Render confirmation dialog overlay
  */
-static void render_dialog(u8g2_t *u8g2, const char *service_name, bool is_running, int x_offset) {
+static void render_dialog(u8g2_t *u8g2, const char *action, const char *subject, int x_offset) {
     int dx = DIALOG_X + x_offset;
     int dy = DIALOG_Y;
 
@@ -86,9 +258,8 @@ static void render_dialog(u8g2_t *u8g2, const char *service_name, bool is_runnin
 
     /* Draw action text */
     u8g2_SetFont(u8g2, font_content);
-    const char *action = is_running ? "Stop" : "Start";
     char title[24];
-    snprintf(title, sizeof(title), "%s %s?", action, service_name);
+    snprintf(title, sizeof(title), "%s %s?", action, subject);
 
     /* Truncate if too long */
     int title_w = u8g2_GetStrWidth(u8g2, title);
@@ -123,14 +294,21 @@ static void render_dialog(u8g2_t *u8g2, const char *service_name, bool is_runnin
 
 static const char *services_get_title(const sys_status_t *status) {
     (void)status;
-    return "Services";
+
+    switch (state.sort) {
+        case SORT_CPU: return "Svc CPU%";
+        case SORT_MEM: return "Svc Mem";
+        default:       return "Services";
+    }
 }
 
-static const char *get_service_icon(const service_status_t *svc, svc_ui_state_t ui_state,
-                                    uint64_t now_ms, int svc_idx) {
+static const char *get_service_icon(const service_status_t *svc, const svc_item_t *item,
+                                    uint64_t now_ms) {
+    svc_ui_state_t ui_state = item->ui_state;
+
     /* Handle transitional states with blinking (target icon <-> blank) */
     if (ui_state == SVC_UI_STARTING || ui_state == SVC_UI_STOPPING) {
-        uint64_t elapsed = now_ms - state.state_change_ms[svc_idx];
+        uint64_t elapsed = now_ms - item->state_change_ms;
         int phase = (int)(elapsed / ANIM_BLINK_PERIOD_MS) % 2;
         /* Target icon based on operation direction */
         const char *target_icon = (ui_state == SVC_UI_STARTING) ? ICON_RUNNING : ICON_STOPPED;
@@ -151,7 +329,20 @@ static const char *get_service_icon(const service_status_t *svc, svc_ui_state_t
     return svc->running ? ICON_RUNNING : ICON_STOPPED;
 }
 
-static void render_service_line(u8g2_t *u8g2, int y, const char *name,
+/* Usage column text for the current sort mode ("" if no cgroup data) */
+static void format_usage(const service_status_t *svc, char *buf, size_t buflen) {
+    if (!svc->usage_valid) {
+        buf[0] = '\0';
+    } else if (state.sort == SORT_MEM) {
+        sys_status_format_bytes(svc->mem_bytes, buf, buflen);
+    } else if (svc->cpu_percent >= 9.95f) {
+        snprintf(buf, buflen, "%d%%", (int)(svc->cpu_percent + 0.5f));
+    } else {
+        snprintf(buf, buflen, "%.1f%%", svc->cpu_percent);
+    }
+}
+
+static void render_service_line(u8g2_t *u8g2, int y, const char *name, const char *value,
                                 const char *icon, int is_selected, page_mode_t mode,
                                 int x_offset) {
     char buf[32];
@@ -163,9 +354,21 @@ static void render_service_line(u8g2_t *u8g2, int y, const char *name,
         u8g2_SetDrawColor(u8g2, 0);
     }
 
-    /* Draw service name */
+    /* Draw usage column (right-aligned before the icon) */
     u8g2_SetFont(u8g2, font_content);
-    snprintf(buf, sizeof(buf), "%s", name);
+    int name_max_x = SCREEN_WIDTH - MARGIN_RIGHT - ICON_COL_WIDTH;
+    if (value[0]) {
+        int value_w = u8g2_GetStrWidth(u8g2, value);
+        name_max_x -= value_w + 3;
+        ui_draw_str(u8g2, x_offset + name_max_x + 3, y, value);
+    }
+
+    /* Draw service name, truncated so it does not run into the columns */
+    size_t len = (size_t)snprintf(buf, sizeof(buf), "%s", name);
+    if (len >= sizeof(buf)) len = sizeof(buf) - 1;
+    while (len > 1 && MARGIN_LEFT + u8g2_GetStrWidth(u8g2, buf) > name_max_x) {
+        buf[--len] = '\0';
+    }
     ui_draw_str(u8g2, MARGIN_LEFT + x_offset, y, buf);
 
     /* Draw status icon (right-aligned) */
@@ -179,6 +382,64 @@ static void render_service_line(u8g2_t *u8g2, int y, const char *name,
     }
 }
 
+/*
+ * Batch progress: bar while running, then a short result box.
+ */
+static void render_batch_progress(u8g2_t *u8g2, uint64_t now_ms, int x_offset) {
+    if (!state.batch_visible || state.batch_total <= 0) return;
+
+    bool complete = state.batch_done >= state.batch_total;
+    if (complete) {
+        if (state.batch_end_ms == 0) {
+            state.batch_end_ms = now_ms;
+        } else if (now_ms - state.batch_end_ms >= BATCH_RESULT_MS) {
+            state.batch_visible = false;
+            return;
+        }
+    }
+
+    u8g2_SetDrawColor(u8g2, 0);
+    ui_draw_box(u8g2, x_offset, BATCH_BAR_Y, SCREEN_WIDTH, BATCH_BAR_HEIGHT);
+    u8g2_SetDrawColor(u8g2, 1);
+
+    if (!complete) {
+        int bar_w = SCREEN_WIDTH - MARGIN_LEFT - MARGIN_RIGHT;
+        int fill_w = (bar_w - 4) * state.batch_done / state.batch_total;
+        u8g2_DrawFrame(u8g2, MARGIN_LEFT + x_offset, BATCH_BAR_Y + 1, bar_w, BATCH_BAR_HEIGHT - 2);
+        if (fill_w > 0) {
+            ui_draw_box(u8g2, MARGIN_LEFT + x_offset + 2, BATCH_BAR_Y + 3, fill_w, BATCH_BAR_HEIGHT - 6);
+        }
+        return;
+    }
+
+    /* Result replaces the bar until BATCH_RESULT_MS elapsed */
+    char text[40];
+    if (state.batch_failed > 0) {
+        snprintf(text, sizeof(text), "%d OK, %d failed",
+                 state.batch_total - state.batch_failed, state.batch_failed);
+    } else {
+        snprintf(text, sizeof(text), "All %d OK", state.batch_total);
+    }
+    u8g2_SetDrawColor(u8g2, 0);
+    ui_draw_box(u8g2, x_offset, BATCH_BAR_Y - 4, SCREEN_WIDTH, BATCH_BAR_HEIGHT + 4);
+    u8g2_SetDrawColor(u8g2, 1);
+    u8g2_SetFont(u8g2, font_content);
+    int text_x = (SCREEN_WIDTH - u8g2_GetStrWidth(u8g2, text)) / 2;
+    ui_draw_str(u8g2, text_x + x_offset, SCREEN_HEIGHT - 1, text);
+}
+
+static void draw_row(u8g2_t *u8g2, int row, int baseline_y, bool selected, void *priv) {
+    const row_ctx_t *ctx = (const row_ctx_t *)priv;
+    int index = state.order[row];
+    const service_status_t *svc = &ctx->status->services[index];
+    const char *icon = get_service_icon(svc, &state.items[index], ctx->now_ms);
+    char value[12];
+
+    format_usage(svc, value, sizeof(value));
+    render_service_line(u8g2, baseline_y, svc->name, value, icon, selected, ctx->mode,
+                        ctx->x_offset);
+}
+
 static void services_render(u8g2_t *u8g2, const sys_status_t *status,
                             page_mode_t mode, uint64_t now_ms, int x_offset) {
     if (!u8g2) return;
@@ -189,65 +450,32 @@ static void services_render(u8g2_t *u8g2, const sys_status_t *status,
         return;
     }
 
-    int y_positions[] = {LINE1_Y, LINE2_Y, LINE3_Y};
     int service_count = (int)status->service_count;
 
-    if (service_count == 0) {
+    if (service_count == 0 || !sync_items(status)) {
         u8g2_SetFont(u8g2, font_content);
         ui_draw_str(u8g2, MARGIN_LEFT + x_offset, LINE2_Y, "No services");
         return;
     }
 
-    /* Cache running state and sync ui_states with actual state */
-    for (int i = 0; i < service_count && i < MAX_SERVICES; i++) {
-        bool running = status->services[i].running;
-        state.cached_running[i] = running;
-
-        /* Clear transition/error state when actual state matches expectation */
-        svc_ui_state_t ui_state = state.ui_states[i];
-        bool should_sync = (ui_state == SVC_UI_STARTING && running) ||
-                           (ui_state == SVC_UI_STOPPING && !running) ||
-                           (ui_state == SVC_UI_ERROR && status->services[i].status_valid);
-        if (should_sync) {
-            state.ui_states[i] = running ? SVC_UI_RUNNING : SVC_UI_STOPPED;
-        }
-    }
-
-    /* Render visible services */
-    for (int i = 0; i < VISIBLE_LINES && (state.scroll_offset + i) < service_count; i++) {
-        int svc_idx = state.scroll_offset + i;
-        const service_status_t *svc = &status->services[svc_idx];
-
-        const char *icon = get_service_icon(svc, state.ui_states[svc_idx], now_ms, svc_idx);
-        int is_selected = (svc_idx == state.selected_index);
-
-        render_service_line(u8g2, y_positions[i], svc->name, icon, is_selected, mode, x_offset);
-    }
+    /* Render only rows inside the viewport */
+    row_ctx_t ctx = {
+        .status = status,
+        .mode = mode,
+        .now_ms = now_ms,
+        .x_offset = x_offset,
+    };
+    ui_list_render(&state.list, u8g2, CONTENT_Y_START, now_ms, draw_row, &ctx);
 
     /* Render dialog overlay if active */
-    if (state.dialog == DIALOG_CONFIRM && state.selected_index < service_count) {
-        const service_status_t *svc = &status->services[state.selected_index];
-        render_dialog(u8g2, svc->name, svc->running, x_offset);
-    }
-}
-
-static void ensure_visible(int service_count) {
-    /* Adjust scroll to keep selected item visible */
-    if (state.selected_index < state.scroll_offset) {
-        state.scroll_offset = state.selected_index;
-    } else if (state.selected_index >= state.scroll_offset + VISIBLE_LINES) {
-        state.scroll_offset = state.selected_index - VISIBLE_LINES + 1;
+    if (state.dialog == DIALOG_CONFIRM && state.list.selected < service_count) {
+        const service_status_t *svc = &status->services[state.order[state.list.selected]];
+        render_dialog(u8g2, svc->running ? "Stop" : "Start", svc->name, x_offset);
+    } else if (state.dialog == DIALOG_CONFIRM_BATCH) {
+        render_dialog(u8g2, "Restart", "all", x_offset);
     }
 
-    /* Clamp scroll offset */
-    int max_scroll = service_count - VISIBLE_LINES;
-    if (max_scroll < 0) max_scroll = 0;
-    if (state.scroll_offset > max_scroll) {
-        state.scroll_offset = max_scroll;
-    }
-    if (state.scroll_offset < 0) {
-        state.scroll_offset = 0;
-    }
+    render_batch_progress(u8g2, now_ms, x_offset);
 }
 
 static bool services_on_key(uint8_t key, bool long_press, page_mode_t mode) {
@@ -255,15 +483,15 @@ static bool services_on_key(uint8_t key, bool long_press, page_mode_t mode) {
         return false;
     }
 
-    const service_config_t *cfg = service_config_get();
-    int service_count = cfg ? (int)cfg->count : 0;
+    /* Item table is synced with status on render */
+    int service_count = state.item_count;
 
     if (service_count == 0) {
         return false;
     }
 
     /* Handle dialog input */
-    if (state.dialog == DIALOG_CONFIRM) {
+    if (state.dialog != DIALOG_NONE) {
         switch (key) {
             case KEY_K1:
             case KEY_K3:
@@ -277,13 +505,17 @@ static bool services_on_key(uint8_t key, bool long_press, page_mode_t mode) {
             case KEY_K2:
                 if (!long_press) {
                     /* Confirm selection */
-                    if (state.dialog_selection == 1) {
+                    if (state.dialog_selection == 1 && state.dialog == DIALOG_CONFIRM_BATCH) {
+                        /* Yes - schedule batch restart (consumed by ui_controller) */
+                        state.pending_batch = true;
+                    } else if (state.dialog_selection == 1) {
                         /* Yes selected - toggle service based on actual running state */
-                        bool is_running = state.cached_running[state.selected_index];
-                        state.ui_states[state.selected_index] =
-                            is_running ? SVC_UI_STOPPING : SVC_UI_STARTING;
+                        int index = state.order[state.list.selected];
+                        svc_item_t *item = &state.items[index];
+                        bool is_running = item->cached_running;
+                        item->ui_state = is_running ? SVC_UI_STOPPING : SVC_UI_STARTING;
                         /* Schedule control operation (consumed by ui_controller) */
-                        state.pending_control_index = state.selected_index;
+                        state.pending_control_index = index;
                         state.pending_control_start = !is_running;
                     }
                     /* Close dialog */
@@ -300,11 +532,7 @@ static bool services_on_key(uint8_t key, bool long_press, page_mode_t mode) {
         case KEY_K1:
             if (!long_press) {
                 /* Move up (with wrap) */
-                state.selected_index--;
-                if (state.selected_index < 0) {
-                    state.selected_index = service_count - 1;
-                }
-                ensure_visible(service_count);
+                ui_list_move(&state.list, -1);
                 return true;
             }
             break;
@@ -312,15 +540,25 @@ static bool services_on_key(uint8_t key, bool long_press, page_mode_t mode) {
         case KEY_K3:
             if (!long_press) {
                 /* Move down (with wrap) */
-                state.selected_index++;
-                if (state.selected_index >= service_count) {
-                    state.selected_index = 0;
-                }
-                ensure_visible(service_count);
+                ui_list_move(&state.list, 1);
                 return true;
             }
             break;
 
+        case KEY_K1_K2:
+            /* Cycle sort column (applied on next render) */
+            state.sort = (sort_mode_t)((state.sort + 1) % SORT_COUNT);
+            state.order_dirty = true;
+            return true;
+
+        case KEY_K1_K3:
+            /* Restart all (not while a batch is still running) */
+            if (!state.batch_visible || state.batch_done >= state.batch_total) {
+                state.dialog = DIALOG_CONFIRM_BATCH;
+                state.dialog_selection = 0;  /* Default to No */
+            }
+            return true;
+
         case KEY_K2:
             if (!long_press) {
                 /* Open confirmation dialog */
@@ -336,14 +574,14 @@ static bool services_on_key(uint8_t key, bool long_press, page_mode_t mode) {
 
 static void services_on_enter(void) {
     /* Reset selection to first item when entering */
-    state.selected_index = 0;
-    state.scroll_offset = 0;
+    ui_list_reset(&state.list);
 }
 
 static void services_on_exit(void) {
     /* Close any open dialog */
     state.dialog = DIALOG_NONE;
     state.pending_control_index = -1;
+    state.pending_batch = false;
 }
 
 bool page_services_take_control_request(int *index, bool *start, uint64_t now_ms) {
@@ -356,34 +594,70 @@ bool page_services_take_control_request(int *index, bool *start, uint64_t now_ms
 
     if (index) *index = idx;
     if (start) *start = state.pending_control_start;
-    if (idx >= 0 && idx < MAX_SERVICES) {
-        state.state_change_ms[idx] = now_ms;
+    if (idx >= 0 && idx < state.item_count) {
+        state.items[idx].state_change_ms = now_ms;
+    }
+    return true;
+}
+
+bool page_services_take_batch_request(void) {
+    if (!state.pending_batch) {
+        return false;
     }
+
+    state.pending_batch = false;
     return true;
 }
 
+void page_services_set_batch_progress(int done, int total, int failed) {
+    state.batch_visible = total > 0;
+    state.batch_done = done;
+    state.batch_total = total;
+    state.batch_failed = failed;
+    state.batch_end_ms = 0;
+}
+
 void page_services_notify_control_result(int index, bool success) {
-    if (index < 0 || index >= MAX_SERVICES) return;
+    if (index < 0 || index >= state.item_count) return;
 
     if (!success) {
-        state.ui_states[index] = SVC_UI_ERROR;
+        state.items[index].ui_state = SVC_UI_ERROR;
     }
 }
 
 static int services_get_selected_index(void) {
-    return state.selected_index;
+    return state.list.selected;
 }
 
 static int services_get_item_count(void) {
-    const service_config_t *cfg = service_config_get();
-    return cfg ? (int)cfg->count : 0;
+    return state.item_count;
+}
+
+static bool services_is_animating(void) {
+    return ui_list_is_animating(&state.list);
+}
+
+static uint8_t services_press_dispatch_keys(void) {
+    /* Sort and restart-all are chords, so K1/K3 have no long action */
+    return KEY_BIT(KEY_K1) | KEY_BIT(KEY_K3);
+}
+
+static uint8_t services_repeat_keys(void) {
+    /* A held key toggles a confirmation dialog once, not on every step */
+    if (state.dialog != DIALOG_NONE) return 0;
+    return KEY_BIT(KEY_K1) | KEY_BIT(KEY_K3);
+}
+
+static uint8_t services_gesture_keys(void) {
+    return KEY_BIT(KEY_K1_K2) | KEY_BIT(KEY_K1_K3);
 }
 
 const page_t page_services = {
     .name = "Services",
     .can_enter = true,
+    .double_click_home = true,
     .init = services_init,
-    .destroy = NULL,
+    .destroy = services_destroy,
     .get_title = services_get_title,
     .render = services_render,
     .on_key = services_on_key,
@@ -391,4 +665,8 @@ const page_t page_services = {
     .on_exit = services_on_exit,
     .get_selected_index = services_get_selected_index,
     .get_item_count = services_get_item_count,
+    .is_animating = services_is_animating,
+    .press_dispatch_keys = services_press_dispatch_keys,
+    .repeat_keys = services_repeat_keys,
+    .gesture_keys = services_gesture_keys,
 };
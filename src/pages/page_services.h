@@ -13,6 +13,16 @@
  */
 bool page_services_take_control_request(int *index, bool *start, uint64_t now_ms);
 
+/*
+ * Consume a pending "restart all" request from the Services page.
+ */
+bool page_services_take_batch_request(void);
+
+/*
+ * Update batch progress bar (called from batch completion callbacks).
+ */
+void page_services_set_batch_progress(int done, int total, int failed);
+
 /*
  * Notify the Services page about control result (for UI feedback).
  */
@@ -156,6 +156,15 @@ static void settings_on_enter(void) {
 static void settings_on_exit(void) {
 }
 
+static uint8_t settings_press_dispatch_keys(void) {
+    /* K1/K3 only move the selection; K2 keeps long press for exit */
+    return KEY_BIT(KEY_K1) | KEY_BIT(KEY_K3);
+}
+
+static uint8_t settings_repeat_keys(void) {
+    return KEY_BIT(KEY_K1) | KEY_BIT(KEY_K3);
+}
+
 static int settings_get_selected_index(void) {
     return state.selected_index;
 }
@@ -167,6 +176,7 @@ static int settings_get_item_count(void) {
 const page_t page_settings = {
     .name = "Settings",
     .can_enter = true,
+    .double_click_home = true,
     .init = settings_init,
     .destroy = NULL,
     .get_title = settings_get_title,
@@ -176,4 +186,6 @@ const page_t page_settings = {
     .on_exit = settings_on_exit,
     .get_selected_index = settings_get_selected_index,
     .get_item_count = settings_get_item_count,
+    .press_dispatch_keys = settings_press_dispatch_keys,
+    .repeat_keys = settings_repeat_keys,
 };
@@ -0,0 +1,430 @@
+#include "prom_server.h"
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <libubox/uloop.h>
+
+#include "loop_watch.h"
+#include "metrics.h"
+
+#define PROM_HEAD_MAX 128   /* HTTP header, written in front of the body */
+
+typedef struct {
+    struct uloop_fd ufd;
+    struct uloop_timeout timeout;
+    bool used;
+    bool responding;        /* Request complete, writing the shared response */
+    size_t req_len;
+    size_t sent;
+    char req[PROM_REQUEST_MAX];
+} prom_client_t;
+
+static struct uloop_fd g_listen = { .fd = -1 };
+static char g_unix_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static status_snapshot_t *g_snapshot;
+static prom_client_t g_clients[PROM_MAX_CLIENTS];
+
+/* Response: header right-aligned before the body, sent as one block */
+static char g_out[PROM_HEAD_MAX + PROM_BUF_SIZE];
+static const char *g_resp;
+static size_t g_resp_len;
+static int g_responding;    /* Clients still writing g_resp */
+
+LOOP_WATCH_SOURCE(g_watch_prom, "prom");
+
+METRIC_COUNTER(g_m_requests, "prom_requests");
+METRIC_COUNTER(g_m_rejected, "prom_rejected");
+
+/*
+ * Body rendering
+ */
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+    size_t line_end;        /* Length up to the last complete line */
+    bool full;
+} out_t;
+
+static void out_printf(out_t *o, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void out_printf(out_t *o, const char *fmt, ...) {
+    if (o->full) return;
+
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(o->buf + o->len, o->size - o->len, fmt, ap);
+    va_end(ap);
+
+    if (n < 0 || (size_t)n >= o->size - o->len) {
+        o->full = true;
+        o->len = o->line_end;
+        return;
+    }
+    o->len += (size_t)n;
+    if (o->len > 0 && o->buf[o->len - 1] == '\n') {
+        o->line_end = o->len;
+    }
+}
+
+/* Label value escaping: backslash, double quote, newline */
+static const char *escape_label(char *dst, size_t size, const char *src) {
+    size_t j = 0;
+    for (size_t i = 0; src[i] && j + 2 < size; i++) {
+        char c = src[i];
+        if (c == '\\' || c == '"' || c == '\n') {
+            dst[j++] = '\\';
+            c = (c == '\n') ? 'n' : c;
+        }
+        dst[j++] = c;
+    }
+    dst[j] = '\0';
+    return dst;
+}
+
+static void family(out_t *o, const char *name, const char *type, const char *help) {
+    out_printf(o, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void render_system(out_t *o, const sys_status_t *st) {
+    char host[64], ip[40], gw[40];
+    family(o, "nanohat_info", "gauge", "Host identity");
+    out_printf(o, "nanohat_info{hostname=\"%s\",ip=\"%s\",gateway=\"%s\"} 1\n",
+               escape_label(host, sizeof(host), st->hostname),
+               escape_label(ip, sizeof(ip), st->ip_addr),
+               escape_label(gw, sizeof(gw), st->gateway));
+
+    family(o, "nanohat_cpu_usage_percent", "gauge", "CPU usage");
+    out_printf(o, "nanohat_cpu_usage_percent %.2f\n", st->cpu_usage);
+    family(o, "nanohat_cpu_temperature_celsius", "gauge", "SoC temperature");
+    out_printf(o, "nanohat_cpu_temperature_celsius %.2f\n", st->cpu_temp);
+    family(o, "nanohat_memory_total_bytes", "gauge", "MemTotal");
+    out_printf(o, "nanohat_memory_total_bytes %llu\n",
+               (unsigned long long)st->mem_total_kb * 1024ULL);
+    family(o, "nanohat_memory_available_bytes", "gauge", "MemAvailable");
+    out_printf(o, "nanohat_memory_available_bytes %llu\n",
+               (unsigned long long)st->mem_available_kb * 1024ULL);
+    family(o, "nanohat_uptime_seconds", "gauge", "System uptime");
+    out_printf(o, "nanohat_uptime_seconds %u\n", st->uptime_sec);
+
+    family(o, "nanohat_network_receive_bytes_total", "counter", "Gateway interface RX bytes");
+    out_printf(o, "nanohat_network_receive_bytes_total %llu\n", (unsigned long long)st->rx_bytes);
+    family(o, "nanohat_network_transmit_bytes_total", "counter", "Gateway interface TX bytes");
+    out_printf(o, "nanohat_network_transmit_bytes_total %llu\n", (unsigned long long)st->tx_bytes);
+    family(o, "nanohat_network_receive_rate_bytes", "gauge", "Gateway interface RX bytes/s");
+    out_printf(o, "nanohat_network_receive_rate_bytes %llu\n", (unsigned long long)st->rx_speed);
+    family(o, "nanohat_network_transmit_rate_bytes", "gauge", "Gateway interface TX bytes/s");
+    out_printf(o, "nanohat_network_transmit_rate_bytes %llu\n", (unsigned long long)st->tx_speed);
+}
+
+typedef enum {
+    SVC_INSTALLED,
+    SVC_RUNNING,
+    SVC_VALID,
+    SVC_CPU,
+    SVC_MEM,
+    SVC_FIELDS,
+} svc_field_t;
+
+static const struct {
+    const char *name;
+    const char *help;
+} g_svc_families[SVC_FIELDS] = {
+    [SVC_INSTALLED] = { "nanohat_service_installed", "Init script present" },
+    [SVC_RUNNING]   = { "nanohat_service_running", "Service has a running instance" },
+    [SVC_VALID]     = { "nanohat_service_status_valid", "Last status query succeeded" },
+    [SVC_CPU]       = { "nanohat_service_cpu_percent", "Service cgroup CPU share" },
+    [SVC_MEM]       = { "nanohat_service_memory_bytes", "Service cgroup memory.current" },
+};
+
+static void render_services(out_t *o, const sys_status_t *st) {
+    char name[2 * SERVICE_NAME_MAX_LEN];
+
+    /* One family at a time: samples of a family must be contiguous */
+    for (int f = 0; f < SVC_FIELDS; f++) {
+        family(o, g_svc_families[f].name, "gauge", g_svc_families[f].help);
+        for (size_t i = 0; i < st->service_count; i++) {
+            const service_status_t *svc = &st->services[i];
+            if ((f == SVC_CPU || f == SVC_MEM) && !svc->usage_valid) continue;
+
+            escape_label(name, sizeof(name), svc->name);
+            switch (f) {
+                case SVC_INSTALLED:
+                    out_printf(o, "%s{service=\"%s\"} %d\n", g_svc_families[f].name, name, svc->installed);
+                    break;
+                case SVC_RUNNING:
+                    out_printf(o, "%s{service=\"%s\"} %d\n", g_svc_families[f].name, name, svc->running);
+                    break;
+                case SVC_VALID:
+                    out_printf(o, "%s{service=\"%s\"} %d\n", g_svc_families[f].name, name, svc->status_valid);
+                    break;
+                case SVC_CPU:
+                    out_printf(o, "%s{service=\"%s\"} %.2f\n", g_svc_families[f].name, name, svc->cpu_percent);
+                    break;
+                case SVC_MEM:
+                    out_printf(o, "%s{service=\"%s\"} %llu\n", g_svc_families[f].name, name,
+                               (unsigned long long)svc->mem_bytes);
+                    break;
+            }
+        }
+    }
+}
+
+static void render_registry(out_t *o) {
+    metric_sample_t samples[METRICS_MAX];
+    int n = metrics_snapshot(samples, METRICS_MAX);
+
+    for (int i = 0; i < n; i++) {
+        bool counter = samples[i].type == METRIC_TYPE_COUNTER;
+        size_t len = strlen(samples[i].name);
+        const char *suffix = (counter && (len < 6 || strcmp(samples[i].name + len - 6, "_total") != 0))
+                             ? "_total" : "";
+        out_printf(o, "# TYPE nanohat_%s%s %s\nnanohat_%s%s %llu\n",
+                   samples[i].name, suffix, counter ? "counter" : "gauge",
+                   samples[i].name, suffix, (unsigned long long)samples[i].value);
+    }
+}
+
+size_t prom_render(char *buf, size_t size, const sys_status_t *status) {
+    if (!buf || size == 0) return 0;
+
+    out_t o = { .buf = buf, .size = size };
+    if (status) {
+        render_system(&o, status);
+        render_services(&o, status);
+    }
+    render_registry(&o);
+    buf[o.len < size ? o.len : size - 1] = '\0';
+    return o.len;
+}
+
+/*
+ * Connections
+ */
+static void client_close(prom_client_t *c) {
+    if (!c->used) return;
+
+    uloop_timeout_cancel(&c->timeout);
+    uloop_fd_delete(&c->ufd);
+    close(c->ufd.fd);
+    if (c->responding) {
+        g_responding--;
+    }
+    c->used = false;
+    c->responding = false;
+}
+
+static void build_response(void) {
+    char *body = g_out + PROM_HEAD_MAX;
+    const sys_status_t *status = g_snapshot ? status_snapshot_acquire(g_snapshot) : NULL;
+    size_t body_len = prom_render(body, PROM_BUF_SIZE, status);
+
+    char head[PROM_HEAD_MAX];
+    int head_len = snprintf(head, sizeof(head),
+                            "HTTP/1.0 200 OK\r\n"
+                            "Content-Type: text/plain; version=0.0.4\r\n"
+                            "Content-Length: %zu\r\n\r\n", body_len);
+    g_resp = body - head_len;
+    memcpy((char *)g_resp, head, (size_t)head_len);
+    g_resp_len = (size_t)head_len + body_len;
+}
+
+static void client_write(prom_client_t *c) {
+    while (c->sent < g_resp_len) {
+        /* No SIGPIPE when the scraper hung up */
+        ssize_t n = send(c->ufd.fd, g_resp + c->sent, g_resp_len - c->sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+            if (errno == EINTR) continue;
+            break;
+        }
+        c->sent += (size_t)n;
+    }
+    client_close(c);
+}
+
+static bool request_complete(const prom_client_t *c) {
+    return c->req_len == sizeof(c->req) ||
+           memmem(c->req, c->req_len, "\r\n\r\n", 4) ||
+           memmem(c->req, c->req_len, "\n\n", 2);
+}
+
+static void client_read(prom_client_t *c) {
+    while (c->req_len < sizeof(c->req)) {
+        ssize_t n = read(c->ufd.fd, c->req + c->req_len, sizeof(c->req) - c->req_len);
+        if (n == 0) {
+            client_close(c);
+            return;
+        }
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            if (errno == EINTR) continue;
+            client_close(c);
+            return;
+        }
+        c->req_len += (size_t)n;
+    }
+    if (!request_complete(c)) return;
+
+    /* Render once per burst: a body still being sent is served again */
+    if (g_responding == 0) {
+        build_response();
+    }
+    metric_inc(&g_m_requests);
+    g_responding++;
+    c->responding = true;
+    c->sent = 0;
+    uloop_fd_add(&c->ufd, ULOOP_WRITE);
+    client_write(c);
+}
+
+static void client_cb(struct uloop_fd *u, unsigned int events) {
+    prom_client_t *c = container_of(u, prom_client_t, ufd);
+    loop_watch_begin(&g_watch_prom);
+    if (c->responding) {
+        if (events & ULOOP_WRITE) client_write(c);
+    } else {
+        client_read(c);
+    }
+    loop_watch_end(&g_watch_prom);
+}
+
+static void client_timeout_cb(struct uloop_timeout *t) {
+    client_close(container_of(t, prom_client_t, timeout));
+}
+
+static void listen_cb(struct uloop_fd *u, unsigned int events) {
+    (void)events;
+    loop_watch_begin(&g_watch_prom);
+
+    for (;;) {
+        int fd = accept4(u->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) break;
+
+        prom_client_t *c = NULL;
+        for (int i = 0; i < PROM_MAX_CLIENTS; i++) {
+            if (!g_clients[i].used) {
+                c = &g_clients[i];
+                break;
+            }
+        }
+        if (!c) {
+            metric_inc(&g_m_rejected);
+            close(fd);
+            continue;
+        }
+
+        c->used = true;
+        c->responding = false;
+        c->req_len = 0;
+        c->sent = 0;
+        c->ufd.fd = fd;
+        c->ufd.cb = client_cb;
+        c->timeout.cb = client_timeout_cb;
+        uloop_fd_add(&c->ufd, ULOOP_READ);
+        uloop_timeout_set(&c->timeout, PROM_CLIENT_TIMEOUT_MS);
+    }
+
+    loop_watch_end(&g_watch_prom);
+}
+
+/*
+ * Listener
+ */
+static int listen_unix(const char *path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    unlink(path);   /* Stale socket from a previous run */
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    snprintf(g_unix_path, sizeof(g_unix_path), "%s", path);
+    return fd;
+}
+
+static int listen_tcp(const char *spec) {
+    const char *colon = strrchr(spec, ':');
+    const char *port_str = colon ? colon + 1 : spec;
+    size_t host_len = colon ? (size_t)(colon - spec) : 0;
+
+    /* Loopback only: the endpoint has no authentication */
+    if (host_len != 0 &&
+        !(host_len == 9 && strncmp(spec, "127.0.0.1", 9) == 0) &&
+        !(host_len == 9 && strncmp(spec, "localhost", 9) == 0)) {
+        return -1;
+    }
+
+    char *end;
+    long port = strtol(port_str, &end, 10);
+    if (*port_str == '\0' || *end != '\0' || port < 0 || port > 65535) return -1;
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons((uint16_t)port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int prom_server_start(const char *listen_spec, status_snapshot_t *snapshot) {
+    if (!listen_spec || !listen_spec[0] || g_listen.fd >= 0) return -1;
+
+    int fd = (listen_spec[0] == '/') ? listen_unix(listen_spec) : listen_tcp(listen_spec);
+    if (fd < 0) return -1;
+
+    if (listen(fd, PROM_MAX_CLIENTS) != 0) {
+        close(fd);
+        prom_server_stop();
+        return -1;
+    }
+
+    g_snapshot = snapshot;
+    g_listen.fd = fd;
+    g_listen.cb = listen_cb;
+    if (uloop_fd_add(&g_listen, ULOOP_READ) < 0) {
+        prom_server_stop();
+        return -1;
+    }
+    return 0;
+}
+
+void prom_server_stop(void) {
+    for (int i = 0; i < PROM_MAX_CLIENTS; i++) {
+        client_close(&g_clients[i]);
+    }
+    if (g_listen.fd >= 0) {
+        uloop_fd_delete(&g_listen);
+        close(g_listen.fd);
+        g_listen.fd = -1;
+    }
+    if (g_unix_path[0]) {
+        unlink(g_unix_path);
+        g_unix_path[0] = '\0';
+    }
+    g_snapshot = NULL;
+}
@@ -0,0 +1,57 @@
+/*
+ * Prometheus text exposition endpoint
+ *
+ * An optional listener, driven by uloop, that serves the status the
+ * daemon already collects (system, network, per-service) and the metrics
+ * registry in Prometheus text format 0.0.4, so routers need no separate
+ * exporter:
+ *
+ *   NANOHAT_METRICS_LISTEN=/var/run/nanohat-oled.metrics
+ *       curl --unix-socket /var/run/nanohat-oled.metrics http://x/metrics
+ *   NANOHAT_METRICS_LISTEN=127.0.0.1:9101   (or :9101, loopback only)
+ *       curl http://127.0.0.1:9101/metrics
+ *
+ * Each connection sends one HTTP request and gets one HTTP/1.0 response
+ * (any path). The body is rendered into a static buffer; a request that
+ * arrives while another response is still being written reuses that
+ * body. Clients live in PROM_MAX_CLIENTS static slots: no allocation per
+ * request. Connections beyond that are closed at once, and a client that
+ * sends no complete request within PROM_CLIENT_TIMEOUT_MS is dropped.
+ *
+ * uloop thread only.
+ */
+#ifndef PROM_SERVER_H
+#define PROM_SERVER_H
+
+#include <stddef.h>
+
+#include "status_snapshot.h"
+#include "sys_status.h"
+
+#define PROM_MAX_CLIENTS       4
+#define PROM_BUF_SIZE          65536   /* Rendered body */
+#define PROM_REQUEST_MAX       1024    /* Request head */
+#define PROM_CLIENT_TIMEOUT_MS 2000
+
+/*
+ * Start listening on listen: a Unix socket path (starts with '/') or
+ * [127.0.0.1]:port. Each request renders the newest status published to
+ * snapshot (acquired on the uloop thread, like the UI frames), so a
+ * scrape never mixes two collector passes. Returns 0, or -1 on a bad
+ * address or socket error.
+ */
+int prom_server_start(const char *listen, status_snapshot_t *snapshot);
+
+/*
+ * Close the listener and all clients (removes the Unix socket).
+ */
+void prom_server_stop(void);
+
+/*
+ * Render status and the metrics registry into buf.
+ * Returns the length; output that does not fit is cut after the last
+ * complete line.
+ */
+size_t prom_render(char *buf, size_t size, const sys_status_t *status);
+
+#endif
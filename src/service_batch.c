@@ -0,0 +1,285 @@
+#include "service_batch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libubox/uloop.h>
+#include <libubox/utils.h>
+
+#define INITIAL_JOBS 16
+#define RETRY_MS     100    /* ubus control slots all taken by others */
+
+/* A full batch still leaves control slots for the Services page */
+_Static_assert(SERVICE_BATCH_PARALLEL_MAX < UBUS_HAL_MAX_CONTROLS, "batch control slots");
+
+typedef enum {
+    JOB_QUEUED,
+    JOB_RUNNING,
+    JOB_DONE,
+} job_state_t;
+
+typedef struct {
+    char name[SERVICE_NAME_MAX_LEN];
+    ubus_hal_action_t action;
+    int prev_same;          /* Previous job for the same service, -1 = none */
+    job_state_t state;
+} batch_job_t;
+
+struct service_batch {
+    sys_status_ctx_t *ctx;
+    sys_status_t *status;
+    int max_parallel;
+    service_batch_progress_cb cb;
+    void *priv;
+
+    batch_job_t *jobs;
+    int job_capacity;
+    int next_queued;        /* No queued job before this index */
+
+    /* Service name -> last job index (for per-service ordering) */
+    service_config_t names;
+    int *last_job;
+
+    service_batch_progress_t progress;
+    bool started;
+    bool pumping;           /* Re-entrancy guard (callbacks may run synchronously) */
+    bool repump;
+    bool busy;              /* ubus had no control slot this pass */
+    bool release;           /* Free when the last job in flight completes */
+    struct uloop_timeout retry;
+};
+
+/* Completion context, one per dispatched job */
+typedef struct {
+    service_batch_t *batch;
+    int job;
+} job_ctx_t;
+
+static void pump(service_batch_t *batch);
+
+static void destroy(service_batch_t *batch) {
+    uloop_timeout_cancel(&batch->retry);
+    service_config_free(&batch->names);
+    free(batch->last_job);
+    free(batch->jobs);
+    free(batch);
+}
+
+static void notify(service_batch_t *batch) {
+    if (batch->cb && !batch->release) {
+        batch->cb(&batch->progress, batch->priv);
+    }
+}
+
+static void finish_job(service_batch_t *batch, batch_job_t *job, bool success) {
+    if (job->state == JOB_RUNNING) {
+        batch->progress.running--;
+    }
+    job->state = JOB_DONE;
+    batch->progress.done++;
+    if (!success) {
+        batch->progress.failed++;
+    }
+}
+
+static void job_complete_cb(int index, bool success, int status, void *priv) {
+    (void)index;
+    (void)status;
+
+    job_ctx_t *jctx = (job_ctx_t *)priv;
+    service_batch_t *batch = jctx->batch;
+    finish_job(batch, &batch->jobs[jctx->job], success);
+    free(jctx);
+
+    if (batch->release) {
+        if (batch->progress.running == 0 && !batch->pumping) {
+            destroy(batch);
+        }
+        return;
+    }
+
+    pump(batch);
+    notify(batch);
+}
+
+static void dispatch(service_batch_t *batch, int i) {
+    batch_job_t *job = &batch->jobs[i];
+
+    /* Resolve by name: indices move on config reload */
+    int index = sys_status_find_service(batch->status, job->name);
+    job_ctx_t *jctx = (index >= 0) ? malloc(sizeof(*jctx)) : NULL;
+    if (!jctx) {
+        finish_job(batch, job, false);
+        return;
+    }
+    jctx->batch = batch;
+    jctx->job = i;
+
+    job->state = JOB_RUNNING;
+    batch->progress.running++;
+
+    int ret = sys_status_control_service_action(batch->ctx, batch->status, index,
+                                                job->action, job_complete_cb, jctx);
+    if (ret == UBUS_HAL_BUSY) {
+        /* Not a failure: back in the queue until a slot frees up */
+        free(jctx);
+        job->state = JOB_QUEUED;
+        batch->progress.running--;
+        batch->busy = true;
+    } else if (ret < 0) {
+        free(jctx);
+        finish_job(batch, job, false);
+    }
+}
+
+static void retry_cb(struct uloop_timeout *t) {
+    pump(container_of(t, service_batch_t, retry));
+}
+
+/*
+ * Dispatch queued jobs while slots are free. A job waits until the
+ * previous job for the same service is done.
+ */
+static void pump(service_batch_t *batch) {
+    if (!batch->started) return;
+    if (batch->pumping) {
+        batch->repump = true;
+        return;
+    }
+
+    batch->pumping = true;
+    do {
+        batch->repump = false;
+        batch->busy = false;
+
+        int total = batch->progress.total;
+        for (int i = batch->next_queued;
+             i < total && batch->progress.running < batch->max_parallel &&
+             !batch->release && !batch->busy;
+             i++) {
+            batch_job_t *job = &batch->jobs[i];
+            if (job->state != JOB_QUEUED) continue;
+            if (job->prev_same >= 0 && batch->jobs[job->prev_same].state != JOB_DONE) continue;
+            dispatch(batch, i);
+        }
+
+        while (batch->next_queued < total && batch->jobs[batch->next_queued].state != JOB_QUEUED) {
+            batch->next_queued++;
+        }
+    } while (batch->repump);
+    batch->pumping = false;
+
+    /* Our own completions pump again; with none in flight, poll */
+    if (batch->busy && batch->progress.running == 0) {
+        uloop_timeout_set(&batch->retry, RETRY_MS);
+    }
+}
+
+service_batch_t *service_batch_create(sys_status_ctx_t *ctx, sys_status_t *status,
+                                      int max_parallel,
+                                      service_batch_progress_cb cb, void *priv) {
+    if (!status) return NULL;
+
+    service_batch_t *batch = calloc(1, sizeof(*batch));
+    if (!batch) return NULL;
+
+    if (max_parallel < 1) {
+        max_parallel = service_config_get()->batch_parallel;
+    }
+
+    batch->ctx = ctx;
+    batch->status = status;
+    batch->max_parallel = max_parallel > 0 ? max_parallel : 1;
+    batch->cb = cb;
+    batch->priv = priv;
+    batch->retry.cb = retry_cb;
+    return batch;
+}
+
+int service_batch_add(service_batch_t *batch, const char *name, ubus_hal_action_t action) {
+    if (!batch || !name || batch->release) return -1;
+
+    int key = service_config_find(&batch->names, name);
+    if (key < 0) {
+        /* Room for the new key first: a name is never left without a slot */
+        int *last_job = realloc(batch->last_job, (batch->names.count + 1) * sizeof(*last_job));
+        if (!last_job) return -1;
+        batch->last_job = last_job;
+
+        key = service_config_add(&batch->names, name);
+        if (key < 0) return -1;
+        batch->last_job[key] = -1;
+    }
+
+    int i = batch->progress.total;
+    if (i == batch->job_capacity) {
+        int capacity = batch->job_capacity ? batch->job_capacity * 2 : INITIAL_JOBS;
+        batch_job_t *jobs = realloc(batch->jobs, (size_t)capacity * sizeof(*jobs));
+        if (!jobs) return -1;
+        batch->jobs = jobs;
+        batch->job_capacity = capacity;
+    }
+
+    batch_job_t *job = &batch->jobs[i];
+    memcpy(job->name, batch->names.services[key].name, sizeof(job->name));
+    job->action = action;
+    job->prev_same = batch->last_job[key];
+    job->state = JOB_QUEUED;
+    batch->last_job[key] = i;
+    batch->progress.total++;
+
+    pump(batch);
+    return i;
+}
+
+int service_batch_add_all(service_batch_t *batch, ubus_hal_action_t action) {
+    if (!batch) return 0;
+
+    int added = 0;
+    for (size_t i = 0; i < batch->status->service_count; i++) {
+        if (service_batch_add(batch, batch->status->services[i].name, action) >= 0) {
+            added++;
+        }
+    }
+    return added;
+}
+
+int service_batch_start(service_batch_t *batch) {
+    if (!batch || batch->started) return -1;
+
+    batch->started = true;
+    pump(batch);
+    notify(batch);
+    return 0;
+}
+
+void service_batch_cancel(service_batch_t *batch) {
+    if (!batch) return;
+
+    for (int i = batch->next_queued; i < batch->progress.total; i++) {
+        if (batch->jobs[i].state == JOB_QUEUED) {
+            finish_job(batch, &batch->jobs[i], false);
+        }
+    }
+    batch->next_queued = batch->progress.total;
+    notify(batch);
+}
+
+const service_batch_progress_t *service_batch_get_progress(const service_batch_t *batch) {
+    return batch ? &batch->progress : NULL;
+}
+
+bool service_batch_is_done(const service_batch_t *batch) {
+    return !batch || batch->progress.done == batch->progress.total;
+}
+
+void service_batch_free(service_batch_t *batch) {
+    if (!batch) return;
+
+    if (batch->progress.running > 0) {
+        service_batch_cancel(batch);
+        batch->release = true;
+        return;
+    }
+    destroy(batch);
+}
@@ -0,0 +1,83 @@
+/*
+ * Batched service control for NanoHat OLED
+ *
+ * Runs start/stop/restart for a set of services (e.g. "restart all
+ * monitored") through sys_status_control_service_action(), with at most
+ * max_parallel rc init calls in flight.
+ *
+ * Jobs for the same service run strictly in the order they were added;
+ * jobs for different services run in parallel. Progress is reported from
+ * the completion callbacks, so the UI never has to poll.
+ */
+#ifndef SERVICE_BATCH_H
+#define SERVICE_BATCH_H
+
+#include <stdbool.h>
+
+#include "sys_status.h"
+
+typedef struct {
+    int total;      /* Jobs added */
+    int done;       /* Jobs finished (success, failure or cancelled) */
+    int failed;     /* Subset of done that did not succeed */
+    int running;    /* Jobs in flight */
+} service_batch_progress_t;
+
+/*
+ * Progress callback, invoked after start and after every completed job.
+ * Do not free the batch from inside the callback.
+ */
+typedef void (*service_batch_progress_cb)(const service_batch_progress_t *progress,
+                                          void *priv);
+
+typedef struct service_batch service_batch_t;
+
+/*
+ * Create an empty batch.
+ * max_parallel < 1 uses service_config batch_parallel.
+ */
+service_batch_t *service_batch_create(sys_status_ctx_t *ctx, sys_status_t *status,
+                                      int max_parallel,
+                                      service_batch_progress_cb cb, void *priv);
+
+/*
+ * Queue an action for a service (by name).
+ * Returns job index, or -1 on error.
+ */
+int service_batch_add(service_batch_t *batch, const char *name, ubus_hal_action_t action);
+
+/*
+ * Queue an action for every monitored service, in config order.
+ * Returns number of jobs added.
+ */
+int service_batch_add_all(service_batch_t *batch, ubus_hal_action_t action);
+
+/*
+ * Start dispatching. Jobs added later are picked up as slots free up; a
+ * job ubus has no slot for (UBUS_HAL_BUSY) stays queued and is retried.
+ * Returns 0 on success, -1 on error.
+ */
+int service_batch_start(service_batch_t *batch);
+
+/*
+ * Drop queued jobs (counted as failed); jobs in flight still complete.
+ */
+void service_batch_cancel(service_batch_t *batch);
+
+/*
+ * Current aggregated progress.
+ */
+const service_batch_progress_t *service_batch_get_progress(const service_batch_t *batch);
+
+/*
+ * True once every job has finished.
+ */
+bool service_batch_is_done(const service_batch_t *batch);
+
+/*
+ * Free batch. If jobs are still in flight, queued jobs are cancelled and
+ * the memory is released when the last completion arrives.
+ */
+void service_batch_free(service_batch_t *batch);
+
+#endif
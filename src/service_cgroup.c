@@ -0,0 +1,218 @@
+#include "service_cgroup.h"
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef struct {
+    int cpu_fd;                 /* cpu.stat, -1 = closed */
+    int mem_fd;                 /* memory.current, -1 = closed */
+    uint64_t prev_usage_usec;
+    uint64_t prev_ms;           /* 0 = no previous CPU sample */
+    uint64_t retry_ms;          /* Earliest time to (re)open the group */
+} cg_entry_t;
+
+struct service_cgroup {
+    char root[128];
+    int root_fd;                /* -1 = cgroup root not available */
+    uint64_t root_retry_ms;
+
+    /* Same order as status->services */
+    cg_entry_t *entries;
+    size_t count;
+    uint32_t generation;
+
+    uint64_t last_sample_ms;
+    long ncpu;
+};
+
+static void close_entry(cg_entry_t *e) {
+    if (e->cpu_fd >= 0) close(e->cpu_fd);
+    if (e->mem_fd >= 0) close(e->mem_fd);
+    e->cpu_fd = -1;
+    e->mem_fd = -1;
+    e->prev_ms = 0;
+}
+
+static void close_entries(service_cgroup_t *cg) {
+    for (size_t i = 0; i < cg->count; i++) {
+        close_entry(&cg->entries[i]);
+    }
+}
+
+service_cgroup_t *service_cgroup_init(const char *root) {
+    service_cgroup_t *cg = calloc(1, sizeof(*cg));
+    if (!cg) return NULL;
+
+    snprintf(cg->root, sizeof(cg->root), "%s", root ? root : SERVICE_CGROUP_ROOT);
+    cg->root_fd = -1;
+
+    cg->ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cg->ncpu < 1) cg->ncpu = 1;
+
+    return cg;
+}
+
+void service_cgroup_cleanup(service_cgroup_t *cg) {
+    if (!cg) return;
+
+    close_entries(cg);
+    free(cg->entries);
+    if (cg->root_fd >= 0) close(cg->root_fd);
+    free(cg);
+}
+
+/* Rebuild descriptor table when the service list was reloaded */
+static int sync_entries(service_cgroup_t *cg, const sys_status_t *status) {
+    if (cg->count == status->service_count && cg->generation == status->service_generation) {
+        return 0;
+    }
+
+    close_entries(cg);
+
+    cg_entry_t *entries = NULL;
+    if (status->service_count > 0) {
+        entries = realloc(cg->entries, status->service_count * sizeof(*entries));
+        if (!entries) return -1;
+    } else {
+        free(cg->entries);
+    }
+
+    for (size_t i = 0; i < status->service_count; i++) {
+        memset(&entries[i], 0, sizeof(entries[i]));
+        entries[i].cpu_fd = -1;
+        entries[i].mem_fd = -1;
+    }
+
+    cg->entries = entries;
+    cg->count = status->service_count;
+    cg->generation = status->service_generation;
+    return 0;
+}
+
+static int open_entry(service_cgroup_t *cg, cg_entry_t *e, const char *name) {
+    int dir_fd = openat(cg->root_fd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd < 0) return -1;
+
+    e->cpu_fd = openat(dir_fd, "cpu.stat", O_RDONLY | O_CLOEXEC);
+    /* memory.current only exists if the memory controller is enabled */
+    e->mem_fd = openat(dir_fd, "memory.current", O_RDONLY | O_CLOEXEC);
+    close(dir_fd);
+
+    if (e->cpu_fd < 0 && e->mem_fd < 0) return -1;
+    e->prev_ms = 0;
+    return 0;
+}
+
+/*
+ * Re-read a cgroup file from offset 0 and parse an unsigned value.
+ * key: line prefix to look for (e.g. "usage_usec"), NULL for single-value files.
+ */
+static int read_u64(int fd, const char *key, uint64_t *value) {
+    char buf[512];
+    ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) return -1;
+    buf[n] = '\0';
+
+    const char *p = buf;
+    if (key) {
+        size_t key_len = strlen(key);
+        while (p && !(strncmp(p, key, key_len) == 0 && p[key_len] == ' ')) {
+            p = strchr(p, '\n');
+            if (p) p++;
+        }
+        if (!p) return -1;
+        p += key_len + 1;
+    }
+
+    return sscanf(p, "%" SCNu64, value) == 1 ? 0 : -1;
+}
+
+static bool sample_entry(service_cgroup_t *cg, cg_entry_t *e, service_status_t *svc,
+                         uint64_t now_ms) {
+    bool ok = true;
+
+    if (e->cpu_fd >= 0) {
+        uint64_t usage_usec;
+        if (read_u64(e->cpu_fd, "usage_usec", &usage_usec) == 0) {
+            if (e->prev_ms > 0 && now_ms > e->prev_ms && usage_usec >= e->prev_usage_usec) {
+                /* Share of total CPU time over the interval */
+                double busy_us = (double)(usage_usec - e->prev_usage_usec);
+                double wall_us = (double)(now_ms - e->prev_ms) * 1000.0 * (double)cg->ncpu;
+                svc->cpu_percent = (float)(busy_us * 100.0 / wall_us);
+            } else {
+                svc->cpu_percent = 0.0f;
+            }
+            e->prev_usage_usec = usage_usec;
+            e->prev_ms = now_ms;
+        } else {
+            ok = false;
+        }
+    }
+
+    if (ok && e->mem_fd >= 0) {
+        if (read_u64(e->mem_fd, NULL, &svc->mem_bytes) != 0) {
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+static void clear_usage(service_status_t *svc) {
+    svc->usage_valid = false;
+    svc->cpu_percent = 0.0f;
+    svc->mem_bytes = 0;
+}
+
+int service_cgroup_sample(service_cgroup_t *cg, sys_status_t *status, uint64_t now_ms) {
+    if (!cg || !status) return -1;
+
+    if (cg->last_sample_ms > 0 && now_ms - cg->last_sample_ms < SERVICE_USAGE_INTERVAL_MS) {
+        return -1;
+    }
+    cg->last_sample_ms = now_ms;
+
+    if (sync_entries(cg, status) < 0) return -1;
+
+    if (cg->root_fd < 0 && now_ms >= cg->root_retry_ms) {
+        cg->root_fd = open(cg->root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (cg->root_fd < 0) {
+            cg->root_retry_ms = now_ms + SERVICE_CGROUP_RETRY_MS;
+        }
+    }
+
+    int valid = 0;
+    for (size_t i = 0; i < cg->count; i++) {
+        cg_entry_t *e = &cg->entries[i];
+        service_status_t *svc = &status->services[i];
+
+        if (e->cpu_fd < 0 && e->mem_fd < 0) {
+            bool opened = false;
+            if (cg->root_fd >= 0 && now_ms >= e->retry_ms) {
+                opened = open_entry(cg, e, svc->name) == 0;
+                if (!opened) e->retry_ms = now_ms + SERVICE_CGROUP_RETRY_MS;
+            }
+            if (!opened) {
+                clear_usage(svc);
+                continue;
+            }
+        }
+
+        if (sample_entry(cg, e, svc, now_ms)) {
+            svc->usage_valid = true;
+            valid++;
+        } else {
+            /* Group removed (service stopped): reopen later */
+            close_entry(e);
+            e->retry_ms = now_ms + SERVICE_CGROUP_RETRY_MS;
+            clear_usage(svc);
+        }
+    }
+
+    status->usage_seq++;
+    return valid;
+}
@@ -0,0 +1,50 @@
+/*
+ * Per-service resource usage from procd cgroups (cgroup v2)
+ *
+ * procd places every service in SERVICE_CGROUP_ROOT/<service>/<instance>.
+ * The service-level group aggregates its instances, so cpu.stat
+ * (usage_usec) and memory.current are read there.
+ *
+ * File descriptors are opened once and re-read with pread(); a refresh is a
+ * single batched pass over all services (no open() per service per frame).
+ * Groups that do not exist (service stopped, old procd) are retried at
+ * most every SERVICE_CGROUP_RETRY_MS.
+ */
+#ifndef SERVICE_CGROUP_H
+#define SERVICE_CGROUP_H
+
+#include <stdint.h>
+
+#include "sys_status.h"
+
+#ifndef SERVICE_CGROUP_ROOT
+#define SERVICE_CGROUP_ROOT "/sys/fs/cgroup/services"
+#endif
+
+/* Sampling interval for CPU/memory usage (ms) */
+#define SERVICE_USAGE_INTERVAL_MS 2000
+
+/* Retry interval for missing cgroups (ms) */
+#define SERVICE_CGROUP_RETRY_MS   10000
+
+typedef struct service_cgroup service_cgroup_t;
+
+/*
+ * Create collector for cgroups below root (NULL = SERVICE_CGROUP_ROOT).
+ */
+service_cgroup_t *service_cgroup_init(const char *root);
+
+/*
+ * Close all descriptors and free collector.
+ */
+void service_cgroup_cleanup(service_cgroup_t *cg);
+
+/*
+ * Sample every service in status->services in one pass and update
+ * usage_valid, cpu_percent and mem_bytes. Rate-limited to
+ * SERVICE_USAGE_INTERVAL_MS; bumps status->usage_seq when a pass ran.
+ * Returns number of services with valid usage, or -1 if skipped.
+ */
+int service_cgroup_sample(service_cgroup_t *cg, sys_status_t *status, uint64_t now_ms);
+
+#endif
@@ -1,38 +1,134 @@
 #include "service_config.h"
+
+#include <ctype.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+
+#define INITIAL_CAPACITY    8
+#define INITIAL_INDEX_SIZE  16
+#define UCI_SECTION_TYPE    "services"
 
 static service_config_t g_config;
 static int g_initialized = 0;
+static const char *g_path = SERVICE_CONFIG_PATH;
+static const char *g_initd_path = SERVICE_INITD_PATH;
 
-void service_config_init(service_config_t *config) {
-    if (!config) {
-        config = &g_config;
+/* FNV-1a, good enough for short service names */
+static uint32_t hash_name(const char *name) {
+    uint32_t h = 2166136261u;
+    while (*name) {
+        h ^= (uint8_t)*name++;
+        h *= 16777619u;
     }
+    return h;
+}
 
-    memset(config, 0, sizeof(*config));
+static bool valid_name(const char *name, size_t len) {
+    if (len == 0 || len >= SERVICE_NAME_MAX_LEN) return false;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)name[i];
+        if (!isalnum(c) && c != '_' && c != '-' && c != '.') return false;
+    }
+    return true;
+}
 
-    const char *services_str = MONITORED_SERVICES;
-    if (!services_str || !services_str[0]) {
-        g_initialized = 1;
-        return;
+static void index_insert(int32_t *index, size_t size, const char *name, int32_t entry) {
+    size_t mask = size - 1;
+    size_t slot = hash_name(name) & mask;
+    while (index[slot] >= 0) {
+        slot = (slot + 1) & mask;
     }
+    index[slot] = entry;
+}
 
-    char buf[256];
-    strncpy(buf, services_str, sizeof(buf) - 1);
-    buf[sizeof(buf) - 1] = '\0';
+static int index_resize(service_config_t *config, size_t size) {
+    int32_t *index = malloc(size * sizeof(*index));
+    if (!index) return -1;
 
-    char *saveptr = NULL;
-    char *token = strtok_r(buf, ",", &saveptr);
+    for (size_t i = 0; i < size; i++) index[i] = -1;
+    for (size_t i = 0; i < config->count; i++) {
+        index_insert(index, size, config->services[i].name, (int32_t)i);
+    }
 
-    while (token && config->count < MAX_MONITORED_SERVICES) {
-        /* Skip leading whitespace */
-        while (*token == ' ' || *token == '\t') token++;
+    free(config->index);
+    config->index = index;
+    config->index_size = size;
+    return 0;
+}
 
-        /* Skip empty tokens */
-        if (*token == '\0') {
-            token = strtok_r(NULL, ",", &saveptr);
-            continue;
+int service_config_find(const service_config_t *config, const char *name) {
+    if (!config || !name || !config->index || config->index_size == 0) return -1;
+
+    size_t mask = config->index_size - 1;
+    size_t slot = hash_name(name) & mask;
+    while (config->index[slot] >= 0) {
+        int32_t entry = config->index[slot];
+        if (strcmp(config->services[entry].name, name) == 0) {
+            return entry;
         }
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+int service_config_add(service_config_t *config, const char *name) {
+    if (!config || !name) return -1;
+
+    size_t len = strlen(name);
+    if (!valid_name(name, len)) return -1;
+    if (service_config_find(config, name) >= 0) return -1;
+    if (config->count >= SERVICE_MAX_COUNT) return -1;
+
+    if (config->count == config->capacity) {
+        size_t capacity = config->capacity ? config->capacity * 2 : INITIAL_CAPACITY;
+        service_entry_t *services = realloc(config->services, capacity * sizeof(*services));
+        if (!services) return -1;
+        config->services = services;
+        config->capacity = capacity;
+    }
+
+    /* Keep load factor <= 0.5 so probe chains stay short */
+    if ((config->count + 1) * 2 > config->index_size) {
+        size_t size = config->index_size ? config->index_size * 2 : INITIAL_INDEX_SIZE;
+        if (index_resize(config, size) < 0) return -1;
+    }
+
+    int32_t entry = (int32_t)config->count;
+    memcpy(config->services[entry].name, name, len + 1);
+    index_insert(config->index, config->index_size, name, entry);
+    config->count++;
+    return entry;
+}
+
+void service_config_free(service_config_t *config) {
+    if (!config) return;
+
+    free(config->services);
+    free(config->index);
+    config->services = NULL;
+    config->index = NULL;
+    config->count = 0;
+    config->capacity = 0;
+    config->index_size = 0;
+    config->monitor_all = false;
+}
+
+/* Parse comma separated list (MONITORED_SERVICES format) */
+static void parse_list(service_config_t *config, const char *list) {
+    if (!list || !list[0]) return;
+
+    char *buf = strdup(list);
+    if (!buf) return;
+
+    char *saveptr = NULL;
+    for (char *token = strtok_r(buf, ",", &saveptr); token;
+         token = strtok_r(NULL, ",", &saveptr)) {
+        /* Skip leading whitespace */
+        while (*token == ' ' || *token == '\t') token++;
 
         /* Remove trailing whitespace */
         size_t len = strlen(token);
@@ -40,19 +136,161 @@ void service_config_init(service_config_t *config) {
             token[--len] = '\0';
         }
 
-        if (len > 0 && len < SERVICE_NAME_MAX_LEN) {
-            strncpy(config->services[config->count].name, token, SERVICE_NAME_MAX_LEN - 1);
-            config->services[config->count].name[SERVICE_NAME_MAX_LEN - 1] = '\0';
-            config->count++;
+        service_config_add(config, token);
+    }
+
+    free(buf);
+}
+
+/*
+ * Split next UCI token in place. Handles '...' and "..." quoting.
+ * Returns NULL at end of line or at a comment.
+ */
+static char *next_token(char **cursor) {
+    char *p = *cursor;
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p == '\0' || *p == '\n' || *p == '#') return NULL;
+
+    char *start;
+    if (*p == '\'' || *p == '"') {
+        char quote = *p++;
+        start = p;
+        while (*p && *p != quote) p++;
+    } else {
+        start = p;
+        while (*p && *p != ' ' && *p != '\t' && *p != '\n') p++;
+    }
+
+    if (*p) *p++ = '\0';
+    *cursor = p;
+    return start;
+}
+
+static bool parse_bool(const char *value) {
+    return strcmp(value, "1") == 0 || strcmp(value, "true") == 0 ||
+           strcmp(value, "yes") == 0 || strcmp(value, "on") == 0 ||
+           strcmp(value, "enabled") == 0;
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp((const char *)a, (const char *)b);
+}
+
+/* Add every executable init script (sorted) that is not excluded */
+static void scan_initd(service_config_t *config, const service_config_t *exclude) {
+    DIR *dir = opendir(g_initd_path);
+    if (!dir) return;
+
+    service_entry_t *names = NULL;
+    size_t count = 0, capacity = 0;
+
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL && count < SERVICE_MAX_COUNT) {
+        size_t len = strlen(de->d_name);
+        if (de->d_name[0] == '.') continue;
+        if (!valid_name(de->d_name, len)) continue;
+
+        struct stat st;
+        if (fstatat(dirfd(dir), de->d_name, &st, 0) != 0) continue;
+        if (!S_ISREG(st.st_mode) || !(st.st_mode & S_IXUSR)) continue;
+
+        if (count == capacity) {
+            size_t next = capacity ? capacity * 2 : 64;
+            service_entry_t *grown = realloc(names, next * sizeof(*grown));
+            if (!grown) break;
+            names = grown;
+            capacity = next;
+        }
+        memcpy(names[count].name, de->d_name, len + 1);
+        count++;
+    }
+    closedir(dir);
+
+    /* readdir order is arbitrary; keep the list stable across reloads */
+    if (count > 1) {
+        qsort(names, count, sizeof(*names), compare_names);
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (service_config_find(exclude, names[i].name) < 0) {
+            service_config_add(config, names[i].name);
+        }
+    }
+    free(names);
+}
+
+int service_config_load(service_config_t *config, const char *path) {
+    if (!config) return -1;
+
+    memset(config, 0, sizeof(*config));
+    config->batch_parallel = SERVICE_BATCH_PARALLEL;
+
+    FILE *fp = path ? fopen(path, "r") : NULL;
+    if (!fp) {
+        parse_list(config, MONITORED_SERVICES);
+        return -1;
+    }
+
+    service_config_t exclude;
+    memset(&exclude, 0, sizeof(exclude));
+
+    char line[256];
+    bool in_section = false;
+    while (fgets(line, sizeof(line), fp)) {
+        char *cursor = line;
+        char *keyword = next_token(&cursor);
+        if (!keyword) continue;
+
+        char *key = next_token(&cursor);
+        char *value = key ? next_token(&cursor) : NULL;
+
+        if (strcmp(keyword, "config") == 0) {
+            in_section = key && strcmp(key, UCI_SECTION_TYPE) == 0;
+            continue;
+        }
+        if (!in_section || !key || !value) continue;
+
+        if (strcmp(keyword, "option") == 0) {
+            if (strcmp(key, "monitor_all") == 0) {
+                config->monitor_all = parse_bool(value);
+            } else if (strcmp(key, "batch_parallel") == 0) {
+                int n = atoi(value);
+                if (n < 1) n = 1;
+                if (n > SERVICE_BATCH_PARALLEL_MAX) n = SERVICE_BATCH_PARALLEL_MAX;
+                config->batch_parallel = n;
+            }
+        } else if (strcmp(keyword, "list") == 0) {
+            if (strcmp(key, "service") == 0) {
+                service_config_add(config, value);
+            } else if (strcmp(key, "exclude") == 0) {
+                service_config_add(&exclude, value);
+            }
         }
+    }
+    fclose(fp);
+
+    if (config->monitor_all) {
+        scan_initd(config, &exclude);
+    }
+
+    service_config_free(&exclude);
+    return 0;
+}
 
-        token = strtok_r(NULL, ",", &saveptr);
+void service_config_init(service_config_t *config) {
+    if (!config) {
+        config = &g_config;
     }
 
-    if (config != &g_config) {
-        g_config = *config;
+    if (config == &g_config && g_initialized) {
+        service_config_free(&g_config);
+    }
+
+    service_config_load(config, g_path);
+
+    if (config == &g_config) {
+        g_config.generation = 1;
+        g_initialized = 1;
     }
-    g_initialized = 1;
 }
 
 const service_config_t *service_config_get(void) {
@@ -61,3 +299,28 @@ const service_config_t *service_config_get(void) {
     }
     return &g_config;
 }
+
+int service_config_reload(void) {
+    if (!g_initialized) {
+        service_config_init(&g_config);
+        return g_config.count > 0 ? 0 : -1;
+    }
+
+    /* Build the new table aside so readers never see a half-loaded one */
+    service_config_t next;
+    int ret = service_config_load(&next, g_path);
+
+    uint32_t generation = g_config.generation + 1;
+    service_config_free(&g_config);
+    g_config = next;
+    g_config.generation = generation;
+    return ret;
+}
+
+void service_config_set_path(const char *path) {
+    g_path = path ? path : SERVICE_CONFIG_PATH;
+}
+
+void service_config_set_initd_path(const char *path) {
+    g_initd_path = path ? path : SERVICE_INITD_PATH;
+}
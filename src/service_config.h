@@ -1,40 +1,117 @@
 /*
  * Service configuration for NanoHat OLED
  *
- * Services are configured at compile time via MONITORED_SERVICES macro.
+ * Services are loaded at runtime from a UCI file (SERVICE_CONFIG_PATH):
+ *
+ *   config services 'services'
+ *       option monitor_all '0'
+ *       list service 'dropbear'
+ *       list service 'uhttpd'
+ *       list exclude 'boot'
+ *       option batch_parallel '4'
+ *
+ * With monitor_all enabled every init script in SERVICE_INITD_PATH is
+ * monitored (except excluded ones). If the file is missing, the compile-time
+ * MONITORED_SERVICES macro is used instead.
  * Example: make MONITORED_SERVICES="xray_core,dropbear,uhttpd"
+ *
+ * The table is sized dynamically and indexed by a name -> index hash.
+ * service_config_reload() re-reads the file (SIGHUP) and bumps generation
+ * so that consumers can resync.
  */
 #ifndef SERVICE_CONFIG_H
 #define SERVICE_CONFIG_H
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
-#define MAX_MONITORED_SERVICES 8
 #define SERVICE_NAME_MAX_LEN   32
+#define SERVICE_MAX_COUNT      1024  /* Sanity cap for monitor_all */
+
+/* Concurrent rc init calls for batch control (service_batch.c) */
+#define SERVICE_BATCH_PARALLEL      4
+#define SERVICE_BATCH_PARALLEL_MAX  16
 
 #ifndef MONITORED_SERVICES
 #define MONITORED_SERVICES "xray_core,collectd,luci_statistics,dropbear,uhttpd"
 #endif
 
+#ifndef SERVICE_CONFIG_PATH
+#define SERVICE_CONFIG_PATH "/etc/config/nanohat-oled"
+#endif
+
+#ifndef SERVICE_INITD_PATH
+#define SERVICE_INITD_PATH "/etc/init.d"
+#endif
+
 typedef struct {
     char name[SERVICE_NAME_MAX_LEN];
 } service_entry_t;
 
 typedef struct {
-    service_entry_t services[MAX_MONITORED_SERVICES];
+    service_entry_t *services;  /* Dynamic array, config order */
     size_t count;
+    size_t capacity;
+    int32_t *index;             /* Open-addressing hash: slot -> entry index, -1 = empty */
+    size_t index_size;          /* Power of two */
+    bool monitor_all;
+    int batch_parallel;         /* Batch control concurrency limit */
+    uint32_t generation;        /* Bumped on every (re)load of the global table */
 } service_config_t;
 
 /*
- * Initialize service config by parsing MONITORED_SERVICES string.
+ * Initialize service config from SERVICE_CONFIG_PATH, falling back to
+ * MONITORED_SERVICES. Pass NULL to initialize the global table.
  * Call once at startup.
  */
 void service_config_init(service_config_t *config);
 
+/*
+ * Load config from a UCI file into an uninitialized table.
+ * Returns 0 if the file was parsed, -1 if it could not be opened
+ * (table then holds the MONITORED_SERVICES fallback).
+ */
+int service_config_load(service_config_t *config, const char *path);
+
+/*
+ * Release memory held by a table.
+ */
+void service_config_free(service_config_t *config);
+
+/*
+ * Append a service name. Duplicates and invalid names are ignored.
+ * Returns entry index, or -1 if not added.
+ */
+int service_config_add(service_config_t *config, const char *name);
+
+/*
+ * Look up a service by name (O(1) average).
+ * Returns entry index, or -1 if not configured.
+ */
+int service_config_find(const service_config_t *config, const char *name);
+
 /*
  * Get the global service configuration.
- * Returns NULL if not initialized.
+ * Lazily initialized on first call.
  */
 const service_config_t *service_config_get(void);
 
+/*
+ * Re-read the global configuration (e.g. on SIGHUP) and bump generation.
+ * Returns 0 if the config file was read, -1 if the MONITORED_SERVICES
+ * fallback is in effect.
+ */
+int service_config_reload(void);
+
+/*
+ * Override the config file path used by init/reload (NULL restores default).
+ */
+void service_config_set_path(const char *path);
+
+/*
+ * Override the init script directory scanned by monitor_all (NULL restores default).
+ */
+void service_config_set_initd_path(const char *path);
+
 #endif
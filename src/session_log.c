@@ -0,0 +1,330 @@
+#include "session_log.h"
+
+#include <string.h>
+
+#include "hal/time_hal.h"
+
+#define SESSION_LOG_MAGIC  "NHSL"
+#define RECORD_MAX_BYTES   256
+
+static FILE *g_fp;
+static uint64_t g_time_us;      /* Time of the last record written */
+static size_t g_bytes;
+static bool g_full;
+
+/* Encoding */
+
+typedef struct {
+    uint8_t data[RECORD_MAX_BYTES];
+    size_t len;
+} rec_buf_t;
+
+static void put_byte(rec_buf_t *buf, uint8_t value) {
+    if (buf->len < sizeof(buf->data)) {
+        buf->data[buf->len++] = value;
+    }
+}
+
+static void put_varint(rec_buf_t *buf, uint64_t value) {
+    while (value >= 0x80) {
+        put_byte(buf, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    put_byte(buf, (uint8_t)value);
+}
+
+static void put_svarint(rec_buf_t *buf, int64_t value) {
+    put_varint(buf, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+static void put_float(rec_buf_t *buf, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 4; i++) {
+        put_byte(buf, (uint8_t)(bits >> (8 * i)));
+    }
+}
+
+static void put_string(rec_buf_t *buf, const char *str) {
+    size_t len = strnlen(str, 255);
+    put_byte(buf, (uint8_t)len);
+    for (size_t i = 0; i < len; i++) {
+        put_byte(buf, (uint8_t)str[i]);
+    }
+}
+
+static void begin_record(rec_buf_t *buf, session_rec_type_t type, uint64_t time_us) {
+    buf->len = 0;
+    put_byte(buf, (uint8_t)type);
+    put_svarint(buf, (int64_t)(time_us - g_time_us));
+    g_time_us = time_us;
+}
+
+static void write_record(const rec_buf_t *buf) {
+    if (g_bytes + buf->len > SESSION_LOG_MAX_BYTES) {
+        if (!g_full) {
+            g_full = true;
+            fprintf(stderr, "WARN: session log full, recording stopped\n");
+        }
+        return;
+    }
+    if (fwrite(buf->data, 1, buf->len, g_fp) == buf->len) {
+        g_bytes += buf->len;
+    }
+}
+
+/* Recording */
+
+int session_log_open(const char *path) {
+    session_log_close();
+
+    g_fp = fopen(path, "wb");
+    if (!g_fp) return -1;
+
+    g_time_us = 0;
+    g_full = false;
+    g_bytes = fwrite(SESSION_LOG_MAGIC, 1, 4, g_fp);
+    uint8_t version = SESSION_LOG_VERSION;
+    g_bytes += fwrite(&version, 1, 1, g_fp);
+    return 0;
+}
+
+void session_log_close(void) {
+    if (g_fp) {
+        fclose(g_fp);
+        g_fp = NULL;
+    }
+}
+
+bool session_log_active(void) {
+    return g_fp != NULL && !g_full;
+}
+
+void session_log_gpio_edge(int line, bool pressed, uint64_t timestamp_ns) {
+    if (!session_log_active()) return;
+
+    rec_buf_t buf;
+    begin_record(&buf, SESSION_REC_GPIO_EDGE, timestamp_ns / 1000ULL);
+    put_byte(&buf, (uint8_t)((line & 0x7f) | (pressed ? 0x80 : 0)));
+    write_record(&buf);
+}
+
+void session_log_ubus_query(const char *service, bool installed, bool running,
+                            int status, uint32_t latency_ms) {
+    if (!session_log_active() || !service) return;
+
+    rec_buf_t buf;
+    begin_record(&buf, SESSION_REC_UBUS_QUERY, time_hal_now_ns() / 1000ULL);
+    put_byte(&buf, (uint8_t)((installed ? 1 : 0) | (running ? 2 : 0)));
+    put_svarint(&buf, status);
+    put_varint(&buf, latency_ms);
+    put_string(&buf, service);
+    write_record(&buf);
+}
+
+void session_log_proc(const sys_status_t *status) {
+    if (!session_log_active() || !status) return;
+
+    session_proc_t proc;
+    session_proc_from_status(&proc, status);
+
+    rec_buf_t buf;
+    begin_record(&buf, SESSION_REC_PROC_SAMPLE, time_hal_now_ns() / 1000ULL);
+    put_float(&buf, proc.cpu_usage);
+    put_float(&buf, proc.cpu_temp);
+    put_varint(&buf, proc.mem_total_kb);
+    put_varint(&buf, proc.mem_available_kb);
+    put_varint(&buf, proc.uptime_sec);
+    put_string(&buf, proc.hostname);
+    put_string(&buf, proc.ip_addr);
+    put_string(&buf, proc.gateway);
+    put_varint(&buf, proc.rx_bytes);
+    put_varint(&buf, proc.tx_bytes);
+    put_varint(&buf, proc.rx_speed);
+    put_varint(&buf, proc.tx_speed);
+    write_record(&buf);
+}
+
+void session_log_timer(uint64_t due_ms, uint64_t fired_ms) {
+    if (!session_log_active()) return;
+
+    uint64_t now_us = time_hal_now_ns() / 1000ULL;
+    uint64_t late_us = (fired_ms > due_ms) ? (fired_ms - due_ms) * 1000ULL : 0;
+    if (late_us > UINT32_MAX) late_us = UINT32_MAX;
+
+    rec_buf_t buf;
+    begin_record(&buf, SESSION_REC_TIMER, now_us);
+    put_varint(&buf, late_us);
+    write_record(&buf);
+}
+
+void session_proc_from_status(session_proc_t *proc, const sys_status_t *status) {
+    memset(proc, 0, sizeof(*proc));
+    proc->cpu_usage = status->cpu_usage;
+    proc->cpu_temp = status->cpu_temp;
+    proc->mem_total_kb = status->mem_total_kb;
+    proc->mem_available_kb = status->mem_available_kb;
+    proc->uptime_sec = status->uptime_sec;
+    memcpy(proc->hostname, status->hostname, sizeof(proc->hostname));
+    memcpy(proc->ip_addr, status->ip_addr, sizeof(proc->ip_addr));
+    memcpy(proc->gateway, status->gateway, sizeof(proc->gateway));
+    proc->rx_bytes = status->rx_bytes;
+    proc->tx_bytes = status->tx_bytes;
+    proc->rx_speed = status->rx_speed;
+    proc->tx_speed = status->tx_speed;
+}
+
+void session_proc_to_status(const session_proc_t *proc, sys_status_t *status) {
+    status->cpu_usage = proc->cpu_usage;
+    status->cpu_temp = proc->cpu_temp;
+    status->mem_total_kb = proc->mem_total_kb;
+    status->mem_available_kb = proc->mem_available_kb;
+    status->uptime_sec = proc->uptime_sec;
+    memcpy(status->hostname, proc->hostname, sizeof(status->hostname));
+    memcpy(status->ip_addr, proc->ip_addr, sizeof(status->ip_addr));
+    memcpy(status->gateway, proc->gateway, sizeof(status->gateway));
+    status->rx_bytes = proc->rx_bytes;
+    status->tx_bytes = proc->tx_bytes;
+    status->rx_speed = proc->rx_speed;
+    status->tx_speed = proc->tx_speed;
+}
+
+/* Decoding */
+
+static int get_byte(session_reader_t *reader, uint8_t *value) {
+    int c = fgetc(reader->fp);
+    if (c == EOF) return -1;
+    *value = (uint8_t)c;
+    return 0;
+}
+
+static int get_varint(session_reader_t *reader, uint64_t *value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t b;
+        if (get_byte(reader, &b) < 0) return -1;
+        *value |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return 0;
+    }
+    return -1;
+}
+
+static int get_svarint(session_reader_t *reader, int64_t *value) {
+    uint64_t raw;
+    if (get_varint(reader, &raw) < 0) return -1;
+    *value = (int64_t)(raw >> 1) ^ -(int64_t)(raw & 1);
+    return 0;
+}
+
+static int get_float(session_reader_t *reader, float *value) {
+    uint32_t bits = 0;
+    for (int i = 0; i < 4; i++) {
+        uint8_t b;
+        if (get_byte(reader, &b) < 0) return -1;
+        bits |= (uint32_t)b << (8 * i);
+    }
+    memcpy(value, &bits, sizeof(*value));
+    return 0;
+}
+
+/* Strings longer than the destination are truncated */
+static int get_string(session_reader_t *reader, char *dst, size_t dst_size) {
+    uint8_t len;
+    if (get_byte(reader, &len) < 0) return -1;
+    size_t kept = 0;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c;
+        if (get_byte(reader, &c) < 0) return -1;
+        if (kept + 1 < dst_size) dst[kept++] = (char)c;
+    }
+    dst[kept] = '\0';
+    return 0;
+}
+
+static int get_u64(session_reader_t *reader, uint64_t *value) {
+    return get_varint(reader, value);
+}
+
+static int get_u32(session_reader_t *reader, uint32_t *value) {
+    uint64_t raw;
+    if (get_varint(reader, &raw) < 0 || raw > UINT32_MAX) return -1;
+    *value = (uint32_t)raw;
+    return 0;
+}
+
+int session_reader_open(session_reader_t *reader, const char *path) {
+    memset(reader, 0, sizeof(*reader));
+    reader->fp = fopen(path, "rb");
+    if (!reader->fp) return -1;
+
+    char magic[4];
+    uint8_t version;
+    if (fread(magic, 1, 4, reader->fp) != 4 || memcmp(magic, SESSION_LOG_MAGIC, 4) != 0 ||
+        get_byte(reader, &version) < 0 || version != SESSION_LOG_VERSION) {
+        session_reader_close(reader);
+        return -1;
+    }
+    return 0;
+}
+
+int session_reader_next(session_reader_t *reader, session_record_t *rec) {
+    uint8_t type;
+    if (get_byte(reader, &type) < 0) return 0;
+
+    int64_t delta_us;
+    if (get_svarint(reader, &delta_us) < 0) return -1;
+    reader->time_us += (uint64_t)delta_us;
+
+    memset(rec, 0, sizeof(*rec));
+    rec->type = (session_rec_type_t)type;
+    rec->time_us = reader->time_us;
+
+    uint8_t b;
+    int64_t svalue;
+    switch (rec->type) {
+        case SESSION_REC_GPIO_EDGE:
+            if (get_byte(reader, &b) < 0) return -1;
+            rec->edge.line = b & 0x7f;
+            rec->edge.pressed = (b & 0x80) != 0;
+            return 1;
+
+        case SESSION_REC_UBUS_QUERY:
+            if (get_byte(reader, &b) < 0 || get_svarint(reader, &svalue) < 0 ||
+                get_u32(reader, &rec->ubus.latency_ms) < 0 ||
+                get_string(reader, rec->ubus.service, sizeof(rec->ubus.service)) < 0) {
+                return -1;
+            }
+            rec->ubus.installed = (b & 1) != 0;
+            rec->ubus.running = (b & 2) != 0;
+            rec->ubus.status = (int)svalue;
+            return 1;
+
+        case SESSION_REC_PROC_SAMPLE: {
+            session_proc_t *p = &rec->proc;
+            if (get_float(reader, &p->cpu_usage) < 0 || get_float(reader, &p->cpu_temp) < 0 ||
+                get_u64(reader, &p->mem_total_kb) < 0 ||
+                get_u64(reader, &p->mem_available_kb) < 0 ||
+                get_u32(reader, &p->uptime_sec) < 0 ||
+                get_string(reader, p->hostname, sizeof(p->hostname)) < 0 ||
+                get_string(reader, p->ip_addr, sizeof(p->ip_addr)) < 0 ||
+                get_string(reader, p->gateway, sizeof(p->gateway)) < 0 ||
+                get_u64(reader, &p->rx_bytes) < 0 || get_u64(reader, &p->tx_bytes) < 0 ||
+                get_u64(reader, &p->rx_speed) < 0 || get_u64(reader, &p->tx_speed) < 0) {
+                return -1;
+            }
+            return 1;
+        }
+
+        case SESSION_REC_TIMER:
+            if (get_u32(reader, &rec->timer.late_us) < 0) return -1;
+            return 1;
+    }
+    return -1;
+}
+
+void session_reader_close(session_reader_t *reader) {
+    if (reader->fp) {
+        fclose(reader->fp);
+        reader->fp = NULL;
+    }
+}
@@ -0,0 +1,133 @@
+/*
+ * Session recording for offline performance reproduction
+ *
+ * While a log is open, the inputs that drive the UI are appended to a
+ * compact binary file:
+ *
+ *   GPIO_EDGE    raw button edge (before debounce), kernel timestamp
+ *   UBUS_QUERY   service query result and its request-to-response latency
+ *   PROC_SAMPLE  the /proc derived part of sys_status after an update
+ *   TIMER        UI tick timer firing and how late it was
+ *
+ * The host replay tool (tests/nanohat_replay.c) feeds a log back through
+ * the mock HALs in virtual time and reports performance counters.
+ *
+ * Format: "NHSL" + version byte, then records of
+ *   type (1 byte), time delta in us (zigzag varint), payload
+ * Integers are LEB128 varints, floats raw little-endian IEEE 754, strings
+ * a length byte plus bytes. Recording stops (keeping whole records) once
+ * the file reaches SESSION_LOG_MAX_BYTES.
+ *
+ * Single-threaded: record from the uloop thread only.
+ */
+#ifndef SESSION_LOG_H
+#define SESSION_LOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "sys_status.h"
+
+#define SESSION_LOG_VERSION   1
+#define SESSION_LOG_MAX_BYTES (4u * 1024u * 1024u)
+
+typedef enum {
+    SESSION_REC_GPIO_EDGE = 1,
+    SESSION_REC_UBUS_QUERY,
+    SESSION_REC_PROC_SAMPLE,
+    SESSION_REC_TIMER
+} session_rec_type_t;
+
+/* sys_status fields read from /proc and the network stack */
+typedef struct {
+    float cpu_usage;
+    float cpu_temp;
+    uint64_t mem_total_kb;
+    uint64_t mem_available_kb;
+    uint32_t uptime_sec;
+    char hostname[HOSTNAME_MAX_LEN];
+    char ip_addr[IP_ADDR_MAX_LEN];
+    char gateway[IP_ADDR_MAX_LEN];
+    uint64_t rx_bytes;
+    uint64_t tx_bytes;
+    uint64_t rx_speed;
+    uint64_t tx_speed;
+} session_proc_t;
+
+typedef struct {
+    session_rec_type_t type;
+    uint64_t time_us;       /* time_hal clock */
+    union {
+        struct {
+            uint8_t line;
+            bool pressed;
+        } edge;
+        struct {
+            char service[SERVICE_NAME_MAX_LEN];
+            bool installed;
+            bool running;
+            int status;
+            uint32_t latency_ms;
+        } ubus;
+        session_proc_t proc;
+        struct {
+            uint32_t late_us;   /* Fired after its deadline by this much */
+        } timer;
+    };
+} session_record_t;
+
+/*
+ * Start recording to path (truncated). Replaces an open log.
+ * Returns 0 on success, -1 on failure.
+ */
+int session_log_open(const char *path);
+
+/*
+ * Flush and close the log (no-op if none is open).
+ */
+void session_log_close(void);
+
+/*
+ * True while recording; check before building a record.
+ */
+bool session_log_active(void);
+
+/*
+ * Recorders. No-ops while no log is open.
+ */
+void session_log_gpio_edge(int line, bool pressed, uint64_t timestamp_ns);
+void session_log_ubus_query(const char *service, bool installed, bool running,
+                            int status, uint32_t latency_ms);
+void session_log_proc(const sys_status_t *status);
+void session_log_timer(uint64_t due_ms, uint64_t fired_ms);
+
+/*
+ * Copy between sys_status and a PROC_SAMPLE payload.
+ */
+void session_proc_from_status(session_proc_t *proc, const sys_status_t *status);
+void session_proc_to_status(const session_proc_t *proc, sys_status_t *status);
+
+/*
+ * Sequential reader.
+ */
+typedef struct {
+    FILE *fp;
+    uint64_t time_us;       /* Time of the last record read */
+} session_reader_t;
+
+/*
+ * Open a log and check its header.
+ * Returns 0 on success, -1 if missing or not a session log.
+ */
+int session_reader_open(session_reader_t *reader, const char *path);
+
+/*
+ * Read the next record.
+ * Returns 1 with *rec filled, 0 at end of log, -1 on a corrupt record.
+ */
+int session_reader_next(session_reader_t *reader, session_record_t *rec);
+
+void session_reader_close(session_reader_t *reader);
+
+#endif
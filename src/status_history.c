@@ -0,0 +1,45 @@
+#include "status_history.h"
+
+#include <string.h>
+
+static status_history_sample_t g_ring[STATUS_HISTORY_LEN];
+static size_t g_head;           /* Next slot to write */
+static size_t g_count;
+
+bool status_history_record(const sys_status_t *status, uint64_t now_ms) {
+    if (!status) return false;
+
+    if (g_count > 0) {
+        size_t last = (g_head + STATUS_HISTORY_LEN - 1) % STATUS_HISTORY_LEN;
+        if (now_ms - g_ring[last].time_ms < STATUS_HISTORY_INTERVAL_MS) return false;
+    }
+
+    g_ring[g_head] = (status_history_sample_t){
+        .time_ms = now_ms,
+        .cpu_usage = status->cpu_usage,
+        .cpu_temp = status->cpu_temp,
+        .mem_available_kb = status->mem_available_kb,
+        .rx_speed = status->rx_speed,
+        .tx_speed = status->tx_speed,
+    };
+    g_head = (g_head + 1) % STATUS_HISTORY_LEN;
+    if (g_count < STATUS_HISTORY_LEN) g_count++;
+    return true;
+}
+
+size_t status_history_get(status_history_sample_t *out, size_t max) {
+    if (!out) return 0;
+
+    size_t n = g_count < max ? g_count : max;
+    size_t start = (g_head + STATUS_HISTORY_LEN - n) % STATUS_HISTORY_LEN;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = g_ring[(start + i) % STATUS_HISTORY_LEN];
+    }
+    return n;
+}
+
+void status_history_reset(void) {
+    memset(g_ring, 0, sizeof(g_ring));
+    g_head = 0;
+    g_count = 0;
+}
@@ -0,0 +1,47 @@
+/*
+ * Recent status history
+ *
+ * A fixed ring of the headline numbers (CPU, temperature, memory, WAN
+ * speed), recorded by sys_status_update_local() at most once per
+ * STATUS_HISTORY_INTERVAL_MS, so readers such as `ubus call nanohat
+ * history` get a short trend without sampling /proc themselves.
+ *
+ * uloop thread only.
+ */
+#ifndef STATUS_HISTORY_H
+#define STATUS_HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sys_status.h"
+
+#define STATUS_HISTORY_LEN         60      /* Samples kept */
+#define STATUS_HISTORY_INTERVAL_MS 5000    /* Minimum spacing: 5 minutes in all */
+
+typedef struct {
+    uint64_t time_ms;           /* time_hal_now_ms() when recorded */
+    float cpu_usage;
+    float cpu_temp;
+    uint64_t mem_available_kb;
+    uint64_t rx_speed;
+    uint64_t tx_speed;
+} status_history_sample_t;
+
+/*
+ * Record status at now_ms unless the last sample is younger than
+ * STATUS_HISTORY_INTERVAL_MS. Returns true when a sample was stored.
+ */
+bool status_history_record(const sys_status_t *status, uint64_t now_ms);
+
+/*
+ * Copy up to max samples, oldest first. Returns the number copied.
+ */
+size_t status_history_get(status_history_sample_t *out, size_t max);
+
+/*
+ * Drop all samples.
+ */
+void status_history_reset(void);
+
+#endif
@@ -0,0 +1,100 @@
+#include "status_shm.h"
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "hal/time_hal.h"
+#include "sys_status.h"
+
+static status_shm_t *g_seg;
+static char g_name[64];
+
+static void copy_str(char *dst, size_t dst_size, const char *src) {
+    snprintf(dst, dst_size, "%s", src);
+}
+
+int status_shm_open(const char *name) {
+    if (g_seg) return 0;
+    if (!name) name = STATUS_SHM_NAME;
+
+    int fd = shm_open(name, O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+    if (fd < 0) return -1;
+
+    if (ftruncate(fd, sizeof(status_shm_t)) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+    void *map = mmap(NULL, sizeof(status_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        shm_unlink(name);
+        return -1;
+    }
+
+    g_seg = map;
+    copy_str(g_name, sizeof(g_name), name);
+
+    /* Left over from a previous run: "never published" until the first write */
+    __atomic_store_n(&g_seg->seq, 0, __ATOMIC_RELEASE);
+    g_seg->magic = STATUS_SHM_MAGIC;
+    g_seg->version = STATUS_SHM_VERSION;
+    g_seg->service_size = sizeof(status_shm_service_t);
+    g_seg->size = sizeof(status_shm_t);
+    g_seg->writer_pid = (uint32_t)getpid();
+    return 0;
+}
+
+void status_shm_publish(const sys_status_t *status) {
+    if (!g_seg || !status) return;
+
+    status_shm_t *seg = g_seg;
+    uint32_t seq = seg->seq;    /* Only this thread writes it */
+    __atomic_store_n(&seg->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    seg->update_ms = time_hal_now_ms();
+    seg->cpu_usage = status->cpu_usage;
+    seg->cpu_temp = status->cpu_temp;
+    seg->mem_total_kb = status->mem_total_kb;
+    seg->mem_available_kb = status->mem_available_kb;
+    seg->rx_bytes = status->rx_bytes;
+    seg->tx_bytes = status->tx_bytes;
+    seg->rx_speed = status->rx_speed;
+    seg->tx_speed = status->tx_speed;
+    seg->uptime_sec = status->uptime_sec;
+    copy_str(seg->hostname, sizeof(seg->hostname), status->hostname);
+    copy_str(seg->ip_addr, sizeof(seg->ip_addr), status->ip_addr);
+    copy_str(seg->gateway, sizeof(seg->gateway), status->gateway);
+
+    size_t count = status->service_count;
+    if (count > STATUS_SHM_MAX_SERVICES) count = STATUS_SHM_MAX_SERVICES;
+    for (size_t i = 0; i < count; i++) {
+        const service_status_t *svc = &status->services[i];
+        status_shm_service_t *out = &seg->services[i];
+        copy_str(out->name, sizeof(out->name), svc->name);
+        out->flags = (svc->installed ? STATUS_SHM_SVC_INSTALLED : 0) |
+                     (svc->running ? STATUS_SHM_SVC_RUNNING : 0) |
+                     (svc->status_valid ? STATUS_SHM_SVC_VALID : 0) |
+                     (svc->usage_valid ? STATUS_SHM_SVC_USAGE : 0);
+        out->cpu_percent = svc->cpu_percent;
+        out->mem_bytes = svc->mem_bytes;
+        out->last_update_ms = svc->last_update_ms;
+    }
+    seg->service_count = (uint32_t)count;
+    seg->service_total = (uint32_t)status->service_count;
+
+    __atomic_store_n(&seg->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+void status_shm_close(void) {
+    if (!g_seg) return;
+
+    munmap(g_seg, sizeof(status_shm_t));
+    shm_unlink(g_name);
+    g_seg = NULL;
+}
@@ -0,0 +1,148 @@
+/*
+ * Shared-memory status segment for external consumers
+ *
+ * The daemon already parses /proc every second; LuCI widgets, collectd
+ * exec scripts and shell monitors can read the result from the POSIX
+ * shared-memory object STATUS_SHM_NAME (/dev/shm/nanohat-status) instead
+ * of parsing /proc again. A read is a copy out of the mapping: no
+ * syscall and no parsing once the segment is mapped.
+ *
+ * Layout, version 1 (host byte order, natural alignment, byte offsets):
+ *
+ *   status_shm_t
+ *     0  u32  magic            STATUS_SHM_MAGIC ("NHST")
+ *     4  u16  version          STATUS_SHM_VERSION
+ *     6  u16  service_size     sizeof(status_shm_service_t) = 56
+ *     8  u32  size             segment size in bytes
+ *    12  u32  seq              seqlock sequence, odd while being written
+ *    16  u64  update_ms        CLOCK_MONOTONIC ms of the last publish
+ *    24  u32  writer_pid
+ *    28  u32  service_count    entries used in services[]
+ *    32  f32  cpu_usage        percent
+ *    36  f32  cpu_temp         degrees C
+ *    40  u64  mem_total_kb
+ *    48  u64  mem_available_kb
+ *    56  u64  rx_bytes         gateway interface
+ *    64  u64  tx_bytes
+ *    72  u64  rx_speed         bytes/s
+ *    80  u64  tx_speed         bytes/s
+ *    88  u32  uptime_sec
+ *    92  u32  service_total    monitored services (> service_count if cut)
+ *    96  char hostname[32]     NUL-terminated
+ *   128  char ip_addr[16]
+ *   144  char gateway[16]
+ *   160  status_shm_service_t services[STATUS_SHM_MAX_SERVICES]
+ *
+ *   status_shm_service_t
+ *     0  char name[32]
+ *    32  u32  flags            STATUS_SHM_SVC_* bits
+ *    36  f32  cpu_percent      valid with STATUS_SHM_SVC_USAGE
+ *    40  u64  mem_bytes        valid with STATUS_SHM_SVC_USAGE
+ *    48  u64  last_update_ms   CLOCK_MONOTONIC ms of the last query, 0 = never
+ *
+ * Fields are only ever appended; a reader accepts its own version and
+ * checks service_size. Readers must use the seqlock (status_shm_read()
+ * does): load seq (acquire), retry while odd, copy, fence (acquire),
+ * reload seq and retry if it changed. seq is 0 until the first publish.
+ * update_ms goes stale while the display sleeps (sampling pauses); the
+ * object is removed when the daemon exits.
+ *
+ * The reader part (status_shm_reader.c) depends on libc only and can be
+ * copied into other tools together with this header.
+ */
+#ifndef STATUS_SHM_H
+#define STATUS_SHM_H
+
+#include <stdint.h>
+
+#define STATUS_SHM_NAME         "/nanohat-status"
+#define STATUS_SHM_MAGIC        0x5453484eu     /* "NHST" little-endian */
+#define STATUS_SHM_VERSION      1
+#define STATUS_SHM_MAX_SERVICES 128
+#define STATUS_SHM_READ_TRIES   1000            /* Seqlock retries per read */
+
+/* status_shm_service_t flags */
+#define STATUS_SHM_SVC_INSTALLED 0x1u
+#define STATUS_SHM_SVC_RUNNING   0x2u
+#define STATUS_SHM_SVC_VALID     0x4u   /* Last query succeeded */
+#define STATUS_SHM_SVC_USAGE     0x8u   /* cgroup usage read on last pass */
+
+typedef struct {
+    char name[32];
+    uint32_t flags;
+    float cpu_percent;
+    uint64_t mem_bytes;
+    uint64_t last_update_ms;
+} status_shm_service_t;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t service_size;
+    uint32_t size;
+    uint32_t seq;
+    uint64_t update_ms;
+    uint32_t writer_pid;
+    uint32_t service_count;
+    float cpu_usage;
+    float cpu_temp;
+    uint64_t mem_total_kb;
+    uint64_t mem_available_kb;
+    uint64_t rx_bytes;
+    uint64_t tx_bytes;
+    uint64_t rx_speed;
+    uint64_t tx_speed;
+    uint32_t uptime_sec;
+    uint32_t service_total;
+    char hostname[32];
+    char ip_addr[16];
+    char gateway[16];
+    status_shm_service_t services[STATUS_SHM_MAX_SERVICES];
+} status_shm_t;
+
+/*
+ * Writer (daemon, uloop thread)
+ */
+struct sys_status;
+
+/*
+ * Create (or take over) the segment; NULL name = STATUS_SHM_NAME.
+ * Returns 0, or -1 with publishing disabled.
+ */
+int status_shm_open(const char *name);
+
+/*
+ * Copy status into the segment. No-op while the segment is not open.
+ */
+void status_shm_publish(const struct sys_status *status);
+
+/*
+ * Unmap and remove the segment.
+ */
+void status_shm_close(void);
+
+/*
+ * Reader (any process)
+ */
+typedef struct {
+    const status_shm_t *seg;
+    uint32_t size;
+} status_shm_reader_t;
+
+/*
+ * Map the segment read-only; NULL name = STATUS_SHM_NAME.
+ * Returns 0, -ENOENT if the daemon is not running, -EPROTO on a magic,
+ * version or layout mismatch, or another negative errno.
+ */
+int status_shm_reader_open(status_shm_reader_t *reader, const char *name);
+
+/*
+ * Consistent copy of the segment (header and used services).
+ * Returns 0, -ENODATA before the first publish, or -EAGAIN if every
+ * try raced with the writer.
+ */
+int status_shm_read(const status_shm_reader_t *reader, status_shm_t *out);
+
+void status_shm_reader_close(status_shm_reader_t *reader);
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ * Status segment reader: libc only, see status_shm.h
+ */
+#include "status_shm.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* The documented layout is the ABI */
+_Static_assert(sizeof(status_shm_service_t) == 56, "service entry size");
+_Static_assert(offsetof(status_shm_service_t, last_update_ms) == 48, "service layout");
+_Static_assert(offsetof(status_shm_t, seq) == 12, "seq offset");
+_Static_assert(offsetof(status_shm_t, cpu_usage) == 32, "header layout");
+_Static_assert(offsetof(status_shm_t, uptime_sec) == 88, "header layout");
+_Static_assert(offsetof(status_shm_t, hostname) == 96, "header layout");
+_Static_assert(offsetof(status_shm_t, services) == 160, "services offset");
+
+int status_shm_reader_open(status_shm_reader_t *reader, const char *name) {
+    if (!reader) return -EINVAL;
+    reader->seg = NULL;
+    reader->size = 0;
+    if (!name) name = STATUS_SHM_NAME;
+
+    int fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) return -errno;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        close(fd);
+        return -err;
+    }
+    if ((size_t)st.st_size < offsetof(status_shm_t, services)) {
+        close(fd);
+        return -EPROTO;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    int err = errno;
+    close(fd);
+    if (map == MAP_FAILED) return -err;
+
+    const status_shm_t *seg = map;
+    if (seg->magic != STATUS_SHM_MAGIC || seg->version != STATUS_SHM_VERSION ||
+        seg->service_size != sizeof(status_shm_service_t) ||
+        (size_t)st.st_size < sizeof(status_shm_t)) {
+        munmap(map, (size_t)st.st_size);
+        return -EPROTO;
+    }
+
+    reader->seg = seg;
+    reader->size = (uint32_t)st.st_size;
+    return 0;
+}
+
+int status_shm_read(const status_shm_reader_t *reader, status_shm_t *out) {
+    if (!reader || !reader->seg || !out) return -EINVAL;
+    const status_shm_t *seg = reader->seg;
+
+    for (int tries = 0; tries < STATUS_SHM_READ_TRIES; tries++) {
+        uint32_t seq = __atomic_load_n(&seg->seq, __ATOMIC_ACQUIRE);
+        if (seq == 0) return -ENODATA;
+        if (seq & 1) continue;  /* Publish in progress (a few microseconds) */
+
+        memcpy(out, seg, offsetof(status_shm_t, services));
+        uint32_t count = out->service_count;
+        if (count > STATUS_SHM_MAX_SERVICES) continue;  /* Torn, retry */
+        memcpy(out->services, seg->services, count * sizeof(status_shm_service_t));
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&seg->seq, __ATOMIC_RELAXED) == seq) {
+            return 0;
+        }
+    }
+    return -EAGAIN;
+}
+
+void status_shm_reader_close(status_shm_reader_t *reader) {
+    if (!reader || !reader->seg) return;
+
+    munmap((void *)reader->seg, reader->size);
+    reader->seg = NULL;
+    reader->size = 0;
+}
@@ -0,0 +1,69 @@
+#include "status_snapshot.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SNAPSHOT_FRESH 0x4u     /* Middle buffer not yet taken by the reader */
+#define SNAPSHOT_INDEX 0x3u
+
+void status_snapshot_init(status_snapshot_t *snap) {
+    if (!snap) return;
+
+    memset(snap->bufs, 0, sizeof(snap->bufs));
+    memset(snap->capacity, 0, sizeof(snap->capacity));
+    snap->front = 0;
+    atomic_init(&snap->middle, 1);
+    snap->back = 2;
+    snap->published = 0;
+}
+
+void status_snapshot_free(status_snapshot_t *snap) {
+    if (!snap) return;
+
+    for (int i = 0; i < STATUS_SNAPSHOT_BUFFERS; i++) {
+        free(snap->bufs[i].services);
+        snap->bufs[i].services = NULL;
+        snap->bufs[i].service_count = 0;
+        snap->capacity[i] = 0;
+    }
+}
+
+int status_snapshot_publish(status_snapshot_t *snap, const sys_status_t *status) {
+    if (!snap || !status) return -1;
+
+    int b = snap->back;
+    sys_status_t *dst = &snap->bufs[b];
+    service_status_t *services = dst->services;
+
+    /* Grow only: the table rarely changes size (SIGHUP reload) */
+    if (status->service_count > snap->capacity[b]) {
+        services = realloc(services, status->service_count * sizeof(*services));
+        if (!services) return -1;
+        dst->services = services;
+        snap->capacity[b] = status->service_count;
+    }
+
+    *dst = *status;
+    dst->services = services;
+    if (status->service_count > 0) {
+        memcpy(services, status->services, status->service_count * sizeof(*services));
+    }
+
+    /* Release: the copy is complete before the reader can take it */
+    unsigned old = atomic_exchange_explicit(&snap->middle, (unsigned)b | SNAPSHOT_FRESH,
+                                            memory_order_acq_rel);
+    snap->back = (int)(old & SNAPSHOT_INDEX);
+    snap->published++;
+    return 0;
+}
+
+const sys_status_t *status_snapshot_acquire(status_snapshot_t *snap) {
+    if (!snap) return NULL;
+
+    if (atomic_load_explicit(&snap->middle, memory_order_relaxed) & SNAPSHOT_FRESH) {
+        unsigned old = atomic_exchange_explicit(&snap->middle, (unsigned)snap->front,
+                                                memory_order_acq_rel);
+        snap->front = (int)(old & SNAPSHOT_INDEX);
+    }
+    return &snap->bufs[snap->front];
+}
@@ -0,0 +1,63 @@
+/*
+ * Immutable sys_status snapshots for renderers
+ *
+ * Collectors (/proc sampling, ubus callbacks, offload jobs) keep mutating
+ * their working sys_status_t; renderers never read it. Instead the writer
+ * publishes a deep copy (services table included) and a frame renders
+ * from the snapshot it acquired, which stays untouched until that reader
+ * acquires again, however often the writer publishes in between.
+ *
+ * Three buffers handed over by atomic exchange (triple buffering): the
+ * writer fills its private back buffer and swaps it with the shared
+ * middle one, the reader swaps its front buffer with the middle one when
+ * a newer snapshot is there. Neither side waits for or locks out the
+ * other, and a publish never touches the buffer being rendered.
+ *
+ * One writer thread and one reader thread per snapshot (they may be the
+ * same thread). Several readers on that one thread may share it if each
+ * is done with its view before returning to the loop.
+ */
+#ifndef STATUS_SNAPSHOT_H
+#define STATUS_SNAPSHOT_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sys_status.h"
+
+#define STATUS_SNAPSHOT_BUFFERS 3
+
+typedef struct {
+    sys_status_t bufs[STATUS_SNAPSHOT_BUFFERS];
+    size_t capacity[STATUS_SNAPSHOT_BUFFERS];  /* services[] allocated */
+    int back;                   /* Writer only */
+    int front;                  /* Reader only */
+    atomic_uint middle;         /* Buffer index | fresh flag */
+    uint32_t published;         /* Writer only: publishes so far */
+} status_snapshot_t;
+
+/*
+ * Start with an empty (zeroed) snapshot.
+ */
+void status_snapshot_init(status_snapshot_t *snap);
+
+/*
+ * Free all buffers. Neither side may use snap afterwards.
+ */
+void status_snapshot_free(status_snapshot_t *snap);
+
+/*
+ * Writer: copy status into the next snapshot and make it the newest.
+ * Returns 0, or -1 if the services table could not be copied (the
+ * previous snapshot stays current).
+ */
+int status_snapshot_publish(status_snapshot_t *snap, const sys_status_t *status);
+
+/*
+ * Reader: the newest published snapshot. It stays valid and unchanged
+ * until the reader's next acquire.
+ */
+const sys_status_t *status_snapshot_acquire(status_snapshot_t *snap);
+
+#endif
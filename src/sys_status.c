@@ -1,6 +1,12 @@
 #define _POSIX_C_SOURCE 200809L
 
 #include "sys_status.h"
+#include "offload.h"
+#include "service_cgroup.h"
+#include "session_log.h"
+#include "status_history.h"
+#include "status_shm.h"
+#include "hal/time_hal.h"
 #include "hal/ubus_hal.h"
 
 #include <stdio.h>
@@ -17,6 +23,10 @@
 /* Request ID counter for matching responses */
 static uint32_t g_next_request_id = 1;
 
+/* Replacement for the /proc readers (session replay) */
+static sys_status_local_source_t g_local_source;
+static void *g_local_source_priv;
+
 struct sys_status_ctx {
     /* For CPU usage calculation */
     uint64_t prev_idle;
@@ -34,8 +44,21 @@ struct sys_status_ctx {
     FILE *fp_net;
     FILE *fp_mem;
     FILE *fp_temp;
+
+    /* Per-service cgroup usage collector */
+    service_cgroup_t *cgroup;
+
+    /* IP lookup on the offload pool: ip_result belongs to the worker
+     * while ip_job is set */
+    offload_job_t *ip_job;
+    char ip_result[IP_ADDR_MAX_LEN];
+    sys_status_t *ip_status;    /* Receives ip_result */
+    bool closing;               /* Cleaned up, freed by the job's done() */
 };
 
+/* A lookup still running after this is dropped (result stale) */
+#define IP_LOOKUP_TIMEOUT_MS 2000
+
 static void safe_copy(char *dst, size_t dst_size, const char *src) {
     if (!dst || dst_size == 0) return;
     if (!src) {
@@ -55,6 +78,8 @@ sys_status_ctx_t *sys_status_init(void) {
     ctx->fp_mem = fopen("/proc/meminfo", "r");
     ctx->fp_temp = fopen("/sys/class/thermal/thermal_zone0/temp", "r");
 
+    ctx->cgroup = service_cgroup_init(NULL);
+
     return ctx;
 }
 
@@ -65,7 +90,14 @@ void sys_status_cleanup(sys_status_ctx_t *ctx) {
     if (ctx->fp_net) fclose(ctx->fp_net);
     if (ctx->fp_mem) fclose(ctx->fp_mem);
     if (ctx->fp_temp) fclose(ctx->fp_temp);
+    service_cgroup_cleanup(ctx->cgroup);
 
+    if (ctx->ip_job) {
+        /* The worker may still write ip_result */
+        ctx->closing = true;
+        offload_cancel(ctx->ip_job);
+        return;
+    }
     free(ctx);
 }
 
@@ -136,52 +168,88 @@ static void update_uptime(sys_status_t *status) {
     }
 }
 
-static void update_ip_addr(sys_status_t *status) {
+static void lookup_ip_addr(char *ip_addr, size_t len) {
     struct ifaddrs *ifaddr, *ifa;
-    status->ip_addr[0] = '\0';
+    ip_addr[0] = '\0';
 
     if (getifaddrs(&ifaddr) != 0) {
-        safe_copy(status->ip_addr, sizeof(status->ip_addr), "No IP");
+        safe_copy(ip_addr, len, "No IP");
         return;
     }
 
     /* Priority: br-lan > eth0 > wlan0 > any non-loopback */
     const char *priority[] = {"br-lan", "eth0", "wlan0", NULL};
 
-    for (int p = 0; priority[p] && status->ip_addr[0] == '\0'; p++) {
+    for (int p = 0; priority[p] && ip_addr[0] == '\0'; p++) {
         for (ifa = ifaddr; ifa; ifa = ifa->ifa_next) {
             if (!ifa->ifa_addr || ifa->ifa_addr->sa_family != AF_INET) continue;
             if (strcmp(ifa->ifa_name, priority[p]) == 0) {
                 struct sockaddr_in *addr = (struct sockaddr_in *)ifa->ifa_addr;
-                inet_ntop(AF_INET, &addr->sin_addr, status->ip_addr, sizeof(status->ip_addr));
+                inet_ntop(AF_INET, &addr->sin_addr, ip_addr, len);
                 break;
             }
         }
     }
 
     /* Fallback: first non-loopback */
-    if (status->ip_addr[0] == '\0') {
+    if (ip_addr[0] == '\0') {
         for (ifa = ifaddr; ifa; ifa = ifa->ifa_next) {
             if (!ifa->ifa_addr || ifa->ifa_addr->sa_family != AF_INET) continue;
             if (ifa->ifa_flags & IFF_LOOPBACK) continue;
             struct sockaddr_in *addr = (struct sockaddr_in *)ifa->ifa_addr;
-            inet_ntop(AF_INET, &addr->sin_addr, status->ip_addr, sizeof(status->ip_addr));
+            inet_ntop(AF_INET, &addr->sin_addr, ip_addr, len);
             break;
         }
     }
 
     freeifaddrs(ifaddr);
 
-    if (status->ip_addr[0] == '\0') {
-        safe_copy(status->ip_addr, sizeof(status->ip_addr), "No IP");
+    if (ip_addr[0] == '\0') {
+        safe_copy(ip_addr, len, "No IP");
     }
 }
 
-/* Get current time in milliseconds using monotonic clock */
+static void ip_lookup_work(offload_job_t *job, void *arg) {
+    (void)job;
+    sys_status_ctx_t *ctx = arg;
+    lookup_ip_addr(ctx->ip_result, sizeof(ctx->ip_result));
+}
+
+static void ip_lookup_done(int result, void *arg) {
+    sys_status_ctx_t *ctx = arg;
+    ctx->ip_job = NULL;
+
+    if (ctx->closing) {
+        free(ctx);
+        return;
+    }
+    /* Lands after the update pass: a new address is a change of its own */
+    sys_status_t *status = ctx->ip_status;
+    if (result == 0 && strcmp(status->ip_addr, ctx->ip_result) != 0) {
+        safe_copy(status->ip_addr, sizeof(status->ip_addr), ctx->ip_result);
+        status->update_seq++;
+    }
+}
+
+/*
+ * getifaddrs() dumps every address over netlink: run it on the offload
+ * pool when there is one. The address shown is then one update old;
+ * the first lookup (before the pool starts) and hosts without a pool
+ * stay synchronous.
+ */
+static void update_ip_addr(sys_status_ctx_t *ctx, sys_status_t *status) {
+    if (ctx->ip_job) return;  /* Previous lookup still running */
+
+    ctx->ip_status = status;
+    ctx->ip_job = offload_submit(ip_lookup_work, ip_lookup_done, ctx, IP_LOOKUP_TIMEOUT_MS);
+    if (!ctx->ip_job) {
+        lookup_ip_addr(status->ip_addr, sizeof(status->ip_addr));
+    }
+}
+
+/* Get current time in milliseconds (time_hal, so simulations see it too) */
 static uint64_t get_time_ms(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+    return time_hal_now_ms();
 }
 
 static void update_network_stats(sys_status_ctx_t *ctx, sys_status_t *status) {
@@ -266,26 +334,21 @@ static void update_network_stats(sys_status_ctx_t *ctx, sys_status_t *status) {
     ctx->prev_net_time_ms = now_ms;
 }
 
+void sys_status_set_local_source(sys_status_local_source_t source, void *priv) {
+    g_local_source = source;
+    g_local_source_priv = priv;
+}
+
 void sys_status_update_local(sys_status_ctx_t *ctx, sys_status_t *status) {
     if (!ctx || !status) return;
 
-    /* Initialize service list once (Phase 3 placeholder) */
-    if (status->service_count == 0) {
-        const service_config_t *cfg = service_config_get();
-        if (cfg && cfg->count > 0) {
-            for (size_t i = 0; i < cfg->count && i < MAX_SERVICES; i++) {
-                safe_copy(status->services[i].name, sizeof(status->services[i].name),
-                          cfg->services[i].name);
-                status->services[i].installed = false;
-                status->services[i].running = false;
-                status->services[i].query_pending = false;
-                status->services[i].status_valid = false;
-                status->services[i].request_id = 0;
-                status->services[i].request_time_ms = 0;
-                status->services[i].last_update_ms = 0;
-            }
-            status->service_count = cfg->count;
-        }
+    /* Pick up service list changes (startup and SIGHUP reload) */
+    sys_status_sync_services(status);
+    status->update_seq++;
+
+    if (g_local_source) {
+        g_local_source(status, g_local_source_priv);
+        return;
     }
 
     update_cpu_usage(ctx, status);
@@ -293,8 +356,131 @@ void sys_status_update_local(sys_status_ctx_t *ctx, sys_status_t *status) {
     update_memory(ctx, status);
     update_hostname(status);
     update_uptime(status);
-    update_ip_addr(status);
+    update_ip_addr(ctx, status);
     update_network_stats(ctx, status);
+    service_cgroup_sample(ctx->cgroup, status, get_time_ms());
+    session_log_proc(status);
+    status_shm_publish(status);
+    status_history_record(status, get_time_ms());
+}
+
+bool sys_status_sync_services(sys_status_t *status) {
+    if (!status) return false;
+
+    const service_config_t *cfg = service_config_get();
+    if (!cfg || status->service_generation == cfg->generation) return false;
+
+    service_status_t *services = NULL;
+    if (cfg->count > 0) {
+        services = calloc(cfg->count, sizeof(*services));
+        if (!services) return false;  /* Keep old table, retry next update */
+    }
+
+    for (size_t i = 0; i < cfg->count; i++) {
+        safe_copy(services[i].name, sizeof(services[i].name), cfg->services[i].name);
+    }
+
+    /* Carry over state of services that survived the reload */
+    for (size_t i = 0; i < status->service_count; i++) {
+        int idx = service_config_find(cfg, status->services[i].name);
+        if (idx >= 0) {
+            services[idx] = status->services[i];
+        }
+    }
+
+    free(status->services);
+    status->services = services;
+    status->service_count = cfg->count;
+    status->service_generation = cfg->generation;
+    status->update_seq++;
+    return true;
+}
+
+/*
+ * Queries and controls in flight, so that a status can be freed before
+ * the ubus HAL delivers their callbacks (detached: status = NULL)
+ */
+typedef struct request_link {
+    struct request_link *next;
+    sys_status_t *status;
+    void (*detach)(struct request_link *link);  /* Optional, at detach time */
+} request_link_t;
+
+static request_link_t *g_requests;
+
+static void link_request(request_link_t *link, sys_status_t *status,
+                         void (*detach)(request_link_t *link)) {
+    link->status = status;
+    link->detach = detach;
+    link->next = g_requests;
+    g_requests = link;
+}
+
+static void unlink_request(request_link_t *link) {
+    for (request_link_t **p = &g_requests; *p; p = &(*p)->next) {
+        if (*p == link) {
+            *p = link->next;
+            return;
+        }
+    }
+}
+
+void sys_status_free_services(sys_status_t *status) {
+    if (!status) return;
+
+    free(status->services);
+    status->services = NULL;
+    status->service_count = 0;
+    status->service_generation = 0;
+    status->update_seq++;
+
+    /* Callbacks still to come must not touch status any more */
+    for (request_link_t *link = g_requests; link; link = link->next) {
+        if (link->status == status) {
+            link->status = NULL;
+            if (link->detach) {
+                link->detach(link);
+            }
+        }
+    }
+}
+
+static void mark_service_changed(sys_status_t *status, int idx) {
+    status->service_change_log[status->service_change_seq % SERVICE_CHANGE_LOG_SIZE] = (uint32_t)idx;
+    status->service_change_seq++;
+}
+
+int sys_status_next_changed_service(const sys_status_t *status, uint32_t *cursor, int *index) {
+    if (!status || !cursor) return 0;
+
+    uint32_t pending = status->service_change_seq - *cursor;
+    if (pending == 0) return 0;
+    if (pending > SERVICE_CHANGE_LOG_SIZE) {
+        *cursor = status->service_change_seq;
+        return -1;
+    }
+
+    if (index) *index = (int)status->service_change_log[*cursor % SERVICE_CHANGE_LOG_SIZE];
+    (*cursor)++;
+    return 1;
+}
+
+int sys_status_find_service(const sys_status_t *status, const char *name) {
+    if (!status || !name) return -1;
+
+    const service_config_t *cfg = service_config_get();
+    if (cfg && status->service_generation == cfg->generation) {
+        int idx = service_config_find(cfg, name);
+        return (idx >= 0 && (size_t)idx < status->service_count) ? idx : -1;
+    }
+
+    /* Table not synced with config (e.g. filled by hand) */
+    for (size_t i = 0; i < status->service_count; i++) {
+        if (strcmp(status->services[i].name, name) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
 }
 
 void sys_status_format_uptime(uint32_t uptime_sec, char *buf, size_t buflen) {
@@ -349,7 +535,7 @@ void sys_status_format_speed_bps(uint64_t bytes_per_sec, char *buf, size_t bufle
  * Callback context for service query
  */
 typedef struct {
-    sys_status_t *status;
+    request_link_t link;
     uint32_t request_id;
 } query_ctx_t;
 
@@ -359,43 +545,56 @@ typedef struct {
 static void service_query_cb(const char *service, bool installed,
                               bool running, int status_code, void *priv) {
     query_ctx_t *qctx = (query_ctx_t *)priv;
-    if (!qctx || !qctx->status) {
+    if (!qctx) return;
+    unlink_request(&qctx->link);
+    if (!qctx->link.status) {
         free(qctx);
         return;
     }
 
-    sys_status_t *status = qctx->status;
+    sys_status_t *status = qctx->link.status;
     uint64_t now_ms = get_time_ms();
 
-    /* Find matching service */
-    for (size_t i = 0; i < status->service_count; i++) {
-        if (strcmp(status->services[i].name, service) != 0) continue;
+    /* Find matching service (may have been removed by a reload) */
+    int idx = sys_status_find_service(status, service);
+    service_status_t *svc = (idx >= 0) ? &status->services[idx] : NULL;
 
-        /* Check request ID to avoid stale response overwriting newer state */
-        if (status->services[i].request_id != qctx->request_id) {
-            /* Stale response - ignore */
-            break;
-        }
+    /* Check request ID to avoid stale response overwriting newer state */
+    if (svc && svc->request_id == qctx->request_id) {
+        session_log_ubus_query(service, installed, running, status_code,
+                               (uint32_t)(now_ms - svc->request_time_ms));
 
         /* Update service status */
-        status->services[i].query_pending = false;
-        status->services[i].last_update_ms = now_ms;
+        svc->query_pending = false;
+        svc->last_update_ms = now_ms;
+        status->update_seq++;
 
+        bool changed;
         if (status_code == UBUS_HAL_STATUS_OK) {
-            status->services[i].installed = installed;
-            status->services[i].running = running;
-            status->services[i].status_valid = true;
+            changed = svc->installed != installed || svc->running != running ||
+                      !svc->status_valid;
+            svc->installed = installed;
+            svc->running = running;
+            svc->status_valid = true;
         } else {
             /* Query failed - mark invalid but keep last known state */
-            status->services[i].status_valid = false;
+            changed = svc->status_valid;
+            svc->status_valid = false;
+        }
+        if (changed) {
+            mark_service_changed(status, idx);
         }
-        break;
     }
 
     free(qctx);
 }
 
 int sys_status_query_services(sys_status_ctx_t *ctx, sys_status_t *status) {
+    return sys_status_query_services_stale(ctx, status, SERVICE_REFRESH_INTERVAL_MS);
+}
+
+int sys_status_query_services_stale(sys_status_ctx_t *ctx, sys_status_t *status,
+                                    uint32_t max_age_ms) {
     (void)ctx;  /* Not used currently */
 
     if (!status || !ubus_hal) return 0;
@@ -411,7 +610,7 @@ int sys_status_query_services(sys_status_ctx_t *ctx, sys_status_t *status) {
 
         /* Skip if recently updated */
         if (svc->last_update_ms > 0 &&
-            (now_ms - svc->last_update_ms) < SERVICE_REFRESH_INTERVAL_MS) {
+            (now_ms - svc->last_update_ms) < max_age_ms) {
             continue;
         }
         /* Allocate callback context */
@@ -422,7 +621,7 @@ int sys_status_query_services(sys_status_ctx_t *ctx, sys_status_t *status) {
         uint32_t req_id = g_next_request_id++;
         if (g_next_request_id == 0) g_next_request_id = 1;  /* Avoid 0 */
 
-        qctx->status = status;
+        link_request(&qctx->link, status, NULL);
         qctx->request_id = req_id;
 
         /* Mark as pending */
@@ -433,14 +632,20 @@ int sys_status_query_services(sys_status_ctx_t *ctx, sys_status_t *status) {
         /* Initiate async query */
         int ret = ubus_hal->query_service_async(svc->name, service_query_cb, qctx);
         if (ret < 0) {
-            /* Immediate failure */
+            /* Not sent (no slot free: the rest wait for the next pass) */
             svc->query_pending = false;
+            unlink_request(&qctx->link);
             free(qctx);
+            if (ret == UBUS_HAL_BUSY) break;
         } else {
             queries_sent++;
         }
     }
 
+    /* Pending markers show on the Services page */
+    if (queries_sent > 0) {
+        status->update_seq++;
+    }
     return queries_sent;
 }
 
@@ -459,38 +664,48 @@ bool sys_status_has_pending_queries(const sys_status_t *status) {
  * Callback context for service control
  */
 typedef struct {
-    sys_status_t *status;
-    int index;
-    bool start;
+    request_link_t link;
+    char name[SERVICE_NAME_MAX_LEN];  /* Index may move if config is reloaded */
+    ubus_hal_action_t action;
     sys_status_control_cb cb;
     void *priv;
 } control_ctx_t;
 
+/* Status freed first: fail the control now, the ubus callback only frees */
+static void control_detach(request_link_t *link) {
+    control_ctx_t *cctx = (control_ctx_t *)link;
+    sys_status_control_cb cb = cctx->cb;
+    cctx->cb = NULL;
+    if (cb) {
+        cb(-1, false, UBUS_HAL_STATUS_ERROR, cctx->priv);
+    }
+}
+
 /*
  * Callback invoked when ubus control completes
  */
 static void service_control_cb(const char *service, bool success,
                                 int status_code, void *priv) {
     (void)service;
-    (void)status_code;
 
     control_ctx_t *cctx = (control_ctx_t *)priv;
-    if (!cctx || !cctx->status) {
-        free(cctx);
-        return;
-    }
+    if (!cctx) return;
+    unlink_request(&cctx->link);
 
-    sys_status_t *status = cctx->status;
-    int idx = cctx->index;
+    /* Detached: already reported by control_detach() */
+    sys_status_t *status = cctx->link.status;
+    int idx = status ? sys_status_find_service(status, cctx->name) : -1;
 
-    if (idx >= 0 && (size_t)idx < status->service_count) {
+    if (idx >= 0) {
         /* Force a query refresh to get updated status */
         status->services[idx].last_update_ms = 0;
 
         /* If successful, optimistically update running state */
         if (success) {
-            status->services[idx].running = cctx->start;
+            status->services[idx].running = (cctx->action != UBUS_HAL_ACTION_STOP);
         }
+        mark_service_changed(status, idx);
+        status->update_seq++;
     }
 
     if (cctx->cb) {
@@ -503,6 +718,14 @@ static void service_control_cb(const char *service, bool success,
 int sys_status_control_service(sys_status_ctx_t *ctx, sys_status_t *status,
                                 int index, bool start,
                                 sys_status_control_cb cb, void *priv) {
+    return sys_status_control_service_action(ctx, status, index,
+                                             start ? UBUS_HAL_ACTION_START : UBUS_HAL_ACTION_STOP,
+                                             cb, priv);
+}
+
+int sys_status_control_service_action(sys_status_ctx_t *ctx, sys_status_t *status,
+                                      int index, ubus_hal_action_t action,
+                                      sys_status_control_cb cb, void *priv) {
     (void)ctx;
 
     if (!status || !ubus_hal || !ubus_hal->control_service_async) return -1;
@@ -514,17 +737,18 @@ int sys_status_control_service(sys_status_ctx_t *ctx, sys_status_t *status,
     control_ctx_t *cctx = malloc(sizeof(control_ctx_t));
     if (!cctx) return -1;
 
-    cctx->status = status;
-    cctx->index = index;
-    cctx->start = start;
+    link_request(&cctx->link, status, control_detach);
+    safe_copy(cctx->name, sizeof(cctx->name), svc->name);
+    cctx->action = action;
     cctx->cb = cb;
     cctx->priv = priv;
 
     /* Initiate async control */
-    int ret = ubus_hal->control_service_async(svc->name, start, service_control_cb, cctx);
+    int ret = ubus_hal->control_service_async(svc->name, action, service_control_cb, cctx);
     if (ret < 0) {
+        unlink_request(&cctx->link);
         free(cctx);
-        return -1;
+        return (ret == UBUS_HAL_BUSY) ? UBUS_HAL_BUSY : -1;
     }
 
     return 0;
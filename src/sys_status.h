@@ -12,13 +12,16 @@
 #include <stddef.h>
 
 #include "service_config.h"
-#define MAX_SERVICES MAX_MONITORED_SERVICES
+#include "hal/ubus_hal.h"
 #define HOSTNAME_MAX_LEN 32
 #define IP_ADDR_MAX_LEN  16
 
 /* Service query refresh interval (ms) */
 #define SERVICE_REFRESH_INTERVAL_MS 5000
 
+/* Changed-service log length (power of two) */
+#define SERVICE_CHANGE_LOG_SIZE 64
+
 typedef struct {
     char name[SERVICE_NAME_MAX_LEN];
     bool installed;
@@ -28,6 +31,11 @@ typedef struct {
     uint32_t request_id;     /* For matching responses */
     uint64_t request_time_ms; /* When query was sent */
     uint64_t last_update_ms;  /* When status was last updated */
+
+    /* Resource usage from the service's procd cgroup (service_cgroup.c) */
+    bool usage_valid;        /* cgroup found and read on last pass */
+    float cpu_percent;       /* Share of total CPU since previous pass */
+    uint64_t mem_bytes;      /* memory.current */
 } service_status_t;
 
 typedef struct sys_status {
@@ -47,9 +55,22 @@ typedef struct sys_status {
     uint64_t rx_speed;    /* bytes/sec */
     uint64_t tx_speed;    /* bytes/sec */
 
-    /* Service status (Phase 4 via ubus) */
-    service_status_t services[MAX_SERVICES];
+    /* Service status (Phase 4 via ubus), same order as service_config */
+    service_status_t *services;
     size_t service_count;
+    uint32_t service_generation;  /* service_config generation last synced */
+
+    /* Ring of service indices whose visible state changed, so consumers
+     * can sync incrementally instead of scanning every service */
+    uint32_t service_change_seq;  /* Total changes recorded */
+    uint32_t service_change_log[SERVICE_CHANGE_LOG_SIZE];
+
+    uint32_t usage_seq;           /* Bumped after each cgroup usage pass */
+
+    /* Bumped on any change a renderer can see (sample, table resync,
+     * query sent or answered, control result), so copies of the status
+     * are only refreshed when it moved */
+    uint32_t update_seq;
 } sys_status_t;
 
 typedef struct sys_status_ctx sys_status_ctx_t;
@@ -71,10 +92,53 @@ void sys_status_cleanup(sys_status_ctx_t *ctx);
 
 /*
  * Update local system info (CPU, memory, etc.) from /proc.
+ * Also syncs the service table with service_config and samples
+ * per-service cgroup usage (every SERVICE_USAGE_INTERVAL_MS), then
+ * publishes the result (status_shm.h, status_history.h).
  * This is synchronous and fast.
  */
 void sys_status_update_local(sys_status_ctx_t *ctx, sys_status_t *status);
 
+/*
+ * Replace the /proc and network readers of sys_status_update_local()
+ * (NULL restores them). The source fills the same fields; cgroup usage
+ * sampling is skipped while one is set. Used by the session replay tool.
+ */
+typedef void (*sys_status_local_source_t)(sys_status_t *status, void *priv);
+void sys_status_set_local_source(sys_status_local_source_t source, void *priv);
+
+/*
+ * Rebuild status->services from the current service_config.
+ * State of services present in both old and new config is preserved, so a
+ * reload does not drop known status or in-flight queries.
+ * Returns true if the table changed.
+ */
+bool sys_status_sync_services(sys_status_t *status);
+
+/*
+ * Free the service table owned by status. Queries and controls still in
+ * flight for it are detached and never touch status again; control
+ * callbacks run right away with index -1 and failure.
+ */
+void sys_status_free_services(sys_status_t *status);
+
+/*
+ * Find service index by name (hash lookup when synced).
+ * Returns index in status->services, or -1 if not found.
+ */
+int sys_status_find_service(const sys_status_t *status, const char *name);
+
+/*
+ * Fetch the next service changed since *cursor (running, installed,
+ * status_valid or a completed control operation).
+ * Returns 1 with *index set, 0 when caught up, or -1 if the consumer fell
+ * more than SERVICE_CHANGE_LOG_SIZE changes behind; *cursor is then moved
+ * to the head and the caller must resync every service.
+ * Indices logged before a table resync (service_generation change) are
+ * meaningless; consumers resync fully on generation change anyway.
+ */
+int sys_status_next_changed_service(const sys_status_t *status, uint32_t *cursor, int *index);
+
 /*
  * Utility: format uptime as "Xd Xh Xm" or "Xh Xm"
  */
@@ -95,11 +159,22 @@ void sys_status_format_speed_bps(uint64_t bytes_per_sec, char *buf, size_t bufle
  * Queries are only sent if:
  *   - No query is pending for the service, AND
  *   - Last update was more than SERVICE_REFRESH_INTERVAL_MS ago
+ * The pass stops when the ubus HAL has no request slot left; the
+ * services it did not reach stay stale and go out on the next call.
  *
  * Returns number of queries initiated.
  */
 int sys_status_query_services(sys_status_ctx_t *ctx, sys_status_t *status);
 
+/*
+ * Same as sys_status_query_services() with a custom refresh age:
+ * services updated less than max_age_ms ago are skipped.
+ * Used to back off while the Services page is far away and to prefetch
+ * when navigation heads towards it.
+ */
+int sys_status_query_services_stale(sys_status_ctx_t *ctx, sys_status_t *status,
+                                    uint32_t max_age_ms);
+
 /*
  * Check if any service queries are pending.
  */
@@ -118,4 +193,13 @@ int sys_status_control_service(sys_status_ctx_t *ctx, sys_status_t *status,
                                 int index, bool start,
                                 sys_status_control_cb cb, void *priv);
 
+/*
+ * Same as sys_status_control_service() with an explicit action
+ * (UBUS_HAL_ACTION_START/STOP/RESTART). Returns UBUS_HAL_BUSY, with the
+ * callback not invoked, when every control slot is taken: retry later.
+ */
+int sys_status_control_service_action(sys_status_ctx_t *ctx, sys_status_t *status,
+                                      int index, ubus_hal_action_t action,
+                                      sys_status_control_cb cb, void *priv);
+
 #endif
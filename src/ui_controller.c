@@ -5,20 +5,95 @@
 
 #include <string.h>
 
+#include "frame_prof.h"
 #include "hal/display_hal.h"
+#include "input_latency.h"
+#include "metrics.h"
 #include "pages/pages.h"
 #include "pages/page_services.h"
 
+METRIC_COUNTER(g_m_frames_rendered, "ui_frames_rendered");
+METRIC_COUNTER(g_m_frames_flushed, "ui_frames_flushed");
+
+/*
+ * Hand the working copy to renderers, only when a collector or ubus
+ * callback changed it since the last publish (a publish deep-copies the
+ * services table).
+ */
+static void publish_status(ui_controller_t *ui) {
+    if (ui->snapshot.published > 0 && ui->status.update_seq == ui->published_seq) {
+        return;
+    }
+    if (status_snapshot_publish(&ui->snapshot, &ui->status) == 0) {
+        ui->published_seq = ui->status.update_seq;
+    }
+}
+
+static void request_render(ui_controller_t *ui) {
+    publish_status(ui);
+    ui->needs_render = true;
+    if (ui->render_hook) {
+        ui->render_hook();
+    }
+}
+
 static void ui_services_control_cb(int index, bool success, int status, void *priv) {
     (void)status;
-    (void)priv;
     page_services_notify_control_result(index, success);
+    if (priv) {
+        request_render((ui_controller_t *)priv);
+    }
+}
+
+/* Query age for the Services page at the given page distance */
+static uint32_t service_refresh_age(int distance) {
+    if (distance <= 0) return SERVICE_REFRESH_INTERVAL_MS;
+    if (distance == 1) return UI_SERVICE_REFRESH_ADJACENT_MS;
+    return UI_SERVICE_REFRESH_FAR_MS;
+}
+
+/*
+ * Prefetch as soon as a slide towards the Services page starts, so that
+ * results arrive during the slide animation instead of after it.
+ */
+static void prefetch_services(ui_controller_t *ui) {
+    if (!ui->status_ctx || ui->status.service_count == 0) return;
+    if (!page_controller_is_animating(&ui->page_ctrl)) return;
+
+    if (page_controller_page_distance(&ui->page_ctrl, &page_services) == 0) {
+        sys_status_query_services_stale(ui->status_ctx, &ui->status,
+                                        SERVICE_REFRESH_INTERVAL_MS);
+    }
+}
+
+static void ui_batch_progress_cb(const service_batch_progress_t *progress, void *priv) {
+    ui_controller_t *ui = (ui_controller_t *)priv;
+    page_services_set_batch_progress(progress->done, progress->total, progress->failed);
+    request_render(ui);
+}
+
+/* Run control/batch requests raised by page key handlers */
+static void take_page_requests(ui_controller_t *ui, uint64_t now_ms) {
+    int control_index = -1;
+    bool control_start = false;
+    if (page_services_take_control_request(&control_index, &control_start, now_ms)) {
+        if (!ui->status_ctx ||
+            sys_status_control_service(ui->status_ctx, &ui->status, control_index,
+                                       control_start, ui_services_control_cb, ui) < 0) {
+            page_services_notify_control_result(control_index, false);
+        }
+    }
+
+    if (page_services_take_batch_request()) {
+        ui_controller_start_batch(ui, UBUS_HAL_ACTION_RESTART);
+    }
 }
 
 void ui_controller_init(ui_controller_t *ui) {
     if (!ui) return;
 
     memset(ui, 0, sizeof(*ui));
+    status_snapshot_init(&ui->snapshot);
     ui->power_on = true;
     ui->needs_render = true;
 
@@ -31,16 +106,25 @@ void ui_controller_init(ui_controller_t *ui) {
     /* Initialize system status context */
     ui->status_ctx = sys_status_init();
     if (ui->status_ctx) {
+        FRAME_PROF_BEGIN(sample_ns);
         sys_status_update_local(ui->status_ctx, &ui->status);
+        FRAME_PROF_END(sample_ns, FRAME_PHASE_SAMPLE, NULL);
     }
+    publish_status(ui);
 }
 
 void ui_controller_cleanup(ui_controller_t *ui) {
     if (!ui) return;
 
+    /* Controls still in flight are failed below: nothing to render */
+    ui->render_hook = NULL;
     page_controller_destroy(&ui->page_ctrl);
+    service_batch_free(ui->batch);
+    ui->batch = NULL;
     sys_status_cleanup(ui->status_ctx);
     ui->status_ctx = NULL;
+    sys_status_free_services(&ui->status);
+    status_snapshot_free(&ui->snapshot);
 }
 
 bool ui_controller_handle_button(ui_controller_t *ui, uint8_t key, bool long_press, uint64_t now_ms) {
@@ -49,15 +133,12 @@ bool ui_controller_handle_button(ui_controller_t *ui, uint8_t key, bool long_pre
     bool changed = page_controller_handle_key(&ui->page_ctrl, key, long_press, now_ms);
     ui->power_on = page_controller_is_screen_on(&ui->page_ctrl);
 
-    int control_index = -1;
-    bool control_start = false;
-    if (page_services_take_control_request(&control_index, &control_start, now_ms)) {
-        if (!ui->status_ctx ||
-            sys_status_control_service(ui->status_ctx, &ui->status, control_index,
-                                       control_start, ui_services_control_cb, NULL) < 0) {
-            page_services_notify_control_result(control_index, false);
-        }
+    take_page_requests(ui, now_ms);
+
+    if (changed) {
+        prefetch_services(ui);
     }
+    publish_status(ui);
 
     if (changed) {
         ui->needs_render = true;
@@ -68,23 +149,43 @@ bool ui_controller_handle_button(ui_controller_t *ui, uint8_t key, bool long_pre
 
 bool ui_controller_tick(ui_controller_t *ui, uint64_t now_ms) {
     if (!ui) return false;
+    FRAME_PROF_BEGIN(tick_ns);
+
+    /* Release finished batch (never from inside its own callbacks) */
+    if (ui->batch && service_batch_is_done(ui->batch)) {
+        service_batch_free(ui->batch);
+        ui->batch = NULL;
+    }
 
+    /* May replay keys buffered during an animation */
     bool needs_render = page_controller_tick(&ui->page_ctrl, now_ms);
     ui->power_on = page_controller_is_screen_on(&ui->page_ctrl);
+    take_page_requests(ui, now_ms);
+    prefetch_services(ui);
 
     /* Update status only in static mode to keep speeds stable */
-    if (ui->power_on && !page_controller_is_animating(&ui->page_ctrl) && ui->status_ctx) {
+    bool animating = page_controller_is_animating(&ui->page_ctrl) ||
+                     page_controller_is_page_animating(&ui->page_ctrl);
+    if (ui->power_on && !animating && ui->status_ctx) {
+        FRAME_PROF_BEGIN(sample_ns);
         sys_status_update_local(ui->status_ctx, &ui->status);
-        /* Trigger async service queries if services configured */
+        FRAME_PROF_END(sample_ns, FRAME_PHASE_SAMPLE, NULL);
+        /* Trigger async service queries, backing off while Services is far away */
         if (ui->status.service_count > 0) {
-            sys_status_query_services(ui->status_ctx, &ui->status);
+            int distance = page_controller_page_distance(&ui->page_ctrl, &page_services);
+            sys_status_query_services_stale(ui->status_ctx, &ui->status,
+                                            service_refresh_age(distance));
         }
         needs_render = true;
     }
 
+    /* Also picks up service query results that came in since the last tick */
+    publish_status(ui);
+
     if (needs_render) {
         ui->needs_render = true;
     }
+    FRAME_PROF_END(tick_ns, FRAME_PHASE_TICK, NULL);
     return needs_render;
 }
 
@@ -102,6 +203,7 @@ bool ui_controller_render(ui_controller_t *ui, uint64_t now_ms) {
         if (display_hal->set_power) {
             display_hal->set_power(false);
         }
+        input_latency_mark(INPUT_LATENCY_FLUSHED);
         ui->needs_render = false;
         return true;
     }
@@ -112,15 +214,30 @@ bool ui_controller_render(ui_controller_t *ui, uint64_t now_ms) {
         return false;
     }
 
+    FRAME_PROF_BEGIN(frame_ns);
     if (display_hal->clear_buffer) {
         display_hal->clear_buffer();
     }
 
-    page_controller_render(&ui->page_ctrl, u8g2, &ui->status, now_ms);
+    /*
+     * The frame renders from an immutable copy: nothing a collector or
+     * ubus callback does to ui->status can change it mid-frame. Frames
+     * only acquire; publishing follows status changes.
+     */
+    const sys_status_t *view = status_snapshot_acquire(&ui->snapshot);
+
+    page_controller_render(&ui->page_ctrl, u8g2, view, now_ms);
+    input_latency_mark(INPUT_LATENCY_RENDERED);
+    metric_inc(&g_m_frames_rendered);
 
     if (display_hal->send_buffer) {
+        FRAME_PROF_BEGIN(flush_ns);
         display_hal->send_buffer();
+        FRAME_PROF_END(flush_ns, FRAME_PHASE_FLUSH, NULL);
+        metric_inc(&g_m_frames_flushed);
     }
+    input_latency_mark(INPUT_LATENCY_FLUSHED);
+    FRAME_PROF_END(frame_ns, FRAME_PHASE_FRAME, NULL);
 
     if (display_hal->set_power) {
         display_hal->set_power(true);
@@ -137,9 +254,35 @@ int ui_controller_next_timeout_ms(const ui_controller_t *ui) {
         return UI_TICK_IDLE_MS;
     }
 
-    if (page_controller_is_animating(&ui->page_ctrl)) {
+    if (page_controller_is_animating(&ui->page_ctrl) ||
+        page_controller_is_page_animating(&ui->page_ctrl)) {
         return UI_TICK_ANIM_MS;
     }
 
     return UI_TICK_STATIC_MS;
 }
+
+void ui_controller_reload_config(ui_controller_t *ui) {
+    if (!ui) return;
+
+    service_config_reload();
+    if (sys_status_sync_services(&ui->status)) {
+        publish_status(ui);
+        ui->needs_render = true;
+    }
+}
+
+int ui_controller_start_batch(ui_controller_t *ui, ubus_hal_action_t action) {
+    if (!ui || !ui->status_ctx) return -1;
+
+    if (ui->batch) {
+        if (!service_batch_is_done(ui->batch)) return -1;
+        service_batch_free(ui->batch);
+    }
+
+    ui->batch = service_batch_create(ui->status_ctx, &ui->status, 0, ui_batch_progress_cb, ui);
+    if (!ui->batch) return -1;
+
+    service_batch_add_all(ui->batch, action);
+    return service_batch_start(ui->batch);
+}
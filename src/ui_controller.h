@@ -8,6 +8,8 @@
 #include <stdint.h>
 
 #include "page_controller.h"
+#include "service_batch.h"
+#include "status_snapshot.h"
 #include "sys_status.h"
 
 #define UI_TICK_ANIM_MS    20
@@ -15,12 +17,28 @@
 #define UI_TICK_IDLE_MS    0
 #define UI_AUTO_SLEEP_MS   30000
 
+/*
+ * Service query age by distance of the Services page from the visible
+ * page (0 = shown, 1 = adjacent, more = far). A slide towards the
+ * Services page prefetches with the shown-page age.
+ */
+#define UI_SERVICE_REFRESH_ADJACENT_MS  15000
+#define UI_SERVICE_REFRESH_FAR_MS       60000
+
 typedef struct {
     page_controller_t page_ctrl;
-    sys_status_t status;
+    sys_status_t status;        /* Working copy, mutated by the collectors */
     sys_status_ctx_t *status_ctx;
+    status_snapshot_t snapshot; /* What pages render: published when status changes */
+    uint32_t published_seq;     /* status.update_seq in the newest snapshot */
     bool needs_render;
     bool power_on;
+
+    /* Batch control in progress (NULL = none) */
+    service_batch_t *batch;
+
+    /* Optional: called when async results (ubus callbacks) need a render */
+    void (*render_hook)(void);
 } ui_controller_t;
 
 void ui_controller_init(ui_controller_t *ui);
@@ -31,4 +49,16 @@ bool ui_controller_tick(ui_controller_t *ui, uint64_t now_ms);
 bool ui_controller_render(ui_controller_t *ui, uint64_t now_ms);
 int ui_controller_next_timeout_ms(const ui_controller_t *ui);
 
+/*
+ * Reload service configuration (SIGHUP) without dropping known status.
+ */
+void ui_controller_reload_config(ui_controller_t *ui);
+
+/*
+ * Run an action on every monitored service as one batch
+ * (service_config batch_parallel calls in flight).
+ * Returns 0 if started, -1 if a batch is already running or on error.
+ */
+int ui_controller_start_batch(ui_controller_t *ui, ubus_hal_action_t action);
+
 #endif
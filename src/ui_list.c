@@ -0,0 +1,140 @@
+/*
+ * Virtualized list widget for NanoHat OLED UI
+ */
+#include "ui_list.h"
+
+#include <string.h>
+
+#include "anim.h"
+#include "fonts.h"
+
+void ui_list_init(ui_list_t *list, int row_height, int visible_rows) {
+    if (!list) return;
+
+    memset(list, 0, sizeof(*list));
+    list->row_height = row_height > 0 ? row_height : CONTENT_LINE_HEIGHT;
+    list->visible_rows = visible_rows > 0 ? visible_rows : 1;
+
+    /* Cap height centred in the row */
+    int ascent = font_ascent(font_content);
+    list->baseline = (list->row_height - ascent) / 2 + ascent;
+}
+
+static int max_scroll_px(const ui_list_t *list) {
+    int max_top = list->count - list->visible_rows;
+    return (max_top > 0) ? max_top * list->row_height : 0;
+}
+
+static int clamp_scroll(const ui_list_t *list, int px) {
+    int max_px = max_scroll_px(list);
+    if (px > max_px) px = max_px;
+    if (px < 0) px = 0;
+    return px;
+}
+
+static void jump_to(ui_list_t *list, int px) {
+    list->scroll_px = list->from_px = list->target_px = px;
+}
+
+void ui_list_set_count(ui_list_t *list, int count) {
+    if (!list) return;
+
+    list->count = count > 0 ? count : 0;
+    if (list->selected >= list->count) {
+        list->selected = list->count > 0 ? list->count - 1 : 0;
+    }
+    jump_to(list, clamp_scroll(list, list->target_px));
+}
+
+void ui_list_reset(ui_list_t *list) {
+    if (!list) return;
+
+    list->selected = 0;
+    jump_to(list, 0);
+}
+
+/* Scroll offset keeping the selection visible; moves only when it leaves the viewport */
+static int scroll_for_selection(const ui_list_t *list) {
+    int top_px = list->target_px;
+    int sel_px = list->selected * list->row_height;
+    int view_px = list->visible_rows * list->row_height;
+    if (sel_px < top_px) {
+        top_px = sel_px;
+    } else if (sel_px + list->row_height > top_px + view_px) {
+        top_px = sel_px + list->row_height - view_px;
+    }
+    return clamp_scroll(list, top_px);
+}
+
+void ui_list_select(ui_list_t *list, int index) {
+    if (!list || index < 0 || index >= list->count) return;
+
+    list->selected = index;
+    jump_to(list, scroll_for_selection(list));
+}
+
+bool ui_list_move(ui_list_t *list, int delta) {
+    if (!list || list->count == 0 || delta == 0) return false;
+
+    int selected = (list->selected + delta) % list->count;
+    if (selected < 0) selected += list->count;
+    if (selected == list->selected) return false;
+    list->selected = selected;
+
+    int top_px = scroll_for_selection(list);
+    if (top_px != list->target_px) {
+        /* Retarget from the currently displayed offset (no visible jump) */
+        list->from_px = list->scroll_px;
+        list->target_px = top_px;
+        list->anim_start_ms = 0;
+    }
+    return true;
+}
+
+bool ui_list_is_animating(const ui_list_t *list) {
+    return list && list->scroll_px != list->target_px;
+}
+
+static void update_scroll(ui_list_t *list, uint64_t now_ms) {
+    if (list->scroll_px == list->target_px) return;
+    if (list->anim_start_ms == 0) list->anim_start_ms = now_ms;
+
+    float progress = anim_progress(list->anim_start_ms, now_ms, UI_LIST_SCROLL_MS);
+    if (progress >= 1.0f) {
+        list->scroll_px = list->target_px;
+        return;
+    }
+
+    float eased = ease_out_quad(progress);
+    list->scroll_px = list->from_px + (int)((list->target_px - list->from_px) * eased);
+}
+
+void ui_list_visible_range(const ui_list_t *list, int *first, int *rows) {
+    int f = 0, n = 0;
+    if (list && list->count > 0) {
+        f = list->scroll_px / list->row_height;
+        /* One extra row when scrolled mid-row */
+        n = list->visible_rows + ((list->scroll_px % list->row_height) ? 1 : 0);
+        if (f + n > list->count) n = list->count - f;
+    }
+    if (first) *first = f;
+    if (rows) *rows = n;
+}
+
+void ui_list_render(ui_list_t *list, u8g2_t *u8g2, int y_top, uint64_t now_ms,
+                    ui_list_draw_fn draw, void *priv) {
+    if (!list || !u8g2 || !draw) return;
+
+    update_scroll(list, now_ms);
+
+    int first, rows;
+    ui_list_visible_range(list, &first, &rows);
+
+    /* Rows partially outside the viewport are cut by the page clip window */
+    int y = y_top - (list->scroll_px % list->row_height);
+    for (int i = 0; i < rows; i++) {
+        int index = first + i;
+        draw(u8g2, index, y + list->baseline, index == list->selected, priv);
+        y += list->row_height;
+    }
+}
@@ -0,0 +1,90 @@
+/*
+ * Virtualized list widget for NanoHat OLED UI
+ *
+ * Keeps selection and a pixel scroll offset for lists of any length.
+ * Only rows intersecting the viewport are drawn, and scrolling animates
+ * per pixel (ease-out) instead of jumping whole lines, so rendering cost
+ * is O(visible rows) regardless of item count.
+ */
+#ifndef UI_LIST_H
+#define UI_LIST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "page.h"
+
+/* Scroll animation duration in ms */
+#define UI_LIST_SCROLL_MS 120
+
+/*
+ * Row draw callback.
+ * index: item index, baseline_y: text baseline for the row,
+ * selected: row is the current selection.
+ */
+typedef void (*ui_list_draw_fn)(u8g2_t *u8g2, int index, int baseline_y,
+                                bool selected, void *priv);
+
+typedef struct {
+    int count;          /* Total items */
+    int selected;       /* Selected item index */
+    int row_height;     /* Pixels per row */
+    int visible_rows;   /* Fully visible rows in viewport */
+    int baseline;       /* Text baseline from the row top */
+
+    /* Scroll state (pixels from top of list) */
+    int scroll_px;      /* Currently displayed offset */
+    int from_px;        /* Animation start offset */
+    int target_px;      /* Animation end offset */
+    uint64_t anim_start_ms; /* 0 = start on next render */
+} ui_list_t;
+
+/*
+ * Initialize list with row geometry. Row text (font_content) is centred
+ * vertically: the baseline follows row_height and the font ascent.
+ */
+void ui_list_init(ui_list_t *list, int row_height, int visible_rows);
+
+/*
+ * Set item count; clamps selection and scroll without animating.
+ */
+void ui_list_set_count(ui_list_t *list, int count);
+
+/*
+ * Select first item and reset scroll.
+ */
+void ui_list_reset(ui_list_t *list);
+
+/*
+ * Move selection by delta (with wrap) and start scroll animation if needed.
+ * The animation clock starts at the next ui_list_render(), so this can be
+ * called from key handlers that have no timestamp.
+ * Returns true if selection changed.
+ */
+bool ui_list_move(ui_list_t *list, int delta);
+
+/*
+ * Select item without animation (e.g. after the list was re-sorted),
+ * scrolling only as far as needed to keep it visible.
+ */
+void ui_list_select(ui_list_t *list, int index);
+
+/*
+ * True while scroll animation is running.
+ */
+bool ui_list_is_animating(const ui_list_t *list);
+
+/*
+ * Advance animation and draw visible rows.
+ * y_top: top pixel of the viewport.
+ */
+void ui_list_render(ui_list_t *list, u8g2_t *u8g2, int y_top, uint64_t now_ms,
+                    ui_list_draw_fn draw, void *priv);
+
+/*
+ * First item index intersecting the viewport and number of such rows.
+ * Valid after ui_list_render().
+ */
+void ui_list_visible_range(const ui_list_t *list, int *first, int *rows);
+
+#endif
@@ -3,10 +3,11 @@
 
 #include <stdint.h>
 #include <stdbool.h>
-#include <pthread.h>
+#include <stddef.h>
 #include <stdatomic.h>
 
-#include "ring_queue.h"
+#include "mpsc_ring.h"
+#include "ring_waiter.h"
 
 typedef enum {
     EVT_NONE = 0,
@@ -34,14 +35,23 @@ typedef enum {
     EQ_RESULT_ERR = -1
 } event_queue_result_t;
 
+/*
+ * Events from any number of producer threads to one consumer (UI thread).
+ *
+ * Non-tick events go through a lock-free MPSC ring. Ticks never take a
+ * slot: they are merged into one pending tick (expirations summed, latest
+ * timestamp kept) that is delivered once the ring is drained, so a full
+ * ring only ever holds input events and a tick never displaces one.
+ */
 typedef struct {
-    ring_queue_t ring;
-    uint64_t replaced_ticks;
-    uint64_t dropped_critical;
-    pthread_mutex_t wait_lock;
-    pthread_cond_t wait_cond;
-    bool wait_clock_monotonic;
-    _Atomic uint64_t seq;
+    mpsc_ring_t ring;
+    ring_waiter_t waiter;
+
+    /* Pending tick: bit 32 set when present, low 32 bits = summed data */
+    _Alignas(RING_CACHELINE) _Atomic uint64_t tick_pending;
+    _Atomic uint64_t tick_timestamp_ns;
+
+    _Atomic uint64_t dropped_critical;
     _Atomic bool closed;
 } event_queue_t;
 
@@ -53,4 +63,12 @@ event_queue_result_t event_queue_push(event_queue_t *q, const app_event_t *event
 int event_queue_try_pop(event_queue_t *q, app_event_t *out);
 int event_queue_wait(event_queue_t *q, app_event_t *out, int timeout_ms);
 
+/*
+ * poll() integration for the consumer: arm, then poll the fd for POLLIN
+ * only if event_queue_arm() returned true (nothing queued yet). After
+ * poll() returns, drain with event_queue_try_pop() and arm again.
+ */
+int event_queue_get_fd(event_queue_t *q);
+bool event_queue_arm(event_queue_t *q);
+
 #endif
@@ -29,10 +29,19 @@ typedef struct {
     bool running;
 } ubus_result_t;
 
+/* Completion of invoke_async(), called on the ubus thread's uloop */
+typedef void (*ubus_hal_done_fn)(const ubus_result_t *result, void *user);
+
 typedef struct {
     int  (*init)(void);
     void (*cleanup)(void);
     int  (*invoke)(const ubus_task_t *task, ubus_result_t *result);
+    /*
+     * Start a call without blocking; must run on the thread that owns the
+     * uloop. On 0, done is called exactly once from the loop. On error,
+     * done is not called. Optional: NULL falls back to invoke().
+     */
+    int  (*invoke_async)(const ubus_task_t *task, ubus_hal_done_fn done, void *user);
     int  (*register_object)(void);
     void (*unregister_object)(void);
 } ubus_hal_ops_t;
@@ -1,7 +1,9 @@
 #include "hal/ubus_hal.h"
 
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <libubox/uloop.h>
 
 static int mock_delay_ms = 0;
 static int mock_fail_count = 0;
@@ -34,13 +36,9 @@ static void mock_cleanup(void) {
     mock_call_count = 0;
 }
 
-static int mock_invoke(const ubus_task_t *task, ubus_result_t *result) {
+static int mock_fill_result(const ubus_task_t *task, ubus_result_t *result) {
     mock_call_count++;
 
-    if (mock_delay_ms > 0) {
-        usleep((useconds_t)mock_delay_ms * 1000);
-    }
-
     memset(result, 0, sizeof(*result));
     strncpy(result->service_name, task->service_name, sizeof(result->service_name) - 1);
     result->action = task->action;
@@ -65,6 +63,40 @@ static int mock_invoke(const ubus_task_t *task, ubus_result_t *result) {
     return 0;
 }
 
+static int mock_invoke(const ubus_task_t *task, ubus_result_t *result) {
+    if (mock_delay_ms > 0) {
+        usleep((useconds_t)mock_delay_ms * 1000);
+    }
+    return mock_fill_result(task, result);
+}
+
+/* Async calls complete from a uloop timer, so several can be in flight */
+typedef struct {
+    struct uloop_timeout timer;
+    ubus_result_t result;
+    ubus_hal_done_fn done;
+    void *user;
+} mock_call_t;
+
+static void mock_call_complete(struct uloop_timeout *t) {
+    mock_call_t *call = container_of(t, mock_call_t, timer);
+    call->done(&call->result, call->user);
+    free(call);
+}
+
+static int mock_invoke_async(const ubus_task_t *task, ubus_hal_done_fn done, void *user) {
+    mock_call_t *call = calloc(1, sizeof(*call));
+    if (!call) {
+        return -1;
+    }
+    mock_fill_result(task, &call->result);
+    call->done = done;
+    call->user = user;
+    call->timer.cb = mock_call_complete;
+    uloop_timeout_set(&call->timer, mock_delay_ms);
+    return 0;
+}
+
 static int mock_register_object(void) {
     return 0;
 }
@@ -76,6 +108,7 @@ static const ubus_hal_ops_t mock_ops = {
     .init = mock_init,
     .cleanup = mock_cleanup,
     .invoke = mock_invoke,
+    .invoke_async = mock_invoke_async,
     .register_object = mock_register_object,
     .unregister_object = mock_unregister_object
 };
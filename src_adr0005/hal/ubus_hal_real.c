@@ -2,10 +2,12 @@
 
 #include "hal/ubus_hal.h"
 
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <libubus.h>
 #include <libubox/blobmsg.h>
+#include <libubox/uloop.h>
 
 static struct ubus_context *ctx = NULL;
 static uint32_t rc_id = 0;
@@ -61,7 +63,51 @@ static void rc_list_cb(struct ubus_request *req, int type, struct blob_attr *msg
     }
 }
 
+/*
+ * Async calls, driven by the ubus thread's uloop. Each call carries its
+ * own timeout: ubus_complete_request_async() does not arm one.
+ */
+typedef struct {
+    struct ubus_request req;
+    struct uloop_timeout timeout;
+    struct list_head list;
+    struct query_ctx qctx;
+    ubus_result_t result;
+    ubus_hal_done_fn done;
+    void *user;
+} async_call_t;
+
+static LIST_HEAD(async_calls);
+static bool connection_lost = false;
+static struct uloop_timeout reconnect_timer;
+
+static void async_call_finish(async_call_t *call, int ret) {
+    uloop_timeout_cancel(&call->timeout);
+    list_del(&call->list);
+    call->result.success = (ret == 0);
+    call->result.error_code = ret;
+    call->done(&call->result, call->user);
+    free(call);
+}
+
+/* Fail every outstanding call; done callbacks may start new ones */
+static void abort_async_calls(int ret) {
+    LIST_HEAD(pending);
+    list_splice_init(&async_calls, &pending);
+
+    while (!list_empty(&pending)) {
+        async_call_t *call = list_first_entry(&pending, async_call_t, list);
+        if (ctx) {
+            ubus_abort_request(ctx, &call->req);
+        }
+        async_call_finish(call, ret);
+    }
+}
+
 static void reset_connection(void) {
+    abort_async_calls(UBUS_STATUS_CONNECTION_FAILED);
+    uloop_timeout_cancel(&reconnect_timer);
+    connection_lost = false;
     if (ctx) {
         ubus_free(ctx);
         ctx = NULL;
@@ -69,6 +115,21 @@ static void reset_connection(void) {
     rc_id = 0;
 }
 
+static void on_reconnect_timer(struct uloop_timeout *t) {
+    (void)t;
+    reset_connection();
+}
+
+/* Called from inside libubus: defer freeing the context to the loop */
+static void on_connection_lost(struct ubus_context *c) {
+    connection_lost = true;
+    if (c->sock.registered) {
+        uloop_fd_delete(&c->sock);
+    }
+    reconnect_timer.cb = on_reconnect_timer;
+    uloop_timeout_set(&reconnect_timer, 0);
+}
+
 static int get_backoff_delay(void) {
     if (consecutive_failures == 0) return 0;
     int delay = BACKOFF_BASE_SEC << (consecutive_failures - 1);  /* 1, 2, 4, 8, ... */
@@ -76,7 +137,8 @@ static int get_backoff_delay(void) {
 }
 
 static int ensure_context(void) {
-    if (ctx) return 0;
+    if (ctx && !connection_lost) return 0;
+    if (ctx) reset_connection();
 
     /* Check backoff delay */
     if (consecutive_failures > 0) {
@@ -97,6 +159,7 @@ static int ensure_context(void) {
     }
 
     /* Connection successful */
+    ctx->connection_lost = on_connection_lost;
     consecutive_failures = 0;
     return 0;
 }
@@ -179,16 +242,92 @@ retry:
     return ret ? -1 : 0;
 }
 
+static void async_complete_cb(struct ubus_request *req, int ret) {
+    async_call_finish(container_of(req, async_call_t, req), ret);
+}
+
+static void async_timeout_cb(struct uloop_timeout *t) {
+    async_call_t *call = container_of(t, async_call_t, timeout);
+    if (ctx) {
+        ubus_abort_request(ctx, &call->req);
+    }
+    async_call_finish(call, UBUS_STATUS_TIMEOUT);
+}
+
+static int real_invoke_async(const ubus_task_t *task, ubus_hal_done_fn done, void *user) {
+    struct blob_buf b = {0};
+    const char *method = "init";
+    const char *action = NULL;
+    int timeout_ms = 5000;
+
+    if (!task || !done || !task->service_name[0]) return -1;
+
+    switch (task->action) {
+    case UBUS_ACTION_QUERY:
+        method = "list";
+        timeout_ms = 2000;
+        break;
+    case UBUS_ACTION_START:
+        action = "start";
+        break;
+    case UBUS_ACTION_STOP:
+        action = "stop";
+        break;
+    default:
+        return -1;
+    }
+
+    /* The rc id lookup is synchronous, once per connection */
+    if (ensure_rc_id() < 0) return -1;
+    if (!ctx->sock.registered) {
+        ubus_add_uloop(ctx);
+    }
+
+    async_call_t *call = calloc(1, sizeof(*call));
+    if (!call) return -1;
+
+    strncpy(call->result.service_name, task->service_name, sizeof(call->result.service_name) - 1);
+    call->result.action = task->action;
+    call->result.request_id = task->request_id;
+    call->done = done;
+    call->user = user;
+
+    blob_buf_init(&b, 0);
+    blobmsg_add_string(&b, "name", task->service_name);
+    if (action) {
+        blobmsg_add_string(&b, "action", action);
+    }
+    int ret = ubus_invoke_async(ctx, rc_id, method, b.head, &call->req);
+    blob_buf_free(&b);
+
+    if (ret) {
+        free(call);
+        if (is_connection_error(ret)) {
+            reset_connection();
+        }
+        return -1;
+    }
+
+    if (task->action == UBUS_ACTION_QUERY) {
+        call->qctx.installed = &call->result.installed;
+        call->qctx.running = &call->result.running;
+        call->req.data_cb = rc_list_cb;
+        call->req.priv = &call->qctx;
+    }
+    call->req.complete_cb = async_complete_cb;
+    list_add_tail(&call->list, &async_calls);
+    call->timeout.cb = async_timeout_cb;
+    uloop_timeout_set(&call->timeout, timeout_ms);
+    ubus_complete_request_async(ctx, &call->req);
+    return 0;
+}
+
 static int real_init(void) {
     return ensure_context();
 }
 
 static void real_cleanup(void) {
-    if (ctx) {
-        ubus_free(ctx);
-        ctx = NULL;
-        rc_id = 0;
-    }
+    reset_connection();
 }
 
 static int real_invoke(const ubus_task_t *task, ubus_result_t *result) {
@@ -237,6 +376,7 @@ static const ubus_hal_ops_t real_ops = {
     .init = real_init,
     .cleanup = real_cleanup,
     .invoke = real_invoke,
+    .invoke_async = real_invoke_async,
     .register_object = real_register_object,
     .unregister_object = real_unregister_object
 };
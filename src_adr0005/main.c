@@ -120,6 +120,12 @@ int main(void) {
         return 1;
     }
 
+    /*
+     * Before the worker starts: uloop_run() installs its own SIGINT/SIGTERM
+     * handlers (process-wide) unless one is already in place.
+     */
+    setup_signals();
+
     if (ubus_thread_start(&g_ubus) != 0) {
         printf("FAIL: ubus thread start\n");
         ubus_thread_destroy(&g_ubus);
@@ -151,7 +157,6 @@ int main(void) {
 
     printf("%s ready (3 threads)\n", APP_NAME);
 
-    setup_signals();
     int rc = event_loop_run(&g_loop);
     if (rc != 0) {
         printf("FAIL: event loop run\n");
@@ -0,0 +1,113 @@
+#include "mpsc_ring.h"
+
+#include <stdalign.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    _Atomic size_t seq;
+} mpsc_slot_t;
+
+#define MPSC_SLOT_ALIGN alignof(max_align_t)
+#define MPSC_ITEM_OFFSET \
+    ((sizeof(mpsc_slot_t) + MPSC_SLOT_ALIGN - 1) & ~(MPSC_SLOT_ALIGN - 1))
+
+static size_t ring_round_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+static mpsc_slot_t *mpsc_ring_slot(mpsc_ring_t *r, size_t pos) {
+    return (mpsc_slot_t *)(r->slots + (pos & r->mask) * r->slot_size);
+}
+
+static void *mpsc_slot_item(mpsc_slot_t *slot) {
+    return (uint8_t *)slot + MPSC_ITEM_OFFSET;
+}
+
+int mpsc_ring_init(mpsc_ring_t *r, size_t capacity, size_t item_size) {
+    if (!r || capacity == 0 || item_size == 0) {
+        return -1;
+    }
+
+    memset(r, 0, sizeof(*r));
+    capacity = ring_round_pow2(capacity);
+    r->slot_size = (MPSC_ITEM_OFFSET + item_size + MPSC_SLOT_ALIGN - 1) & ~(MPSC_SLOT_ALIGN - 1);
+    r->slots = (uint8_t *)malloc(capacity * r->slot_size);
+    if (!r->slots) {
+        return -1;
+    }
+    r->item_size = item_size;
+    r->mask = capacity - 1;
+
+    for (size_t i = 0; i < capacity; i++) {
+        atomic_init(&mpsc_ring_slot(r, i)->seq, i);
+    }
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    return 0;
+}
+
+void mpsc_ring_destroy(mpsc_ring_t *r) {
+    if (!r) {
+        return;
+    }
+    free(r->slots);
+    memset(r, 0, sizeof(*r));
+}
+
+bool mpsc_ring_try_push(mpsc_ring_t *r, const void *item) {
+    size_t pos = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    mpsc_slot_t *slot;
+
+    for (;;) {
+        slot = mpsc_ring_slot(r, pos);
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            /* Slot free for this lap: claim it */
+            if (atomic_compare_exchange_weak_explicit(&r->tail, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* Consumer has not freed it yet: full */
+            return false;
+        } else {
+            pos = atomic_load_explicit(&r->tail, memory_order_relaxed);
+        }
+    }
+
+    memcpy(mpsc_slot_item(slot), item, r->item_size);
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return true;
+}
+
+bool mpsc_ring_try_pop(mpsc_ring_t *r, void *out) {
+    size_t pos = atomic_load_explicit(&r->head, memory_order_relaxed);
+    mpsc_slot_t *slot = mpsc_ring_slot(r, pos);
+    size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    if (seq != pos + 1) {
+        /* Empty, or the next producer has claimed but not yet published */
+        return false;
+    }
+
+    memcpy(out, mpsc_slot_item(slot), r->item_size);
+    atomic_store_explicit(&slot->seq, pos + r->mask + 1, memory_order_release);
+    atomic_store_explicit(&r->head, pos + 1, memory_order_relaxed);
+    return true;
+}
+
+size_t mpsc_ring_count(mpsc_ring_t *r) {
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+}
+
+size_t mpsc_ring_capacity(const mpsc_ring_t *r) {
+    return r->mask + 1;
+}
@@ -0,0 +1,45 @@
+#ifndef MPSC_RING_H
+#define MPSC_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#ifndef RING_CACHELINE
+#define RING_CACHELINE 64
+#endif
+
+/*
+ * Lock-free multi-producer / single-consumer ring of fixed-size items.
+ *
+ * Bounded ring with a sequence number per slot: producers claim a slot
+ * with one CAS on the tail and publish it by bumping the slot sequence;
+ * the consumer needs no atomic read-modify-write at all. Producers never
+ * wait for each other beyond a CAS retry. Capacity is rounded up to a
+ * power of two.
+ */
+typedef struct {
+    _Alignas(RING_CACHELINE) _Atomic size_t tail;   /* Producers */
+    _Alignas(RING_CACHELINE) _Atomic size_t head;   /* Consumer */
+
+    _Alignas(RING_CACHELINE) uint8_t *slots;
+    size_t slot_size;           /* Sequence + item, padded */
+    size_t item_size;
+    size_t mask;
+} mpsc_ring_t;
+
+int mpsc_ring_init(mpsc_ring_t *r, size_t capacity, size_t item_size);
+void mpsc_ring_destroy(mpsc_ring_t *r);
+
+/* Any thread */
+bool mpsc_ring_try_push(mpsc_ring_t *r, const void *item);
+
+/* Consumer thread only */
+bool mpsc_ring_try_pop(mpsc_ring_t *r, void *out);
+
+/* Approximate while producers are active */
+size_t mpsc_ring_count(mpsc_ring_t *r);
+size_t mpsc_ring_capacity(const mpsc_ring_t *r);
+
+#endif
@@ -5,9 +5,9 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdatomic.h>
-#include <pthread.h>
 
-#include "ring_queue.h"
+#include "spsc_ring.h"
+#include "ring_waiter.h"
 #include "hal/ubus_hal.h"
 
 #define RESULT_QUEUE_MAX_ABANDONED 16
@@ -25,18 +25,30 @@ typedef struct {
     uint64_t drops_abandoned;
 } result_queue_stats_t;
 
+/*
+ * Results from the ubus thread (single producer) to the UI thread (single
+ * consumer) over a lock-free SPSC ring.
+ *
+ * Abandoned request IDs are a small lock-free set. A result for an
+ * abandoned ID is dropped on push, or skipped on pop if it was abandoned
+ * after being queued. Queued abandoned results do not count against the
+ * capacity: the ring has RESULT_QUEUE_MAX_ABANDONED spare slots for them,
+ * so a fresh result is still accepted while stale ones wait to be skipped.
+ */
 typedef struct {
-    ring_queue_t ring;
-    result_queue_stats_t stats;
-    pthread_mutex_t wait_lock;
-    pthread_cond_t wait_cond;
-    bool wait_clock_monotonic;
-    _Atomic uint64_t seq;
+    spsc_ring_t ring;
+    ring_waiter_t waiter;
+    size_t capacity;
     _Atomic bool closed;
 
-    uint32_t abandoned_ids[RESULT_QUEUE_MAX_ABANDONED];
-    size_t abandoned_count;
-    pthread_mutex_t abandoned_lock;
+    _Atomic uint64_t pushes;
+    _Atomic uint64_t pops;
+    _Atomic uint64_t drops;
+    _Atomic uint64_t drops_abandoned;
+
+    /* Entry = RESULT_QUEUE_ABANDONED_SET | request_id, 0 = free */
+    _Atomic uint64_t abandoned[RESULT_QUEUE_MAX_ABANDONED];
+    _Atomic uint32_t abandoned_count;
 } result_queue_t;
 
 int result_queue_init(result_queue_t *q, size_t capacity);
@@ -47,6 +59,10 @@ result_queue_result_t result_queue_push(result_queue_t *q, const ubus_result_t *
 int result_queue_try_pop(result_queue_t *q, ubus_result_t *out);
 int result_queue_wait(result_queue_t *q, ubus_result_t *out, int timeout_ms);
 
+/* poll() integration, see event_queue_arm() */
+int result_queue_get_fd(result_queue_t *q);
+bool result_queue_arm(result_queue_t *q);
+
 void result_queue_mark_abandoned(result_queue_t *q, uint32_t request_id);
 void result_queue_clear_abandoned(result_queue_t *q, uint32_t request_id);
 
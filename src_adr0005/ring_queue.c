@@ -15,6 +15,74 @@ static void *ring_queue_item_ptr(ring_queue_t *q, size_t index) {
     return q->buffer + (index * q->item_size);
 }
 
+/* Keyed index: linear probing, backward-shift deletion (no tombstones) */
+
+static uint64_t ring_queue_hash(ring_queue_t *q, const void *item) {
+    uint64_t h = q->key_fn(item, q->key_user);
+    /* splitmix64 finalizer: spread weak caller hashes over the index */
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+static void ring_queue_index_insert(ring_queue_t *q, uint64_t hash, size_t slot) {
+    size_t i = (size_t)hash & q->index_mask;
+    while (q->index[i].used) {
+        i = (i + 1) & q->index_mask;
+    }
+    q->index[i].hash = hash;
+    q->index[i].slot = slot;
+    q->index[i].used = true;
+}
+
+static ring_queue_index_entry_t *ring_queue_index_find(ring_queue_t *q, uint64_t hash, const void *item) {
+    for (size_t i = (size_t)hash & q->index_mask; q->index[i].used; i = (i + 1) & q->index_mask) {
+        ring_queue_index_entry_t *e = &q->index[i];
+        if (e->hash == hash && q->key_eq(ring_queue_item_ptr(q, e->slot), item, q->key_user)) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void ring_queue_index_remove(ring_queue_t *q, size_t slot) {
+    uint64_t hash = ring_queue_hash(q, ring_queue_item_ptr(q, slot));
+    size_t i = (size_t)hash & q->index_mask;
+    while (q->index[i].used && q->index[i].slot != slot) {
+        i = (i + 1) & q->index_mask;
+    }
+    if (!q->index[i].used) {
+        return;
+    }
+
+    /* Pull later entries of the probe run back into the hole */
+    size_t j = i;
+    for (;;) {
+        j = (j + 1) & q->index_mask;
+        if (!q->index[j].used) {
+            break;
+        }
+        size_t home = (size_t)q->index[j].hash & q->index_mask;
+        bool stays = (i <= j) ? (home > i && home <= j) : (home > i || home <= j);
+        if (!stays) {
+            q->index[i] = q->index[j];
+            i = j;
+        }
+    }
+    q->index[i].used = false;
+}
+
+static void ring_queue_index_rebuild(ring_queue_t *q) {
+    memset(q->index, 0, (q->index_mask + 1) * sizeof(*q->index));
+    for (size_t i = 0; i < q->count; i++) {
+        size_t idx = (q->head + i) % q->capacity;
+        ring_queue_index_insert(q, ring_queue_hash(q, ring_queue_item_ptr(q, idx)), idx);
+    }
+}
+
 int ring_queue_init(ring_queue_t *q, size_t capacity, size_t item_size) {
     if (!q || capacity == 0 || item_size == 0) {
         return -1;
@@ -39,7 +107,13 @@ void ring_queue_destroy(ring_queue_t *q) {
     }
     pthread_mutex_destroy(&q->lock);
     free(q->buffer);
+    free(q->index);
     q->buffer = NULL;
+    q->index = NULL;
+    q->index_mask = 0;
+    q->key_fn = NULL;
+    q->key_eq = NULL;
+    q->key_user = NULL;
     q->capacity = 0;
     q->item_size = 0;
     q->head = 0;
@@ -69,8 +143,59 @@ void ring_queue_set_merge_fn(ring_queue_t *q, ring_queue_merge_fn fn, void *user
     ring_queue_unlock(q);
 }
 
-static ring_queue_result_t ring_queue_try_merge(ring_queue_t *q, const void *item) {
-    if (q->policy != RQ_COALESCE || !q->merge_fn || q->count == 0) {
+int ring_queue_set_key_fn(ring_queue_t *q, ring_queue_key_fn key_fn, ring_queue_key_eq_fn key_eq, void *user) {
+    if (!q || !key_fn || !key_eq) {
+        return -1;
+    }
+
+    /* At most half full, so probe runs stay short */
+    size_t size = 1;
+    while (size < q->capacity * 2) {
+        size <<= 1;
+    }
+    ring_queue_index_entry_t *index = (ring_queue_index_entry_t *)calloc(size, sizeof(*index));
+    if (!index) {
+        return -1;
+    }
+
+    ring_queue_lock(q);
+    free(q->index);
+    q->index = index;
+    q->index_mask = size - 1;
+    q->key_fn = key_fn;
+    q->key_eq = key_eq;
+    q->key_user = user;
+    ring_queue_index_rebuild(q);
+    ring_queue_unlock(q);
+    return 0;
+}
+
+static ring_queue_result_t ring_queue_try_merge_keyed(ring_queue_t *q, const void *item, uint64_t hash) {
+    ring_queue_index_entry_t *e = ring_queue_index_find(q, hash, item);
+    if (!e) {
+        return RQ_RESULT_ERR;
+    }
+
+    void *existing = ring_queue_item_ptr(q, e->slot);
+    if (q->merge_fn) {
+        if (!q->merge_fn(existing, item, q->merge_user)) {
+            return RQ_RESULT_ERR;
+        }
+    } else {
+        memcpy(existing, item, q->item_size);
+    }
+    q->stats.merges++;
+    return RQ_RESULT_MERGED;
+}
+
+static ring_queue_result_t ring_queue_try_merge(ring_queue_t *q, const void *item, uint64_t hash) {
+    if (q->policy != RQ_COALESCE || q->count == 0) {
+        return RQ_RESULT_ERR;
+    }
+    if (q->index) {
+        return ring_queue_try_merge_keyed(q, item, hash);
+    }
+    if (!q->merge_fn) {
         return RQ_RESULT_ERR;
     }
 
@@ -94,13 +219,19 @@ ring_queue_result_t ring_queue_push(ring_queue_t *q, const void *item) {
     ring_queue_lock(q);
     q->stats.pushes++;
 
-    if (ring_queue_try_merge(q, item) == RQ_RESULT_MERGED) {
+    /* Hashed once per push: used for both the lookup and the insert */
+    uint64_t hash = q->index ? ring_queue_hash(q, item) : 0;
+    if (ring_queue_try_merge(q, item, hash) == RQ_RESULT_MERGED) {
         ring_queue_unlock(q);
         return RQ_RESULT_MERGED;
     }
 
     if (q->count == q->capacity) {
         if (q->policy == RQ_OVERWRITE_OLDEST) {
+            if (q->index) {
+                ring_queue_index_remove(q, q->tail);
+                ring_queue_index_insert(q, hash, q->tail);
+            }
             memcpy(ring_queue_item_ptr(q, q->tail), item, q->item_size);
             q->tail = (q->tail + 1) % q->capacity;
             // 覆盖最旧元素：满队列时 head 与 tail 对齐到新位置，队列仍保持满。
@@ -116,6 +247,9 @@ ring_queue_result_t ring_queue_push(ring_queue_t *q, const void *item) {
     }
 
     memcpy(ring_queue_item_ptr(q, q->tail), item, q->item_size);
+    if (q->index) {
+        ring_queue_index_insert(q, hash, q->tail);
+    }
     q->tail = (q->tail + 1) % q->capacity;
     q->count++;
     ring_queue_unlock(q);
@@ -133,6 +267,9 @@ bool ring_queue_pop(ring_queue_t *q, void *out) {
         return false;
     }
 
+    if (q->index) {
+        ring_queue_index_remove(q, q->head);
+    }
     memcpy(out, ring_queue_item_ptr(q, q->head), q->item_size);
     q->head = (q->head + 1) % q->capacity;
     q->count--;
@@ -156,6 +293,10 @@ bool ring_queue_replace_first_if(ring_queue_t *q, ring_queue_match_fn match, voi
         size_t idx = (q->head + i) % q->capacity;
         void *existing = ring_queue_item_ptr(q, idx);
         if (match(existing, user)) {
+            if (q->index) {
+                ring_queue_index_remove(q, idx);
+                ring_queue_index_insert(q, ring_queue_hash(q, item), idx);
+            }
             memcpy(existing, item, q->item_size);
             ring_queue_unlock(q);
             return true;
@@ -166,6 +307,25 @@ bool ring_queue_replace_first_if(ring_queue_t *q, ring_queue_match_fn match, voi
     return false;
 }
 
+bool ring_queue_replace_keyed(ring_queue_t *q, const void *item) {
+    if (!q || !item || !q->buffer) {
+        return false;
+    }
+
+    ring_queue_lock(q);
+    if (!q->index || q->count == 0) {
+        ring_queue_unlock(q);
+        return false;
+    }
+
+    ring_queue_index_entry_t *e = ring_queue_index_find(q, ring_queue_hash(q, item), item);
+    if (e) {
+        memcpy(ring_queue_item_ptr(q, e->slot), item, q->item_size);
+    }
+    ring_queue_unlock(q);
+    return e != NULL;
+}
+
 size_t ring_queue_count(ring_queue_t *q) {
     if (!q) {
         return 0;
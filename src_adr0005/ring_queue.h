@@ -22,6 +22,20 @@ typedef enum {
 typedef bool (*ring_queue_merge_fn)(void *existing, const void *incoming, void *user);
 typedef bool (*ring_queue_match_fn)(const void *item, void *user);
 
+/*
+ * Keyed coalescing: key_fn hashes the identity of an item (e.g. service
+ * name + action), key_eq compares two identities. Equal hashes are always
+ * confirmed with key_eq, so the hash need not be unique.
+ */
+typedef uint64_t (*ring_queue_key_fn)(const void *item, void *user);
+typedef bool (*ring_queue_key_eq_fn)(const void *a, const void *b, void *user);
+
+typedef struct {
+    uint64_t hash;
+    size_t slot;
+    bool used;
+} ring_queue_index_entry_t;
+
 typedef struct {
     uint64_t pushes;
     uint64_t pops;
@@ -40,6 +54,14 @@ typedef struct {
     ring_queue_overflow_policy_t policy;
     ring_queue_merge_fn merge_fn;
     void *merge_user;
+
+    /* Keyed mode: open-addressing index from key to slot, NULL otherwise */
+    ring_queue_key_fn key_fn;
+    ring_queue_key_eq_fn key_eq;
+    void *key_user;
+    ring_queue_index_entry_t *index;
+    size_t index_mask;
+
     ring_queue_stats_t stats;
     pthread_mutex_t lock;
 } ring_queue_t;
@@ -50,10 +72,21 @@ void ring_queue_destroy(ring_queue_t *q);
 void ring_queue_set_overflow_policy(ring_queue_t *q, ring_queue_overflow_policy_t policy);
 void ring_queue_set_merge_fn(ring_queue_t *q, ring_queue_merge_fn fn, void *user);
 
+/*
+ * Switch to keyed mode. Under RQ_COALESCE a push then looks up a queued
+ * item with the same key in O(1) and merges into it (merge_fn, or a plain
+ * overwrite when no merge_fn is set) instead of scanning the queue.
+ * Returns -1 if the index cannot be allocated.
+ */
+int ring_queue_set_key_fn(ring_queue_t *q, ring_queue_key_fn key_fn, ring_queue_key_eq_fn key_eq, void *user);
+
 ring_queue_result_t ring_queue_push(ring_queue_t *q, const void *item);
 bool ring_queue_pop(ring_queue_t *q, void *out);
 bool ring_queue_replace_first_if(ring_queue_t *q, ring_queue_match_fn match, void *user, const void *item);
 
+/* Keyed mode: overwrite the queued item with the same key as item, O(1) */
+bool ring_queue_replace_keyed(ring_queue_t *q, const void *item);
+
 size_t ring_queue_count(ring_queue_t *q);
 size_t ring_queue_capacity(ring_queue_t *q);
 ring_queue_stats_t ring_queue_get_stats(ring_queue_t *q);
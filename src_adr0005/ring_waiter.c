@@ -0,0 +1,135 @@
+#include "ring_waiter.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+static uint64_t ring_waiter_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+int ring_waiter_init(ring_waiter_t *w) {
+    if (!w) {
+        return -1;
+    }
+
+    atomic_store(&w->sleeping, false);
+#ifdef __linux__
+    w->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (w->fd < 0) {
+        return -1;
+    }
+    w->wfd = w->fd;
+#else
+    /* Non-Linux test hosts: a non-blocking pipe stands in for eventfd */
+    int fds[2];
+    if (pipe(fds) < 0) {
+        return -1;
+    }
+    for (int i = 0; i < 2; i++) {
+        fcntl(fds[i], F_SETFL, O_NONBLOCK);
+        fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+    }
+    w->fd = fds[0];
+    w->wfd = fds[1];
+#endif
+    return 0;
+}
+
+void ring_waiter_destroy(ring_waiter_t *w) {
+    if (!w) {
+        return;
+    }
+    if (w->wfd >= 0 && w->wfd != w->fd) {
+        close(w->wfd);
+    }
+    if (w->fd >= 0) {
+        close(w->fd);
+    }
+    w->fd = -1;
+    w->wfd = -1;
+}
+
+void ring_waiter_wake(ring_waiter_t *w) {
+    uint64_t v = 1;
+    ssize_t n;
+    do {
+        n = write(w->wfd, &v, sizeof(v));
+    } while (n < 0 && errno == EINTR);
+    /* EAGAIN: counter/pipe already full, the consumer will wake anyway */
+}
+
+void ring_waiter_notify(ring_waiter_t *w) {
+    /* Pairs with the fence in ring_waiter_arm() */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&w->sleeping, memory_order_relaxed) &&
+        atomic_exchange(&w->sleeping, false)) {
+        ring_waiter_wake(w);
+    }
+}
+
+void ring_waiter_arm(ring_waiter_t *w) {
+    atomic_store_explicit(&w->sleeping, true, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+void ring_waiter_disarm(ring_waiter_t *w) {
+    atomic_store_explicit(&w->sleeping, false, memory_order_relaxed);
+}
+
+void ring_waiter_drain(ring_waiter_t *w) {
+    uint64_t v;
+    while (read(w->fd, &v, sizeof(v)) > 0) {
+    }
+}
+
+int ring_waiter_wait(ring_waiter_t *w, ring_waiter_pop_fn pop, void *queue, void *out,
+                     const _Atomic bool *closed, int timeout_ms) {
+    uint64_t deadline = timeout_ms > 0 ? ring_waiter_now_ms() + (uint64_t)timeout_ms : 0;
+
+    for (;;) {
+        if (pop(queue, out)) {
+            return 1;
+        }
+        if (atomic_load(closed) || timeout_ms == 0) {
+            return 0;
+        }
+
+        int wait_ms = -1;
+        if (timeout_ms > 0) {
+            uint64_t now = ring_waiter_now_ms();
+            if (now >= deadline) {
+                return 0;
+            }
+            wait_ms = (int)(deadline - now);
+        }
+
+        ring_waiter_arm(w);
+        if (pop(queue, out)) {
+            ring_waiter_disarm(w);
+            return 1;
+        }
+        if (atomic_load(closed)) {
+            ring_waiter_disarm(w);
+            return 0;
+        }
+
+        struct pollfd pfd = { .fd = w->fd, .events = POLLIN };
+        int rc = poll(&pfd, 1, wait_ms);
+        ring_waiter_disarm(w);
+        if (rc > 0) {
+            ring_waiter_drain(w);
+        } else if (rc < 0 && errno != EINTR) {
+            return 0;
+        }
+    }
+}
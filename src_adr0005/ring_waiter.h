@@ -0,0 +1,52 @@
+#ifndef RING_WAITER_H
+#define RING_WAITER_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/*
+ * Blocking side of the lock-free queues (spsc_ring / mpsc_ring).
+ *
+ * The consumer sleeps in poll() on an eventfd instead of a condvar, so a
+ * queue can also be polled together with other fds. Producers only write
+ * the eventfd while the consumer is actually asleep: the consumer sets
+ * `sleeping` and re-checks the ring, the producer publishes its item and
+ * then checks `sleeping`, each with a full fence in between, so at least
+ * one side sees the other and a wakeup is never lost.
+ */
+typedef struct {
+    int fd;                     /* Read end, poll() for POLLIN */
+    int wfd;                    /* Write end (== fd for eventfd) */
+    _Atomic bool sleeping;
+} ring_waiter_t;
+
+/* Returns true when an item was popped into out */
+typedef bool (*ring_waiter_pop_fn)(void *queue, void *out);
+
+int ring_waiter_init(ring_waiter_t *w);
+void ring_waiter_destroy(ring_waiter_t *w);
+
+/* Producer: call after the item is published */
+void ring_waiter_notify(ring_waiter_t *w);
+
+/* Unconditional wakeup (close) */
+void ring_waiter_wake(ring_waiter_t *w);
+
+/*
+ * Consumer: mark as about to sleep. The caller must re-check the queue
+ * afterwards and only poll() the fd if it is still empty.
+ */
+void ring_waiter_arm(ring_waiter_t *w);
+void ring_waiter_disarm(ring_waiter_t *w);
+
+/* Consumer: drain pending wakeups after poll() returned */
+void ring_waiter_drain(ring_waiter_t *w);
+
+/*
+ * Pop with timeout (-1 waits forever). Returns 1 with an item, 0 on
+ * timeout or when *closed is set.
+ */
+int ring_waiter_wait(ring_waiter_t *w, ring_waiter_pop_fn pop, void *queue, void *out,
+                     const _Atomic bool *closed, int timeout_ms);
+
+#endif
@@ -0,0 +1,92 @@
+#include "spsc_ring.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static size_t ring_round_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+static uint8_t *spsc_ring_slot(spsc_ring_t *r, size_t pos) {
+    return r->buffer + (pos & r->mask) * r->item_size;
+}
+
+int spsc_ring_init(spsc_ring_t *r, size_t capacity, size_t item_size) {
+    if (!r || capacity == 0 || item_size == 0) {
+        return -1;
+    }
+
+    memset(r, 0, sizeof(*r));
+    capacity = ring_round_pow2(capacity);
+    r->buffer = (uint8_t *)malloc(capacity * item_size);
+    if (!r->buffer) {
+        return -1;
+    }
+    r->item_size = item_size;
+    r->mask = capacity - 1;
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    return 0;
+}
+
+void spsc_ring_destroy(spsc_ring_t *r) {
+    if (!r) {
+        return;
+    }
+    free(r->buffer);
+    memset(r, 0, sizeof(*r));
+}
+
+bool spsc_ring_try_push(spsc_ring_t *r, const void *item) {
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    if (tail - r->head_cache > r->mask) {
+        r->head_cache = atomic_load_explicit(&r->head, memory_order_acquire);
+        if (tail - r->head_cache > r->mask) {
+            return false;
+        }
+    }
+
+    memcpy(spsc_ring_slot(r, tail), item, r->item_size);
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+size_t spsc_ring_count_if(spsc_ring_t *r, spsc_ring_match_fn fn, void *user) {
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    size_t n = 0;
+    for (size_t pos = head; pos != tail; pos++) {
+        if (fn(spsc_ring_slot(r, pos), user)) {
+            n++;
+        }
+    }
+    return n;
+}
+
+bool spsc_ring_try_pop(spsc_ring_t *r, void *out) {
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    if (head == r->tail_cache) {
+        r->tail_cache = atomic_load_explicit(&r->tail, memory_order_acquire);
+        if (head == r->tail_cache) {
+            return false;
+        }
+    }
+
+    memcpy(out, spsc_ring_slot(r, head), r->item_size);
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    return true;
+}
+
+size_t spsc_ring_count(spsc_ring_t *r) {
+    size_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    return tail - head;
+}
+
+size_t spsc_ring_capacity(const spsc_ring_t *r) {
+    return r->mask + 1;
+}
@@ -0,0 +1,55 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#ifndef RING_CACHELINE
+#define RING_CACHELINE 64
+#endif
+
+/*
+ * Lock-free single-producer / single-consumer ring of fixed-size items.
+ *
+ * Exactly one thread pushes and one thread pops. Each index lives on its
+ * own cache line next to the owner's cached copy of the other index, so
+ * the common push/pop touches no shared line except the slot itself.
+ * Capacity is rounded up to a power of two.
+ */
+typedef bool (*spsc_ring_match_fn)(const void *item, void *user);
+
+typedef struct {
+    _Alignas(RING_CACHELINE) _Atomic size_t head;   /* Consumer */
+    size_t tail_cache;
+
+    _Alignas(RING_CACHELINE) _Atomic size_t tail;   /* Producer */
+    size_t head_cache;
+
+    _Alignas(RING_CACHELINE) uint8_t *buffer;
+    size_t item_size;
+    size_t mask;
+} spsc_ring_t;
+
+int spsc_ring_init(spsc_ring_t *r, size_t capacity, size_t item_size);
+void spsc_ring_destroy(spsc_ring_t *r);
+
+/* Producer side */
+bool spsc_ring_try_push(spsc_ring_t *r, const void *item);
+
+/*
+ * Producer side: count queued items matching fn. Slots are only written
+ * by the producer, so the items it has queued can be read without racing
+ * the consumer.
+ */
+size_t spsc_ring_count_if(spsc_ring_t *r, spsc_ring_match_fn fn, void *user);
+
+/* Consumer side */
+bool spsc_ring_try_pop(spsc_ring_t *r, void *out);
+
+/* Any thread; exact only from the producer or consumer */
+size_t spsc_ring_count(spsc_ring_t *r);
+size_t spsc_ring_capacity(const spsc_ring_t *r);
+
+#endif
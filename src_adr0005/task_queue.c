@@ -2,9 +2,7 @@
 
 #include "task_queue.h"
 
-#include <errno.h>
 #include <string.h>
-#include <time.h>
 
 static bool task_queue_merge_same_service_action(void *existing, const void *incoming, void *user) {
     (void)user;
@@ -21,11 +19,28 @@ static bool task_queue_merge_same_service_action(void *existing, const void *inc
     return false;
 }
 
-static void task_queue_signal(task_queue_t *q) {
-    atomic_fetch_add(&q->seq, 1);
-    pthread_mutex_lock(&q->wait_lock);
-    pthread_cond_signal(&q->wait_cond);
-    pthread_mutex_unlock(&q->wait_lock);
+/* Coalescing key: service name + action */
+static uint64_t task_queue_key(const void *item, void *user) {
+    (void)user;
+    const ubus_task_t *task = (const ubus_task_t *)item;
+
+    /* FNV-1a */
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < sizeof(task->service_name) && task->service_name[i]; i++) {
+        h ^= (uint8_t)task->service_name[i];
+        h *= 0x100000001b3ULL;
+    }
+    h ^= (uint64_t)task->action;
+    h *= 0x100000001b3ULL;
+    return h;
+}
+
+static bool task_queue_key_eq(const void *a, const void *b, void *user) {
+    (void)user;
+    const ubus_task_t *ta = (const ubus_task_t *)a;
+    const ubus_task_t *tb = (const ubus_task_t *)b;
+    return ta->action == tb->action &&
+           strncmp(ta->service_name, tb->service_name, sizeof(ta->service_name)) == 0;
 }
 
 int task_queue_init(task_queue_t *q, size_t capacity) {
@@ -39,27 +54,21 @@ int task_queue_init(task_queue_t *q, size_t capacity) {
     }
     ring_queue_set_overflow_policy(&q->ring, RQ_COALESCE);
     ring_queue_set_merge_fn(&q->ring, task_queue_merge_same_service_action, NULL);
+    if (ring_queue_set_key_fn(&q->ring, task_queue_key, task_queue_key_eq, NULL) != 0) {
+        ring_queue_destroy(&q->ring);
+        return -1;
+    }
+    if (ring_waiter_init(&q->waiter) != 0) {
+        ring_queue_destroy(&q->ring);
+        return -1;
+    }
 
-    pthread_mutex_init(&q->wait_lock, NULL);
-    q->wait_clock_monotonic = false;
-#ifdef __linux__
-    pthread_condattr_t attr;
-    if (pthread_condattr_init(&attr) == 0) {
-        if (pthread_condattr_setclock(&attr, CLOCK_MONOTONIC) == 0) {
-            pthread_cond_init(&q->wait_cond, &attr);
-            q->wait_clock_monotonic = true;
-        } else {
-            pthread_cond_init(&q->wait_cond, NULL);
-        }
-        pthread_condattr_destroy(&attr);
-    } else {
-        pthread_cond_init(&q->wait_cond, NULL);
-    }
-#else
-    pthread_cond_init(&q->wait_cond, NULL);
-#endif
-    atomic_store(&q->seq, 0);
     atomic_store(&q->closed, false);
+    atomic_store(&q->pushes, 0);
+    atomic_store(&q->pops, 0);
+    atomic_store(&q->drops, 0);
+    atomic_store(&q->merges, 0);
+    atomic_store(&q->expired, 0);
     return 0;
 }
 
@@ -68,8 +77,7 @@ void task_queue_destroy(task_queue_t *q) {
         return;
     }
     ring_queue_destroy(&q->ring);
-    pthread_mutex_destroy(&q->wait_lock);
-    pthread_cond_destroy(&q->wait_cond);
+    ring_waiter_destroy(&q->waiter);
     memset(q, 0, sizeof(*q));
 }
 
@@ -78,7 +86,11 @@ void task_queue_close(task_queue_t *q) {
         return;
     }
     atomic_store(&q->closed, true);
-    task_queue_signal(q);
+    ring_waiter_wake(&q->waiter);
+}
+
+static void task_queue_count(_Atomic uint64_t *counter) {
+    atomic_fetch_add_explicit(counter, 1, memory_order_relaxed);
 }
 
 task_queue_result_t task_queue_push(task_queue_t *q, const ubus_task_t *task) {
@@ -86,119 +98,61 @@ task_queue_result_t task_queue_push(task_queue_t *q, const ubus_task_t *task) {
         return TQ_RESULT_ERR;
     }
 
-    ring_queue_result_t result = ring_queue_push(&q->ring, task);
-    pthread_mutex_lock(&q->wait_lock);
-    switch (result) {
+    switch (ring_queue_push(&q->ring, task)) {
     case RQ_RESULT_OK:
-        q->stats.pushes++;
-        pthread_mutex_unlock(&q->wait_lock);
-        task_queue_signal(q);
+        task_queue_count(&q->pushes);
+        ring_waiter_notify(&q->waiter);
         return TQ_RESULT_OK;
     case RQ_RESULT_MERGED:
-        q->stats.merges++;
-        pthread_mutex_unlock(&q->wait_lock);
-        task_queue_signal(q);
+        /* Already queued: the consumer has been woken for it */
+        task_queue_count(&q->merges);
         return TQ_RESULT_MERGED;
     case RQ_RESULT_DROPPED:
-        q->stats.drops++;
-        pthread_mutex_unlock(&q->wait_lock);
+        task_queue_count(&q->drops);
         return TQ_RESULT_DROPPED;
     default:
-        pthread_mutex_unlock(&q->wait_lock);
         return TQ_RESULT_ERR;
     }
 }
 
-int task_queue_try_pop(task_queue_t *q, ubus_task_t *out) {
-    if (!q || !out) {
-        return -1;
-    }
-    bool got = ring_queue_pop(&q->ring, out);
-    if (got) {
-        pthread_mutex_lock(&q->wait_lock);
-        q->stats.pops++;
-        pthread_mutex_unlock(&q->wait_lock);
-        return 1;
+static bool task_queue_pop(void *queue, void *out) {
+    task_queue_t *q = (task_queue_t *)queue;
+    if (!ring_queue_pop(&q->ring, out)) {
+        return false;
     }
-    return 0;
+    task_queue_count(&q->pops);
+    return true;
 }
 
-static int task_queue_timed_wait(task_queue_t *q, uint64_t seq, int timeout_ms) {
-    if (timeout_ms < 0) {
-        while (atomic_load(&q->seq) == seq && !atomic_load(&q->closed)) {
-            pthread_cond_wait(&q->wait_cond, &q->wait_lock);
-        }
-        return 0;
-    }
-
-    struct timespec ts;
-    clockid_t clock_id = CLOCK_REALTIME;
-#ifdef __linux__
-    if (q->wait_clock_monotonic) {
-        clock_id = CLOCK_MONOTONIC;
-    }
-#endif
-    clock_gettime(clock_id, &ts);
-    uint64_t nsec = (uint64_t)ts.tv_nsec + (uint64_t)timeout_ms * 1000000ULL;
-    ts.tv_sec += (time_t)(nsec / 1000000000ULL);
-    ts.tv_nsec = (long)(nsec % 1000000000ULL);
-
-    while (atomic_load(&q->seq) == seq && !atomic_load(&q->closed)) {
-        int rc = pthread_cond_timedwait(&q->wait_cond, &q->wait_lock, &ts);
-        if (rc == ETIMEDOUT) {
-            return 1;
-        }
+int task_queue_try_pop(task_queue_t *q, ubus_task_t *out) {
+    if (!q || !out) {
+        return -1;
     }
-
-    return 0;
+    return task_queue_pop(q, out) ? 1 : 0;
 }
 
 int task_queue_wait(task_queue_t *q, ubus_task_t *out, int timeout_ms) {
     if (!q || !out) {
         return -1;
     }
+    return ring_waiter_wait(&q->waiter, task_queue_pop, q, out, &q->closed, timeout_ms);
+}
+
+int task_queue_get_fd(task_queue_t *q) {
+    return q ? q->waiter.fd : -1;
+}
 
-    uint64_t seq = atomic_load(&q->seq);
-    for (;;) {
-        if (ring_queue_pop(&q->ring, out)) {
-            pthread_mutex_lock(&q->wait_lock);
-            q->stats.pops++;
-            pthread_mutex_unlock(&q->wait_lock);
-            return 1;
-        }
-        if (atomic_load(&q->closed)) {
-            return 0;
-        }
-
-        if (timeout_ms == 0) {
-            return 0;
-        }
-
-        pthread_mutex_lock(&q->wait_lock);
-        if (ring_queue_pop(&q->ring, out)) {
-            q->stats.pops++;
-            pthread_mutex_unlock(&q->wait_lock);
-            return 1;
-        }
-        if (atomic_load(&q->closed)) {
-            pthread_mutex_unlock(&q->wait_lock);
-            return 0;
-        }
-
-        if (atomic_load(&q->seq) != seq) {
-            seq = atomic_load(&q->seq);
-            pthread_mutex_unlock(&q->wait_lock);
-            continue;
-        }
-
-        int timed_out = task_queue_timed_wait(q, seq, timeout_ms);
-        seq = atomic_load(&q->seq);
-        pthread_mutex_unlock(&q->wait_lock);
-
-        if (timed_out) {
-            return 0;
-        }
+bool task_queue_arm(task_queue_t *q) {
+    if (!q) {
+        return false;
+    }
+    ring_waiter_drain(&q->waiter);
+    ring_waiter_arm(&q->waiter);
+    if (ring_queue_count(&q->ring) > 0 || atomic_load(&q->closed)) {
+        ring_waiter_disarm(&q->waiter);
+        return false;
     }
+    return true;
 }
 
 bool task_queue_is_expired(const ubus_task_t *task, uint64_t now_ms) {
@@ -213,8 +167,10 @@ task_queue_stats_t task_queue_get_stats(task_queue_t *q) {
     if (!q) {
         return stats;
     }
-    pthread_mutex_lock(&q->wait_lock);
-    stats = q->stats;
-    pthread_mutex_unlock(&q->wait_lock);
+    stats.pushes = atomic_load_explicit(&q->pushes, memory_order_relaxed);
+    stats.pops = atomic_load_explicit(&q->pops, memory_order_relaxed);
+    stats.drops = atomic_load_explicit(&q->drops, memory_order_relaxed);
+    stats.merges = atomic_load_explicit(&q->merges, memory_order_relaxed);
+    stats.expired = atomic_load_explicit(&q->expired, memory_order_relaxed);
     return stats;
 }
@@ -5,9 +5,9 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdatomic.h>
-#include <pthread.h>
 
 #include "ring_queue.h"
+#include "ring_waiter.h"
 #include "hal/ubus_hal.h"
 
 typedef enum {
@@ -25,14 +25,21 @@ typedef struct {
     uint64_t expired;
 } task_queue_stats_t;
 
+/*
+ * Tasks from the UI thread to the ubus thread. Pushes coalesce by service
+ * + action (keyed ring_queue); the consumer is woken through an eventfd
+ * it can add to its uloop (task_queue_get_fd / task_queue_arm).
+ */
 typedef struct {
     ring_queue_t ring;
-    task_queue_stats_t stats;
-    pthread_mutex_t wait_lock;
-    pthread_cond_t wait_cond;
-    bool wait_clock_monotonic;
-    _Atomic uint64_t seq;
+    ring_waiter_t waiter;
     _Atomic bool closed;
+
+    _Atomic uint64_t pushes;
+    _Atomic uint64_t pops;
+    _Atomic uint64_t drops;
+    _Atomic uint64_t merges;
+    _Atomic uint64_t expired;
 } task_queue_t;
 
 int task_queue_init(task_queue_t *q, size_t capacity);
@@ -43,6 +50,10 @@ task_queue_result_t task_queue_push(task_queue_t *q, const ubus_task_t *task);
 int task_queue_try_pop(task_queue_t *q, ubus_task_t *out);
 int task_queue_wait(task_queue_t *q, ubus_task_t *out, int timeout_ms);
 
+/* poll() integration, see event_queue_arm() */
+int task_queue_get_fd(task_queue_t *q);
+bool task_queue_arm(task_queue_t *q);
+
 bool task_queue_is_expired(const ubus_task_t *task, uint64_t now_ms);
 
 task_queue_stats_t task_queue_get_stats(task_queue_t *q);
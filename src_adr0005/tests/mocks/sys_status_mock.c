@@ -1,7 +1,7 @@
 /*
  * sys_status mock for host testing
  */
-#include "../../src/sys_status.h"
+#include "sys_status.h"
 
 #include <stdio.h>
 #include <stdlib.h>
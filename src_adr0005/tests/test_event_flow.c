@@ -99,7 +99,7 @@ int main(void) {
         waited++;
     }
 
-    if (atomic_load(&g_tick_count) == 0 || display_mock_begin_count() == 0) {
+    if (atomic_load(&g_tick_count) == 0 || display_mock_clear_count() == 0) {
         fprintf(stderr, "tick not received\n");
         event_loop_request_shutdown(&loop);
         pthread_join(th, NULL);
@@ -88,11 +88,17 @@ static int test_replace_abandoned_when_full(void) {
     ubus_result_t r3 = make_result("s3", UBUS_ACTION_QUERY, 3, true);
     TEST_ASSERT(result_queue_push(&q, &r3) == RQ_OK);
 
+    /* The abandoned result is skipped, the others keep FIFO order */
     ubus_result_t out = {0};
     TEST_ASSERT(result_queue_try_pop(&q, &out) == 1);
-    TEST_ASSERT(out.request_id == 3);
-    TEST_ASSERT(result_queue_try_pop(&q, &out) == 1);
     TEST_ASSERT(out.request_id == 2);
+    TEST_ASSERT(result_queue_try_pop(&q, &out) == 1);
+    TEST_ASSERT(out.request_id == 3);
+    TEST_ASSERT(result_queue_try_pop(&q, &out) == 0);
+
+    result_queue_stats_t stats = result_queue_get_stats(&q);
+    TEST_ASSERT(stats.drops_abandoned == 1);
+    TEST_ASSERT(stats.drops == 0);
 
     result_queue_destroy(&q);
     return 0;
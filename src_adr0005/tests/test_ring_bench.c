@@ -0,0 +1,281 @@
+/*
+ * Lock-free ring stress tests with a throughput comparison against the
+ * mutex-based ring_queue, in the style of test_thread_safety.c.
+ *
+ * Correctness is asserted (nothing lost, per-producer FIFO order); the
+ * ns/item figures are printed for comparison only.
+ */
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "event_queue.h"
+#include "mpsc_ring.h"
+#include "ring_queue.h"
+#include "spsc_ring.h"
+
+#define TEST_ASSERT(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "ASSERT FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+#define RING_CAPACITY 256
+#define SPSC_ITEMS 200000
+#define PRODUCERS 4
+#define ITEMS_PER_PRODUCER 50000
+#define MPSC_ITEMS (PRODUCERS * ITEMS_PER_PRODUCER)
+
+typedef struct {
+    uint32_t producer;
+    uint32_t seq;
+} bench_item_t;
+
+typedef enum {
+    BENCH_RING_QUEUE = 0,
+    BENCH_SPSC,
+    BENCH_MPSC
+} bench_kind_t;
+
+typedef struct {
+    bench_kind_t kind;
+    ring_queue_t rq;
+    spsc_ring_t spsc;
+    mpsc_ring_t mpsc;
+} bench_queue_t;
+
+typedef struct {
+    bench_queue_t *queue;
+    uint32_t producer;
+    uint32_t items;
+} bench_producer_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static bool bench_push(bench_queue_t *q, const bench_item_t *item) {
+    switch (q->kind) {
+    case BENCH_RING_QUEUE:
+        return ring_queue_push(&q->rq, item) == RQ_RESULT_OK;
+    case BENCH_SPSC:
+        return spsc_ring_try_push(&q->spsc, item);
+    case BENCH_MPSC:
+        return mpsc_ring_try_push(&q->mpsc, item);
+    }
+    return false;
+}
+
+static bool bench_pop(bench_queue_t *q, bench_item_t *out) {
+    switch (q->kind) {
+    case BENCH_RING_QUEUE:
+        return ring_queue_pop(&q->rq, out);
+    case BENCH_SPSC:
+        return spsc_ring_try_pop(&q->spsc, out);
+    case BENCH_MPSC:
+        return mpsc_ring_try_pop(&q->mpsc, out);
+    }
+    return false;
+}
+
+static void *bench_producer_thread(void *arg) {
+    bench_producer_t *ctx = (bench_producer_t *)arg;
+    for (uint32_t i = 0; i < ctx->items; i++) {
+        bench_item_t item = {.producer = ctx->producer, .seq = i};
+        while (!bench_push(ctx->queue, &item)) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/* Runs producers against one consumer, checks order, returns ns/item */
+static int bench_run(bench_queue_t *q, int producers, uint32_t items_per_producer,
+                     uint64_t *ns_per_item) {
+    pthread_t threads[PRODUCERS];
+    bench_producer_t ctx[PRODUCERS];
+    uint32_t next_seq[PRODUCERS] = {0};
+    uint64_t total = (uint64_t)producers * items_per_producer;
+
+    uint64_t start = now_ns();
+    for (int i = 0; i < producers; i++) {
+        ctx[i].queue = q;
+        ctx[i].producer = (uint32_t)i;
+        ctx[i].items = items_per_producer;
+        TEST_ASSERT(pthread_create(&threads[i], NULL, bench_producer_thread, &ctx[i]) == 0);
+    }
+
+    for (uint64_t got = 0; got < total;) {
+        bench_item_t item;
+        if (!bench_pop(q, &item)) {
+            sched_yield();
+            continue;
+        }
+        TEST_ASSERT(item.producer < (uint32_t)producers);
+        TEST_ASSERT(item.seq == next_seq[item.producer]);
+        next_seq[item.producer]++;
+        got++;
+    }
+
+    for (int i = 0; i < producers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    *ns_per_item = (now_ns() - start) / total;
+
+    bench_item_t extra;
+    TEST_ASSERT(!bench_pop(q, &extra));
+    return 0;
+}
+
+static int test_spsc_vs_ring_queue(void) {
+    bench_queue_t q = {.kind = BENCH_RING_QUEUE};
+    uint64_t mutex_ns = 0;
+    uint64_t spsc_ns = 0;
+
+    TEST_ASSERT(ring_queue_init(&q.rq, RING_CAPACITY, sizeof(bench_item_t)) == 0);
+    ring_queue_set_overflow_policy(&q.rq, RQ_REJECT_NEW);
+    TEST_ASSERT(bench_run(&q, 1, SPSC_ITEMS, &mutex_ns) == 0);
+    ring_queue_destroy(&q.rq);
+
+    q.kind = BENCH_SPSC;
+    TEST_ASSERT(spsc_ring_init(&q.spsc, RING_CAPACITY, sizeof(bench_item_t)) == 0);
+    TEST_ASSERT(spsc_ring_capacity(&q.spsc) == RING_CAPACITY);
+    TEST_ASSERT(bench_run(&q, 1, SPSC_ITEMS, &spsc_ns) == 0);
+    spsc_ring_destroy(&q.spsc);
+
+    printf("1P1C %d items: ring_queue %llu ns/item, spsc_ring %llu ns/item\n",
+           SPSC_ITEMS, (unsigned long long)mutex_ns, (unsigned long long)spsc_ns);
+    return 0;
+}
+
+static int test_mpsc_vs_ring_queue(void) {
+    bench_queue_t q = {.kind = BENCH_RING_QUEUE};
+    uint64_t mutex_ns = 0;
+    uint64_t mpsc_ns = 0;
+
+    TEST_ASSERT(ring_queue_init(&q.rq, RING_CAPACITY, sizeof(bench_item_t)) == 0);
+    ring_queue_set_overflow_policy(&q.rq, RQ_REJECT_NEW);
+    TEST_ASSERT(bench_run(&q, PRODUCERS, ITEMS_PER_PRODUCER, &mutex_ns) == 0);
+    ring_queue_destroy(&q.rq);
+
+    q.kind = BENCH_MPSC;
+    TEST_ASSERT(mpsc_ring_init(&q.mpsc, RING_CAPACITY, sizeof(bench_item_t)) == 0);
+    TEST_ASSERT(bench_run(&q, PRODUCERS, ITEMS_PER_PRODUCER, &mpsc_ns) == 0);
+    mpsc_ring_destroy(&q.mpsc);
+
+    printf("%dP1C %d items: ring_queue %llu ns/item, mpsc_ring %llu ns/item\n",
+           PRODUCERS, MPSC_ITEMS, (unsigned long long)mutex_ns, (unsigned long long)mpsc_ns);
+    return 0;
+}
+
+static int test_ring_bounds(void) {
+    spsc_ring_t spsc;
+    mpsc_ring_t mpsc;
+    bench_item_t item = {0};
+
+    /* Capacity rounds up to a power of two and is enforced exactly */
+    TEST_ASSERT(spsc_ring_init(&spsc, 3, sizeof(item)) == 0);
+    TEST_ASSERT(mpsc_ring_init(&mpsc, 3, sizeof(item)) == 0);
+    TEST_ASSERT(spsc_ring_capacity(&spsc) == 4);
+    TEST_ASSERT(mpsc_ring_capacity(&mpsc) == 4);
+
+    /* Several laps to exercise index wrap */
+    for (uint32_t lap = 0; lap < 3; lap++) {
+        for (uint32_t i = 0; i < 4; i++) {
+            item.seq = lap * 4 + i;
+            TEST_ASSERT(spsc_ring_try_push(&spsc, &item));
+            TEST_ASSERT(mpsc_ring_try_push(&mpsc, &item));
+        }
+        TEST_ASSERT(!spsc_ring_try_push(&spsc, &item));
+        TEST_ASSERT(!mpsc_ring_try_push(&mpsc, &item));
+        TEST_ASSERT(spsc_ring_count(&spsc) == 4);
+        TEST_ASSERT(mpsc_ring_count(&mpsc) == 4);
+
+        for (uint32_t i = 0; i < 4; i++) {
+            TEST_ASSERT(spsc_ring_try_pop(&spsc, &item) && item.seq == lap * 4 + i);
+            TEST_ASSERT(mpsc_ring_try_pop(&mpsc, &item) && item.seq == lap * 4 + i);
+        }
+        TEST_ASSERT(!spsc_ring_try_pop(&spsc, &item));
+        TEST_ASSERT(!mpsc_ring_try_pop(&mpsc, &item));
+    }
+
+    spsc_ring_destroy(&spsc);
+    mpsc_ring_destroy(&mpsc);
+    return 0;
+}
+
+typedef struct {
+    event_queue_t *queue;
+    uint32_t producer;
+} wake_producer_t;
+
+static void *wake_producer_thread(void *arg) {
+    wake_producer_t *ctx = (wake_producer_t *)arg;
+    for (uint32_t i = 0; i < ITEMS_PER_PRODUCER / 10; i++) {
+        app_event_t evt = {
+            .type = EVT_BTN_K1_SHORT,
+            .line = (uint8_t)ctx->producer,
+            .timestamp_ns = i,
+            .data = i
+        };
+        while (event_queue_push(ctx->queue, &evt) != EQ_RESULT_OK) {
+            sched_yield();
+        }
+        /* Bursty producers so the consumer keeps going to sleep */
+        if ((i % 64) == 63) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static int test_blocking_wakeups(void) {
+    event_queue_t q;
+    TEST_ASSERT(event_queue_init(&q, 32) == 0);
+
+    pthread_t threads[PRODUCERS];
+    wake_producer_t ctx[PRODUCERS];
+    uint32_t next_seq[PRODUCERS] = {0};
+    uint64_t start = now_ns();
+    for (int i = 0; i < PRODUCERS; i++) {
+        ctx[i].queue = &q;
+        ctx[i].producer = (uint32_t)i;
+        TEST_ASSERT(pthread_create(&threads[i], NULL, wake_producer_thread, &ctx[i]) == 0);
+    }
+
+    /* A lost wakeup shows up as a wait timing out with items outstanding */
+    for (int got = 0; got < PRODUCERS * (ITEMS_PER_PRODUCER / 10); got++) {
+        app_event_t evt = {0};
+        TEST_ASSERT(event_queue_wait(&q, &evt, 2000) == 1);
+        TEST_ASSERT(evt.line < PRODUCERS);
+        TEST_ASSERT(evt.data == next_seq[evt.line]);
+        next_seq[evt.line]++;
+    }
+
+    for (int i = 0; i < PRODUCERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    printf("event_queue blocking %d items: %llu ns/item\n", PRODUCERS * (ITEMS_PER_PRODUCER / 10),
+           (unsigned long long)((now_ns() - start) / (PRODUCERS * (ITEMS_PER_PRODUCER / 10))));
+
+    event_queue_destroy(&q);
+    return 0;
+}
+
+int main(void) {
+    int rc = 0;
+    rc |= test_ring_bounds();
+    rc |= test_spsc_vs_ring_queue();
+    rc |= test_mpsc_vs_ring_queue();
+    rc |= test_blocking_wakeups();
+
+    if (rc == 0) {
+        printf("ALL TESTS PASSED\n");
+    }
+    return rc;
+}
@@ -125,6 +125,84 @@ static int test_queue_coalesce_policy(void) {
     return 0;
 }
 
+static uint64_t kv_key(const void *item, void *user) {
+    (void)user;
+    /* Deliberately weak: collisions must be resolved by kv_key_eq */
+    return (uint64_t)(((const kv_item_t *)item)->key % 7);
+}
+
+static bool kv_key_eq(const void *a, const void *b, void *user) {
+    (void)user;
+    return ((const kv_item_t *)a)->key == ((const kv_item_t *)b)->key;
+}
+
+static int test_queue_keyed_coalesce(void) {
+    ring_queue_t q;
+    TEST_ASSERT(ring_queue_init(&q, 4, sizeof(kv_item_t)) == 0);
+    ring_queue_set_overflow_policy(&q, RQ_COALESCE);
+    TEST_ASSERT(ring_queue_set_key_fn(&q, kv_key, kv_key_eq, NULL) == 0);
+
+    /* No merge_fn: the newer item replaces the queued one in place */
+    kv_item_t a = {.key = 1, .value = 1};
+    kv_item_t b = {.key = 8, .value = 2};   /* Same hash as key 1 */
+    kv_item_t c = {.key = 1, .value = 3};
+    TEST_ASSERT(ring_queue_push(&q, &a) == RQ_RESULT_OK);
+    TEST_ASSERT(ring_queue_push(&q, &b) == RQ_RESULT_OK);
+    TEST_ASSERT(ring_queue_push(&q, &c) == RQ_RESULT_MERGED);
+    TEST_ASSERT(ring_queue_count(&q) == 2);
+
+    kv_item_t d = {.key = 8, .value = 9};
+    kv_item_t e = {.key = 5, .value = 9};
+    TEST_ASSERT(ring_queue_replace_keyed(&q, &d) == true);
+    TEST_ASSERT(ring_queue_replace_keyed(&q, &e) == false);
+
+    kv_item_t out = {0};
+    TEST_ASSERT(ring_queue_pop(&q, &out) && out.key == 1 && out.value == 3);
+    TEST_ASSERT(ring_queue_pop(&q, &out) && out.key == 8 && out.value == 9);
+
+    /* With merge_fn */
+    ring_queue_set_merge_fn(&q, merge_sum, NULL);
+    TEST_ASSERT(ring_queue_push(&q, &a) == RQ_RESULT_OK);
+    TEST_ASSERT(ring_queue_push(&q, &c) == RQ_RESULT_MERGED);
+    TEST_ASSERT(ring_queue_pop(&q, &out) && out.key == 1 && out.value == 4);
+    TEST_ASSERT(ring_queue_get_stats(&q).merges == 2);
+
+    ring_queue_destroy(&q);
+    return 0;
+}
+
+static int test_queue_keyed_matches_linear(void) {
+    ring_queue_t keyed;
+    ring_queue_t linear;
+    TEST_ASSERT(ring_queue_init(&keyed, 64, sizeof(kv_item_t)) == 0);
+    TEST_ASSERT(ring_queue_init(&linear, 64, sizeof(kv_item_t)) == 0);
+    ring_queue_set_overflow_policy(&keyed, RQ_COALESCE);
+    ring_queue_set_overflow_policy(&linear, RQ_COALESCE);
+    ring_queue_set_merge_fn(&keyed, merge_sum, NULL);
+    ring_queue_set_merge_fn(&linear, merge_sum, NULL);
+    TEST_ASSERT(ring_queue_set_key_fn(&keyed, kv_key, kv_key_eq, NULL) == 0);
+
+    /* Random pushes/pops: the index must agree with a full scan */
+    srand(1234);
+    for (int i = 0; i < 20000; i++) {
+        if (rand() % 3 != 0) {
+            kv_item_t item = {.key = rand() % 100, .value = i};
+            TEST_ASSERT(ring_queue_push(&keyed, &item) == ring_queue_push(&linear, &item));
+        } else {
+            kv_item_t k = {0};
+            kv_item_t l = {0};
+            bool got = ring_queue_pop(&keyed, &k);
+            TEST_ASSERT(got == ring_queue_pop(&linear, &l));
+            TEST_ASSERT(!got || (k.key == l.key && k.value == l.value));
+        }
+        TEST_ASSERT(ring_queue_count(&keyed) == ring_queue_count(&linear));
+    }
+
+    ring_queue_destroy(&keyed);
+    ring_queue_destroy(&linear);
+    return 0;
+}
+
 typedef struct {
     ring_queue_t *q;
     int start;
@@ -198,6 +276,8 @@ int main(void) {
     rc |= test_queue_overwrite_policy();
     rc |= test_queue_reject_policy();
     rc |= test_queue_coalesce_policy();
+    rc |= test_queue_keyed_coalesce();
+    rc |= test_queue_keyed_matches_linear();
     rc |= test_queue_thread_safety();
 
     if (rc == 0) {
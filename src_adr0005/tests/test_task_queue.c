@@ -77,6 +77,33 @@ static int test_no_merge_different_action(void) {
     return 0;
 }
 
+static int test_merge_backlog(void) {
+    task_queue_t q;
+    TEST_ASSERT(task_queue_init(&q, 256) == 0);
+
+    /* Refreshes piling up behind a slow rpcd: one task per service/action */
+    char name[32];
+    for (uint32_t round = 0; round < 3; round++) {
+        for (uint32_t i = 0; i < 200; i++) {
+            snprintf(name, sizeof(name), "svc%u", (unsigned)i);
+            ubus_task_t t = make_task(name, UBUS_ACTION_QUERY, round * 1000 + i);
+            TEST_ASSERT(task_queue_push(&q, &t) == (round == 0 ? TQ_RESULT_OK : TQ_RESULT_MERGED));
+        }
+    }
+
+    ubus_task_t out = {0};
+    for (uint32_t i = 0; i < 200; i++) {
+        snprintf(name, sizeof(name), "svc%u", (unsigned)i);
+        TEST_ASSERT(task_queue_try_pop(&q, &out) == 1);
+        TEST_ASSERT(strcmp(out.service_name, name) == 0);
+        TEST_ASSERT(out.request_id == 2000 + i);
+    }
+    TEST_ASSERT(task_queue_try_pop(&q, &out) == 0);
+
+    task_queue_destroy(&q);
+    return 0;
+}
+
 static int test_drop_when_full(void) {
     task_queue_t q;
     TEST_ASSERT(task_queue_init(&q, 2) == 0);
@@ -154,6 +181,7 @@ int main(void) {
     rc |= test_push_pop();
     rc |= test_merge_same_service_action();
     rc |= test_no_merge_different_action();
+    rc |= test_merge_backlog();
     rc |= test_drop_when_full();
     rc |= test_is_expired();
     rc |= test_wait_timeout();
@@ -131,6 +131,45 @@ static int test_multiple_tasks(void) {
     return 0;
 }
 
+static int test_concurrent_calls(void) {
+    task_queue_t tq;
+    result_queue_t rq;
+    ubus_thread_t ut;
+
+    TEST_ASSERT(task_queue_init(&tq, 8) == 0);
+    TEST_ASSERT(result_queue_init(&rq, 8) == 0);
+    TEST_ASSERT(ubus_thread_init(&ut, &tq, &rq) == 0);
+
+    ubus_hal_mock_reset();
+    ubus_hal_mock_set_delay(100);
+    TEST_ASSERT(ubus_thread_start(&ut) == 0);
+
+    /* No explicit wakeup: the task queue's eventfd wakes the worker */
+    char svc_name[32];
+    uint64_t start_ms = time_hal_now_ms();
+    for (int i = 0; i < 6; i++) {
+        snprintf(svc_name, sizeof(svc_name), "svc%d", i);
+        ubus_task_t task = make_task(svc_name, UBUS_ACTION_QUERY, (uint32_t)(20 + i));
+        TEST_ASSERT(task_queue_push(&tq, &task) == TQ_RESULT_OK);
+    }
+
+    for (int i = 0; i < 6; i++) {
+        ubus_result_t result = {0};
+        TEST_ASSERT(result_queue_wait(&rq, &result, 1000) == 1);
+        TEST_ASSERT(result.success == true);
+    }
+
+    /* Six 100 ms calls overlap instead of running back to back */
+    TEST_ASSERT(time_hal_now_ms() - start_ms < 400);
+    TEST_ASSERT(ubus_hal_mock_get_call_count() == 6);
+
+    ubus_thread_stop(&ut);
+    ubus_thread_destroy(&ut);
+    result_queue_destroy(&rq);
+    task_queue_destroy(&tq);
+    return 0;
+}
+
 static int test_graceful_shutdown(void) {
     task_queue_t tq;
     result_queue_t rq;
@@ -164,6 +203,7 @@ int main(void) {
     rc |= test_basic_invoke();
     rc |= test_expired_task();
     rc |= test_multiple_tasks();
+    rc |= test_concurrent_calls();
     rc |= test_graceful_shutdown();
 
     if (rc == 0) {
@@ -44,6 +44,7 @@ static int test_k2_short_home_turns_off(void) {
     ui_controller_init(&ui);
 
     /* On home page (page 0), K2 short press should turn off screen */
+    ui.page_ctrl.current_page = 0;
     app_event_t evt = {
         .type = EVT_BTN_K2_SHORT,
         .line = 1,
@@ -85,7 +86,8 @@ static int test_k3_switches_page(void) {
     ui_controller_t ui;
     ui_controller_init(&ui);
 
-    TEST_ASSERT(ui.page_ctrl.current_page == 0);
+    /* Starts on the Network page */
+    TEST_ASSERT(ui.page_ctrl.current_page == 1);
 
     /* K3 should go to next page */
     app_event_t evt = {
@@ -97,8 +99,9 @@ static int test_k3_switches_page(void) {
 
     ui_controller_handle_event(&ui, &evt);
 
-    /* Page should have changed (animation started) */
-    TEST_ASSERT(ui.page_ctrl.current_page == 1);
+    /* Slide to the next page started (current_page follows when it ends) */
+    TEST_ASSERT(ui.page_ctrl.anim.type == ANIM_SLIDE_LEFT);
+    TEST_ASSERT(ui.page_ctrl.anim.to_page == 2);
 
     return 0;
 }
@@ -120,7 +123,8 @@ static int test_k1_switches_page(void) {
 
     ui_controller_handle_event(&ui, &evt);
 
-    TEST_ASSERT(ui.page_ctrl.current_page == 0);
+    TEST_ASSERT(ui.page_ctrl.anim.type == ANIM_SLIDE_RIGHT);
+    TEST_ASSERT(ui.page_ctrl.anim.to_page == 0);
 
     return 0;
 }
@@ -129,8 +133,8 @@ static int test_k2_long_enter_mode(void) {
     ui_controller_t ui;
     ui_controller_init(&ui);
 
-    /* Go to services page (page 2) which supports enter mode */
-    ui.page_ctrl.current_page = 2;
+    /* Go to services page (page 3) which supports enter mode */
+    ui.page_ctrl.current_page = 3;
 
     TEST_ASSERT(ui.page_ctrl.page_mode == PAGE_MODE_VIEW);
 
@@ -5,9 +5,9 @@
 #include "hal/time_hal.h"
 
 #include <errno.h>
+#include <signal.h>
 #include <string.h>
 #include <unistd.h>
-#include <poll.h>
 
 #ifdef __linux__
 #include <sys/eventfd.h>
@@ -16,65 +16,133 @@
 #include "eventfd_compat.h"
 #endif
 
+static void post_failure(ubus_thread_t *ut, const ubus_task_t *task, int error_code) {
+    ubus_result_t result = {0};
+    strncpy(result.service_name, task->service_name, sizeof(result.service_name) - 1);
+    result.action = task->action;
+    result.request_id = task->request_id;
+    result.success = false;
+    result.error_code = error_code;
+    result_queue_push(ut->result_queue, &result);
+}
+
+static void on_call_done(const ubus_result_t *result, void *user) {
+    ubus_thread_t *ut = (ubus_thread_t *)user;
+    result_queue_push(ut->result_queue, result);
+    ut->in_flight--;
+    /* Not from inside the HAL's callback: start the next calls from the loop */
+    uloop_timeout_set(&ut->dispatch_timer, 0);
+}
+
 static void process_task(ubus_thread_t *ut, ubus_task_t *task) {
     uint64_t now_ms = time_hal_now_ms();
 
     if (task_queue_is_expired(task, now_ms)) {
-        ubus_result_t result = {0};
-        strncpy(result.service_name, task->service_name, sizeof(result.service_name) - 1);
-        result.action = task->action;
-        result.request_id = task->request_id;
-        result.success = false;
-        result.error_code = -ETIMEDOUT;
-        result_queue_push(ut->result_queue, &result);
+        post_failure(ut, task, -ETIMEDOUT);
         return;
     }
 
-    ubus_result_t result = {0};
-    if (ubus_hal && ubus_hal->invoke) {
+    if (!ubus_hal || (!ubus_hal->invoke_async && !ubus_hal->invoke)) {
+        post_failure(ut, task, -ENOTSUP);
+        return;
+    }
+
+    if (!ubus_hal->invoke_async) {
+        ubus_result_t result = {0};
         ubus_hal->invoke(task, &result);
-    } else {
-        strncpy(result.service_name, task->service_name, sizeof(result.service_name) - 1);
-        result.action = task->action;
-        result.request_id = task->request_id;
-        result.success = false;
-        result.error_code = -ENOTSUP;
+        result_queue_push(ut->result_queue, &result);
+        return;
     }
 
-    result_queue_push(ut->result_queue, &result);
+    ut->in_flight++;
+    if (ubus_hal->invoke_async(task, on_call_done, ut) != 0) {
+        ut->in_flight--;
+        post_failure(ut, task, -EIO);
+    }
 }
 
-static void *ubus_thread_main(void *arg) {
-    ubus_thread_t *ut = (ubus_thread_t *)arg;
-
-    struct pollfd pfd = {
-        .fd = ut->wakeup_fd,
-        .events = POLLIN,
-        .revents = 0
-    };
+/*
+ * Start queued tasks up to the in-flight limit. Once the queue is empty,
+ * arm its eventfd; uloop then sleeps until a push, a completion or stop.
+ */
+static void dispatch_tasks(ubus_thread_t *ut) {
+    ubus_task_t task;
 
-    while (ut->running) {
-        ubus_task_t task;
+    if (!atomic_load(&ut->running)) {
         while (task_queue_try_pop(ut->task_queue, &task) == 1) {
-            process_task(ut, &task);
+            post_failure(ut, &task, -ECANCELED);
+        }
+        if (ut->in_flight == 0) {
+            uloop_end();
         }
+        return;
+    }
 
-        int ret = poll(&pfd, 1, 100);
-        if (ret > 0 && (pfd.revents & POLLIN)) {
-            uint64_t val;
-            while (read(ut->wakeup_fd, &val, sizeof(val)) > 0) {}
+    while (ut->in_flight < UBUS_THREAD_MAX_INFLIGHT) {
+        if (task_queue_try_pop(ut->task_queue, &task) == 1) {
+            process_task(ut, &task);
+            continue;
+        }
+        if (task_queue_arm(ut->task_queue)) {
+            break;
         }
     }
+}
+
+static void on_dispatch_timer(struct uloop_timeout *t) {
+    dispatch_tasks(container_of(t, ubus_thread_t, dispatch_timer));
+}
 
+static void on_tasks(struct uloop_fd *u, unsigned int events) {
+    (void)events;
+    /* Consume the wakeup even when at the in-flight limit: completions re-dispatch */
+    uint64_t val;
+    while (read(u->fd, &val, sizeof(val)) > 0) {}
+    dispatch_tasks(container_of(u, ubus_thread_t, task_ufd));
+}
+
+static void on_wakeup(struct uloop_fd *u, unsigned int events) {
+    (void)events;
+    ubus_thread_t *ut = container_of(u, ubus_thread_t, wakeup_ufd);
+    uint64_t val;
+    while (read(ut->wakeup_fd, &val, sizeof(val)) > 0) {}
+    dispatch_tasks(ut);
+}
+
+static void *ubus_thread_main(void *arg) {
+    ubus_thread_t *ut = (ubus_thread_t *)arg;
+
+    /* Shutdown signals belong to the main thread's event loop */
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    sigaddset(&set, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    /* The worker is the only uloop user in this process */
+    uloop_init();
+    ut->in_flight = 0;
+    ut->wakeup_ufd.fd = ut->wakeup_fd;
+    ut->wakeup_ufd.cb = on_wakeup;
+    uloop_fd_add(&ut->wakeup_ufd, ULOOP_READ);
+    ut->task_ufd.fd = task_queue_get_fd(ut->task_queue);
+    ut->task_ufd.cb = on_tasks;
+    uloop_fd_add(&ut->task_ufd, ULOOP_READ);
+    ut->dispatch_timer.cb = on_dispatch_timer;
+
+    dispatch_tasks(ut);
+    uloop_run();
+
+    uloop_timeout_cancel(&ut->dispatch_timer);
+    uloop_fd_delete(&ut->task_ufd);
+    uloop_fd_delete(&ut->wakeup_ufd);
+    uloop_done();
+
+    /* Anything pushed after the loop ended */
     ubus_task_t task;
     while (task_queue_try_pop(ut->task_queue, &task) == 1) {
-        ubus_result_t result = {0};
-        strncpy(result.service_name, task.service_name, sizeof(result.service_name) - 1);
-        result.action = task.action;
-        result.request_id = task.request_id;
-        result.success = false;
-        result.error_code = -ECANCELED;
-        result_queue_push(ut->result_queue, &result);
+        post_failure(ut, &task, -ECANCELED);
     }
 
     return NULL;
@@ -92,29 +160,30 @@ int ubus_thread_init(ubus_thread_t *ut, task_queue_t *tq, result_queue_t *rq) {
     if (ut->wakeup_fd < 0) {
         return -1;
     }
-    ut->running = false;
+    atomic_store(&ut->running, false);
     return 0;
 }
 
 int ubus_thread_start(ubus_thread_t *ut) {
-    if (!ut || ut->running) {
+    if (!ut || atomic_load(&ut->running)) {
         return -1;
     }
 
-    ut->running = true;
+    atomic_store(&ut->running, true);
     if (pthread_create(&ut->thread, NULL, ubus_thread_main, ut) != 0) {
-        ut->running = false;
+        atomic_store(&ut->running, false);
         return -1;
     }
     return 0;
 }
 
 void ubus_thread_stop(ubus_thread_t *ut) {
-    if (!ut || !ut->running) {
+    if (!ut || !atomic_load(&ut->running)) {
         return;
     }
 
-    ut->running = false;
+    /* In-flight calls finish (bounded by their timeouts), queued ones are cancelled */
+    atomic_store(&ut->running, false);
     ubus_thread_wakeup(ut);
     pthread_join(ut->thread, NULL);
 }
@@ -123,7 +192,7 @@ void ubus_thread_destroy(ubus_thread_t *ut) {
     if (!ut) {
         return;
     }
-    if (ut->running) {
+    if (atomic_load(&ut->running)) {
         ubus_thread_stop(ut);
     }
     if (ut->wakeup_fd >= 0) {
@@ -2,17 +2,35 @@
 #define UBUS_THREAD_H
 
 #include <stdbool.h>
+#include <stdatomic.h>
 #include <pthread.h>
+#include <libubox/uloop.h>
 
 #include "task_queue.h"
 #include "result_queue.h"
 
+/* Calls in flight at once; further tasks wait in the task queue */
+#define UBUS_THREAD_MAX_INFLIGHT 8
+
+/*
+ * ubus worker: owns the process uloop (ubus_add_uloop) and runs calls
+ * through ubus_hal->invoke_async(), so several are in flight at once.
+ * It sleeps in uloop until the task queue's eventfd fires, a call
+ * completes or stop is requested: no periodic wakeups when idle.
+ * Results go to the result queue, whose eventfd the UI side can poll.
+ */
 typedef struct {
     task_queue_t *task_queue;
     result_queue_t *result_queue;
     pthread_t thread;
     int wakeup_fd;
-    bool running;
+    _Atomic bool running;
+
+    /* Worker thread only */
+    struct uloop_fd wakeup_ufd;
+    struct uloop_fd task_ufd;
+    struct uloop_timeout dispatch_timer;
+    int in_flight;
 } ubus_thread_t;
 
 int ubus_thread_init(ubus_thread_t *ut, task_queue_t *tq, result_queue_t *rq);
@@ -0,0 +1,47 @@
+/*
+ * nanohat-replay - replay a recorded session on the host
+ *
+ * Record on the device with NANOHAT_SESSION_LOG=/tmp/session.log, copy
+ * the log over and run:
+ *
+ *   nanohat-replay [-c service-config] session.log
+ *
+ * Prints render/flush/ubus counters and per-frame render time, so a
+ * regression can be bisected offline against the same input.
+ */
+#include <stdio.h>
+#include <unistd.h>
+
+#include "service_config.h"
+#include "session_replay.h"
+
+static void usage(const char *prog) {
+    fprintf(stderr, "usage: %s [-c service-config] session.log\n", prog);
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "c:h")) != -1) {
+        switch (opt) {
+            case 'c':
+                service_config_set_path(optarg);
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 2;
+    }
+    service_config_reload();
+
+    session_replay_report_t report;
+    if (session_replay_run(argv[optind], &report) < 0) {
+        fprintf(stderr, "cannot replay %s\n", argv[optind]);
+        return 1;
+    }
+    session_replay_print(&report, stdout);
+    return 0;
+}
@@ -0,0 +1,284 @@
+#include "session_replay.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libubox/uloop.h>
+
+#include "app_loop.h"
+#include "hal/display_hal.h"
+#include "hal/gpio_hal.h"
+#include "hal/time_hal.h"
+#include "hal/ubus_hal.h"
+#include "session_log.h"
+#include "sim_loop.h"
+#include "sys_status.h"
+
+/* Test API from the mocks */
+typedef bool (*ubus_mock_responder_t)(const char *service, bool *installed, bool *running,
+                                      int *status, int *delay_ms, void *priv);
+extern void ubus_mock_set_responder(ubus_mock_responder_t responder, void *priv);
+extern unsigned long ubus_mock_get_request_count(void);
+extern unsigned long display_null_get_flush_count(void);
+extern void gpio_mock_inject_edge(int line, int falling, uint64_t timestamp_ns);
+extern uint64_t gpio_mock_next_deadline_ms(void);
+
+typedef struct {
+    session_record_t *recs;
+    size_t count;
+    size_t cap;
+} rec_array_t;
+
+static rec_array_t g_edges;
+static rec_array_t g_ubus;
+static rec_array_t g_proc;
+
+static bool *g_ubus_used;
+static size_t g_ubus_cursor;        /* Every result before it is used */
+static size_t g_proc_cursor;
+static size_t g_edge_cursor;
+static int64_t g_offset_us;         /* Replay time - recorded time */
+
+static struct uloop_timeout g_edge_timer;
+static struct uloop_timeout g_gpio_timer;
+static session_replay_report_t *g_report;
+
+static int rec_push(rec_array_t *arr, const session_record_t *rec) {
+    if (arr->count == arr->cap) {
+        size_t cap = arr->cap ? arr->cap * 2 : 256;
+        session_record_t *recs = realloc(arr->recs, cap * sizeof(*recs));
+        if (!recs) return -1;
+        arr->recs = recs;
+        arr->cap = cap;
+    }
+    arr->recs[arr->count++] = *rec;
+    return 0;
+}
+
+static void rec_free(rec_array_t *arr) {
+    free(arr->recs);
+    memset(arr, 0, sizeof(*arr));
+}
+
+static uint64_t replay_time_us(const session_record_t *rec) {
+    return (uint64_t)((int64_t)rec->time_us + g_offset_us);
+}
+
+/* Load the log, split by type; timer records only feed the report */
+static int load(const char *path, session_replay_report_t *report,
+                uint64_t *first_us, uint64_t *last_us) {
+    session_reader_t reader;
+    if (session_reader_open(&reader, path) < 0) return -1;
+
+    session_record_t rec;
+    int ret;
+    while ((ret = session_reader_next(&reader, &rec)) > 0) {
+        if (report->records == 0 || rec.time_us < *first_us) *first_us = rec.time_us;
+        if (report->records == 0 || rec.time_us > *last_us) *last_us = rec.time_us;
+        report->records++;
+
+        switch (rec.type) {
+            case SESSION_REC_GPIO_EDGE:
+                report->edges++;
+                ret = rec_push(&g_edges, &rec);
+                break;
+            case SESSION_REC_UBUS_QUERY:
+                report->ubus++;
+                ret = rec_push(&g_ubus, &rec);
+                break;
+            case SESSION_REC_PROC_SAMPLE:
+                report->proc++;
+                ret = rec_push(&g_proc, &rec);
+                break;
+            case SESSION_REC_TIMER:
+                report->timers++;
+                latency_hist_record(&report->device_timer_late_us, rec.timer.late_us);
+                ret = 0;
+                break;
+        }
+        if (ret < 0) break;
+    }
+    if (ret < 0) {
+        fprintf(stderr, "WARN: %s: unreadable record after %" PRIu64 ", replaying the rest\n",
+                path, report->records);
+    }
+    session_reader_close(&reader);
+
+    g_ubus_used = calloc(g_ubus.count ? g_ubus.count : 1, sizeof(bool));
+    return (report->records > 0 && g_ubus_used) ? 0 : -1;
+}
+
+/* Answer queries in recorded order per service, with recorded latency */
+static bool ubus_responder(const char *service, bool *installed, bool *running,
+                           int *status, int *delay_ms, void *priv) {
+    (void)priv;
+    for (size_t i = g_ubus_cursor; i < g_ubus.count; i++) {
+        const session_record_t *rec = &g_ubus.recs[i];
+        if (g_ubus_used[i] || strcmp(rec->ubus.service, service) != 0) continue;
+
+        g_ubus_used[i] = true;
+        while (g_ubus_cursor < g_ubus.count && g_ubus_used[g_ubus_cursor]) {
+            g_ubus_cursor++;
+        }
+        *installed = rec->ubus.installed;
+        *running = rec->ubus.running;
+        *status = rec->ubus.status;
+        *delay_ms = (int)rec->ubus.latency_ms;
+        return true;
+    }
+    g_report->ubus_unmatched++;
+    return false;
+}
+
+/* Latest recorded sample at or before now */
+static void proc_source(sys_status_t *status, void *priv) {
+    (void)priv;
+    if (g_proc.count == 0) return;
+
+    uint64_t now_us = time_hal_now_ns() / 1000ULL;
+    while (g_proc_cursor + 1 < g_proc.count &&
+           replay_time_us(&g_proc.recs[g_proc_cursor + 1]) <= now_us) {
+        g_proc_cursor++;
+    }
+    session_proc_to_status(&g_proc.recs[g_proc_cursor].proc, status);
+}
+
+static void frame_observer(uint64_t render_ns) {
+    g_report->renders++;
+    latency_hist_record(&g_report->frame_us, render_ns / 1000ULL);
+}
+
+/* Long-press, repeat and gesture deadlines of the mock (its timer fd) */
+static void gpio_timer_cb(struct uloop_timeout *t);
+
+static void arm_gpio_timer(void) {
+    uint64_t deadline = gpio_mock_next_deadline_ms();
+    if (deadline == 0) {
+        uloop_timeout_cancel(&g_gpio_timer);
+        return;
+    }
+    uint64_t now_ms = time_hal_now_ms();
+    g_gpio_timer.cb = gpio_timer_cb;
+    uloop_timeout_set(&g_gpio_timer, deadline > now_ms ? (int)(deadline - now_ms) : 0);
+}
+
+static void gpio_timer_cb(struct uloop_timeout *t) {
+    (void)t;
+    app_loop_gpio_readable();
+    arm_gpio_timer();
+}
+
+static void edge_timer_cb(struct uloop_timeout *t);
+
+static void arm_edge_timer(void) {
+    if (g_edge_cursor >= g_edges.count) return;
+
+    uint64_t due_ms = replay_time_us(&g_edges.recs[g_edge_cursor]) / 1000ULL;
+    uint64_t now_ms = time_hal_now_ms();
+    g_edge_timer.cb = edge_timer_cb;
+    uloop_timeout_set(&g_edge_timer, due_ms > now_ms ? (int)(due_ms - now_ms) : 0);
+}
+
+static void edge_timer_cb(struct uloop_timeout *t) {
+    (void)t;
+    uint64_t now_us = time_hal_now_ns() / 1000ULL;
+    while (g_edge_cursor < g_edges.count &&
+           replay_time_us(&g_edges.recs[g_edge_cursor]) / 1000ULL <= now_us / 1000ULL) {
+        const session_record_t *rec = &g_edges.recs[g_edge_cursor++];
+        gpio_mock_inject_edge(rec->edge.line, rec->edge.pressed ? 1 : 0,
+                              replay_time_us(rec) * 1000ULL);
+    }
+    app_loop_gpio_readable();
+    arm_gpio_timer();
+    arm_edge_timer();
+}
+
+static void cleanup(void) {
+    rec_free(&g_edges);
+    rec_free(&g_ubus);
+    rec_free(&g_proc);
+    free(g_ubus_used);
+    g_ubus_used = NULL;
+    g_ubus_cursor = 0;
+    g_proc_cursor = 0;
+    g_edge_cursor = 0;
+    g_report = NULL;
+}
+
+int session_replay_run(const char *path, session_replay_report_t *report) {
+    memset(report, 0, sizeof(*report));
+    latency_hist_reset(&report->frame_us);
+    latency_hist_reset(&report->device_timer_late_us);
+    g_report = report;
+
+    uint64_t first_us = 0, last_us = 0;
+    if (load(path, report, &first_us, &last_us) < 0) {
+        cleanup();
+        return -1;
+    }
+    report->duration_ms = (last_us - first_us) / 1000ULL;
+
+    /* Recorded start maps to now; the virtual clock only moves forward */
+    uint64_t start_us = time_hal_now_ns() / 1000ULL;
+    g_offset_us = (int64_t)start_us - (int64_t)first_us;
+
+    display_hal->init();
+    gpio_hal->init();
+    ubus_hal->init();
+    ubus_mock_set_responder(ubus_responder, NULL);
+    sys_status_set_local_source(proc_source, NULL);
+    app_loop_set_frame_observer(frame_observer);
+
+    unsigned long flushes = display_null_get_flush_count();
+    unsigned long requests = ubus_mock_get_request_count();
+
+    app_loop_init();
+    app_loop_start();
+    arm_edge_timer();
+
+    /* Run one second past the last record so pending work settles */
+    report->wakeups = sim_loop_run_until(start_us / 1000ULL + report->duration_ms + 1000);
+
+    report->flushes = display_null_get_flush_count() - flushes;
+    report->requests = ubus_mock_get_request_count() - requests;
+
+    app_loop_cleanup();
+    sim_loop_reset();
+    app_loop_set_frame_observer(NULL);
+    sys_status_set_local_source(NULL, NULL);
+    ubus_mock_set_responder(NULL, NULL);
+    ubus_hal->cleanup();
+    gpio_hal->cleanup();
+    display_hal->cleanup();
+    cleanup();
+    return 0;
+}
+
+static void print_hist(FILE *fp, const char *name, const latency_hist_t *hist) {
+    fprintf(fp, "%-14s n=%" PRIu64 " p50=%" PRIu64 "us p90=%" PRIu64 "us p99=%" PRIu64
+            "us max=%" PRIu64 "us\n", name, hist->count,
+            latency_hist_percentile(hist, 50), latency_hist_percentile(hist, 90),
+            latency_hist_percentile(hist, 99), hist->max_us);
+}
+
+void session_replay_print(const session_replay_report_t *report, FILE *fp) {
+    double hours = (double)report->duration_ms / 3600000.0;
+    if (hours <= 0) hours = 1.0 / 3600000.0;
+
+    fprintf(fp, "log: %" PRIu64 " records over %.1f s (edges=%" PRIu64 " ubus=%" PRIu64
+            " proc=%" PRIu64 " timers=%" PRIu64 ")\n", report->records,
+            (double)report->duration_ms / 1000.0, report->edges, report->ubus,
+            report->proc, report->timers);
+    fprintf(fp, "renders=%lu (%.1f/h) flushes=%lu (%.1f/h) ubus=%lu (%.1f/h) "
+            "wakeups=%" PRIu64 " (%.1f/h)\n",
+            report->renders, (double)report->renders / hours,
+            report->flushes, (double)report->flushes / hours,
+            report->requests, (double)report->requests / hours,
+            report->wakeups, (double)report->wakeups / hours);
+    if (report->ubus_unmatched > 0) {
+        fprintf(fp, "ubus queries without a recorded result: %lu (mock defaults used)\n",
+                report->ubus_unmatched);
+    }
+    print_hist(fp, "frame", &report->frame_us);
+    print_hist(fp, "device-timer", &report->device_timer_late_us);
+}
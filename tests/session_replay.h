@@ -0,0 +1,54 @@
+/*
+ * Session log replay in virtual time
+ *
+ * Feeds a log written by session_log.c back through the host build:
+ * GPIO edges go into gpio_hal_mock at their recorded times, ubus queries
+ * are answered with the recorded results and latencies (ubus_hal_mock
+ * responder), and sys_status reads the recorded /proc samples instead of
+ * the host's. The UI runs the production wiring (app_loop.c) on
+ * sim_loop, so a day-long log replays in seconds with its timing intact.
+ *
+ * Link with sim_loop.c and time_hal_virtual.c instead of libubox and
+ * time_hal_real.c.
+ */
+#ifndef SESSION_REPLAY_H
+#define SESSION_REPLAY_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "input_latency.h"
+
+typedef struct {
+    /* Log contents */
+    uint64_t records;
+    uint64_t edges;
+    uint64_t ubus;
+    uint64_t proc;
+    uint64_t timers;
+    uint64_t duration_ms;
+
+    /* Replay counters */
+    unsigned long renders;
+    unsigned long flushes;
+    unsigned long requests;         /* ubus requests issued */
+    unsigned long ubus_unmatched;   /* Queries without a recorded result left */
+    uint64_t wakeups;               /* Loop timeouts fired */
+
+    latency_hist_t frame_us;        /* Render time per frame on this host */
+    latency_hist_t device_timer_late_us;  /* UI timer lateness on the device (from the log) */
+} session_replay_report_t;
+
+/*
+ * Replay a log. HALs are initialized and cleaned up inside.
+ * Returns 0 on success, -1 if the log cannot be read or is empty.
+ * A corrupt tail is reported on stderr and the readable part replayed.
+ */
+int session_replay_run(const char *path, session_replay_report_t *report);
+
+/*
+ * Print the report (counters, per-hour rates, histogram percentiles).
+ */
+void session_replay_print(const session_replay_report_t *report, FILE *fp);
+
+#endif
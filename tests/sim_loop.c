@@ -0,0 +1,88 @@
+#include "sim_loop.h"
+
+#include <stdbool.h>
+#include <libubox/uloop.h>
+
+#include "hal/time_hal.h"
+
+/* Pending timeouts, sorted by deadline (FIFO among equal deadlines) */
+static struct list_head g_timeouts = LIST_HEAD_INIT(g_timeouts);
+
+static uint64_t deadline_ms(const struct uloop_timeout *t) {
+    return (uint64_t)t->time.tv_sec * 1000ULL + (uint64_t)t->time.tv_usec / 1000ULL;
+}
+
+int uloop_timeout_add(struct uloop_timeout *timeout) {
+    if (timeout->pending) return -1;
+
+    struct uloop_timeout *pos;
+    list_for_each_entry(pos, &g_timeouts, list) {
+        if (deadline_ms(pos) > deadline_ms(timeout)) break;
+    }
+    list_add_tail(&timeout->list, &pos->list);
+    timeout->pending = true;
+    return 0;
+}
+
+int uloop_timeout_set(struct uloop_timeout *timeout, int msecs) {
+    if (timeout->pending) {
+        uloop_timeout_cancel(timeout);
+    }
+
+    uint64_t when = time_hal_now_ms() + (uint64_t)(msecs > 0 ? msecs : 0);
+    timeout->time.tv_sec = (time_t)(when / 1000ULL);
+    timeout->time.tv_usec = (suseconds_t)((when % 1000ULL) * 1000ULL);
+    return uloop_timeout_add(timeout);
+}
+
+int uloop_timeout_cancel(struct uloop_timeout *timeout) {
+    if (!timeout->pending) return -1;
+
+    list_del(&timeout->list);
+    timeout->pending = false;
+    return 0;
+}
+
+int64_t uloop_timeout_remaining64(struct uloop_timeout *timeout) {
+    if (!timeout->pending) return -1;
+
+    uint64_t now = time_hal_now_ms();
+    uint64_t when = deadline_ms(timeout);
+    return when > now ? (int64_t)(when - now) : 0;
+}
+
+int uloop_timeout_remaining(struct uloop_timeout *timeout) {
+    int64_t remaining = uloop_timeout_remaining64(timeout);
+    return remaining > INT32_MAX ? INT32_MAX : (int)remaining;
+}
+
+uint64_t sim_loop_next_deadline_ms(void) {
+    if (list_empty(&g_timeouts)) return 0;
+    return deadline_ms(list_first_entry(&g_timeouts, struct uloop_timeout, list));
+}
+
+uint64_t sim_loop_run_until(uint64_t end_ms) {
+    uint64_t fired = 0;
+
+    while (!list_empty(&g_timeouts)) {
+        struct uloop_timeout *t = list_first_entry(&g_timeouts, struct uloop_timeout, list);
+        uint64_t when = deadline_ms(t);
+        if (when > end_ms) break;
+
+        time_hal_virtual_set_ns(when * 1000000ULL);
+        uloop_timeout_cancel(t);
+        fired++;
+        if (t->cb) {
+            t->cb(t);
+        }
+    }
+
+    time_hal_virtual_set_ns(end_ms * 1000000ULL);
+    return fired;
+}
+
+void sim_loop_reset(void) {
+    while (!list_empty(&g_timeouts)) {
+        uloop_timeout_cancel(list_first_entry(&g_timeouts, struct uloop_timeout, list));
+    }
+}
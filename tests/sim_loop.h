@@ -0,0 +1,36 @@
+/*
+ * Virtual-time loop driver for simulation tests
+ *
+ * sim_loop.c provides the uloop timeout API (uloop_timeout_set/add/
+ * cancel/remaining) on top of time_hal_virtual.c. A simulation binary
+ * links it instead of libubox, so every timer in the code under test
+ * (UI tick, render kick, ubus mock responses and timeouts) runs in
+ * virtual time. sim_loop_run_until() jumps straight from one deadline
+ * to the next: idle time costs nothing.
+ *
+ * There are no fds: input is scripted with timeouts as well.
+ */
+#ifndef SIM_LOOP_H
+#define SIM_LOOP_H
+
+#include <stdint.h>
+
+/*
+ * Fire every timeout due up to end_ms (time_hal ms) in deadline order,
+ * moving the virtual clock to each deadline; timeouts added by callbacks
+ * are honored. Leaves the clock at end_ms.
+ * Returns the number of timeouts fired.
+ */
+uint64_t sim_loop_run_until(uint64_t end_ms);
+
+/*
+ * Deadline (time_hal ms) of the earliest pending timeout, 0 if none.
+ */
+uint64_t sim_loop_next_deadline_ms(void);
+
+/*
+ * Cancel all pending timeouts.
+ */
+void sim_loop_reset(void);
+
+#endif
@@ -0,0 +1,242 @@
+/*
+ * Framebuffer mirror tests (RLE codec, tile deltas, Unix socket
+ * streaming with keyframe requests and a static screen)
+ */
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <libubox/uloop.h>
+
+#include "fb_mirror.h"
+#include "metrics.h"
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "ASSERT FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+static uint8_t g_fb[FB_MIRROR_FB_SIZE];
+static uint8_t g_view[FB_MIRROR_FB_SIZE];
+static uint8_t g_msg[FB_MIRROR_MSG_MAX];
+static char g_path[64];
+
+static int test_rle(void) {
+    static uint8_t src[FB_MIRROR_FB_SIZE];
+    static uint8_t enc[FB_MIRROR_RLE_MAX];
+    static uint8_t dec[FB_MIRROR_FB_SIZE];
+
+    /* Blank frame: a handful of runs */
+    memset(src, 0, sizeof(src));
+    size_t len = fb_mirror_rle_encode(src, sizeof(src), enc);
+    ASSERT_TRUE(len == 16);
+    ASSERT_TRUE(fb_mirror_rle_decode(enc, len, dec, sizeof(dec)) == (int)sizeof(src));
+    ASSERT_TRUE(memcmp(src, dec, sizeof(src)) == 0);
+
+    /* Pairs never split literals: worst case stays within the bound */
+    for (size_t i = 0; i < sizeof(src); i++) {
+        src[i] = (uint8_t)((i / 2) * 7);
+    }
+    len = fb_mirror_rle_encode(src, sizeof(src), enc);
+    ASSERT_TRUE(len == FB_MIRROR_RLE_MAX);
+    ASSERT_TRUE(fb_mirror_rle_decode(enc, len, dec, sizeof(dec)) == (int)sizeof(src));
+    ASSERT_TRUE(memcmp(src, dec, sizeof(src)) == 0);
+
+    /* Mixed runs and noise */
+    srand(1);
+    for (int round = 0; round < 200; round++) {
+        for (size_t i = 0; i < sizeof(src); i++) {
+            src[i] = (rand() % 4 == 0) ? (uint8_t)rand() : src[i ? i - 1 : 0];
+        }
+        len = fb_mirror_rle_encode(src, sizeof(src), enc);
+        ASSERT_TRUE(len <= FB_MIRROR_RLE_MAX);
+        ASSERT_TRUE(fb_mirror_rle_decode(enc, len, dec, sizeof(dec)) == (int)sizeof(src));
+        ASSERT_TRUE(memcmp(src, dec, sizeof(src)) == 0);
+    }
+
+    /* Truncated or overflowing input */
+    const uint8_t cut[] = { 0x05, 1, 2 };
+    ASSERT_TRUE(fb_mirror_rle_decode(cut, sizeof(cut), dec, sizeof(dec)) < 0);
+    const uint8_t run[] = { 0xff, 9 };
+    ASSERT_TRUE(fb_mirror_rle_decode(run, sizeof(run), dec, 100) < 0);
+    return 0;
+}
+
+static int test_encode(void) {
+    static uint8_t shadow[FB_MIRROR_FB_SIZE];
+    memset(g_fb, 0, sizeof(g_fb));
+    memset(shadow, 0, sizeof(shadow));
+    memset(g_view, 0xaa, sizeof(g_view));
+
+    /* Keyframe covers everything */
+    size_t len = fb_mirror_encode(g_fb, NULL, 7, g_msg);
+    ASSERT_TRUE(len > 0 && fb_mirror_msg_len(g_msg) == (int)len);
+    uint32_t seq = 0;
+    ASSERT_TRUE(fb_mirror_decode(g_msg, len, g_view, &seq) == FB_MIRROR_KEYFRAME && seq == 7);
+    ASSERT_TRUE(memcmp(g_fb, g_view, sizeof(g_fb)) == 0);
+
+    /* Unchanged: nothing to send */
+    ASSERT_TRUE(fb_mirror_encode(g_fb, shadow, 8, g_msg) == 0);
+
+    /* One pixel: one tile */
+    g_fb[5 * 128 + 37] = 0x10;
+    len = fb_mirror_encode(g_fb, shadow, 8, g_msg);
+    ASSERT_TRUE(len <= FB_MIRROR_HEADER_SIZE + FB_MIRROR_MAP_SIZE + 1 + FB_MIRROR_TILE_SIZE);
+    int tile = (5 * 128 + 37) / FB_MIRROR_TILE_SIZE;
+    ASSERT_TRUE(g_msg[FB_MIRROR_HEADER_SIZE + tile / 8] == (1u << (tile % 8)));
+    ASSERT_TRUE(fb_mirror_decode(g_msg, len, g_view, &seq) == FB_MIRROR_DELTA && seq == 8);
+    ASSERT_TRUE(memcmp(g_fb, g_view, sizeof(g_fb)) == 0);
+
+    /* Malformed */
+    ASSERT_TRUE(fb_mirror_decode(g_msg, len - 1, g_view, &seq) < 0);
+    g_msg[0] = 'X';
+    ASSERT_TRUE(fb_mirror_msg_len(g_msg) < 0);
+    return 0;
+}
+
+/* Run the loop until the server has handled what is queued */
+static void end_cb(struct uloop_timeout *t) {
+    (void)t;
+    uloop_end();
+}
+
+static void pump(void) {
+    static struct uloop_timeout end = { .cb = end_cb };
+    uloop_timeout_set(&end, 20);
+    uloop_run();
+}
+
+static int connect_client(void) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", g_path);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    struct timeval tv = { .tv_sec = 2 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+/* Read one message and apply it to g_view; returns its type or -1 */
+static int read_msg(int fd, uint32_t *seq, size_t *len_out) {
+    size_t got = 0;
+    while (got < FB_MIRROR_HEADER_SIZE) {
+        ssize_t n = read(fd, g_msg + got, FB_MIRROR_HEADER_SIZE - got);
+        if (n <= 0) return -1;
+        got += (size_t)n;
+    }
+    int len = fb_mirror_msg_len(g_msg);
+    if (len < 0) return -1;
+    while (got < (size_t)len) {
+        ssize_t n = read(fd, g_msg + got, (size_t)len - got);
+        if (n <= 0) return -1;
+        got += (size_t)n;
+    }
+    if (len_out) *len_out = (size_t)len;
+    return fb_mirror_decode(g_msg, (size_t)len, g_view, seq);
+}
+
+static bool nothing_pending(int fd) {
+    uint8_t b;
+    return recv(fd, &b, 1, MSG_DONTWAIT) < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+static int test_stream(void) {
+    snprintf(g_path, sizeof(g_path), "/tmp/nanohat-mirror-test-%d.sock", (int)getpid());
+    ASSERT_TRUE(fb_mirror_start("relative.sock") < 0);
+    ASSERT_TRUE(fb_mirror_start(g_path) == 0);
+    ASSERT_TRUE(access(g_path, F_OK) == 0);
+
+    uint64_t frames = 0, keyframes = 0;
+    metrics_get("mirror_frames", &frames);
+    metrics_get("mirror_keyframes", &keyframes);
+
+    /* Connected before the first frame: keyframe arrives with it */
+    int a = connect_client();
+    ASSERT_TRUE(a >= 0);
+    pump();
+    ASSERT_TRUE(nothing_pending(a));
+
+    memset(g_fb, 0, sizeof(g_fb));
+    memset(g_view, 0xff, sizeof(g_view));
+    g_fb[0] = 0x81;
+    fb_mirror_frame(g_fb);
+    uint32_t seq = 0;
+    ASSERT_TRUE(read_msg(a, &seq, NULL) == FB_MIRROR_KEYFRAME);
+    ASSERT_TRUE(memcmp(g_fb, g_view, sizeof(g_fb)) == 0);
+    uint32_t key_seq = seq;
+
+    /* Static screen: nothing sent */
+    fb_mirror_frame(g_fb);
+    fb_mirror_frame(g_fb);
+    ASSERT_TRUE(nothing_pending(a));
+
+    /* Two tiles changed: a small delta with the next seq */
+    g_fb[300] = 0x3c;
+    g_fb[1023] = 0x01;
+    fb_mirror_frame(g_fb);
+    size_t len = 0;
+    ASSERT_TRUE(read_msg(a, &seq, &len) == FB_MIRROR_DELTA && seq == key_seq + 1);
+    ASSERT_TRUE(len < 64);
+    ASSERT_TRUE(memcmp(g_fb, g_view, sizeof(g_fb)) == 0);
+
+    /* Keyframe on request */
+    const char req = FB_MIRROR_REQ_KEYFRAME;
+    ASSERT_TRUE(write(a, &req, 1) == 1);
+    pump();
+    ASSERT_TRUE(read_msg(a, &seq, NULL) == FB_MIRROR_KEYFRAME && seq == key_seq + 1);
+
+    /* A late client gets the current frame at once */
+    int b = connect_client();
+    ASSERT_TRUE(b >= 0);
+    pump();
+    memset(g_view, 0, sizeof(g_view));
+    ASSERT_TRUE(read_msg(b, &seq, NULL) == FB_MIRROR_KEYFRAME && seq == key_seq + 1);
+    ASSERT_TRUE(memcmp(g_fb, g_view, sizeof(g_fb)) == 0);
+
+    /* Both follow the next delta */
+    g_fb[512] = 0xff;
+    fb_mirror_frame(g_fb);
+    ASSERT_TRUE(read_msg(a, &seq, NULL) == FB_MIRROR_DELTA && seq == key_seq + 2);
+    ASSERT_TRUE(read_msg(b, &seq, NULL) == FB_MIRROR_DELTA && seq == key_seq + 2);
+    ASSERT_TRUE(memcmp(g_fb, g_view, sizeof(g_fb)) == 0);
+
+    uint64_t value = 0;
+    ASSERT_TRUE(metrics_get("mirror_frames", &value) && value == frames + 2);
+    ASSERT_TRUE(metrics_get("mirror_keyframes", &value) && value == keyframes + 3);
+
+    /* Disconnects are noticed */
+    close(a);
+    close(b);
+    pump();
+    fb_mirror_frame(g_fb);
+
+    fb_mirror_stop();
+    ASSERT_TRUE(access(g_path, F_OK) != 0);
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("=== test_fb_mirror ===\n");
+    uloop_init();
+
+    failures += test_rle();
+    failures += test_encode();
+    failures += test_stream();
+
+    uloop_done();
+    printf("=== failures: %d ===\n", failures);
+    return failures ? 1 : 0;
+}
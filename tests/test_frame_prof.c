@@ -0,0 +1,136 @@
+/*
+ * Frame profiler tests (phase probes, ring wrap, trace export)
+ *
+ * Built with -DFRAME_PROFILE so the probes in ui_controller and
+ * page_controller are compiled in.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "frame_prof.h"
+#include "hal/display_hal.h"
+#include "hal/time_hal.h"
+#include "ui_controller.h"
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "ASSERT FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+static frame_prof_event_t g_events[FRAME_PROF_EVENTS];
+
+static int find_phase(const frame_prof_event_t *events, int n, frame_phase_t phase) {
+    for (int i = 0; i < n; i++) {
+        if (events[i].phase == phase) return i;
+    }
+    return -1;
+}
+
+static int test_frame_phases(void) {
+    display_hal->init();
+    ui_controller_t ui;
+    ui_controller_init(&ui);
+    frame_prof_reset();
+
+    uint64_t now_ms = time_hal_now_ms();
+    ui_controller_tick(&ui, now_ms);
+    ASSERT_TRUE(ui_controller_render(&ui, now_ms));
+
+    int n = frame_prof_snapshot(g_events, FRAME_PROF_EVENTS);
+    int tick = find_phase(g_events, n, FRAME_PHASE_TICK);
+    int sample = find_phase(g_events, n, FRAME_PHASE_SAMPLE);
+    int frame = find_phase(g_events, n, FRAME_PHASE_FRAME);
+    int title = find_phase(g_events, n, FRAME_PHASE_TITLE);
+    int page = find_phase(g_events, n, FRAME_PHASE_PAGE);
+    int flush = find_phase(g_events, n, FRAME_PHASE_FLUSH);
+    ASSERT_TRUE(tick >= 0 && sample >= 0 && frame >= 0);
+    ASSERT_TRUE(title >= 0 && page >= 0 && flush >= 0);
+
+    /* Events complete inner-first; inner phases nest inside their parent */
+    ASSERT_TRUE(sample < tick);
+    ASSERT_TRUE(g_events[sample].start_ns >= g_events[tick].start_ns);
+    ASSERT_TRUE(title < frame && page < frame && flush < frame);
+    for (int i = 0; i < n; i++) {
+        if (i == frame || g_events[i].start_ns < g_events[frame].start_ns) continue;
+        ASSERT_TRUE(g_events[i].start_ns + g_events[i].dur_ns <=
+                    g_events[frame].start_ns + g_events[frame].dur_ns);
+    }
+
+    ASSERT_TRUE(g_events[page].label != NULL);
+    ASSERT_TRUE(g_events[title].label == g_events[page].label);
+    ASSERT_TRUE(g_events[flush].label == NULL);
+
+    ui_controller_cleanup(&ui);
+    display_hal->cleanup();
+    return 0;
+}
+
+static int test_ring_wrap(void) {
+    frame_prof_reset();
+    ASSERT_TRUE(frame_prof_snapshot(g_events, FRAME_PROF_EVENTS) == 0);
+
+    /* Start times 0..N+9: the ring keeps the newest N, oldest first */
+    for (uint64_t i = 0; i < FRAME_PROF_EVENTS + 10; i++) {
+        frame_prof_record(FRAME_PHASE_FLUSH, NULL, i);
+    }
+    ASSERT_TRUE(frame_prof_snapshot(g_events, FRAME_PROF_EVENTS) == FRAME_PROF_EVENTS);
+    ASSERT_TRUE(g_events[0].start_ns == 10);
+    ASSERT_TRUE(g_events[FRAME_PROF_EVENTS - 1].start_ns == FRAME_PROF_EVENTS + 9);
+
+    /* A short buffer gets the newest events */
+    ASSERT_TRUE(frame_prof_snapshot(g_events, 2) == 2);
+    ASSERT_TRUE(g_events[1].start_ns == FRAME_PROF_EVENTS + 9);
+
+    ASSERT_TRUE(frame_prof_phase_name(FRAME_PHASE_PAGE) != NULL);
+    ASSERT_TRUE(frame_prof_phase_name(FRAME_PHASES) == NULL);
+    return 0;
+}
+
+static int test_trace_export(void) {
+    frame_prof_reset();
+    frame_prof_record(FRAME_PHASE_PAGE, "ho\"me", 1234567);
+    frame_prof_record(FRAME_PHASE_FRAME, NULL, 1000000);
+
+    char path[] = "/tmp/nanohat-trace-XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_TRUE(fd >= 0);
+    close(fd);
+
+    ASSERT_TRUE(frame_prof_dump(path) == 2);
+
+    char buf[1024];
+    FILE *fp = fopen(path, "r");
+    ASSERT_TRUE(fp != NULL);
+    size_t len = fread(buf, 1, sizeof(buf) - 1, fp);
+    fclose(fp);
+    unlink(path);
+    buf[len] = '\0';
+    printf("%s", buf);
+
+    ASSERT_TRUE(strncmp(buf, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 39) == 0);
+    ASSERT_TRUE(strstr(buf, "\"name\":\"page\"") != NULL);
+    ASSERT_TRUE(strstr(buf, "\"ts\":1234.567") != NULL);
+    ASSERT_TRUE(strstr(buf, "\"args\":{\"page\":\"ho\\\"me\"}") != NULL);
+    ASSERT_TRUE(strstr(buf, "\"name\":\"frame\"") != NULL);
+    ASSERT_TRUE(strcmp(buf + len - 3, "]}\n") == 0);
+
+    ASSERT_TRUE(frame_prof_dump("/nonexistent/trace.json") < 0);
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("=== test_frame_prof ===\n");
+
+    failures += test_frame_phases();
+    failures += test_ring_wrap();
+    failures += test_trace_export();
+
+    printf("=== failures: %d ===\n", failures);
+    return failures ? 1 : 0;
+}
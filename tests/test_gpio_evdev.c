@@ -0,0 +1,170 @@
+/*
+ * evdev GPIO backend test through uinput
+ *
+ * Creates a virtual gpio-keys-like device reporting BTN_0..BTN_2 and
+ * drives the backend with it. Skipped (exit 77) when /dev/uinput is not
+ * available, e.g. in containers.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "gpio_hal.h"
+#include "time_hal.h"
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "ASSERT FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+#define SKIP_CODE 77
+
+static int g_uinput = -1;
+
+static void emit(int type, int code, int value) {
+    struct input_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.type = (unsigned short)type;
+    ev.code = (unsigned short)code;
+    ev.value = value;
+    (void)write(g_uinput, &ev, sizeof(ev));
+}
+
+static void key(int code, int value) {
+    emit(EV_KEY, code, value);
+    emit(EV_SYN, SYN_REPORT, 0);
+}
+
+static int create_device(void) {
+    g_uinput = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
+    if (g_uinput < 0) return -1;
+
+    ioctl(g_uinput, UI_SET_EVBIT, EV_KEY);
+    ioctl(g_uinput, UI_SET_KEYBIT, BTN_0);
+    ioctl(g_uinput, UI_SET_KEYBIT, BTN_1);
+    ioctl(g_uinput, UI_SET_KEYBIT, BTN_2);
+
+    struct uinput_setup setup;
+    memset(&setup, 0, sizeof(setup));
+    setup.id.bustype = BUS_VIRTUAL;
+    snprintf(setup.name, sizeof(setup.name), "nanohat-test-keys");
+    if (ioctl(g_uinput, UI_DEV_SETUP, &setup) < 0 || ioctl(g_uinput, UI_DEV_CREATE) < 0) {
+        close(g_uinput);
+        g_uinput = -1;
+        return -1;
+    }
+
+    usleep(200 * 1000);  /* Let the event node appear */
+    return 0;
+}
+
+/* Wait up to timeout_ms for the next event on either fd */
+static int wait_event(gpio_event_t *event, int timeout_ms) {
+    uint64_t deadline = time_hal_now_ms() + (uint64_t)timeout_ms;
+    for (;;) {
+        int ret = gpio_hal->read_event(event);
+        if (ret != 0) return ret;
+
+        uint64_t now = time_hal_now_ms();
+        if (now >= deadline) return 0;
+
+        struct pollfd fds[2] = {
+            { .fd = gpio_hal->get_fd(), .events = POLLIN },
+            { .fd = gpio_hal->get_timer_fd(), .events = POLLIN },
+        };
+        poll(fds, 2, (int)(deadline - now));
+    }
+}
+
+static int test_short_press(void) {
+    gpio_event_t event;
+
+    key(BTN_0, 1);
+    key(BTN_0, 0);
+    ASSERT_TRUE(wait_event(&event, 200) == 1);
+    ASSERT_TRUE(event.type == GPIO_EVT_BTN_K1_SHORT);
+    ASSERT_TRUE(event.line == 0);
+    /* Kernel timestamps are switched to time_hal's clock */
+    uint64_t now_ns = time_hal_now_ns();
+    ASSERT_TRUE(event.timestamp_ns <= now_ns && now_ns - event.timestamp_ns < 1000000000ULL);
+    ASSERT_TRUE(wait_event(&event, 50) == 0);
+    return 0;
+}
+
+static int test_long_press(void) {
+    gpio_event_t event;
+
+    key(BTN_1, 1);
+    ASSERT_TRUE(wait_event(&event, GPIO_LONG_PRESS_MS + 200) == 1);
+    ASSERT_TRUE(event.type == GPIO_EVT_BTN_K2_LONG);
+    key(BTN_1, 0);
+    ASSERT_TRUE(wait_event(&event, 50) == 0);
+    return 0;
+}
+
+static int test_batched_burst(void) {
+    gpio_event_t event;
+
+    /* Three clicks written at once arrive in one read() */
+    for (int i = 0; i < 3; i++) {
+        key(BTN_2, 1);
+        key(BTN_2, 0);
+    }
+    int clicks = 0;
+    while (wait_event(&event, 100) == 1) {
+        ASSERT_TRUE(event.type == GPIO_EVT_BTN_K3_SHORT);
+        clicks++;
+    }
+    ASSERT_TRUE(clicks == 3);
+    return 0;
+}
+
+static int test_press_dispatch(void) {
+    gpio_event_t event;
+
+    gpio_hal->set_press_dispatch(GPIO_LINE_BIT(2));
+    key(BTN_2, 1);
+    ASSERT_TRUE(wait_event(&event, 100) == 1);
+    ASSERT_TRUE(event.type == GPIO_EVT_BTN_K3_SHORT);
+    key(BTN_2, 0);
+    ASSERT_TRUE(wait_event(&event, 50) == 0);
+    gpio_hal->set_press_dispatch(0);
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("=== test_gpio_evdev ===\n");
+
+    if (create_device() < 0) {
+        printf("SKIP: /dev/uinput not available (%s)\n", strerror(errno));
+        return SKIP_CODE;
+    }
+
+    if (gpio_hal->init() != 0) {
+        fprintf(stderr, "gpio_hal init failed\n");
+        ioctl(g_uinput, UI_DEV_DESTROY);
+        close(g_uinput);
+        return 1;
+    }
+
+    failures += test_short_press();
+    failures += test_long_press();
+    failures += test_batched_burst();
+    failures += test_press_dispatch();
+
+    gpio_hal->cleanup();
+    ioctl(g_uinput, UI_DEV_DESTROY);
+    close(g_uinput);
+
+    printf("=== failures: %d ===\n", failures);
+    return failures ? 1 : 0;
+}
@@ -17,6 +17,9 @@
 static int events_received = 0;
 static gpio_event_type_t last_event_type = GPIO_EVT_NONE;
 static int last_event_line = -1;
+static uint64_t last_event_ts = 0;
+static int repeat_events = 0;
+static int repeat_steps = 0;
 
 /* GPIO fd for uloop */
 static struct uloop_fd gpio_uloop_fd;
@@ -46,6 +49,11 @@ static void handle_gpio_event(const gpio_event_t *event) {
     events_received++;
     last_event_type = event->type;
     last_event_line = event->line;
+    last_event_ts = event->timestamp_ns;
+    if (event->type == GPIO_EVT_BTN_K3_REPEAT) {
+        repeat_events++;
+        repeat_steps += event->repeat;
+    }
     printf("  Event: line=%d type=%d\n", event->line, event->type);
 }
 
@@ -343,6 +351,215 @@ static int test_gpio_multiple_buttons(void) {
     return 0;
 }
 
+static int test_gpio_press_dispatch(void) {
+    printf("Test: GPIO press dispatch\n");
+
+    events_received = 0;
+    last_event_type = GPIO_EVT_NONE;
+    gpio_mock_clear();
+    gpio_hal->set_press_dispatch(GPIO_LINE_BIT(2));
+
+    /* Hold K3 past the long-press threshold */
+    uint64_t press_ns = time_hal_now_ns();
+    gpio_mock_inject_edge(2, 1, press_ns);
+
+    uloop_init();
+
+    setup_gpio_fds();
+
+    release_line = 2;
+    release_timeout.cb = release_cb;
+    uloop_timeout_set(&release_timeout, LONG_WAIT_MS + 50);
+
+    test_timeout.cb = timeout_cb;
+    uloop_timeout_set(&test_timeout, LONG_WAIT_MS + 200);
+
+    uloop_run();
+    uloop_done();
+    gpio_hal->set_press_dispatch(0);
+
+    if (events_received != 1) {
+        printf("  FAIL: expected 1 event, got %d\n", events_received);
+        return 1;
+    }
+
+    if (last_event_type != GPIO_EVT_BTN_K3_SHORT || last_event_ts != press_ns) {
+        printf("  FAIL: expected K3_SHORT at press edge, got type=%d\n", last_event_type);
+        return 1;
+    }
+
+    printf("  PASS: short event on press edge, no long/release event\n");
+    return 0;
+}
+
+static int test_gpio_auto_repeat(void) {
+    printf("Test: GPIO auto-repeat\n");
+
+    events_received = 0;
+    repeat_events = 0;
+    repeat_steps = 0;
+    gpio_mock_clear();
+    gpio_hal->set_auto_repeat(GPIO_LINE_BIT(2));
+
+    /* Hold K3: repeats due at 400, 550, 670, 766, 842 ms (accelerating) */
+    gpio_mock_inject_edge(2, 1, time_hal_now_ns());
+
+    uloop_init();
+
+    setup_gpio_fds();
+
+    release_line = 2;
+    release_timeout.cb = release_cb;
+    uloop_timeout_set(&release_timeout, 870);
+
+    test_timeout.cb = timeout_cb;
+    uloop_timeout_set(&test_timeout, 1100);
+
+    uloop_run();
+    uloop_done();
+
+    /* Short on press, then one event per step; nothing after release */
+    if (events_received != 1 + repeat_events || repeat_steps < 4 || repeat_steps > 6) {
+        printf("  FAIL: events=%d repeat_events=%d steps=%d\n",
+               events_received, repeat_events, repeat_steps);
+        gpio_hal->set_auto_repeat(0);
+        return 1;
+    }
+    printf("  PASS: %d repeat steps while held\n", repeat_steps);
+
+    /* UI falls behind: missed steps arrive as one coalesced event */
+    events_received = 0;
+    repeat_events = 0;
+    repeat_steps = 0;
+    gpio_mock_inject_edge(2, 1, time_hal_now_ns());
+    gpio_event_t event;
+    while (gpio_hal->read_event(&event) > 0) {
+        handle_gpio_event(&event);
+    }
+    usleep(900 * 1000);
+    while (gpio_hal->read_event(&event) > 0) {
+        handle_gpio_event(&event);
+    }
+    gpio_mock_inject_edge(2, 0, time_hal_now_ns());
+    while (gpio_hal->read_event(&event) > 0) {
+        handle_gpio_event(&event);
+    }
+    gpio_hal->set_auto_repeat(0);
+
+    if (events_received != 2 || repeat_events != 1 || repeat_steps < 4) {
+        printf("  FAIL: coalesce events=%d repeat_events=%d steps=%d\n",
+               events_received, repeat_events, repeat_steps);
+        return 1;
+    }
+
+    printf("  PASS: %d missed steps coalesced into one event\n", repeat_steps);
+    return 0;
+}
+
+static void read_all_events(void) {
+    gpio_event_t event;
+    while (gpio_hal->read_event(&event) > 0) {
+        handle_gpio_event(&event);
+    }
+}
+
+static int test_gpio_gestures(void) {
+    printf("Test: GPIO gestures\n");
+
+    static const gpio_gesture_t gestures[] = {
+        { GPIO_GESTURE_CHORD, GPIO_LINE_BIT(0) | GPIO_LINE_BIT(2), GPIO_EVT_CHORD_K1_K3 },
+        { GPIO_GESTURE_DOUBLE, GPIO_LINE_BIT(1), GPIO_EVT_BTN_K2_DOUBLE },
+    };
+    gpio_gesture_config_t config = { .gestures = gestures, .count = 2 };
+    gpio_gesture_config_t invalid = { .gestures = gestures, .count = GPIO_GESTURE_MAX + 1 };
+    if (gpio_hal->set_gestures(&invalid) == 0 || gpio_hal->set_gestures(&config) != 0) {
+        printf("  FAIL: set_gestures validation\n");
+        return 1;
+    }
+
+    /* K1 then K3 within the chord window: one chord event, releases swallowed */
+    events_received = 0;
+    gpio_mock_clear();
+    uint64_t t = time_hal_now_ns();
+    gpio_mock_inject_edge(0, 1, t);
+    gpio_mock_inject_edge(2, 1, t + 20 * 1000000ULL);
+    gpio_mock_inject_edge(0, 0, t + 100 * 1000000ULL);
+    gpio_mock_inject_edge(2, 0, t + 110 * 1000000ULL);
+    read_all_events();
+    if (events_received != 1 || last_event_type != GPIO_EVT_CHORD_K1_K3 ||
+        last_event_line != 0 || last_event_ts != t) {
+        printf("  FAIL: chord events=%d type=%d\n", events_received, last_event_type);
+        return 1;
+    }
+
+    /* Lone press-dispatch K1: held for the window, then sent with its edge time */
+    events_received = 0;
+    gpio_mock_clear();
+    gpio_hal->set_press_dispatch(GPIO_LINE_BIT(0));
+    t = time_hal_now_ns();
+    gpio_mock_inject_edge(0, 1, t);
+    read_all_events();
+    int held_events = events_received;
+    usleep((GPIO_CHORD_WINDOW_MS + 20) * 1000);
+    read_all_events();
+    gpio_mock_inject_edge(0, 0, time_hal_now_ns());
+    read_all_events();
+    gpio_hal->set_press_dispatch(0);
+    if (held_events != 0 || events_received != 1 ||
+        last_event_type != GPIO_EVT_BTN_K1_SHORT || last_event_ts != t) {
+        printf("  FAIL: chord timeout held=%d events=%d type=%d\n",
+               held_events, events_received, last_event_type);
+        return 1;
+    }
+
+    /* Two K2 clicks within the double window */
+    events_received = 0;
+    gpio_mock_clear();
+    t = time_hal_now_ns();
+    gpio_mock_inject_edge(1, 1, t);
+    gpio_mock_inject_edge(1, 0, t + 50 * 1000000ULL);
+    gpio_mock_inject_edge(1, 1, t + 100 * 1000000ULL);
+    gpio_mock_inject_edge(1, 0, t + 150 * 1000000ULL);
+    read_all_events();
+    if (events_received != 1 || last_event_type != GPIO_EVT_BTN_K2_DOUBLE) {
+        printf("  FAIL: double events=%d type=%d\n", events_received, last_event_type);
+        return 1;
+    }
+
+    /* Single K2 click: delivered unchanged once the window expires */
+    events_received = 0;
+    gpio_mock_clear();
+    t = time_hal_now_ns();
+    gpio_mock_inject_edge(1, 1, t);
+    gpio_mock_inject_edge(1, 0, t + 40 * 1000000ULL);
+    read_all_events();
+    held_events = events_received;
+    usleep((40 + GPIO_DOUBLE_WINDOW_MS + 20) * 1000);
+    read_all_events();
+    if (held_events != 0 || events_received != 1 ||
+        last_event_type != GPIO_EVT_BTN_K2_SHORT || last_event_ts != t + 40 * 1000000ULL) {
+        printf("  FAIL: single click held=%d events=%d type=%d\n",
+               held_events, events_received, last_event_type);
+        return 1;
+    }
+
+    /* Cleared table: plain presses pass straight through */
+    gpio_hal->set_gestures(NULL);
+    events_received = 0;
+    gpio_mock_clear();
+    t = time_hal_now_ns();
+    gpio_mock_inject_edge(1, 1, t);
+    gpio_mock_inject_edge(1, 0, t + 40 * 1000000ULL);
+    read_all_events();
+    if (events_received != 1 || last_event_type != GPIO_EVT_BTN_K2_SHORT) {
+        printf("  FAIL: no gestures events=%d type=%d\n", events_received, last_event_type);
+        return 1;
+    }
+
+    printf("  PASS: chord, double-click and pass-through\n");
+    return 0;
+}
+
 int main(void) {
     int failures = 0;
 
@@ -355,6 +572,9 @@ int main(void) {
     failures += test_gpio_release_before_threshold();
     failures += test_gpio_debounce();
     failures += test_gpio_multiple_buttons();
+    failures += test_gpio_press_dispatch();
+    failures += test_gpio_auto_repeat();
+    failures += test_gpio_gestures();
 
     gpio_hal->cleanup();
 
@@ -0,0 +1,135 @@
+/*
+ * Shared key state machine tests (long press, deadlines, auto-repeat,
+ * release-time long press without a timer)
+ */
+#include <stdio.h>
+
+#include "gpio_keys.h"
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "ASSERT FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+#define MS(ms) ((uint64_t)(ms) * 1000000ULL)
+
+static void keys_init(gpio_keys_t *keys, bool timed) {
+    gpio_keys_reset(keys);
+    keys->timed = timed;
+}
+
+static int test_long_press(void) {
+    gpio_keys_t keys;
+    keys_init(&keys, true);
+    gpio_event_t evt;
+    uint64_t deadline = 0;
+
+    ASSERT_TRUE(!gpio_keys_next_deadline_ms(&keys, &deadline));
+
+    /* Long press fires while held, the release adds nothing */
+    gpio_keys_edge(&keys, 0, true, MS(1000));
+    ASSERT_TRUE(gpio_keys_next_deadline_ms(&keys, &deadline));
+    ASSERT_TRUE(deadline == 1000 + GPIO_LONG_PRESS_MS);
+
+    gpio_keys_expire(&keys, MS(1000 + GPIO_LONG_PRESS_MS - 1));
+    ASSERT_TRUE(!gpio_keys_pop(&keys, &evt));
+    gpio_keys_expire(&keys, MS(1000 + GPIO_LONG_PRESS_MS));
+    ASSERT_TRUE(gpio_keys_pop(&keys, &evt) && evt.type == GPIO_EVT_BTN_K1_LONG);
+    ASSERT_TRUE(!gpio_keys_next_deadline_ms(&keys, &deadline));
+
+    gpio_keys_edge(&keys, 0, false, MS(2000));
+    ASSERT_TRUE(!gpio_keys_pop(&keys, &evt));
+
+    /* Short press: on release */
+    gpio_keys_edge(&keys, 2, true, MS(3000));
+    gpio_keys_edge(&keys, 2, false, MS(3100));
+    ASSERT_TRUE(gpio_keys_pop(&keys, &evt) && evt.type == GPIO_EVT_BTN_K3_SHORT);
+    ASSERT_TRUE(evt.timestamp_ns == MS(3100));
+    return 0;
+}
+
+static int test_due_deadline_stays_first(void) {
+    gpio_keys_t keys;
+    keys_init(&keys, true);
+    uint64_t deadline = 0;
+
+    /* K1 long press is overdue (timer late), K2's is still ahead */
+    gpio_keys_edge(&keys, 0, true, MS(1000));
+    gpio_keys_edge(&keys, 1, true, MS(1300));
+    ASSERT_TRUE(gpio_keys_next_deadline_ms(&keys, &deadline));
+    ASSERT_TRUE(deadline == 1000 + GPIO_LONG_PRESS_MS);
+    return 0;
+}
+
+static int test_auto_repeat(void) {
+    gpio_keys_t keys;
+    keys_init(&keys, true);
+    keys.auto_repeat = GPIO_LINE_BIT(2);
+    gpio_event_t evt;
+    uint64_t deadline = 0;
+
+    /* Short press on the press edge, repeats after the delay */
+    gpio_keys_edge(&keys, 2, true, MS(1000));
+    ASSERT_TRUE(gpio_keys_pop(&keys, &evt) && evt.type == GPIO_EVT_BTN_K3_SHORT);
+    ASSERT_TRUE(gpio_keys_next_deadline_ms(&keys, &deadline));
+    ASSERT_TRUE(deadline == 1000 + GPIO_REPEAT_DELAY_MS);
+
+    gpio_keys_expire(&keys, MS(1000 + GPIO_REPEAT_DELAY_MS));
+    ASSERT_TRUE(gpio_keys_pop(&keys, &evt) && evt.type == GPIO_EVT_BTN_K3_REPEAT);
+    ASSERT_TRUE(evt.repeat == 1);
+
+    /* Unread steps coalesce into one event */
+    gpio_keys_expire(&keys, MS(1000 + GPIO_REPEAT_DELAY_MS + GPIO_REPEAT_START_MS));
+    gpio_keys_expire(&keys, MS(2000));
+    ASSERT_TRUE(gpio_keys_pop(&keys, &evt) && evt.type == GPIO_EVT_BTN_K3_REPEAT);
+    ASSERT_TRUE(evt.repeat >= 3);
+    ASSERT_TRUE(!gpio_keys_pop(&keys, &evt));
+
+    /* Release stops it and emits nothing */
+    gpio_keys_edge(&keys, 2, false, MS(2010));
+    ASSERT_TRUE(!gpio_keys_pop(&keys, &evt));
+    ASSERT_TRUE(!gpio_keys_next_deadline_ms(&keys, &deadline));
+
+    /* Dropping held input keeps the masks */
+    gpio_keys_edge(&keys, 2, true, MS(3000));
+    gpio_keys_drop(&keys);
+    ASSERT_TRUE(!gpio_keys_pop(&keys, &evt));
+    ASSERT_TRUE(!gpio_keys_next_deadline_ms(&keys, &deadline));
+    ASSERT_TRUE(keys.auto_repeat == GPIO_LINE_BIT(2));
+    return 0;
+}
+
+static int test_untimed(void) {
+    gpio_keys_t keys;
+    keys_init(&keys, false);
+    keys.auto_repeat = GPIO_LINE_BIT(0);
+    gpio_event_t evt;
+    uint64_t deadline = 0;
+
+    /* No timer: no repeat, long press known on release */
+    gpio_keys_edge(&keys, 0, true, MS(1000));
+    ASSERT_TRUE(!gpio_keys_pop(&keys, &evt));
+    ASSERT_TRUE(!gpio_keys_next_deadline_ms(&keys, &deadline));
+    gpio_keys_edge(&keys, 0, false, MS(1000 + GPIO_LONG_PRESS_MS));
+    ASSERT_TRUE(gpio_keys_pop(&keys, &evt) && evt.type == GPIO_EVT_BTN_K1_LONG);
+
+    gpio_keys_edge(&keys, 1, true, MS(2000));
+    gpio_keys_edge(&keys, 1, false, MS(2100));
+    ASSERT_TRUE(gpio_keys_pop(&keys, &evt) && evt.type == GPIO_EVT_BTN_K2_SHORT);
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("=== test_gpio_keys ===\n");
+    failures += test_long_press();
+    failures += test_due_deadline_stays_first();
+    failures += test_auto_repeat();
+    failures += test_untimed();
+
+    printf("=== failures: %d ===\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * Button-to-photon latency tests (histogram percentiles, stage tracking)
+ */
+#include <stdio.h>
+
+#include "hal/display_hal.h"
+#include "hal/time_hal.h"
+#include "input_latency.h"
+#include "ui_controller.h"
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "ASSERT FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+static int test_hist_percentiles(void) {
+    latency_hist_t hist;
+    latency_hist_reset(&hist);
+    ASSERT_TRUE(latency_hist_percentile(&hist, 50.0) == 0);
+
+    /* 1..1000 us, uniform */
+    for (uint64_t v = 1; v <= 1000; v++) {
+        latency_hist_record(&hist, v);
+    }
+    ASSERT_TRUE(hist.count == 1000);
+    ASSERT_TRUE(hist.max_us == 1000);
+
+    /* Bucket upper bounds are within 25% above the exact value */
+    uint64_t p50 = latency_hist_percentile(&hist, 50.0);
+    uint64_t p99 = latency_hist_percentile(&hist, 99.0);
+    ASSERT_TRUE(p50 >= 500 && p50 <= 625);
+    ASSERT_TRUE(p99 >= 990 && p99 <= 1000);
+    ASSERT_TRUE(latency_hist_percentile(&hist, 100.0) == 1000);
+
+    /* Small values are exact, huge values saturate */
+    latency_hist_reset(&hist);
+    latency_hist_record(&hist, 3);
+    ASSERT_TRUE(latency_hist_percentile(&hist, 50.0) == 3);
+    latency_hist_record(&hist, UINT64_MAX / 2);
+    ASSERT_TRUE(latency_hist_percentile(&hist, 100.0) == UINT64_MAX / 2);
+    return 0;
+}
+
+static int test_stage_tracking(void) {
+    input_latency_reset();
+
+    /* No input in flight: timer/ubus renders are not recorded */
+    input_latency_mark(INPUT_LATENCY_FLUSHED);
+    ASSERT_TRUE(input_latency_get(INPUT_LATENCY_FLUSHED)->count == 0);
+
+    display_hal->init();
+    ui_controller_t ui;
+    ui_controller_init(&ui);
+
+    /* Edge 2 ms in the past, through key handling, render and flush */
+    uint64_t now_ms = time_hal_now_ms();
+    input_latency_begin(time_hal_now_ns() - 2000000ULL);
+    ui_controller_handle_button(&ui, KEY_K3, false, now_ms);
+    input_latency_mark(INPUT_LATENCY_HANDLED);
+    input_latency_mark(INPUT_LATENCY_HANDLED);  /* Recorded once */
+    ASSERT_TRUE(ui_controller_render(&ui, now_ms));
+
+    for (int i = 0; i < INPUT_LATENCY_STAGES; i++) {
+        const latency_hist_t *h = input_latency_get((input_latency_stage_t)i);
+        ASSERT_TRUE(h->count == 1);
+        ASSERT_TRUE(h->max_us >= 2000);
+    }
+    ASSERT_TRUE(input_latency_get(INPUT_LATENCY_HANDLED)->max_us <=
+                input_latency_get(INPUT_LATENCY_FLUSHED)->max_us);
+
+    /* Flush completed the input: later frames are not attributed to it */
+    ui.needs_render = true;
+    ui_controller_render(&ui, now_ms);
+    ASSERT_TRUE(input_latency_get(INPUT_LATENCY_FLUSHED)->count == 1);
+
+    ASSERT_TRUE(input_latency_get(INPUT_LATENCY_STAGES) == NULL);
+    input_latency_dump(stdout);
+
+    ui_controller_cleanup(&ui);
+    display_hal->cleanup();
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("=== test_input_latency ===\n");
+
+    failures += test_hist_percentiles();
+    failures += test_stage_tracking();
+
+    printf("=== failures: %d ===\n", failures);
+    return failures ? 1 : 0;
+}
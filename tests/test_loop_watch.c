@@ -0,0 +1,128 @@
+/*
+ * Event-loop lag and stall watchdog test
+ *
+ * Runs on sim_loop with the virtual clock, so a "blocking" callback is
+ * one that advances the clock: lag and stall values are exact.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <libubox/uloop.h>
+
+#include "hal/time_hal.h"
+#include "loop_watch.h"
+#include "sim_loop.h"
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "ASSERT FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+LOOP_WATCH_SOURCE(g_watch_blocker, "blocker");
+LOOP_WATCH_SOURCE(g_watch_victim, "victim");
+LOOP_WATCH_SOURCE(g_watch_fd, "fd");
+
+static uint64_t g_block_ms;
+
+static void blocker_cb(struct uloop_timeout *t) {
+    loop_watch_timeout_begin(&g_watch_blocker, t);
+    time_hal_virtual_advance_ms(g_block_ms);    /* e.g. a stuck I2C write */
+    loop_watch_end(&g_watch_blocker);
+}
+
+static void victim_cb(struct uloop_timeout *t) {
+    loop_watch_timeout_begin(&g_watch_victim, t);
+    loop_watch_end(&g_watch_victim);
+}
+
+static int test_lag_behind_stall(void) {
+    struct uloop_timeout blocker = { .cb = blocker_cb };
+    struct uloop_timeout victim = { .cb = victim_cb };
+
+    loop_watch_reset();
+    g_block_ms = 80;
+    uint64_t start_ms = time_hal_now_ms();
+    uloop_timeout_set(&blocker, 100);
+    uloop_timeout_set(&victim, 120);
+    sim_loop_run_until(start_ms + 1000);
+
+    /* The victim was due 20 ms into the 80 ms block: 60 ms late */
+    const loop_watch_source_t *v = loop_watch_find("victim");
+    ASSERT_TRUE(v != NULL);
+    ASSERT_TRUE(v->lag_us.count == 1);
+    ASSERT_TRUE(v->lag_us.max_us == 60000);
+    ASSERT_TRUE(v->stalls == 0);
+
+    const loop_watch_source_t *b = loop_watch_find("blocker");
+    ASSERT_TRUE(b != NULL);
+    ASSERT_TRUE(b->lag_us.max_us == 0);
+    ASSERT_TRUE(b->run_us.max_us == 80000);
+    ASSERT_TRUE(b->stalls == 1);
+
+    loop_stall_t stalls[LOOP_STALL_LOG];
+    uint64_t total = 0;
+    ASSERT_TRUE(loop_watch_stalls(stalls, LOOP_STALL_LOG, &total) == 1);
+    ASSERT_TRUE(total == 1);
+    ASSERT_TRUE(strcmp(stalls[0].name, "blocker") == 0);
+    ASSERT_TRUE(stalls[0].run_us == 80000);
+    ASSERT_TRUE(stalls[0].at_ms == start_ms + 100);
+    return 0;
+}
+
+static int test_below_threshold(void) {
+    struct uloop_timeout blocker = { .cb = blocker_cb };
+
+    loop_watch_reset();
+    g_block_ms = LOOP_STALL_MS - 1;
+    uloop_timeout_set(&blocker, 10);
+    sim_loop_run_until(time_hal_now_ms() + 100);
+
+    ASSERT_TRUE(loop_watch_find("blocker")->run_us.count == 1);
+    ASSERT_TRUE(loop_watch_find("blocker")->stalls == 0);
+    uint64_t total = 1;
+    loop_stall_t stall;
+    ASSERT_TRUE(loop_watch_stalls(&stall, 1, &total) == 0);
+    ASSERT_TRUE(total == 0);
+    return 0;
+}
+
+static int test_stall_log_keeps_newest(void) {
+    loop_watch_reset();
+
+    /* fd-style callbacks stalling for 50, 51, ... ms */
+    int count = LOOP_STALL_LOG + 3;
+    for (int i = 0; i < count; i++) {
+        loop_watch_begin(&g_watch_fd);
+        time_hal_virtual_advance_ms(LOOP_STALL_MS + (uint64_t)i);
+        loop_watch_end(&g_watch_fd);
+    }
+
+    loop_stall_t stalls[LOOP_STALL_LOG];
+    uint64_t total = 0;
+    ASSERT_TRUE(loop_watch_stalls(stalls, LOOP_STALL_LOG, &total) == LOOP_STALL_LOG);
+    ASSERT_TRUE(total == (uint64_t)count);
+    ASSERT_TRUE(stalls[0].run_us == (uint64_t)(LOOP_STALL_MS + count - 1) * 1000ULL);
+    ASSERT_TRUE(stalls[LOOP_STALL_LOG - 1].run_us ==
+                (uint64_t)(LOOP_STALL_MS + count - LOOP_STALL_LOG) * 1000ULL);
+
+    const loop_watch_source_t *fd = loop_watch_find("fd");
+    ASSERT_TRUE(fd->stalls == (uint32_t)count);
+    ASSERT_TRUE(fd->lag_us.count == 0);     /* No deadline for fd callbacks */
+
+    loop_watch_dump(stdout);
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("=== test_loop_watch ===\n");
+
+    failures += test_lag_behind_stall();
+    failures += test_below_threshold();
+    failures += test_stall_log_keeps_newest();
+
+    printf("=== failures: %d ===\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,137 @@
+/*
+ * Runtime metrics registry tests (registration, snapshot, module counters)
+ */
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "hal/display_hal.h"
+#include "hal/time_hal.h"
+#include "metrics.h"
+#include "ui_controller.h"
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "ASSERT FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+static uint64_t g_level = 7;
+
+static uint64_t read_level(void) {
+    return g_level;
+}
+
+METRIC_COUNTER(g_m_test_events, "test_events");
+METRIC_GAUGE(g_m_test_depth, "test_depth");
+METRIC_GAUGE_FN(g_m_test_level, "test_level", read_level);
+
+static int test_registry(void) {
+    metrics_reset();
+
+    /* Hot values sit alone on their cache line */
+    ASSERT_TRUE(sizeof(metric_t) % METRICS_CACHELINE == 0);
+    ASSERT_TRUE(((uintptr_t)&g_m_test_events.value % METRICS_CACHELINE) == 0);
+    ASSERT_TRUE(((uintptr_t)&g_m_test_depth.value % METRICS_CACHELINE) == 0);
+
+    metric_inc(&g_m_test_events);
+    metric_add(&g_m_test_events, 41);
+    metric_set(&g_m_test_depth, 3);
+
+    uint64_t value = 0;
+    ASSERT_TRUE(metrics_get("test_events", &value) && value == 42);
+    ASSERT_TRUE(metrics_get("test_depth", &value) && value == 3);
+    ASSERT_TRUE(metrics_get("test_level", &value) && value == 7);
+    ASSERT_TRUE(!metrics_get("test_missing", &value));
+
+    /* Sampled gauges follow the owner's state, reset leaves them alone */
+    g_level = 9;
+    metrics_reset();
+    ASSERT_TRUE(metrics_get("test_level", &value) && value == 9);
+    ASSERT_TRUE(metrics_get("test_events", &value) && value == 0);
+    ASSERT_TRUE(metric_get(&g_m_test_depth) == 0);
+    return 0;
+}
+
+/* A duplicate name is a build mistake: loud, and fatal with asserts on */
+static int test_duplicate_fails(void) {
+    static metric_t dup = { .name = "test_events", .type = METRIC_TYPE_COUNTER };
+
+    fflush(NULL);
+    pid_t pid = fork();
+    ASSERT_TRUE(pid >= 0);
+    if (pid == 0) {
+        metrics_register(&dup);
+        _exit(0);
+    }
+
+    int wstatus = 0;
+    ASSERT_TRUE(waitpid(pid, &wstatus, 0) == pid);
+#ifdef NDEBUG
+    ASSERT_TRUE(WIFEXITED(wstatus) && WEXITSTATUS(wstatus) == 0);
+#else
+    ASSERT_TRUE(WIFSIGNALED(wstatus) && WTERMSIG(wstatus) == SIGABRT);
+#endif
+
+    /* The registry here is untouched */
+    uint64_t value = 0;
+    metric_set(&g_m_test_events, 5);
+    ASSERT_TRUE(metrics_get("test_events", &value) && value == 5);
+    return 0;
+}
+
+static int test_snapshot_sorted(void) {
+    metric_sample_t samples[METRICS_MAX];
+    int n = metrics_snapshot(samples, METRICS_MAX);
+    ASSERT_TRUE(n > 3);
+    for (int i = 1; i < n; i++) {
+        ASSERT_TRUE(strcmp(samples[i - 1].name, samples[i].name) < 0);
+    }
+
+    /* A short buffer is filled, not overrun */
+    ASSERT_TRUE(metrics_snapshot(samples, 2) == 2);
+    ASSERT_TRUE(metrics_snapshot(NULL, 2) == 0);
+    return 0;
+}
+
+static int test_module_counters(void) {
+    /* Registered from startup, before any use */
+    uint64_t rendered = 1;
+    ASSERT_TRUE(metrics_get("ui_frames_rendered", &rendered) && rendered == 0);
+    ASSERT_TRUE(metrics_get("ui_frames_flushed", NULL));
+
+    display_hal->init();
+    ui_controller_t ui;
+    ui_controller_init(&ui);
+    uint64_t now_ms = time_hal_now_ms();
+    ASSERT_TRUE(ui_controller_render(&ui, now_ms));
+    ui.needs_render = true;
+    ASSERT_TRUE(ui_controller_render(&ui, now_ms));
+
+    uint64_t flushed = 0;
+    ASSERT_TRUE(metrics_get("ui_frames_rendered", &rendered) && rendered == 2);
+    ASSERT_TRUE(metrics_get("ui_frames_flushed", &flushed) && flushed == 2);
+
+    ui_controller_cleanup(&ui);
+    display_hal->cleanup();
+
+    metrics_dump(stdout);
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("=== test_metrics ===\n");
+
+    failures += test_registry();
+    failures += test_duplicate_fails();
+    failures += test_snapshot_sorted();
+    failures += test_module_counters();
+
+    printf("=== failures: %d ===\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,259 @@
+/*
+ * Offload pool tests (completion via uloop, cancellation, deadlines,
+ * shutdown, sys_status IP lookup)
+ */
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <libubox/uloop.h>
+
+#include "offload.h"
+#include "sys_status.h"
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "ASSERT FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+#define JOBS 8
+
+typedef struct {
+    int input;
+    int output;
+    int status;
+    atomic_bool ran;
+    bool done;
+    int sleep_ms;
+} job_arg_t;
+
+static struct uloop_fd g_fd;
+static struct uloop_timeout g_guard;
+static int g_done_count;
+static int g_done_target;
+static atomic_bool g_gate_open;
+
+static void square_work(offload_job_t *job, void *arg) {
+    (void)job;
+    job_arg_t *a = arg;
+    a->ran = true;
+    if (a->sleep_ms > 0) usleep((useconds_t)a->sleep_ms * 1000);
+    a->output = a->input * a->input;
+}
+
+static void gate_work(offload_job_t *job, void *arg) {
+    (void)job;
+    job_arg_t *a = arg;
+    a->ran = true;
+    while (!atomic_load(&g_gate_open)) usleep(1000);
+}
+
+static void stop_aware_work(offload_job_t *job, void *arg) {
+    job_arg_t *a = arg;
+    a->ran = true;
+    for (int i = 0; i < 1000 && !offload_job_stopped(job); i++) usleep(1000);
+}
+
+static void job_done(int status, void *arg) {
+    job_arg_t *a = arg;
+    a->status = status;
+    a->done = true;
+    if (++g_done_count >= g_done_target) uloop_end();
+}
+
+static void fd_cb(struct uloop_fd *u, unsigned int events) {
+    (void)u;
+    (void)events;
+    offload_dispatch();
+}
+
+static void guard_cb(struct uloop_timeout *t) {
+    (void)t;
+    fprintf(stderr, "  guard timeout\n");
+    uloop_end();
+}
+
+/* Run uloop until target more done() calls or 2 s */
+static void run_until_done(int target) {
+    g_done_count = 0;
+    g_done_target = target;
+    g_guard.cb = guard_cb;
+    uloop_timeout_set(&g_guard, 2000);
+    uloop_run();
+    uloop_timeout_cancel(&g_guard);
+}
+
+static int start_pool(void) {
+    ASSERT_TRUE(offload_init(2) == 0);
+    ASSERT_TRUE(offload_running());
+    g_fd.fd = offload_get_fd();
+    g_fd.cb = fd_cb;
+    ASSERT_TRUE(uloop_fd_add(&g_fd, ULOOP_READ) == 0);
+    return 0;
+}
+
+static void stop_pool(void) {
+    uloop_fd_delete(&g_fd);
+    offload_cleanup();
+}
+
+static int test_not_running(void) {
+    job_arg_t a = { 0 };
+    ASSERT_TRUE(!offload_running());
+    ASSERT_TRUE(offload_get_fd() < 0);
+    ASSERT_TRUE(offload_submit(square_work, job_done, &a, 0) == NULL);
+    offload_dispatch();
+    offload_cleanup();
+    ASSERT_TRUE(!a.done);
+    return 0;
+}
+
+static int test_results(void) {
+    if (start_pool()) return 1;
+
+    job_arg_t args[JOBS];
+    memset(args, 0, sizeof(args));
+    for (int i = 0; i < JOBS; i++) {
+        args[i].input = i + 1;
+        args[i].sleep_ms = 5;
+        ASSERT_TRUE(offload_submit(square_work, job_done, &args[i], 0) != NULL);
+    }
+    run_until_done(JOBS);
+
+    for (int i = 0; i < JOBS; i++) {
+        ASSERT_TRUE(args[i].done && args[i].status == 0);
+        ASSERT_TRUE(args[i].output == (i + 1) * (i + 1));
+    }
+
+    stop_pool();
+    return 0;
+}
+
+static int test_cancel(void) {
+    if (start_pool()) return 1;
+
+    /* Both workers blocked: the third job stays queued */
+    job_arg_t gates[2] = { 0 };
+    job_arg_t queued = { .input = 3 };
+    atomic_store(&g_gate_open, false);
+    ASSERT_TRUE(offload_submit(gate_work, job_done, &gates[0], 0) != NULL);
+    ASSERT_TRUE(offload_submit(gate_work, job_done, &gates[1], 0) != NULL);
+    offload_job_t *job = offload_submit(square_work, job_done, &queued, 0);
+    ASSERT_TRUE(job != NULL);
+
+    offload_cancel(job);
+    atomic_store(&g_gate_open, true);
+    run_until_done(3);
+
+    ASSERT_TRUE(gates[0].status == 0 && gates[1].status == 0);
+    ASSERT_TRUE(queued.done && queued.status == -ECANCELED);
+    ASSERT_TRUE(!queued.ran);
+
+    /* A running job sees the cancel through offload_job_stopped() */
+    job_arg_t running = { 0 };
+    job = offload_submit(stop_aware_work, job_done, &running, 0);
+    ASSERT_TRUE(job != NULL);
+    while (!running.ran) usleep(1000);
+    offload_cancel(job);
+    run_until_done(1);
+    ASSERT_TRUE(running.done && running.status == -ECANCELED);
+
+    stop_pool();
+    return 0;
+}
+
+static int test_deadline(void) {
+    if (start_pool()) return 1;
+
+    /* Finishes after its deadline: reported late */
+    job_arg_t slow = { .input = 2, .sleep_ms = 60 };
+    ASSERT_TRUE(offload_submit(square_work, job_done, &slow, 20) != NULL);
+
+    /* Gives up at its deadline instead of running 1 s */
+    job_arg_t polling = { 0 };
+    ASSERT_TRUE(offload_submit(stop_aware_work, job_done, &polling, 30) != NULL);
+
+    /* Within its deadline */
+    job_arg_t fast = { .input = 4 };
+    ASSERT_TRUE(offload_submit(square_work, job_done, &fast, 1000) != NULL);
+
+    run_until_done(3);
+    ASSERT_TRUE(slow.ran && slow.status == -ETIMEDOUT);
+    ASSERT_TRUE(polling.done && polling.status == -ETIMEDOUT);
+    ASSERT_TRUE(fast.status == 0 && fast.output == 16);
+
+    stop_pool();
+    return 0;
+}
+
+static int test_cleanup_delivers(void) {
+    if (start_pool()) return 1;
+
+    job_arg_t args[3];
+    memset(args, 0, sizeof(args));
+    for (int i = 0; i < 3; i++) {
+        args[i].sleep_ms = 30;
+        ASSERT_TRUE(offload_submit(square_work, job_done, &args[i], 0) != NULL);
+    }
+
+    /* No loop iteration: cleanup itself calls every done() */
+    g_done_count = 0;
+    g_done_target = 100;
+    stop_pool();
+    ASSERT_TRUE(g_done_count == 3);
+    ASSERT_TRUE(args[0].done && args[1].done && args[2].done);
+    ASSERT_TRUE(args[2].status == -ECANCELED && !args[2].ran);
+    ASSERT_TRUE(!offload_running());
+    return 0;
+}
+
+static int test_sys_status_ip(void) {
+    /* Before the pool starts the lookup is inline */
+    sys_status_t status;
+    memset(&status, 0, sizeof(status));
+    sys_status_ctx_t *ctx = sys_status_init();
+    ASSERT_TRUE(ctx != NULL);
+    sys_status_update_local(ctx, &status);
+    ASSERT_TRUE(status.ip_addr[0] != '\0');
+
+    /* With the pool: the result arrives through the loop */
+    if (start_pool()) return 1;
+    status.ip_addr[0] = '\0';
+    sys_status_update_local(ctx, &status);
+    uint32_t seq = status.update_seq;
+    for (int i = 0; i < 2000 && status.ip_addr[0] == '\0'; i++) {
+        usleep(1000);
+        offload_dispatch();
+    }
+    printf("  ip: %s\n", status.ip_addr);
+    ASSERT_TRUE(status.ip_addr[0] != '\0');
+    ASSERT_TRUE(status.update_seq != seq);  /* Snapshots see the new address */
+
+    /* Cleanup with a lookup in flight: freed by the job's done() */
+    sys_status_update_local(ctx, &status);
+    sys_status_cleanup(ctx);
+    stop_pool();
+    sys_status_free_services(&status);
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("=== test_offload ===\n");
+
+    uloop_init();
+    failures += test_not_running();
+    failures += test_results();
+    failures += test_cancel();
+    failures += test_deadline();
+    failures += test_cleanup_delivers();
+    failures += test_sys_status_ip();
+    uloop_done();
+
+    printf("=== failures: %d ===\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,208 @@
+/*
+ * Prometheus endpoint tests (exposition text, Unix socket serving,
+ * client slot limit)
+ */
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <libubox/uloop.h>
+
+#include "metrics.h"
+#include "prom_server.h"
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "ASSERT FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+static char g_buf[PROM_BUF_SIZE];
+static char g_path[64];
+static sys_status_t g_status;
+static status_snapshot_t g_snapshot;
+static service_status_t g_services[2];
+
+static void fill_status(void) {
+    memset(&g_status, 0, sizeof(g_status));
+    memset(g_services, 0, sizeof(g_services));
+    g_status.cpu_usage = 12.5f;
+    g_status.mem_total_kb = 2;
+    g_status.uptime_sec = 42;
+    g_status.rx_bytes = 1000;
+    snprintf(g_status.hostname, sizeof(g_status.hostname), "Open\"Wrt");
+    snprintf(g_status.ip_addr, sizeof(g_status.ip_addr), "192.168.1.1");
+
+    snprintf(g_services[0].name, sizeof(g_services[0].name), "dropbear");
+    g_services[0].installed = true;
+    g_services[0].running = true;
+    snprintf(g_services[1].name, sizeof(g_services[1].name), "uhttpd");
+    g_services[1].usage_valid = true;
+    g_services[1].mem_bytes = 4096;
+    g_status.services = g_services;
+    g_status.service_count = 2;
+}
+
+static int test_render(void) {
+    size_t len = prom_render(g_buf, sizeof(g_buf), &g_status);
+    ASSERT_TRUE(len > 0 && len == strlen(g_buf));
+    ASSERT_TRUE(g_buf[len - 1] == '\n');
+
+    ASSERT_TRUE(strstr(g_buf, "# TYPE nanohat_cpu_usage_percent gauge\nnanohat_cpu_usage_percent 12.50\n"));
+    ASSERT_TRUE(strstr(g_buf, "nanohat_memory_total_bytes 2048\n"));
+    ASSERT_TRUE(strstr(g_buf, "nanohat_uptime_seconds 42\n"));
+    ASSERT_TRUE(strstr(g_buf, "# TYPE nanohat_network_receive_bytes_total counter\n"));
+    ASSERT_TRUE(strstr(g_buf, "nanohat_info{hostname=\"Open\\\"Wrt\",ip=\"192.168.1.1\",gateway=\"\"} 1\n"));
+    ASSERT_TRUE(strstr(g_buf, "nanohat_service_running{service=\"dropbear\"} 1\n"));
+    ASSERT_TRUE(strstr(g_buf, "nanohat_service_running{service=\"uhttpd\"} 0\n"));
+    ASSERT_TRUE(strstr(g_buf, "nanohat_service_memory_bytes{service=\"uhttpd\"} 4096\n"));
+    ASSERT_TRUE(!strstr(g_buf, "nanohat_service_memory_bytes{service=\"dropbear\"}"));
+
+    /* Registry counters get the _total suffix */
+    ASSERT_TRUE(strstr(g_buf, "# TYPE nanohat_prom_requests_total counter\n"));
+
+    /* A short buffer is cut after a complete line */
+    len = prom_render(g_buf, 100, &g_status);
+    ASSERT_TRUE(len > 0 && len < 100 && g_buf[len - 1] == '\n');
+    ASSERT_TRUE(strlen(g_buf) == len);
+    return 0;
+}
+
+/* Client thread: runs blocking sockets while main runs uloop */
+static atomic_bool g_client_done;
+static int g_client_failures;
+static struct uloop_timeout g_poll;
+
+static int connect_client(void) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", g_path);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    struct timeval tv = { .tv_sec = 2 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+static ssize_t read_all(int fd, char *buf, size_t size) {
+    size_t len = 0;
+    while (len + 1 < size) {
+        ssize_t n = read(fd, buf + len, size - 1 - len);
+        if (n == 0) break;
+        if (n < 0) return -1;
+        len += (size_t)n;
+    }
+    buf[len] = '\0';
+    return (ssize_t)len;
+}
+
+static int client_run(void) {
+    static char resp[PROM_BUF_SIZE + 256];
+    int fds[PROM_MAX_CLIENTS + 1];
+
+    for (int i = 0; i <= PROM_MAX_CLIENTS; i++) {
+        fds[i] = connect_client();
+        ASSERT_TRUE(fds[i] >= 0);
+        usleep(20000);  /* Let the loop accept in order */
+    }
+
+    /* No slot left for the last one: closed at once */
+    ASSERT_TRUE(read_all(fds[PROM_MAX_CLIENTS], resp, sizeof(resp)) == 0);
+    close(fds[PROM_MAX_CLIENTS]);
+
+    static const char request[] = "GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n";
+    for (int i = 0; i < PROM_MAX_CLIENTS; i++) {
+        ASSERT_TRUE(write(fds[i], request, sizeof(request) - 1) == (ssize_t)sizeof(request) - 1);
+    }
+    for (int i = 0; i < PROM_MAX_CLIENTS; i++) {
+        ssize_t len = read_all(fds[i], resp, sizeof(resp));
+        close(fds[i]);
+        ASSERT_TRUE(len > 0);
+        ASSERT_TRUE(strncmp(resp, "HTTP/1.0 200 OK\r\n", 17) == 0);
+        ASSERT_TRUE(strstr(resp, "Content-Type: text/plain; version=0.0.4\r\n"));
+
+        const char *body = strstr(resp, "\r\n\r\n");
+        size_t content_length = 0;
+        ASSERT_TRUE(body && sscanf(strstr(resp, "Content-Length:"), "Content-Length: %zu", &content_length) == 1);
+        body += 4;
+        ASSERT_TRUE(strlen(body) == content_length);
+        ASSERT_TRUE(strstr(body, "nanohat_uptime_seconds 42\n"));
+    }
+    return 0;
+}
+
+static void *client_main(void *arg) {
+    (void)arg;
+    g_client_failures = client_run();
+    atomic_store(&g_client_done, true);
+    return NULL;
+}
+
+static void poll_cb(struct uloop_timeout *t) {
+    if (atomic_load(&g_client_done)) {
+        uloop_end();
+        return;
+    }
+    uloop_timeout_set(t, 10);
+}
+
+static int test_serve_unix(void) {
+    snprintf(g_path, sizeof(g_path), "/tmp/nanohat-prom-test-%d.sock", (int)getpid());
+    status_snapshot_init(&g_snapshot);
+    ASSERT_TRUE(status_snapshot_publish(&g_snapshot, &g_status) == 0);
+    ASSERT_TRUE(prom_server_start("", &g_snapshot) < 0);
+    ASSERT_TRUE(prom_server_start("192.168.1.1:9101", &g_snapshot) < 0);  /* Not loopback */
+    ASSERT_TRUE(prom_server_start("127.0.0.1:nope", &g_snapshot) < 0);
+    ASSERT_TRUE(prom_server_start(g_path, &g_snapshot) == 0);
+
+    /* Scrapes serve the published snapshot, not the working copy */
+    g_status.uptime_sec = 43;
+    ASSERT_TRUE(access(g_path, F_OK) == 0);
+
+    uint64_t requests = 0, rejected = 0;
+    metrics_get("prom_requests", &requests);
+    metrics_get("prom_rejected", &rejected);
+
+    pthread_t client;
+    atomic_store(&g_client_done, false);
+    ASSERT_TRUE(pthread_create(&client, NULL, client_main, NULL) == 0);
+    g_poll.cb = poll_cb;
+    uloop_timeout_set(&g_poll, 10);
+    uloop_run();
+    pthread_join(client, NULL);
+    ASSERT_TRUE(g_client_failures == 0);
+
+    uint64_t value = 0;
+    ASSERT_TRUE(metrics_get("prom_requests", &value) && value == requests + PROM_MAX_CLIENTS);
+    ASSERT_TRUE(metrics_get("prom_rejected", &value) && value == rejected + 1);
+
+    prom_server_stop();
+    ASSERT_TRUE(access(g_path, F_OK) != 0);
+    g_status.uptime_sec = 42;
+    status_snapshot_free(&g_snapshot);
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("=== test_prom_server ===\n");
+    uloop_init();
+    fill_status();
+
+    failures += test_render();
+    failures += test_serve_unix();
+
+    uloop_done();
+    printf("=== failures: %d ===\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,261 @@
+/*
+ * Batch service control tests (concurrency limit, per-service order, progress)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libubox/uloop.h>
+
+#include "hal/ubus_hal.h"
+#include "service_batch.h"
+#include "sys_status.h"
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "ASSERT FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+/* Test injection API from mock */
+extern void ubus_mock_set_response(const char *service, int status,
+                                    bool installed, bool running, int delay_ms);
+extern void ubus_mock_clear_responses(void);
+extern int ubus_mock_get_pending_count(void);
+
+typedef struct {
+    int calls;
+    int max_running;
+    int max_pending;
+    service_batch_progress_t last;
+} progress_log_t;
+
+static struct uloop_timeout g_guard;
+
+static void progress_cb(const service_batch_progress_t *progress, void *priv) {
+    progress_log_t *log = (progress_log_t *)priv;
+    log->calls++;
+    log->last = *progress;
+    if (progress->running > log->max_running) log->max_running = progress->running;
+    int pending = ubus_mock_get_pending_count();
+    if (pending > log->max_pending) log->max_pending = pending;
+
+    if (progress->done == progress->total) {
+        uloop_end();
+    }
+}
+
+static void guard_cb(struct uloop_timeout *t) {
+    (void)t;
+    uloop_end();
+}
+
+static void run_loop(int guard_ms) {
+    g_guard.cb = guard_cb;
+    uloop_timeout_set(&g_guard, guard_ms);
+    uloop_run();
+    uloop_timeout_cancel(&g_guard);
+}
+
+static void add_service(sys_status_t *status, const char *name) {
+    size_t n = status->service_count;
+    status->services = realloc(status->services, (n + 1) * sizeof(*status->services));
+    memset(&status->services[n], 0, sizeof(status->services[n]));
+    snprintf(status->services[n].name, sizeof(status->services[n].name), "%s", name);
+    status->service_count = n + 1;
+}
+
+static int test_parallel_limit(sys_status_t *status) {
+    ubus_mock_clear_responses();
+    char name[SERVICE_NAME_MAX_LEN];
+    for (int i = 0; i < 10; i++) {
+        snprintf(name, sizeof(name), "svc%d", i);
+        /* Varying delays so completions interleave */
+        ubus_mock_set_response(name, UBUS_HAL_STATUS_OK, true, false, 20 + (i % 3) * 15);
+    }
+    ubus_mock_set_response("svc7", UBUS_HAL_STATUS_NOT_FOUND, false, false, 10);
+
+    progress_log_t log;
+    memset(&log, 0, sizeof(log));
+    service_batch_t *batch = service_batch_create(NULL, status, 3, progress_cb, &log);
+    ASSERT_TRUE(batch != NULL);
+    ASSERT_TRUE(service_batch_add_all(batch, UBUS_HAL_ACTION_RESTART) == 10);
+    ASSERT_TRUE(service_batch_get_progress(batch)->running == 0);  /* Not started yet */
+
+    ASSERT_TRUE(service_batch_start(batch) == 0);
+    ASSERT_TRUE(service_batch_get_progress(batch)->running == 3);
+    run_loop(2000);
+
+    ASSERT_TRUE(service_batch_is_done(batch));
+    ASSERT_TRUE(log.last.total == 10);
+    ASSERT_TRUE(log.last.done == 10);
+    ASSERT_TRUE(log.last.failed == 1);
+    ASSERT_TRUE(log.max_running == 3);
+    ASSERT_TRUE(log.max_pending <= 3);
+    ASSERT_TRUE(log.calls == 11);  /* Start + one per completion */
+
+    /* Restart is optimistic "running" on success */
+    ASSERT_TRUE(status->services[0].running);
+    ASSERT_TRUE(!status->services[7].running);
+
+    service_batch_free(batch);
+    return 0;
+}
+
+static int test_per_service_order(sys_status_t *status) {
+    ubus_mock_clear_responses();
+    /* Slow stop, fast start: start must still complete last */
+    ubus_mock_set_response("svc0", UBUS_HAL_STATUS_OK, true, true, 60);
+    ubus_mock_set_response("svc1", UBUS_HAL_STATUS_OK, true, true, 10);
+
+    progress_log_t log;
+    memset(&log, 0, sizeof(log));
+    service_batch_t *batch = service_batch_create(NULL, status, 4, progress_cb, &log);
+    ASSERT_TRUE(service_batch_add(batch, "svc0", UBUS_HAL_ACTION_STOP) == 0);
+    ASSERT_TRUE(service_batch_add(batch, "svc0", UBUS_HAL_ACTION_START) == 1);
+    ASSERT_TRUE(service_batch_add(batch, "svc1", UBUS_HAL_ACTION_STOP) == 2);
+    ASSERT_TRUE(service_batch_add(batch, "missing", UBUS_HAL_ACTION_STOP) == 3);
+
+    ASSERT_TRUE(service_batch_start(batch) == 0);
+    /* svc0 start waits for svc0 stop; unknown service fails immediately */
+    ASSERT_TRUE(service_batch_get_progress(batch)->running == 2);
+    ASSERT_TRUE(service_batch_get_progress(batch)->failed == 1);
+    run_loop(2000);
+
+    ASSERT_TRUE(log.last.done == 4);
+    ASSERT_TRUE(log.last.failed == 1);
+    ASSERT_TRUE(status->services[0].running);   /* Start ran after stop */
+    ASSERT_TRUE(!status->services[1].running);
+
+    service_batch_free(batch);
+    return 0;
+}
+
+static int test_free_in_flight(sys_status_t *status) {
+    ubus_mock_clear_responses();
+
+    progress_log_t log;
+    memset(&log, 0, sizeof(log));
+    service_batch_t *batch = service_batch_create(NULL, status, 2, progress_cb, &log);
+    service_batch_add_all(batch, UBUS_HAL_ACTION_START);
+    service_batch_start(batch);
+    int calls = log.calls;
+
+    /* Queued jobs are dropped; completions of in-flight jobs are harmless */
+    service_batch_free(batch);
+    ASSERT_TRUE(ubus_mock_get_pending_count() == 2);
+    run_loop(200);
+    ASSERT_TRUE(ubus_mock_get_pending_count() == 0);
+    ASSERT_TRUE(log.calls == calls + 1);  /* Only the cancel notification */
+    return 0;
+}
+
+static int g_blocker_calls;
+
+static void blocker_cb(const char *service, bool success, int status, void *priv) {
+    (void)service;
+    (void)success;
+    (void)status;
+    (void)priv;
+    g_blocker_calls++;
+}
+
+static void query_cb(const char *service, bool installed, bool running,
+                     int status, void *priv) {
+    (void)service;
+    (void)installed;
+    (void)running;
+    (void)status;
+    (void)priv;
+}
+
+static int test_busy_requeue(sys_status_t *status) {
+    ubus_mock_clear_responses();
+    ubus_mock_set_response("blocker", UBUS_HAL_STATUS_OK, true, true, 50);
+
+    /* Someone else holds every control slot */
+    g_blocker_calls = 0;
+    for (int i = 0; i < UBUS_HAL_MAX_CONTROLS; i++) {
+        ASSERT_TRUE(ubus_hal->control_service_async("blocker", UBUS_HAL_ACTION_RESTART,
+                                                    blocker_cb, NULL) == 0);
+    }
+    ASSERT_TRUE(ubus_hal->control_service_async("blocker", UBUS_HAL_ACTION_RESTART,
+                                                blocker_cb, NULL) == UBUS_HAL_BUSY);
+    /* Queries have slots of their own */
+    ASSERT_TRUE(ubus_hal->query_service_async("blocker", query_cb, NULL) == 0);
+
+    progress_log_t log;
+    memset(&log, 0, sizeof(log));
+    service_batch_t *batch = service_batch_create(NULL, status, 4, progress_cb, &log);
+    service_batch_add_all(batch, UBUS_HAL_ACTION_RESTART);
+    ASSERT_TRUE(service_batch_start(batch) == 0);
+
+    /* No slot is not a failure: the jobs wait */
+    ASSERT_TRUE(log.last.running == 0);
+    ASSERT_TRUE(log.last.done == 0);
+    run_loop(2000);
+
+    ASSERT_TRUE(g_blocker_calls == UBUS_HAL_MAX_CONTROLS);
+    ASSERT_TRUE(service_batch_is_done(batch));
+    ASSERT_TRUE(log.last.done == 10);
+    ASSERT_TRUE(log.last.failed == 0);
+
+    service_batch_free(batch);
+    return 0;
+}
+
+/* Last: shuts the HAL down */
+static int test_cleanup_fails_in_flight(sys_status_t *status) {
+    ubus_mock_clear_responses();
+    for (int i = 0; i < 10; i++) {
+        char name[SERVICE_NAME_MAX_LEN];
+        snprintf(name, sizeof(name), "svc%d", i);
+        ubus_mock_set_response(name, UBUS_HAL_STATUS_OK, true, true, 1000);
+    }
+
+    progress_log_t log;
+    memset(&log, 0, sizeof(log));
+    service_batch_t *batch = service_batch_create(NULL, status, 3, progress_cb, &log);
+    service_batch_add_all(batch, UBUS_HAL_ACTION_RESTART);
+    service_batch_start(batch);
+    ASSERT_TRUE(log.last.running == 3);
+
+    /* Shutdown fails what is in flight; the rest cannot be sent any more */
+    ubus_hal->cleanup();
+    ASSERT_TRUE(service_batch_is_done(batch));
+    ASSERT_TRUE(log.last.running == 0);
+    ASSERT_TRUE(log.last.failed == 10);
+
+    service_batch_free(batch);
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("=== test_service_batch ===\n");
+
+    uloop_init();
+    ubus_hal->init();
+
+    sys_status_t status;
+    memset(&status, 0, sizeof(status));
+    char name[SERVICE_NAME_MAX_LEN];
+    for (int i = 0; i < 10; i++) {
+        snprintf(name, sizeof(name), "svc%d", i);
+        add_service(&status, name);
+    }
+
+    failures += test_parallel_limit(&status);
+    failures += test_per_service_order(&status);
+    failures += test_free_in_flight(&status);
+    failures += test_busy_requeue(&status);
+    failures += test_cleanup_fails_in_flight(&status);
+
+    ubus_hal->cleanup();
+    uloop_done();
+    free(status.services);
+
+    printf("=== failures: %d ===\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+/*
+ * Per-service cgroup usage collector tests (fake cgroup tree in /tmp)
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "service_cgroup.h"
+#include "sys_status.h"
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "ASSERT FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+static char g_root[] = "/tmp/nanohat-cg-XXXXXX";
+
+static void write_group(const char *name, unsigned long usage_usec, unsigned long mem) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", g_root, name);
+    mkdir(path, 0755);
+
+    /* Rewrite in place: the collector keeps its descriptors open */
+    snprintf(path, sizeof(path), "%s/%s/cpu.stat", g_root, name);
+    FILE *fp = fopen(path, "r+");
+    if (!fp) fp = fopen(path, "w");
+    if (fp) {
+        fprintf(fp, "usage_usec %010lu\nuser_usec 0\nsystem_usec 0\n", usage_usec);
+        fclose(fp);
+    }
+
+    snprintf(path, sizeof(path), "%s/%s/memory.current", g_root, name);
+    fp = fopen(path, "r+");
+    if (!fp) fp = fopen(path, "w");
+    if (fp) {
+        fprintf(fp, "%010lu\n", mem);
+        fclose(fp);
+    }
+}
+
+static void add_service(sys_status_t *status, const char *name) {
+    size_t n = status->service_count;
+    status->services = realloc(status->services, (n + 1) * sizeof(*status->services));
+    memset(&status->services[n], 0, sizeof(status->services[n]));
+    snprintf(status->services[n].name, sizeof(status->services[n].name), "%s", name);
+    status->service_count = n + 1;
+}
+
+static int test_sample_usage(void) {
+    sys_status_t status;
+    memset(&status, 0, sizeof(status));
+    add_service(&status, "dropbear");
+    add_service(&status, "missing");
+    status.service_generation = 1;
+
+    write_group("dropbear", 1000000, 4 * 1024 * 1024);
+
+    service_cgroup_t *cg = service_cgroup_init(g_root);
+    ASSERT_TRUE(cg != NULL);
+
+    /* First pass: memory known, no CPU delta yet */
+    ASSERT_TRUE(service_cgroup_sample(cg, &status, 10000) == 1);
+    ASSERT_TRUE(status.usage_seq == 1);
+    ASSERT_TRUE(status.services[0].usage_valid);
+    ASSERT_TRUE(status.services[0].mem_bytes == 4 * 1024 * 1024);
+    ASSERT_TRUE(status.services[0].cpu_percent == 0.0f);
+    ASSERT_TRUE(!status.services[1].usage_valid);
+
+    /* Rate-limited between passes */
+    ASSERT_TRUE(service_cgroup_sample(cg, &status, 10000 + SERVICE_USAGE_INTERVAL_MS - 1) == -1);
+    ASSERT_TRUE(status.usage_seq == 1);
+
+    /* 0.5 s of CPU over 2 s on all CPUs */
+    write_group("dropbear", 1500000, 8 * 1024 * 1024);
+    ASSERT_TRUE(service_cgroup_sample(cg, &status, 10000 + SERVICE_USAGE_INTERVAL_MS) == 1);
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu < 1) ncpu = 1;
+    float expected = 25.0f / (float)ncpu;
+    ASSERT_TRUE(fabsf(status.services[0].cpu_percent - expected) < 0.01f);
+    ASSERT_TRUE(status.services[0].mem_bytes == 8 * 1024 * 1024);
+
+    /* Missing group is retried only after SERVICE_CGROUP_RETRY_MS */
+    write_group("missing", 0, 1024);
+    ASSERT_TRUE(service_cgroup_sample(cg, &status, 10000 + 2 * SERVICE_USAGE_INTERVAL_MS) == 1);
+    ASSERT_TRUE(!status.services[1].usage_valid);
+    ASSERT_TRUE(service_cgroup_sample(cg, &status, 10000 + SERVICE_CGROUP_RETRY_MS) == 2);
+    ASSERT_TRUE(status.services[1].usage_valid);
+    ASSERT_TRUE(status.services[1].mem_bytes == 1024);
+
+    service_cgroup_cleanup(cg);
+    free(status.services);
+    return 0;
+}
+
+static int test_no_cgroup_root(void) {
+    sys_status_t status;
+    memset(&status, 0, sizeof(status));
+    add_service(&status, "dropbear");
+
+    service_cgroup_t *cg = service_cgroup_init("/nonexistent/cgroup");
+    ASSERT_TRUE(cg != NULL);
+    ASSERT_TRUE(service_cgroup_sample(cg, &status, 1000) == 0);
+    ASSERT_TRUE(!status.services[0].usage_valid);
+
+    service_cgroup_cleanup(cg);
+    free(status.services);
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("=== test_service_cgroup ===\n");
+
+    if (!mkdtemp(g_root)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    failures += test_sample_usage();
+    failures += test_no_cgroup_root();
+
+    char cmd[300];
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", g_root);
+    (void)!system(cmd);
+
+    printf("=== failures: %d ===\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,205 @@
+/*
+ * Service configuration tests (runtime UCI config, hash index, reload)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "service_config.h"
+#include "sys_status.h"
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "ASSERT FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+static char g_tmpdir[] = "/tmp/nanohat-svc-XXXXXX";
+static char g_config_path[256];
+static char g_initd_path[256];
+
+static void write_file(const char *path, const char *content, mode_t mode) {
+    FILE *fp = fopen(path, "w");
+    if (!fp) return;
+    fputs(content, fp);
+    fclose(fp);
+    chmod(path, mode);
+}
+
+static void write_initd(const char *name, mode_t mode) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", g_initd_path, name);
+    write_file(path, "#!/bin/sh /etc/rc.common\n", mode);
+}
+
+static int test_fallback_to_macro(void) {
+    service_config_t cfg;
+    int ret = service_config_load(&cfg, "/nonexistent/nanohat-oled");
+
+    ASSERT_TRUE(ret == -1);
+    ASSERT_TRUE(cfg.count == 5);
+    ASSERT_TRUE(strcmp(cfg.services[0].name, "xray_core") == 0);
+    ASSERT_TRUE(service_config_find(&cfg, "uhttpd") == 4);
+    ASSERT_TRUE(service_config_find(&cfg, "missing") == -1);
+
+    service_config_free(&cfg);
+    return 0;
+}
+
+static int test_parse_uci(void) {
+    write_file(g_config_path,
+               "# comment\n"
+               "config other 'x'\n"
+               "\tlist service 'ignored'\n"
+               "\n"
+               "config services 'services'\n"
+               "\toption monitor_all '0'\n"
+               "\tlist service 'dropbear'\n"
+               "\tlist service \"uhttpd\"   # trailing comment\n"
+               "\tlist service dnsmasq\n"
+               "\tlist service 'dropbear'\n"
+               "\tlist service 'bad name'\n",
+               0644);
+
+    service_config_t cfg;
+    ASSERT_TRUE(service_config_load(&cfg, g_config_path) == 0);
+    ASSERT_TRUE(!cfg.monitor_all);
+    ASSERT_TRUE(cfg.count == 3);
+    ASSERT_TRUE(strcmp(cfg.services[0].name, "dropbear") == 0);
+    ASSERT_TRUE(strcmp(cfg.services[1].name, "uhttpd") == 0);
+    ASSERT_TRUE(strcmp(cfg.services[2].name, "dnsmasq") == 0);
+    ASSERT_TRUE(service_config_find(&cfg, "ignored") == -1);
+
+    service_config_free(&cfg);
+    return 0;
+}
+
+static int test_monitor_all(void) {
+    write_initd("uhttpd", 0755);
+    write_initd("boot", 0755);
+    write_initd("dnsmasq", 0755);
+    write_initd("README", 0644);  /* Not executable */
+    write_initd("dropbear", 0755);
+
+    write_file(g_config_path,
+               "config services 'services'\n"
+               "\toption monitor_all '1'\n"
+               "\tlist service 'xray_core'\n"
+               "\tlist exclude 'boot'\n",
+               0644);
+
+    service_config_t cfg;
+    ASSERT_TRUE(service_config_load(&cfg, g_config_path) == 0);
+    ASSERT_TRUE(cfg.monitor_all);
+
+    /* Explicit entries first, then sorted init scripts */
+    ASSERT_TRUE(cfg.count == 4);
+    ASSERT_TRUE(strcmp(cfg.services[0].name, "xray_core") == 0);
+    ASSERT_TRUE(strcmp(cfg.services[1].name, "dnsmasq") == 0);
+    ASSERT_TRUE(strcmp(cfg.services[2].name, "dropbear") == 0);
+    ASSERT_TRUE(strcmp(cfg.services[3].name, "uhttpd") == 0);
+    ASSERT_TRUE(service_config_find(&cfg, "boot") == -1);
+    ASSERT_TRUE(service_config_find(&cfg, "README") == -1);
+
+    service_config_free(&cfg);
+    return 0;
+}
+
+static int test_large_table(void) {
+    service_config_t cfg;
+    memset(&cfg, 0, sizeof(cfg));
+
+    char name[SERVICE_NAME_MAX_LEN];
+    for (int i = 0; i < 300; i++) {
+        snprintf(name, sizeof(name), "svc%03d", i);
+        ASSERT_TRUE(service_config_add(&cfg, name) == i);
+    }
+    ASSERT_TRUE(cfg.count == 300);
+    ASSERT_TRUE(cfg.index_size >= 600);
+
+    for (int i = 0; i < 300; i++) {
+        snprintf(name, sizeof(name), "svc%03d", i);
+        ASSERT_TRUE(service_config_find(&cfg, name) == i);
+    }
+    ASSERT_TRUE(service_config_add(&cfg, "svc042") == -1);
+
+    service_config_free(&cfg);
+    return 0;
+}
+
+static int test_reload_keeps_state(void) {
+    write_file(g_config_path,
+               "config services 'services'\n"
+               "\tlist service 'dropbear'\n"
+               "\tlist service 'uhttpd'\n",
+               0644);
+    service_config_init(NULL);
+    uint32_t generation = service_config_get()->generation;
+
+    sys_status_t status;
+    memset(&status, 0, sizeof(status));
+    ASSERT_TRUE(sys_status_sync_services(&status));
+    ASSERT_TRUE(status.service_count == 2);
+    ASSERT_TRUE(!sys_status_sync_services(&status));  /* Already synced */
+
+    int idx = sys_status_find_service(&status, "uhttpd");
+    ASSERT_TRUE(idx == 1);
+    status.services[idx].running = true;
+    status.services[idx].status_valid = true;
+    status.services[idx].request_id = 42;
+
+    /* Reorder, add one, drop one */
+    write_file(g_config_path,
+               "config services 'services'\n"
+               "\tlist service 'dnsmasq'\n"
+               "\tlist service 'uhttpd'\n"
+               "\tlist service 'xray_core'\n",
+               0644);
+    ASSERT_TRUE(service_config_reload() == 0);
+    ASSERT_TRUE(service_config_get()->generation == generation + 1);
+    ASSERT_TRUE(sys_status_sync_services(&status));
+
+    ASSERT_TRUE(status.service_count == 3);
+    ASSERT_TRUE(sys_status_find_service(&status, "dropbear") == -1);
+    idx = sys_status_find_service(&status, "uhttpd");
+    ASSERT_TRUE(idx == 1);
+    ASSERT_TRUE(status.services[idx].running);
+    ASSERT_TRUE(status.services[idx].status_valid);
+    ASSERT_TRUE(status.services[idx].request_id == 42);
+    ASSERT_TRUE(!status.services[0].status_valid);
+
+    sys_status_free_services(&status);
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("=== test_service_config ===\n");
+
+    if (!mkdtemp(g_tmpdir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    snprintf(g_config_path, sizeof(g_config_path), "%s/nanohat-oled", g_tmpdir);
+    snprintf(g_initd_path, sizeof(g_initd_path), "%s/init.d", g_tmpdir);
+    mkdir(g_initd_path, 0755);
+    service_config_set_path(g_config_path);
+    service_config_set_initd_path(g_initd_path);
+
+    failures += test_fallback_to_macro();
+    failures += test_parse_uci();
+    failures += test_monitor_all();
+    failures += test_large_table();
+    failures += test_reload_keeps_state();
+
+    char cmd[300];
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", g_tmpdir);
+    (void)!system(cmd);
+
+    printf("=== failures: %d ===\n", failures);
+    return failures ? 1 : 0;
+}
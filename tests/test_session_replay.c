@@ -0,0 +1,204 @@
+/*
+ * Session record/replay round trip
+ *
+ * Records a scripted session through the production wiring (app_loop,
+ * sys_status, mock HALs) in virtual time, replays the log and checks that
+ * the replay reproduces the same frames, flushes and ubus traffic.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <libubox/uloop.h>
+
+#include "app_loop.h"
+#include "hal/display_hal.h"
+#include "hal/gpio_hal.h"
+#include "hal/time_hal.h"
+#include "hal/ubus_hal.h"
+#include "service_config.h"
+#include "session_log.h"
+#include "session_replay.h"
+#include "sim_loop.h"
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "ASSERT FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+/* Test API from the mocks */
+extern void gpio_mock_inject_edge(int line, int falling, uint64_t timestamp_ns);
+extern uint64_t gpio_mock_next_deadline_ms(void);
+extern unsigned long display_null_get_flush_count(void);
+extern unsigned long ubus_mock_get_request_count(void);
+
+typedef struct {
+    uint32_t at_ms;         /* From session start */
+    uint8_t line;
+    bool pressed;
+} script_edge_t;
+
+/* K3 x2 to Services, K2 long to enter, K3 x2 in the list, K2 long out */
+static const script_edge_t g_script[] = {
+    { 1000, 2, true  }, { 1080, 2, false },
+    { 1600, 2, true  }, { 1700, 2, false },
+    { 3000, 1, true  }, { 3900, 1, false },
+    { 4500, 2, true  }, { 4560, 2, false },
+    { 5000, 2, true  }, { 5090, 2, false },
+    { 7000, 1, true  }, { 7800, 1, false },
+};
+#define SCRIPT_EDGES ((int)(sizeof(g_script) / sizeof(g_script[0])))
+
+/* Long enough for auto-sleep after the last input: nothing runs after */
+#define SESSION_MS 60000
+
+static struct uloop_timeout g_script_timer;
+static struct uloop_timeout g_gpio_timer;
+static uint64_t g_start_ms;
+static int g_script_pos;
+static unsigned long g_renders;
+
+static void count_frame(uint64_t render_ns) {
+    (void)render_ns;
+    g_renders++;
+}
+
+static void gpio_timer_cb(struct uloop_timeout *t) {
+    (void)t;
+    app_loop_gpio_readable();
+    uint64_t deadline = gpio_mock_next_deadline_ms();
+    if (deadline != 0) {
+        uint64_t now_ms = time_hal_now_ms();
+        uloop_timeout_set(&g_gpio_timer, deadline > now_ms ? (int)(deadline - now_ms) : 0);
+    }
+}
+
+static void script_cb(struct uloop_timeout *t) {
+    const script_edge_t *edge = &g_script[g_script_pos++];
+    uint64_t now_ns = time_hal_now_ns();
+
+    session_log_gpio_edge(edge->line, edge->pressed, now_ns);
+    gpio_mock_inject_edge(edge->line, edge->pressed ? 1 : 0, now_ns);
+    gpio_timer_cb(&g_gpio_timer);
+
+    if (g_script_pos < SCRIPT_EDGES) {
+        uint64_t next_ms = g_start_ms + g_script[g_script_pos].at_ms;
+        uloop_timeout_set(t, (int)(next_ms - time_hal_now_ms()));
+    }
+}
+
+/* Returns 0 and fills the counters on success */
+static int record_session(const char *path, unsigned long *renders, unsigned long *flushes,
+                          unsigned long *requests) {
+    if (session_log_open(path) < 0) return -1;
+
+    display_hal->init();
+    gpio_hal->init();
+    ubus_hal->init();
+    app_loop_set_frame_observer(count_frame);
+    g_renders = 0;
+    g_script_pos = 0;
+    g_gpio_timer.cb = gpio_timer_cb;
+    g_script_timer.cb = script_cb;
+
+    unsigned long flushes_before = display_null_get_flush_count();
+    unsigned long requests_before = ubus_mock_get_request_count();
+
+    app_loop_init();
+    g_start_ms = time_hal_now_ms();
+    app_loop_start();
+    uloop_timeout_set(&g_script_timer, (int)g_script[0].at_ms);
+    sim_loop_run_until(g_start_ms + SESSION_MS);
+
+    *renders = g_renders;
+    *flushes = display_null_get_flush_count() - flushes_before;
+    *requests = ubus_mock_get_request_count() - requests_before;
+
+    app_loop_cleanup();
+    sim_loop_reset();
+    app_loop_set_frame_observer(NULL);
+    ubus_hal->cleanup();
+    gpio_hal->cleanup();
+    display_hal->cleanup();
+    session_log_close();
+    return 0;
+}
+
+static int test_round_trip(const char *path) {
+    unsigned long renders, flushes, requests;
+    ASSERT_TRUE(record_session(path, &renders, &flushes, &requests) == 0);
+    printf("recorded: renders=%lu flushes=%lu ubus=%lu\n", renders, flushes, requests);
+    ASSERT_TRUE(renders > 0);
+    ASSERT_TRUE(requests > 0);
+
+    session_replay_report_t report;
+    ASSERT_TRUE(session_replay_run(path, &report) == 0);
+    session_replay_print(&report, stdout);
+
+    ASSERT_TRUE(report.edges == SCRIPT_EDGES);
+    ASSERT_TRUE(report.ubus > 0);
+    ASSERT_TRUE(report.proc > 0);
+    ASSERT_TRUE(report.timers > 0);
+    ASSERT_TRUE(report.ubus_unmatched == 0);
+    ASSERT_TRUE(report.device_timer_late_us.max_us == 0);  /* Virtual time is never late */
+
+    /* Same input, same timing: same work */
+    ASSERT_TRUE(report.renders == renders);
+    ASSERT_TRUE(report.flushes == flushes);
+    ASSERT_TRUE(report.requests == requests);
+    ASSERT_TRUE(report.frame_us.count == renders);
+    return 0;
+}
+
+static int test_truncated_log(const char *path) {
+    /* A log cut mid-record (device lost power) still replays */
+    FILE *fp = fopen(path, "r+b");
+    ASSERT_TRUE(fp != NULL);
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fclose(fp);
+    ASSERT_TRUE(truncate(path, size - 3) == 0);
+
+    session_replay_report_t report;
+    ASSERT_TRUE(session_replay_run(path, &report) == 0);
+    ASSERT_TRUE(report.records > 0);
+    ASSERT_TRUE(report.renders > 0);
+    return 0;
+}
+
+static int test_not_a_log(void) {
+    session_replay_report_t report;
+    ASSERT_TRUE(session_replay_run("/nonexistent/session.log", &report) < 0);
+    ASSERT_TRUE(session_replay_run("/proc/self/status", &report) < 0);
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("=== test_session_replay ===\n");
+
+    char path[] = "/tmp/nanohat-session-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+
+    service_config_set_path("/nonexistent/nanohat-oled");
+    service_config_reload();
+    page_controller_set_auto_screen_off(true);
+
+    failures += test_round_trip(path);
+    failures += test_truncated_log(path);
+    failures += test_not_a_log();
+
+    unlink(path);
+    service_config_set_path(NULL);
+
+    printf("=== failures: %d ===\n", failures);
+    return failures ? 1 : 0;
+}
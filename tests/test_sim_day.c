@@ -0,0 +1,247 @@
+/*
+ * Accelerated simulation of a day of UI use in virtual time
+ *
+ * Runs the same tick/render/input wiring as main.c, but on sim_loop and
+ * time_hal_virtual: scripted sessions every 15 minutes, auto-sleep in
+ * between. Prints renders, flushes and ubus requests per simulated hour;
+ * those are the efficiency numbers to watch when changing refresh policy.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <libubox/uloop.h>
+
+#include "hal/display_hal.h"
+#include "hal/time_hal.h"
+#include "hal/ubus_hal.h"
+#include "page.h"
+#include "service_config.h"
+#include "sim_loop.h"
+#include "ui_controller.h"
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "ASSERT FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+#define HOUR_MS           (3600ULL * 1000ULL)
+#define SESSION_PERIOD_MS (15ULL * 60ULL * 1000ULL)
+
+/* Test API from the mocks */
+extern unsigned long display_null_get_flush_count(void);
+extern unsigned long ubus_mock_get_request_count(void);
+
+typedef struct {
+    uint32_t delay_ms;      /* After the previous step */
+    uint8_t key;
+    bool long_press;
+} sim_step_t;
+
+/* Wake, browse to Services, scroll the list, leave; then idle to sleep */
+static const sim_step_t g_session[] = {
+    { 0,    KEY_K1, false },
+    { 500,  KEY_K3, false },
+    { 1500, KEY_K3, false },
+    { 3000, KEY_K2, true  },
+    { 800,  KEY_K3, false },
+    { 300,  KEY_K3, false },
+    { 2000, KEY_K2, true  },
+};
+#define SESSION_STEPS ((int)(sizeof(g_session) / sizeof(g_session[0])))
+
+typedef struct {
+    unsigned long renders;
+    unsigned long flushes;
+    unsigned long requests;
+    uint64_t timeouts;
+} sim_counts_t;
+
+static ui_controller_t g_ui;
+static struct uloop_timeout g_ui_timer;
+static struct uloop_timeout g_render_kick;
+static struct uloop_timeout g_input_timer;
+static unsigned long g_renders;
+static int g_step;
+static int g_sessions;
+static int g_sessions_asleep;   /* Sessions that found the screen off */
+
+static void schedule_ui_timer(void);
+
+static void render(uint64_t now_ms) {
+    if (ui_controller_render(&g_ui, now_ms)) {
+        g_renders++;
+    }
+}
+
+static void ui_timer_cb(struct uloop_timeout *t) {
+    (void)t;
+    uint64_t now_ms = time_hal_now_ms();
+    ui_controller_tick(&g_ui, now_ms);
+    render(now_ms);
+    schedule_ui_timer();
+}
+
+static void schedule_ui_timer(void) {
+    int next_ms = ui_controller_next_timeout_ms(&g_ui);
+    if (next_ms > 0) {
+        g_ui_timer.cb = ui_timer_cb;
+        uloop_timeout_set(&g_ui_timer, next_ms);
+    }
+}
+
+static void render_kick_cb(struct uloop_timeout *t) {
+    (void)t;
+    render(time_hal_now_ms());
+    schedule_ui_timer();
+}
+
+static void request_render(void) {
+    g_render_kick.cb = render_kick_cb;
+    uloop_timeout_set(&g_render_kick, 0);
+}
+
+static void input_cb(struct uloop_timeout *t) {
+    uint64_t now_ms = time_hal_now_ms();
+
+    if (g_step == 0) {
+        g_sessions++;
+        if (!page_controller_is_screen_on(&g_ui.page_ctrl)) {
+            g_sessions_asleep++;
+        }
+    }
+
+    const sim_step_t *step = &g_session[g_step];
+    ui_controller_handle_button(&g_ui, step->key, step->long_press, now_ms);
+    render(now_ms);
+    schedule_ui_timer();
+
+    g_step = (g_step + 1) % SESSION_STEPS;
+    uint64_t next_ms = g_step ? g_session[g_step].delay_ms : 0;
+    if (g_step == 0) {
+        /* Next session starts one period after this one did */
+        uint64_t session_ms = 0;
+        for (int i = 0; i < SESSION_STEPS; i++) session_ms += g_session[i].delay_ms;
+        next_ms = SESSION_PERIOD_MS - session_ms;
+    }
+    uloop_timeout_set(t, (int)next_ms);
+}
+
+static void snapshot(sim_counts_t *c) {
+    c->renders = g_renders;
+    c->flushes = display_null_get_flush_count();
+    c->requests = ubus_mock_get_request_count();
+    c->timeouts = 0;
+}
+
+static void run(uint64_t duration_ms, sim_counts_t *delta) {
+    sim_counts_t before, after;
+    snapshot(&before);
+    uint64_t fired = sim_loop_run_until(time_hal_now_ms() + duration_ms);
+    snapshot(&after);
+
+    delta->renders = after.renders - before.renders;
+    delta->flushes = after.flushes - before.flushes;
+    delta->requests = after.requests - before.requests;
+    delta->timeouts = fired;
+}
+
+static void print_rates(const char *name, const sim_counts_t *c, uint64_t duration_ms) {
+    double hours = (double)duration_ms / (double)HOUR_MS;
+    printf("%-6s renders/h=%.1f flushes/h=%.1f ubus/h=%.1f wakeups/h=%.1f\n", name,
+           (double)c->renders / hours, (double)c->flushes / hours,
+           (double)c->requests / hours, (double)c->timeouts / hours);
+}
+
+static void start(void) {
+    ui_controller_init(&g_ui);
+    g_ui.render_hook = request_render;
+    g_renders = 0;
+    g_step = 0;
+    g_sessions = 0;
+    g_sessions_asleep = 0;
+    render(time_hal_now_ms());
+    schedule_ui_timer();
+}
+
+static void stop(void) {
+    sim_loop_reset();
+    ui_controller_cleanup(&g_ui);
+}
+
+static int test_idle_hour(void) {
+    start();
+
+    /* Awake until auto-sleep, then nothing may run */
+    sim_counts_t awake, idle;
+    run(UI_AUTO_SLEEP_MS + 2000, &awake);
+    ASSERT_TRUE(!page_controller_is_screen_on(&g_ui.page_ctrl));
+    run(HOUR_MS, &idle);
+    print_rates("idle", &idle, HOUR_MS);
+
+    ASSERT_TRUE(awake.renders > 0);
+    ASSERT_TRUE(idle.renders == 0);
+    ASSERT_TRUE(idle.flushes == 0);
+    ASSERT_TRUE(idle.requests == 0);
+    ASSERT_TRUE(idle.timeouts == 0);
+
+    stop();
+    return 0;
+}
+
+static int test_day(void) {
+    start();
+    g_input_timer.cb = input_cb;
+    uloop_timeout_set(&g_input_timer, 1000);
+
+    struct timespec wall_start, wall_end;
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+    uint64_t sim_start = time_hal_now_ms();
+
+    sim_counts_t day;
+    run(24 * HOUR_MS, &day);
+
+    clock_gettime(CLOCK_MONOTONIC, &wall_end);
+    double wall_ms = (double)(wall_end.tv_sec - wall_start.tv_sec) * 1000.0 +
+                     (double)(wall_end.tv_nsec - wall_start.tv_nsec) / 1e6;
+    print_rates("day", &day, 24 * HOUR_MS);
+    printf("simulated 24 h in %.0f ms wall time, %d sessions\n", wall_ms, g_sessions);
+
+    ASSERT_TRUE(time_hal_now_ms() - sim_start == 24 * HOUR_MS);
+    ASSERT_TRUE(g_sessions == 24 * 4);
+    /* Every session after the first finds the screen asleep */
+    ASSERT_TRUE(g_sessions_asleep == g_sessions - 1);
+
+    /* Sessions are ~40 s awake: far below 1 Hz around the clock */
+    ASSERT_TRUE(day.renders > 0);
+    ASSERT_TRUE(day.renders / 24 < 3600 / 4);
+    ASSERT_TRUE(day.flushes <= day.renders);
+    ASSERT_TRUE(day.requests > 0);
+    ASSERT_TRUE(day.requests / 24 <= 4 * 20 * g_ui.status.service_count);
+
+    stop();
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("=== test_sim_day ===\n");
+
+    display_hal->init();
+    ubus_hal->init();
+    service_config_set_path("/nonexistent/nanohat-oled");
+    service_config_reload();
+    page_controller_set_auto_screen_off(true);
+
+    failures += test_idle_hour();
+    failures += test_day();
+
+    ubus_hal->cleanup();
+    display_hal->cleanup();
+    service_config_set_path(NULL);
+
+    printf("=== failures: %d ===\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,74 @@
+/*
+ * Status history ring tests (interval gating, order, wrap-around)
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "status_history.h"
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "ASSERT FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+static status_history_sample_t g_out[STATUS_HISTORY_LEN + 4];
+
+static int test_interval(void) {
+    status_history_reset();
+
+    sys_status_t status;
+    memset(&status, 0, sizeof(status));
+    status.cpu_usage = 10.0f;
+    status.rx_speed = 100;
+
+    ASSERT_TRUE(!status_history_record(NULL, 1000));
+    ASSERT_TRUE(status_history_get(g_out, STATUS_HISTORY_LEN) == 0);
+
+    ASSERT_TRUE(status_history_record(&status, 1000));
+    status.cpu_usage = 20.0f;
+    ASSERT_TRUE(!status_history_record(&status, 1000 + STATUS_HISTORY_INTERVAL_MS - 1));
+    ASSERT_TRUE(status_history_record(&status, 1000 + STATUS_HISTORY_INTERVAL_MS));
+
+    ASSERT_TRUE(status_history_get(g_out, STATUS_HISTORY_LEN) == 2);
+    ASSERT_TRUE(g_out[0].time_ms == 1000 && g_out[0].cpu_usage == 10.0f);
+    ASSERT_TRUE(g_out[1].cpu_usage == 20.0f && g_out[1].rx_speed == 100);
+    return 0;
+}
+
+static int test_wrap(void) {
+    status_history_reset();
+
+    sys_status_t status;
+    memset(&status, 0, sizeof(status));
+    size_t total = STATUS_HISTORY_LEN + 7;
+    for (size_t i = 0; i < total; i++) {
+        status.tx_speed = i;
+        ASSERT_TRUE(status_history_record(&status, (i + 1) * STATUS_HISTORY_INTERVAL_MS));
+    }
+
+    /* Oldest samples dropped, order kept */
+    size_t n = status_history_get(g_out, STATUS_HISTORY_LEN + 4);
+    ASSERT_TRUE(n == STATUS_HISTORY_LEN);
+    for (size_t i = 0; i < n; i++) {
+        ASSERT_TRUE(g_out[i].tx_speed == total - STATUS_HISTORY_LEN + i);
+    }
+
+    /* A short buffer gets the newest samples */
+    n = status_history_get(g_out, 3);
+    ASSERT_TRUE(n == 3 && g_out[2].tx_speed == total - 1 && g_out[0].tx_speed == total - 3);
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("=== test_status_history ===\n");
+
+    failures += test_interval();
+    failures += test_wrap();
+
+    printf("=== failures: %d ===\n", failures);
+    return failures ? 1 : 0;
+}
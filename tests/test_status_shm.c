@@ -0,0 +1,184 @@
+/*
+ * Status shared-memory segment tests (layout, publish/read, seqlock under
+ * a concurrent writer, version check)
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "status_shm.h"
+#include "sys_status.h"
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "ASSERT FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+#define STRESS_PUBLISHES 100000
+
+static char g_name[64];
+static status_shm_t g_out;
+
+static int test_publish_read(void) {
+    status_shm_reader_t reader;
+    ASSERT_TRUE(status_shm_reader_open(&reader, g_name) == -ENOENT);
+
+    ASSERT_TRUE(status_shm_open(g_name) == 0);
+    ASSERT_TRUE(status_shm_reader_open(&reader, g_name) == 0);
+    ASSERT_TRUE(status_shm_read(&reader, &g_out) == -ENODATA);
+
+    service_status_t services[2];
+    memset(services, 0, sizeof(services));
+    snprintf(services[0].name, sizeof(services[0].name), "dropbear");
+    services[0].installed = true;
+    services[0].running = true;
+    services[0].status_valid = true;
+    snprintf(services[1].name, sizeof(services[1].name), "uhttpd");
+    services[1].usage_valid = true;
+    services[1].cpu_percent = 2.5f;
+    services[1].mem_bytes = 4096;
+
+    sys_status_t status;
+    memset(&status, 0, sizeof(status));
+    status.cpu_usage = 12.5f;
+    status.mem_total_kb = 1024;
+    status.uptime_sec = 3600;
+    status.rx_speed = 1000;
+    snprintf(status.hostname, sizeof(status.hostname), "OpenWrt");
+    snprintf(status.ip_addr, sizeof(status.ip_addr), "192.168.1.1");
+    status.services = services;
+    status.service_count = 2;
+
+    status_shm_publish(&status);
+    ASSERT_TRUE(status_shm_read(&reader, &g_out) == 0);
+    ASSERT_TRUE(g_out.magic == STATUS_SHM_MAGIC && g_out.version == STATUS_SHM_VERSION);
+    ASSERT_TRUE(g_out.size == sizeof(status_shm_t) && g_out.writer_pid == (uint32_t)getpid());
+    ASSERT_TRUE(g_out.seq == 2 && g_out.update_ms > 0);
+    ASSERT_TRUE(g_out.cpu_usage == 12.5f && g_out.mem_total_kb == 1024);
+    ASSERT_TRUE(g_out.uptime_sec == 3600 && g_out.rx_speed == 1000);
+    ASSERT_TRUE(strcmp(g_out.hostname, "OpenWrt") == 0);
+    ASSERT_TRUE(strcmp(g_out.ip_addr, "192.168.1.1") == 0);
+    ASSERT_TRUE(g_out.service_count == 2 && g_out.service_total == 2);
+    ASSERT_TRUE(strcmp(g_out.services[0].name, "dropbear") == 0);
+    ASSERT_TRUE(g_out.services[0].flags == (STATUS_SHM_SVC_INSTALLED | STATUS_SHM_SVC_RUNNING |
+                                           STATUS_SHM_SVC_VALID));
+    ASSERT_TRUE(g_out.services[1].flags == STATUS_SHM_SVC_USAGE);
+    ASSERT_TRUE(g_out.services[1].cpu_percent == 2.5f && g_out.services[1].mem_bytes == 4096);
+
+    status_shm_reader_close(&reader);
+    status_shm_close();
+
+    /* Removed with the daemon */
+    ASSERT_TRUE(status_shm_reader_open(&reader, g_name) == -ENOENT);
+    return 0;
+}
+
+static int test_layout_mismatch(void) {
+    int fd = shm_open(g_name, O_CREAT | O_RDWR, 0600);
+    ASSERT_TRUE(fd >= 0);
+    ASSERT_TRUE(ftruncate(fd, sizeof(status_shm_t)) == 0);
+    status_shm_t *seg = mmap(NULL, sizeof(*seg), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT_TRUE(seg != MAP_FAILED);
+
+    status_shm_reader_t reader;
+    seg->magic = STATUS_SHM_MAGIC;
+    seg->version = STATUS_SHM_VERSION + 1;
+    seg->service_size = sizeof(status_shm_service_t);
+    ASSERT_TRUE(status_shm_reader_open(&reader, g_name) == -EPROTO);
+    seg->version = STATUS_SHM_VERSION;
+    seg->service_size = 48;
+    ASSERT_TRUE(status_shm_reader_open(&reader, g_name) == -EPROTO);
+
+    munmap(seg, sizeof(*seg));
+    shm_unlink(g_name);
+    return 0;
+}
+
+/* Writer thread: every value of a publish carries the same number */
+static atomic_bool g_writer_done;
+
+static void *writer_main(void *arg) {
+    (void)arg;
+    service_status_t services[STATUS_SHM_MAX_SERVICES];
+    memset(services, 0, sizeof(services));
+    sys_status_t status;
+    memset(&status, 0, sizeof(status));
+    status.services = services;
+
+    for (uint32_t n = 1; n <= STRESS_PUBLISHES; n++) {
+        status.uptime_sec = n;
+        status.rx_bytes = n;
+        status.service_count = 1 + n % 200;  /* Also past the segment limit */
+        size_t used = status.service_count < STATUS_SHM_MAX_SERVICES ?
+                      status.service_count : STATUS_SHM_MAX_SERVICES;
+        for (size_t i = 0; i < used; i++) {
+            services[i].mem_bytes = n;
+        }
+        status_shm_publish(&status);
+    }
+    atomic_store(&g_writer_done, true);
+    return NULL;
+}
+
+static int test_concurrent_reads(void) {
+    ASSERT_TRUE(status_shm_open(g_name) == 0);
+    status_shm_reader_t reader;
+    ASSERT_TRUE(status_shm_reader_open(&reader, g_name) == 0);
+
+    pthread_t writer;
+    atomic_store(&g_writer_done, false);
+    ASSERT_TRUE(pthread_create(&writer, NULL, writer_main, NULL) == 0);
+
+    uint64_t reads = 0;
+    int torn = 0;
+    uint32_t last = 0;
+    while (!atomic_load(&g_writer_done) || last < STRESS_PUBLISHES) {
+        int ret = status_shm_read(&reader, &g_out);
+        if (ret == -ENODATA || ret == -EAGAIN) continue;
+        if (ret != 0) {
+            torn++;
+            break;
+        }
+        uint32_t n = g_out.uptime_sec;
+        uint32_t total = 1 + n % 200;
+        if (g_out.rx_bytes != n || n < last) torn++;
+        if (g_out.service_total != total) torn++;
+        if (g_out.service_count != (total < STATUS_SHM_MAX_SERVICES ? total : STATUS_SHM_MAX_SERVICES)) torn++;
+        for (uint32_t i = 0; i < g_out.service_count; i++) {
+            if (g_out.services[i].mem_bytes != n) torn++;
+        }
+        last = n;
+        reads++;
+    }
+    pthread_join(writer, NULL);
+
+    printf("  %" PRIu64 " reads, last %u, torn %d\n", reads, last, torn);
+    ASSERT_TRUE(torn == 0 && last == STRESS_PUBLISHES);
+
+    status_shm_reader_close(&reader);
+    status_shm_close();
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("=== test_status_shm ===\n");
+    snprintf(g_name, sizeof(g_name), "/nanohat-status-test-%d", (int)getpid());
+
+    failures += test_publish_read();
+    failures += test_layout_mismatch();
+    failures += test_concurrent_reads();
+
+    printf("=== failures: %d ===\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,150 @@
+/*
+ * Status snapshot tests (held frame stays unchanged, deep copy, threaded
+ * publish/acquire consistency)
+ */
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "status_snapshot.h"
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "ASSERT FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+#define STRESS_PUBLISHES 200000
+#define STRESS_SERVICES  16
+
+static int test_hold_and_copy(void) {
+    status_snapshot_t snap;
+    status_snapshot_init(&snap);
+
+    /* Nothing published yet: an empty status */
+    const sys_status_t *view = status_snapshot_acquire(&snap);
+    ASSERT_TRUE(view != NULL && view->service_count == 0 && view->services == NULL);
+
+    service_status_t services[2];
+    memset(services, 0, sizeof(services));
+    snprintf(services[0].name, sizeof(services[0].name), "dropbear");
+    snprintf(services[1].name, sizeof(services[1].name), "uhttpd");
+    services[0].running = true;
+
+    sys_status_t status;
+    memset(&status, 0, sizeof(status));
+    status.services = services;
+    status.service_count = 2;
+    status.uptime_sec = 1;
+    snprintf(status.ip_addr, sizeof(status.ip_addr), "10.0.0.1");
+
+    ASSERT_TRUE(status_snapshot_publish(&snap, &status) == 0);
+    view = status_snapshot_acquire(&snap);
+    ASSERT_TRUE(view->uptime_sec == 1 && strcmp(view->ip_addr, "10.0.0.1") == 0);
+    ASSERT_TRUE(view->services != services && view->service_count == 2);
+    ASSERT_TRUE(view->services[0].running && strcmp(view->services[1].name, "uhttpd") == 0);
+
+    /* The held frame survives any number of publishes and working-copy edits */
+    services[0].running = false;
+    for (uint32_t i = 2; i < 10; i++) {
+        status.uptime_sec = i;
+        ASSERT_TRUE(status_snapshot_publish(&snap, &status) == 0);
+    }
+    ASSERT_TRUE(view->uptime_sec == 1 && view->services[0].running);
+
+    /* The next acquire sees the newest publish only */
+    view = status_snapshot_acquire(&snap);
+    ASSERT_TRUE(view->uptime_sec == 9 && !view->services[0].running);
+    ASSERT_TRUE(status_snapshot_acquire(&snap) == view);
+
+    /* Table shrinks and grows (reload) */
+    status.service_count = 1;
+    ASSERT_TRUE(status_snapshot_publish(&snap, &status) == 0);
+    ASSERT_TRUE(status_snapshot_acquire(&snap)->service_count == 1);
+    status.service_count = 0;
+    status.services = NULL;
+    ASSERT_TRUE(status_snapshot_publish(&snap, &status) == 0);
+    ASSERT_TRUE(status_snapshot_acquire(&snap)->service_count == 0);
+
+    status_snapshot_free(&snap);
+    return 0;
+}
+
+/* Writer thread: every field of a publish carries the same sequence number */
+typedef struct {
+    status_snapshot_t *snap;
+    atomic_bool done;
+} stress_t;
+
+static void *writer_main(void *arg) {
+    stress_t *st = arg;
+    service_status_t services[STRESS_SERVICES];
+    memset(services, 0, sizeof(services));
+
+    sys_status_t status;
+    memset(&status, 0, sizeof(status));
+    status.services = services;
+
+    for (uint32_t seq = 1; seq <= STRESS_PUBLISHES; seq++) {
+        status.uptime_sec = seq;
+        status.rx_bytes = seq;
+        status.service_count = 1 + seq % STRESS_SERVICES;
+        for (size_t i = 0; i < status.service_count; i++) {
+            services[i].mem_bytes = seq;
+        }
+        status_snapshot_publish(st->snap, &status);
+    }
+    atomic_store(&st->done, true);
+    return NULL;
+}
+
+static int test_threaded(void) {
+    status_snapshot_t snap;
+    status_snapshot_init(&snap);
+    stress_t st = { .snap = &snap };
+    atomic_init(&st.done, false);
+
+    pthread_t writer;
+    ASSERT_TRUE(pthread_create(&writer, NULL, writer_main, &st) == 0);
+
+    uint32_t last = 0;
+    uint64_t frames = 0;
+    int torn = 0;
+    while (!atomic_load(&st.done) || last < STRESS_PUBLISHES) {
+        const sys_status_t *view = status_snapshot_acquire(&snap);
+        uint32_t seq = view->uptime_sec;
+        if (seq < last) torn++;                     /* Went back in time */
+        if (view->rx_bytes != seq) torn++;
+        if (seq > 0 && view->service_count != 1 + seq % STRESS_SERVICES) torn++;
+        for (size_t i = 0; i < view->service_count; i++) {
+            if (view->services[i].mem_bytes != seq) torn++;
+        }
+        last = seq;
+        frames++;
+    }
+    pthread_join(writer, NULL);
+
+    printf("  %" PRIu64 " frames, last %u, torn %d\n", frames, last, torn);
+    ASSERT_TRUE(torn == 0);
+    ASSERT_TRUE(last == STRESS_PUBLISHES);
+    ASSERT_TRUE(snap.published == STRESS_PUBLISHES);
+
+    status_snapshot_free(&snap);
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("=== test_status_snapshot ===\n");
+
+    failures += test_hold_and_copy();
+    failures += test_threaded();
+
+    printf("=== failures: %d ===\n", failures);
+    return failures ? 1 : 0;
+}
@@ -10,6 +10,7 @@
 #include <string.h>
 #include <stdbool.h>
 #include <assert.h>
+#include <unistd.h>
 #include <libubox/uloop.h>
 
 #include "hal/ubus_hal.h"
@@ -357,24 +358,13 @@ static void test_sys_status_integration(void) {
     ubus_mock_set_response("uhttpd", UBUS_HAL_STATUS_OK, true, false, 50);
 
     /* Initialize service config */
-    service_config_t config;
-    service_config_init(&config);
+    service_config_init(NULL);
 
-    /* Create status with services */
+    /* Create status with services (normally done by sys_status_update_local) */
     sys_status_t status;
     memset(&status, 0, sizeof(status));
-
-    /* Manually populate services (normally done by sys_status_update_local) */
-    const service_config_t *cfg = service_config_get();
-    if (cfg) {
-        for (size_t i = 0; i < cfg->count && i < MAX_SERVICES; i++) {
-            strncpy(status.services[i].name, cfg->services[i].name,
-                    sizeof(status.services[i].name) - 1);
-            status.services[i].query_pending = false;
-            status.services[i].status_valid = false;
-        }
-        status.service_count = cfg->count;
-    }
+    assert(sys_status_sync_services(&status));
+    assert(status.service_count == service_config_get()->count);
 
     /* Initiate queries */
     int queries = sys_status_query_services(NULL, &status);
@@ -402,6 +392,90 @@ static void test_sys_status_integration(void) {
     /* Verify no longer pending */
     assert(!sys_status_has_pending_queries(&status));
 
+    sys_status_free_services(&status);
+    printf("  PASSED\n");
+}
+
+/*
+ * Test 7: more services than request slots
+ *
+ * A pass stops when the HAL is full; the rest go out on later passes
+ * and a refresh never marks a service it could not query as invalid.
+ */
+#define MANY_SERVICES (UBUS_HAL_MAX_QUERIES * 2 + 5)
+
+static void run_loop(int ms) {
+    g_timeout.cb = test4_timeout_cb;
+    uloop_timeout_set(&g_timeout, ms);
+    uloop_run();
+}
+
+static size_t count_valid(const sys_status_t *status) {
+    size_t n = 0;
+    for (size_t i = 0; i < status->service_count; i++) {
+        if (status->services[i].status_valid) n++;
+    }
+    return n;
+}
+
+static void test_more_services_than_slots(void) {
+    printf("\n=== Test: more services than request slots ===\n");
+
+    char path[] = "/tmp/nanohat-ubus-test-XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    FILE *fp = fdopen(fd, "w");
+    assert(fp);
+    fprintf(fp, "config services 'services'\n");
+    for (int i = 0; i < MANY_SERVICES; i++) {
+        fprintf(fp, "\tlist service 'svc%02d'\n", i);
+    }
+    fclose(fp);
+
+    ubus_mock_clear_responses();
+    ubus_mock_set_default_response(UBUS_HAL_STATUS_OK, true, true, 20);
+    service_config_set_path(path);
+    assert(service_config_reload() == 0);
+
+    sys_status_t status;
+    memset(&status, 0, sizeof(status));
+    assert(sys_status_sync_services(&status));
+    assert(status.service_count == MANY_SERVICES);
+
+    /* First pass fills the slots, nothing fails synchronously */
+    assert(sys_status_query_services(NULL, &status) == UBUS_HAL_MAX_QUERIES);
+    assert(ubus_mock_get_pending_count() == UBUS_HAL_MAX_QUERIES);
+
+    /* Later passes pick up where the previous one stopped */
+    int passes = 1;
+    while (count_valid(&status) < status.service_count && passes < 10) {
+        run_loop(50);
+        sys_status_query_services(NULL, &status);
+        passes++;
+    }
+    run_loop(50);
+    printf("  %zu/%zu valid after %d passes\n", count_valid(&status), status.service_count, passes);
+    assert(count_valid(&status) == status.service_count);
+
+    /* A refresh of every row keeps them all valid while slots are short */
+    for (size_t i = 0; i < status.service_count; i++) {
+        status.services[i].last_update_ms = 0;
+    }
+    for (int pass = 0; pass < 4; pass++) {
+        sys_status_query_services(NULL, &status);
+        assert(count_valid(&status) == status.service_count);
+        run_loop(50);
+    }
+    assert(!sys_status_has_pending_queries(&status));
+    for (size_t i = 0; i < status.service_count; i++) {
+        assert(status.services[i].last_update_ms > 0);
+    }
+
+    sys_status_free_services(&status);
+    service_config_set_path(NULL);
+    service_config_reload();
+    unlink(path);
+    ubus_mock_clear_responses();
     printf("  PASSED\n");
 }
 
@@ -422,6 +496,7 @@ int main(void) {
     test_callback_at_most_once();
     test_consecutive_timeouts();
     test_sys_status_integration();
+    test_more_services_than_slots();
 
     /* Cleanup */
     ubus_hal->cleanup();
@@ -6,6 +6,12 @@
 #include "ui_controller.h"
 #include "anim.h"
 #include "pages/pages.h"
+#include "service_config.h"
+#include "hal/display_hal.h"
+#include "hal/ubus_hal.h"
+
+/* Test API from the ubus mock */
+extern unsigned long ubus_mock_get_request_count(void);
 
 #define ASSERT_TRUE(cond) do { \
     if (!(cond)) { \
@@ -67,10 +73,15 @@ static int test_auto_sleep(void) {
     ui_controller_t ui;
     ui_controller_init(&ui);
 
+    /* Off by default (Settings toggle) */
+    bool was_enabled = page_controller_is_auto_screen_off_enabled();
+    page_controller_set_auto_screen_off(true);
+
     page_controller_set_idle_timeout(&ui.page_ctrl, 100);
     ui_controller_handle_button(&ui, KEY_K1, false, 1000);
 
     ui_controller_tick(&ui, 1200);
+    page_controller_set_auto_screen_off(was_enabled);
     ASSERT_TRUE(!page_controller_is_screen_on(&ui.page_ctrl));
 
     ui_controller_cleanup(&ui);
@@ -83,34 +94,24 @@ static int test_page_order_and_wrap(void) {
 
     int page_count = 0;
     const page_t **pages = pages_get_list(&page_count);
-    ASSERT_TRUE(page_count == 4);
+    ASSERT_TRUE(page_count == 5);
+    ASSERT_TRUE(pages[page_count - 1] == &page_settings);
 
     uint64_t t = 1000;
 
-    ASSERT_TRUE(ui.page_ctrl.current_page == 0);
-    ASSERT_TRUE(ui.page_ctrl.pages[0] == pages[0]);
-
-    ui_controller_handle_button(&ui, KEY_K3, false, t);
-    ui_controller_tick(&ui, t + ANIM_SLIDE_DURATION_MS + 1);
+    /* Starts on Gateway, K3 walks forward and wraps back to it */
     ASSERT_TRUE(ui.page_ctrl.current_page == 1);
-    ASSERT_TRUE(ui.page_ctrl.pages[1] == pages[1]);
+    ASSERT_TRUE(ui.page_ctrl.pages[1] == &page_gateway);
 
-    t += 500;
-    ui_controller_handle_button(&ui, KEY_K3, false, t);
-    ui_controller_tick(&ui, t + ANIM_SLIDE_DURATION_MS + 1);
-    ASSERT_TRUE(ui.page_ctrl.current_page == 2);
-    ASSERT_TRUE(ui.page_ctrl.pages[2] == pages[2]);
-
-    t += 500;
-    ui_controller_handle_button(&ui, KEY_K3, false, t);
-    ui_controller_tick(&ui, t + ANIM_SLIDE_DURATION_MS + 1);
-    ASSERT_TRUE(ui.page_ctrl.current_page == 3);
-    ASSERT_TRUE(ui.page_ctrl.pages[3] == pages[3]);
+    for (int i = 2; i <= page_count + 1; i++) {
+        ui_controller_handle_button(&ui, KEY_K3, false, t);
+        ui_controller_tick(&ui, t + ANIM_SLIDE_DURATION_MS + 1);
+        ASSERT_TRUE(ui.page_ctrl.current_page == i % page_count);
+        ASSERT_TRUE(ui.page_ctrl.pages[i % page_count] == pages[i % page_count]);
+        t += 500;
+    }
 
-    t += 500;
-    ui_controller_handle_button(&ui, KEY_K3, false, t);
-    ui_controller_tick(&ui, t + ANIM_SLIDE_DURATION_MS + 1);
-    ASSERT_TRUE(ui.page_ctrl.current_page == 0);
+    ASSERT_TRUE(ui.page_ctrl.current_page == 1);
 
     ui_controller_cleanup(&ui);
     return 0;
@@ -163,10 +164,242 @@ static int test_k2_long_on_non_enter_shakes(void) {
     return 0;
 }
 
+static int find_page(const ui_controller_t *ui, const page_t *page) {
+    for (int i = 0; i < ui->page_ctrl.page_count; i++) {
+        if (ui->page_ctrl.pages[i] == page) return i;
+    }
+    return -1;
+}
+
+static int test_press_dispatch_policy(void) {
+    ui_controller_t ui;
+    ui_controller_init(&ui);
+
+    /* View mode: K1/K3 have no long action, K2 long enters */
+    ASSERT_TRUE(page_controller_press_dispatch_keys(&ui.page_ctrl) ==
+                (KEY_BIT(KEY_K1) | KEY_BIT(KEY_K3)));
+    ASSERT_TRUE(page_controller_repeat_keys(&ui.page_ctrl) == 0);
+
+    /* K2 double-click only where bound: elsewhere K2 is not delayed */
+    ASSERT_TRUE(page_controller_gesture_keys(&ui.page_ctrl) == 0);
+    ui.page_ctrl.current_page = find_page(&ui, &page_services);
+    ASSERT_TRUE(page_controller_gesture_keys(&ui.page_ctrl) == KEY_BIT(KEY_K2_DOUBLE));
+    ui.page_ctrl.current_page = 0;
+    ASSERT_TRUE(page_controller_gesture_keys(&ui.page_ctrl) == 0);
+
+    /* Screen off: any key only wakes */
+    ui.page_ctrl.screen_state = SCREEN_OFF;
+    ASSERT_TRUE(page_controller_press_dispatch_keys(&ui.page_ctrl) ==
+                (KEY_BIT(KEY_K1) | KEY_BIT(KEY_K2) | KEY_BIT(KEY_K3)));
+    ASSERT_TRUE(page_controller_gesture_keys(&ui.page_ctrl) == 0);
+    ui.page_ctrl.screen_state = SCREEN_ON;
+
+    /* Enter mode: per page */
+    ui.page_ctrl.page_mode = PAGE_MODE_ENTER;
+    ui.page_ctrl.current_page = find_page(&ui, &page_settings);
+    ASSERT_TRUE(ui.page_ctrl.current_page >= 0);
+    ASSERT_TRUE(page_controller_press_dispatch_keys(&ui.page_ctrl) ==
+                (KEY_BIT(KEY_K1) | KEY_BIT(KEY_K3)));
+
+    ASSERT_TRUE(page_controller_repeat_keys(&ui.page_ctrl) ==
+                (KEY_BIT(KEY_K1) | KEY_BIT(KEY_K3)));
+    ASSERT_TRUE(page_controller_gesture_keys(&ui.page_ctrl) == 0);
+
+    /* Services: long actions moved to chords, so K1/K3 dispatch and repeat */
+    ui.page_ctrl.current_page = find_page(&ui, &page_services);
+    ASSERT_TRUE(ui.page_ctrl.current_page >= 0);
+    ASSERT_TRUE(page_controller_press_dispatch_keys(&ui.page_ctrl) ==
+                (KEY_BIT(KEY_K1) | KEY_BIT(KEY_K3)));
+    ASSERT_TRUE(page_controller_repeat_keys(&ui.page_ctrl) ==
+                (KEY_BIT(KEY_K1) | KEY_BIT(KEY_K3)));
+    ASSERT_TRUE(page_controller_gesture_keys(&ui.page_ctrl) ==
+                (KEY_BIT(KEY_K1_K2) | KEY_BIT(KEY_K1_K3)));
+
+    ui.page_ctrl.page_mode = PAGE_MODE_VIEW;
+    ui_controller_cleanup(&ui);
+    return 0;
+}
+
+/*
+ * Hold a key the way the GPIO HAL delivers it: one press, then one more
+ * per repeat step while the page opts the key into auto-repeat.
+ */
+static void hold_key(ui_controller_t *ui, uint8_t key, int steps, uint64_t *t) {
+    ui_controller_handle_button(ui, key, false, *t);
+    for (int i = 0; i < steps; i++) {
+        *t += 100;
+        if (page_controller_repeat_keys(&ui->page_ctrl) & KEY_BIT(key)) {
+            ui_controller_handle_button(ui, key, false, *t);
+        }
+    }
+    *t += 100;
+}
+
+static int test_dialog_hold_toggles_once(void) {
+    ui_controller_t ui;
+    ui_controller_init(&ui);
+    uint64_t t = 1000;
+
+    ui.page_ctrl.page_mode = PAGE_MODE_ENTER;
+    ui.page_ctrl.current_page = find_page(&ui, &page_services);
+    ASSERT_TRUE(ui.page_ctrl.current_page >= 0);
+    ui_controller_render(&ui, t);   /* Syncs the service rows */
+    ASSERT_TRUE(page_services.get_item_count() > 0);
+
+    /* K2 opens the confirmation dialog on No; repeat is off inside it */
+    ASSERT_TRUE(ui_controller_handle_button(&ui, KEY_K2, false, t));
+    ASSERT_TRUE(page_controller_repeat_keys(&ui.page_ctrl) == 0);
+
+    /* A long hold of K1 flips to Yes exactly once: confirming controls */
+    hold_key(&ui, KEY_K1, 8, &t);
+    unsigned long requests = ubus_mock_get_request_count();
+    ASSERT_TRUE(ui_controller_handle_button(&ui, KEY_K2, false, t));
+    ASSERT_TRUE(ubus_mock_get_request_count() == requests + 1);
+
+    /* Dialog closed: list navigation repeats again */
+    ASSERT_TRUE(page_controller_repeat_keys(&ui.page_ctrl) ==
+                (KEY_BIT(KEY_K1) | KEY_BIT(KEY_K3)));
+
+    /* Two holds of K3 in a fresh dialog: No, Yes, No again */
+    ASSERT_TRUE(ui_controller_handle_button(&ui, KEY_K2, false, t));
+    hold_key(&ui, KEY_K3, 8, &t);
+    hold_key(&ui, KEY_K3, 8, &t);
+    requests = ubus_mock_get_request_count();
+    ASSERT_TRUE(ui_controller_handle_button(&ui, KEY_K2, false, t));
+    ASSERT_TRUE(ubus_mock_get_request_count() == requests);
+
+    ui.page_ctrl.page_mode = PAGE_MODE_VIEW;
+    ui_controller_cleanup(&ui);
+    return 0;
+}
+
+static int test_double_click_home(void) {
+    ui_controller_t ui;
+    ui_controller_init(&ui);
+
+    int count = ui.page_ctrl.page_count;
+    ASSERT_TRUE(count >= 3);
+    uint64_t t = 1000;
+
+    /* Not bound on this page */
+    ui.page_ctrl.current_page = find_page(&ui, &page_network);
+    ASSERT_TRUE(!ui_controller_handle_button(&ui, KEY_K2_DOUBLE, false, t));
+
+    ui.page_ctrl.current_page = find_page(&ui, &page_settings);
+    ASSERT_TRUE(ui_controller_handle_button(&ui, KEY_K2_DOUBLE, false, t));
+    ASSERT_TRUE(ui.page_ctrl.anim.type == ANIM_SLIDE_RIGHT);
+    ASSERT_TRUE(ui.page_ctrl.anim.to_page == 0);
+    ASSERT_TRUE(page_controller_is_screen_on(&ui.page_ctrl));
+
+    ui_controller_tick(&ui, t + ANIM_SLIDE_DURATION_MS + 1);
+    ASSERT_TRUE(ui.page_ctrl.current_page == 0);
+
+    /* Already home: nothing to do */
+    ASSERT_TRUE(!ui_controller_handle_button(&ui, KEY_K2_DOUBLE, false,
+                                             t + ANIM_SLIDE_DURATION_MS + 10));
+    ASSERT_TRUE(ui.page_ctrl.anim.type == ANIM_NONE);
+
+    ui_controller_cleanup(&ui);
+    return 0;
+}
+
+static int test_rapid_keys_jump(void) {
+    ui_controller_t ui;
+    ui_controller_init(&ui);
+
+    int start = ui.page_ctrl.current_page;
+    int count = ui.page_ctrl.page_count;
+    ASSERT_TRUE(count >= 4);
+    uint64_t t = 1000;
+
+    /* Second press early in the slide: one slide, two pages */
+    ASSERT_TRUE(ui_controller_handle_button(&ui, KEY_K3, false, t));
+    ASSERT_TRUE(ui_controller_handle_button(&ui, KEY_K3, false, t + 50));
+    ASSERT_TRUE(ui.page_ctrl.anim.from_page == start);
+    ASSERT_TRUE(ui.page_ctrl.anim.to_page == (start + 2) % count);
+    ASSERT_TRUE(ui.page_ctrl.anim.start_ms == t);
+
+    /* Late press: fast-forward and chain the next slide */
+    t += ANIM_SLIDE_DURATION_MS * 3 / 4;
+    ASSERT_TRUE(ui_controller_handle_button(&ui, KEY_K3, false, t));
+    ASSERT_TRUE(ui.page_ctrl.current_page == (start + 2) % count);
+    ASSERT_TRUE(ui.page_ctrl.anim.from_page == (start + 2) % count);
+    ASSERT_TRUE(ui.page_ctrl.anim.to_page == (start + 3) % count);
+    ASSERT_TRUE(ui.page_ctrl.anim.start_ms == t);
+
+    ui_controller_tick(&ui, t + ANIM_SLIDE_DURATION_MS + 1);
+    ASSERT_TRUE(ui.page_ctrl.current_page == (start + 3) % count);
+    ASSERT_TRUE(!page_controller_is_animating(&ui.page_ctrl));
+
+    ui_controller_cleanup(&ui);
+    return 0;
+}
+
+static int test_keys_queued_during_animation(void) {
+    ui_controller_t ui;
+    ui_controller_init(&ui);
+
+    int start = ui.page_ctrl.current_page;
+    uint64_t t = 1000;
+
+    /* Opposite direction and K2 are buffered, not dropped */
+    ui_controller_handle_button(&ui, KEY_K3, false, t);
+    ASSERT_TRUE(!ui_controller_handle_button(&ui, KEY_K1, false, t + 100));
+    ASSERT_TRUE(!ui_controller_handle_button(&ui, KEY_K2, false, t + 150));
+    ASSERT_TRUE(ui.page_ctrl.key_queue_len == 2);
+
+    /* End of slide: K1 slides back, K2 waits for that slide */
+    t += ANIM_SLIDE_DURATION_MS + 1;
+    ui_controller_tick(&ui, t);
+    ASSERT_TRUE(page_controller_is_animating(&ui.page_ctrl));
+    ASSERT_TRUE(ui.page_ctrl.anim.type == ANIM_SLIDE_RIGHT);
+    ASSERT_TRUE(ui.page_ctrl.anim.to_page == start);
+    ASSERT_TRUE(ui.page_ctrl.key_queue_len == 1);
+
+    t += ANIM_SLIDE_DURATION_MS + 1;
+    ui_controller_tick(&ui, t);
+    ASSERT_TRUE(ui.page_ctrl.current_page == start);
+    ASSERT_TRUE(!page_controller_is_screen_on(&ui.page_ctrl));
+    ASSERT_TRUE(ui.page_ctrl.key_queue_len == 0);
+
+    ui_controller_cleanup(&ui);
+    return 0;
+}
+
+static int test_snapshot_published_on_change(void) {
+    ui_controller_t ui;
+    ui_controller_init(&ui);
+    ASSERT_TRUE(ui.snapshot.published == 1);
+
+    /* Animation frames render the same status: acquire only, no copy */
+    ui_controller_handle_button(&ui, KEY_K3, false, 1000);
+    uint32_t published = ui.snapshot.published;
+    for (uint64_t now_ms = 1000; now_ms < 1000 + ANIM_SLIDE_DURATION_MS / 2; now_ms += UI_TICK_ANIM_MS) {
+        ui_controller_tick(&ui, now_ms);
+        ASSERT_TRUE(ui_controller_render(&ui, now_ms));
+    }
+    ASSERT_TRUE(ui.snapshot.published == published);
+
+    /* A collector change is published once, then rendered */
+    ui.status.cpu_temp = 42.0f;
+    ui.status.update_seq++;
+    ui_controller_tick(&ui, 1000 + ANIM_SLIDE_DURATION_MS / 2);
+    ASSERT_TRUE(ui.snapshot.published == published + 1);
+    ASSERT_TRUE(status_snapshot_acquire(&ui.snapshot)->cpu_temp == 42.0f);
+
+    ui_controller_cleanup(&ui);
+    return 0;
+}
+
 int main(void) {
     int failures = 0;
 
     printf("=== test_ui_controller ===\n");
+    display_hal->init();
+    ubus_hal->init();
+    service_config_set_path("/nonexistent/nanohat-oled");
+    service_config_reload();
+
     failures += test_init_power_on();
     failures += test_k2_short_turns_off();
     failures += test_any_key_wakes_screen();
@@ -176,7 +409,16 @@ int main(void) {
     failures += test_wake_does_not_change_page();
     failures += test_k2_short_turns_off_any_page();
     failures += test_k2_long_on_non_enter_shakes();
-
+    failures += test_press_dispatch_policy();
+    failures += test_dialog_hold_toggles_once();
+    failures += test_double_click_home();
+    failures += test_rapid_keys_jump();
+    failures += test_keys_queued_during_animation();
+    failures += test_snapshot_published_on_change();
+
+    ubus_hal->cleanup();
+    display_hal->cleanup();
+    service_config_set_path(NULL);
     printf("=== failures: %d ===\n", failures);
     return failures ? 1 : 0;
 }
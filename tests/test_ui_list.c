@@ -0,0 +1,179 @@
+/*
+ * List widget tests (virtualized rendering, pixel scroll, change log)
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "fonts.h"
+#include "ui_list.h"
+#include "sys_status.h"
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "ASSERT FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+#define ROW_H 16
+#define ROWS  3
+
+/* Rows are never drawn to a real display here */
+static char g_fake_u8g2[64];
+
+typedef struct {
+    int calls;
+    int first_index;
+    int first_y;
+    int selected_index;
+} draw_log_t;
+
+static void log_row(u8g2_t *u8g2, int index, int baseline_y, bool selected, void *priv) {
+    (void)u8g2;
+    draw_log_t *log = (draw_log_t *)priv;
+    if (log->calls == 0) {
+        log->first_index = index;
+        log->first_y = baseline_y;
+    }
+    if (selected) {
+        log->selected_index = index;
+    }
+    log->calls++;
+}
+
+static void render(ui_list_t *list, uint64_t now_ms, draw_log_t *log) {
+    memset(log, 0, sizeof(*log));
+    log->selected_index = -1;
+    ui_list_render(list, (u8g2_t *)g_fake_u8g2, 16, now_ms, log_row, log);
+}
+
+static int test_renders_visible_rows_only(void) {
+    ui_list_t list;
+    ui_list_init(&list, ROW_H, ROWS);
+    ui_list_set_count(&list, 1000);
+
+    draw_log_t log;
+    render(&list, 1000, &log);
+    ASSERT_TRUE(log.calls == ROWS);
+    ASSERT_TRUE(log.first_index == 0);
+    ASSERT_TRUE(log.first_y == 16 + 12);
+    ASSERT_TRUE(log.selected_index == 0);
+
+    /* Short list draws only its items */
+    ui_list_set_count(&list, 2);
+    render(&list, 1000, &log);
+    ASSERT_TRUE(log.calls == 2);
+    return 0;
+}
+
+static int test_smooth_scroll(void) {
+    ui_list_t list;
+    ui_list_init(&list, ROW_H, ROWS);
+    ui_list_set_count(&list, 10);
+
+    /* Selection inside viewport: no scroll */
+    ASSERT_TRUE(ui_list_move(&list, 1));
+    ASSERT_TRUE(ui_list_move(&list, 1));
+    ASSERT_TRUE(!ui_list_is_animating(&list));
+
+    /* Leaving the viewport starts a one-row animation */
+    ASSERT_TRUE(ui_list_move(&list, 1));
+    ASSERT_TRUE(list.selected == 3);
+    ASSERT_TRUE(list.target_px == ROW_H);
+    ASSERT_TRUE(ui_list_is_animating(&list));
+
+    draw_log_t log;
+    render(&list, 1000, &log);  /* Animation clock starts here */
+    ASSERT_TRUE(list.scroll_px == 0);
+
+    /* Mid-animation: partial offset, one extra row drawn */
+    render(&list, 1000 + UI_LIST_SCROLL_MS / 2, &log);
+    ASSERT_TRUE(list.scroll_px > 0 && list.scroll_px < ROW_H);
+    ASSERT_TRUE(log.calls == ROWS + 1);
+    ASSERT_TRUE(log.first_index == 0);
+    ASSERT_TRUE(log.first_y == 16 + 12 - list.scroll_px);
+
+    render(&list, 1000 + UI_LIST_SCROLL_MS, &log);
+    ASSERT_TRUE(!ui_list_is_animating(&list));
+    ASSERT_TRUE(list.scroll_px == ROW_H);
+    ASSERT_TRUE(log.calls == ROWS);
+    ASSERT_TRUE(log.first_index == 1);
+    ASSERT_TRUE(log.selected_index == 3);
+
+    /* Wrap to the top scrolls back */
+    ASSERT_TRUE(ui_list_move(&list, -4));
+    ASSERT_TRUE(list.selected == 9);
+    ASSERT_TRUE(list.target_px == (10 - ROWS) * ROW_H);
+    ASSERT_TRUE(ui_list_move(&list, 1));
+    ASSERT_TRUE(list.selected == 0);
+    ASSERT_TRUE(list.target_px == 0);
+
+    /* Shrinking the list clamps without animating */
+    ui_list_reset(&list);
+    ASSERT_TRUE(ui_list_move(&list, -1));
+    render(&list, 2000, &log);
+    render(&list, 2000 + UI_LIST_SCROLL_MS, &log);
+    ui_list_set_count(&list, 4);
+    ASSERT_TRUE(list.selected == 3);
+    ASSERT_TRUE(list.scroll_px == ROW_H);
+    ASSERT_TRUE(!ui_list_is_animating(&list));
+    return 0;
+}
+
+static int test_baseline_follows_row_height(void) {
+    ui_list_t list;
+    draw_log_t log;
+    int ascent = font_ascent(font_content);
+
+    /* Cap height centred: same gap above and below (rounded down above) */
+    for (int row_h = ascent; row_h <= 24; row_h++) {
+        ui_list_init(&list, row_h, ROWS);
+        ui_list_set_count(&list, 10);
+        render(&list, 1000, &log);
+        int above = log.first_y - 16 - ascent;
+        int below = row_h - (log.first_y - 16);
+        ASSERT_TRUE(above >= 0 && below >= 0);
+        ASSERT_TRUE(below - above == 0 || below - above == 1);
+    }
+    return 0;
+}
+
+static int test_change_log(void) {
+    sys_status_t status;
+    memset(&status, 0, sizeof(status));
+
+    uint32_t cursor = 0;
+    int index = -1;
+    ASSERT_TRUE(sys_status_next_changed_service(&status, &cursor, &index) == 0);
+
+    /* Two logged changes are returned in order */
+    status.service_change_log[0] = 7;
+    status.service_change_log[1] = 2;
+    status.service_change_seq = 2;
+    ASSERT_TRUE(sys_status_next_changed_service(&status, &cursor, &index) == 1);
+    ASSERT_TRUE(index == 7);
+    ASSERT_TRUE(sys_status_next_changed_service(&status, &cursor, &index) == 1);
+    ASSERT_TRUE(index == 2);
+    ASSERT_TRUE(sys_status_next_changed_service(&status, &cursor, &index) == 0);
+
+    /* Lagging consumer is told to resync and moved to the head */
+    status.service_change_seq = cursor + SERVICE_CHANGE_LOG_SIZE + 1;
+    ASSERT_TRUE(sys_status_next_changed_service(&status, &cursor, &index) == -1);
+    ASSERT_TRUE(cursor == status.service_change_seq);
+    ASSERT_TRUE(sys_status_next_changed_service(&status, &cursor, &index) == 0);
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("=== test_ui_list ===\n");
+
+    failures += test_renders_visible_rows_only();
+    failures += test_smooth_scroll();
+    failures += test_baseline_follows_row_height();
+    failures += test_change_log();
+
+    printf("=== failures: %d ===\n", failures);
+    return failures ? 1 : 0;
+}
@@ -1,8 +1,13 @@
 /*
- * UI refresh policy tests (50ms / 1000ms / 0)
+ * UI refresh policy tests (50ms / 1000ms / 0, service query back-off)
  */
 #include <stdio.h>
+#include <libubox/uloop.h>
 
+#include "hal/time_hal.h"
+#include "hal/ubus_hal.h"
+#include "pages/pages.h"
+#include "service_config.h"
 #include "ui_controller.h"
 
 #define ASSERT_TRUE(cond) do { \
@@ -12,6 +17,17 @@
     } \
 } while (0)
 
+/* Test injection API from mock */
+extern int ubus_mock_get_pending_count(void);
+
+/* Tick until the slide animation has finished */
+static void finish_slide(ui_controller_t *ui, uint64_t *now_ms) {
+    for (int i = 0; i < 50 && page_controller_is_animating(&ui->page_ctrl); i++) {
+        *now_ms += UI_TICK_ANIM_MS;
+        ui_controller_tick(ui, *now_ms);
+    }
+}
+
 static int test_refresh_policy(void) {
     ui_controller_t ui;
     ui_controller_init(&ui);
@@ -31,9 +47,49 @@ static int test_refresh_policy(void) {
     return 0;
 }
 
+static int test_service_prefetch(void) {
+    uloop_init();
+    ubus_hal->init();
+    service_config_set_path("/nonexistent/nanohat-oled");
+    service_config_reload();
+
+    ui_controller_t ui;
+    ui_controller_init(&ui);
+    ASSERT_TRUE(ui.status.service_count > 0);
+    ASSERT_TRUE(page_controller_page_distance(&ui.page_ctrl, &page_services) == 2);
+
+    /* Data is 10 s old: due on the Services page, not elsewhere */
+    for (size_t i = 0; i < ui.status.service_count; i++) {
+        ui.status.services[i].last_update_ms = time_hal_now_ms() - 10000;
+    }
+
+    uint64_t now_ms = 1000;
+    ui_controller_tick(&ui, now_ms);
+    ASSERT_TRUE(ubus_mock_get_pending_count() == 0);
+
+    /* Adjacent page: 10 s is within UI_SERVICE_REFRESH_ADJACENT_MS */
+    ui_controller_handle_button(&ui, KEY_K3, false, now_ms);
+    finish_slide(&ui, &now_ms);
+    ASSERT_TRUE(page_controller_page_distance(&ui.page_ctrl, &page_services) == 1);
+    ASSERT_TRUE(ubus_mock_get_pending_count() == 0);
+
+    /* Slide towards Services: queries go out before the slide ends */
+    ui_controller_handle_button(&ui, KEY_K3, false, now_ms);
+    ASSERT_TRUE(page_controller_is_animating(&ui.page_ctrl));
+    ASSERT_TRUE(page_controller_page_distance(&ui.page_ctrl, &page_services) == 0);
+    ASSERT_TRUE(ubus_mock_get_pending_count() == (int)ui.status.service_count);
+
+    ui_controller_cleanup(&ui);
+    ubus_hal->cleanup();
+    uloop_done();
+    service_config_set_path(NULL);
+    return 0;
+}
+
 int main(void) {
     printf("=== test_ui_refresh_policy ===\n");
     int failures = test_refresh_policy();
+    failures += test_service_prefetch();
     printf("=== failures: %d ===\n", failures);
     return failures ? 1 : 0;
 }